@@ -17,24 +17,27 @@ void EpdFont::getTextBounds(const char* string, const int startX, const int star
 
   int cursorX = startX;
   const int cursorY = startY;
-  uint32_t cp;
-  while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&string)))) {
-    const EpdGlyph* glyph = getGlyph(cp);
-
-    if (!glyph) {
-      glyph = getGlyph(REPLACEMENT_GLYPH);
-    }
-
-    if (!glyph) {
-      // TODO: Better handle this?
-      continue;
+  uint32_t span[UTF8_SPAN_MAX];
+  size_t count;
+  while ((count = utf8NextCodepoints(reinterpret_cast<const uint8_t**>(&string), span, UTF8_SPAN_MAX))) {
+    for (size_t i = 0; i < count; i++) {
+      const EpdGlyph* glyph = getGlyph(span[i]);
+
+      if (!glyph) {
+        glyph = getGlyph(REPLACEMENT_GLYPH);
+      }
+
+      if (!glyph) {
+        // TODO: Better handle this?
+        continue;
+      }
+
+      *minX = std::min(*minX, cursorX + glyph->left);
+      *maxX = std::max(*maxX, cursorX + glyph->left + glyph->width);
+      *minY = std::min(*minY, cursorY + glyph->top - glyph->height);
+      *maxY = std::max(*maxY, cursorY + glyph->top);
+      cursorX += glyph->advanceX;
     }
-
-    *minX = std::min(*minX, cursorX + glyph->left);
-    *maxX = std::max(*maxX, cursorX + glyph->left + glyph->width);
-    *minY = std::min(*minY, cursorY + glyph->top - glyph->height);
-    *maxY = std::max(*maxY, cursorY + glyph->top);
-    cursorX += glyph->advanceX;
   }
 }
 
@@ -68,7 +71,12 @@ const EpdGlyph* EpdFont::getGlyph(const uint32_t cp) const {
       left = mid + 1;
     } else {
       // Found: cp >= interval->first && cp <= interval->last
-      return &data->glyph[interval->offset + (cp - interval->first)];
+      const uint32_t glyphIndex = interval->offset + (cp - interval->first);
+      if (!data->glyph) {
+        // Font packs on the SD card page their glyph metrics in on demand
+        return data->groupSource ? data->groupSource->getGlyph(glyphIndex) : nullptr;
+      }
+      return &data->glyph[glyphIndex];
     }
   }
 
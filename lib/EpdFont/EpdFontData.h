@@ -21,7 +21,8 @@ typedef struct {
   uint32_t compressedSize;    ///< Compressed DEFLATE stream size
   uint32_t uncompressedSize;  ///< Decompressed size
   uint16_t glyphCount;        ///< Number of glyphs in this group
-  uint16_t firstGlyphIndex;   ///< First glyph index in the global glyph array
+  uint16_t firstGlyphIndex;   ///< First glyph index in the global glyph array (groups may be non-contiguous, see
+                              ///< EpdFontData::glyphToGroup)
 } EpdFontGroup;
 
 /// Glyph interval structure
@@ -31,16 +32,34 @@ typedef struct {
   uint32_t offset;  ///< Index of the first code point into the glyph array
 } EpdUnicodeInterval;
 
+/// Reads glyph metrics and compressed group data for fonts that are not memory mapped (e.g. .epdfont files on the SD
+/// card)
+class EpdFontGroupSource {
+ public:
+  virtual ~EpdFontGroupSource() = default;
+  /// Read `size` bytes starting `offset` bytes into the compressed data. Returns true if all bytes were read.
+  virtual bool readCompressed(uint32_t offset, uint32_t size, uint8_t* out) = 0;
+  /// Metrics of glyph `glyphIndex`, or NULL. Only valid until a few more glyphs have been looked up, like the bitmaps
+  /// handed out by FontDecompressor.
+  virtual const EpdGlyph* getGlyph(uint32_t glyphIndex) = 0;
+  /// Group index of a glyph returned by getGlyph(), or EpdFontData::groupCount if it is no longer paged in
+  virtual uint16_t getGroupIndex(const EpdGlyph* glyph) const = 0;
+  /// Index of a glyph returned by getGlyph(), or UINT32_MAX if it is no longer paged in
+  virtual uint32_t getGlyphIndex(const EpdGlyph* glyph) const = 0;
+};
+
 /// Data stored for FONT AS A WHOLE
 typedef struct {
-  const uint8_t* bitmap;                ///< Glyph bitmaps, concatenated
-  const EpdGlyph* glyph;                ///< Glyph array
+  const uint8_t* bitmap;                ///< Glyph bitmaps, concatenated (NULL when read through groupSource)
+  const EpdGlyph* glyph;                ///< Glyph array (NULL when read through groupSource)
   const EpdUnicodeInterval* intervals;  ///< Valid unicode intervals for this font
   uint32_t intervalCount;               ///< Number of unicode intervals.
   uint8_t advanceY;                     ///< Newline distance (y axis)
   int ascender;                         ///< Maximal height of a glyph above the base line
   int descender;                        ///< Maximal height of a glyph below the base line
   bool is2Bit;
-  const EpdFontGroup* groups;  ///< NULL for uncompressed fonts
-  uint16_t groupCount;         ///< 0 for uncompressed fonts
+  const EpdFontGroup* groups;       ///< NULL for uncompressed fonts
+  uint16_t groupCount;              ///< 0 for uncompressed fonts
+  const uint16_t* glyphToGroup;     ///< Group index for each glyph, NULL for uncompressed and paged fonts
+  EpdFontGroupSource* groupSource;  ///< Set when `glyph` and `bitmap` are NULL and read on demand, NULL otherwise
 } EpdFontData;
@@ -0,0 +1,235 @@
+#include "EpdFontFile.h"
+
+#include <Logging.h>
+
+#include <algorithm>
+#include <cstring>
+
+// The tables are stored with the in-memory layout of the structs (little-endian, natural alignment), so they can be
+// read straight into place
+static_assert(sizeof(EpdUnicodeInterval) == 12, "EpdUnicodeInterval layout does not match the .epdfont format");
+static_assert(sizeof(EpdGlyph) == 16, "EpdGlyph layout does not match the .epdfont format");
+static_assert(sizeof(EpdFontGroup) == 16, "EpdFontGroup layout does not match the .epdfont format");
+
+namespace {
+constexpr char MAGIC[4] = {'E', 'P', 'D', 'F'};
+constexpr uint8_t FLAG_2BIT = 0x01;
+
+struct __attribute__((packed)) EpdFontFileHeader {
+  char magic[4];
+  uint16_t version;
+  uint8_t flags;
+  uint8_t advanceY;
+  int16_t ascender;
+  int16_t descender;
+  uint32_t intervalCount;
+  uint32_t glyphCount;
+  uint32_t groupCount;
+  uint32_t intervalsOffset;
+  uint32_t glyphsOffset;
+  uint32_t groupsOffset;
+  uint32_t glyphToGroupOffset;
+  uint32_t bitmapOffset;
+  uint32_t bitmapSize;
+};
+static_assert(sizeof(EpdFontFileHeader) == 48, "Unexpected .epdfont header size");
+
+// True if `count` records of `recordSize` bytes starting at `offset` lie within the file. Computed in 64 bits, so a
+// corrupt count cannot wrap around
+bool tableFits(const uint64_t fileSize, const uint32_t offset, const uint32_t count, const size_t recordSize) {
+  return static_cast<uint64_t>(offset) + static_cast<uint64_t>(count) * recordSize <= fileSize;
+}
+}  // namespace
+
+template <typename T>
+bool EpdFontFile::readTable(const uint32_t offset, std::vector<T>& table, const uint32_t count) {
+  if (!tableFits(file.size(), offset, count, sizeof(T)) || !file.seek(offset)) {
+    return false;
+  }
+  table.resize(count);
+  const size_t bytes = count * sizeof(T);
+  return file.read(reinterpret_cast<uint8_t*>(table.data()), bytes) == static_cast<int>(bytes);
+}
+
+bool EpdFontFile::open(const std::string& path) {
+  close();
+
+  if (!Storage.openFileForRead("EFF", path, file)) {
+    return false;
+  }
+
+  EpdFontFileHeader header;
+  if (file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header) ||
+      memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+    LOG_ERR("EFF", "Not an .epdfont file: %s", path.c_str());
+    close();
+    return false;
+  }
+
+  if (header.version != VERSION) {
+    LOG_ERR("EFF", "Unsupported .epdfont version %u (expected %u): %s", header.version, VERSION, path.c_str());
+    close();
+    return false;
+  }
+
+  if (header.intervalCount == 0 || header.intervalCount > MAX_INTERVALS || header.glyphCount == 0 ||
+      header.groupCount == 0 || header.groupCount > MAX_GROUPS) {
+    LOG_ERR("EFF", "Invalid .epdfont tables (%u intervals, %u glyphs, %u groups): %s", header.intervalCount,
+            header.glyphCount, header.groupCount, path.c_str());
+    close();
+    return false;
+  }
+
+  // The glyph tables are paged in later, so check up front that they are complete
+  const uint64_t fileSize = file.size();
+  if (!tableFits(fileSize, header.glyphsOffset, header.glyphCount, sizeof(EpdGlyph)) ||
+      !tableFits(fileSize, header.glyphToGroupOffset, header.glyphCount, sizeof(uint16_t)) ||
+      !tableFits(fileSize, header.bitmapOffset, header.bitmapSize, 1) ||
+      !readTable(header.intervalsOffset, intervals, header.intervalCount) ||
+      !readTable(header.groupsOffset, groups, header.groupCount)) {
+    LOG_ERR("EFF", "Truncated .epdfont file: %s", path.c_str());
+    close();
+    return false;
+  }
+
+  // Validate everything the renderer indexes with, so a corrupt file cannot cause out of bounds reads later. Glyph to
+  // group entries are paged in, so getGroupIndex() checks them on use.
+  for (const auto& interval : intervals) {
+    if (interval.last < interval.first ||
+        static_cast<uint64_t>(interval.offset) + (interval.last - interval.first) >= header.glyphCount) {
+      LOG_ERR("EFF", "Interval U+%04X-U+%04X out of range: %s", interval.first, interval.last, path.c_str());
+      close();
+      return false;
+    }
+  }
+  for (const auto& group : groups) {
+    if (static_cast<uint64_t>(group.compressedOffset) + group.compressedSize > header.bitmapSize) {
+      LOG_ERR("EFF", "Group data out of range: %s", path.c_str());
+      close();
+      return false;
+    }
+  }
+
+  pages.resize(PAGE_SLOTS);
+  glyphCount = header.glyphCount;
+  glyphsOffset = header.glyphsOffset;
+  glyphToGroupOffset = header.glyphToGroupOffset;
+  bitmapOffset = header.bitmapOffset;
+  bitmapSize = header.bitmapSize;
+
+  data.bitmap = nullptr;
+  data.glyph = nullptr;
+  data.intervals = intervals.data();
+  data.intervalCount = header.intervalCount;
+  data.advanceY = header.advanceY;
+  data.ascender = header.ascender;
+  data.descender = header.descender;
+  data.is2Bit = (header.flags & FLAG_2BIT) != 0;
+  data.groups = groups.data();
+  data.groupCount = static_cast<uint16_t>(header.groupCount);
+  data.glyphToGroup = nullptr;
+  data.groupSource = this;
+
+  LOG_DBG("EFF", "Loaded %s: %u intervals, %u glyphs, %u groups, %u compressed bytes", path.c_str(),
+          header.intervalCount, header.glyphCount, header.groupCount, header.bitmapSize);
+  return true;
+}
+
+void EpdFontFile::close() {
+  if (file.isOpen()) {
+    file.close();
+  }
+  intervals.clear();
+  intervals.shrink_to_fit();
+  groups.clear();
+  groups.shrink_to_fit();
+  pages.clear();
+  pages.shrink_to_fit();
+  lastPageSlot = 0;
+  accessCounter = 0;
+  data = {};
+  glyphCount = 0;
+  glyphsOffset = 0;
+  glyphToGroupOffset = 0;
+  bitmapOffset = 0;
+  bitmapSize = 0;
+}
+
+bool EpdFontFile::readCompressed(const uint32_t offset, const uint32_t size, uint8_t* out) {
+  if (!file.isOpen() || static_cast<uint64_t>(offset) + size > bitmapSize) {
+    return false;
+  }
+  if (!file.seek(bitmapOffset + offset)) {
+    return false;
+  }
+  return file.read(out, size) == static_cast<int>(size);
+}
+
+bool EpdFontFile::loadPage(GlyphPage& slot, const uint32_t page) {
+  const uint32_t first = page * GLYPHS_PER_PAGE;
+  const uint32_t count = std::min(GLYPHS_PER_PAGE, glyphCount - first);
+  const int glyphBytes = static_cast<int>(count * sizeof(EpdGlyph));
+  const int groupBytes = static_cast<int>(count * sizeof(uint16_t));
+
+  slot.page = UINT32_MAX;
+  if (!file.seek(glyphsOffset + first * sizeof(EpdGlyph)) ||
+      file.read(reinterpret_cast<uint8_t*>(slot.glyphs), glyphBytes) != glyphBytes ||
+      !file.seek(glyphToGroupOffset + first * sizeof(uint16_t)) ||
+      file.read(reinterpret_cast<uint8_t*>(slot.groups), groupBytes) != groupBytes) {
+    LOG_ERR("EFF", "Failed to read glyph page %u", page);
+    return false;
+  }
+  slot.page = page;
+  return true;
+}
+
+const EpdGlyph* EpdFontFile::getGlyph(const uint32_t glyphIndex) {
+  if (glyphIndex >= glyphCount) {
+    return nullptr;
+  }
+  const uint32_t page = glyphIndex / GLYPHS_PER_PAGE;
+
+  // Consecutive lookups mostly hit the same page, check it before scanning
+  GlyphPage* slot = &pages[lastPageSlot];
+  if (slot->page != page) {
+    GlyphPage* lru = &pages[0];
+    slot = nullptr;
+    for (auto& candidate : pages) {
+      if (candidate.page == page) {
+        slot = &candidate;
+        break;
+      }
+      if (candidate.lastUsed < lru->lastUsed) {
+        lru = &candidate;
+      }
+    }
+    if (!slot) {
+      if (!loadPage(*lru, page)) {
+        return nullptr;
+      }
+      slot = lru;
+    }
+    lastPageSlot = static_cast<uint8_t>(slot - pages.data());
+  }
+  slot->lastUsed = ++accessCounter;
+  return &slot->glyphs[glyphIndex % GLYPHS_PER_PAGE];
+}
+
+uint16_t EpdFontFile::getGroupIndex(const EpdGlyph* glyph) const {
+  for (const auto& slot : pages) {
+    if (slot.page != UINT32_MAX && glyph >= slot.glyphs && glyph < slot.glyphs + GLYPHS_PER_PAGE) {
+      const uint16_t group = slot.groups[glyph - slot.glyphs];
+      return group < data.groupCount ? group : data.groupCount;
+    }
+  }
+  return data.groupCount;
+}
+
+uint32_t EpdFontFile::getGlyphIndex(const EpdGlyph* glyph) const {
+  for (const auto& slot : pages) {
+    if (slot.page != UINT32_MAX && glyph >= slot.glyphs && glyph < slot.glyphs + GLYPHS_PER_PAGE) {
+      return slot.page * GLYPHS_PER_PAGE + static_cast<uint32_t>(glyph - slot.glyphs);
+    }
+  }
+  return UINT32_MAX;
+}
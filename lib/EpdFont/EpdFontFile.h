@@ -0,0 +1,70 @@
+#pragma once
+
+#include <HalStorage.h>
+
+#include <string>
+#include <vector>
+
+#include "EpdFontData.h"
+
+/**
+ * Font pack read from a `.epdfont` file on the SD card (format: docs/file-formats.md).
+ *
+ * Only the interval and group tables are loaded into RAM. Glyph metrics are paged in from the card GLYPHS_PER_PAGE at a
+ * time into a small LRU cache, so the RAM taken does not grow with the glyph count (CJK packs hold tens of thousands).
+ * Compressed glyph groups stay on the card and are paged in by FontDecompressor. Both go through the EpdFontGroupSource
+ * interface, so `getData()` can be wrapped in an EpdFont and used by the renderer exactly like a builtin font.
+ *
+ * The file must outlive every EpdFont that references it. Clear the renderer's font cache before closing it, as the
+ * decompressor keys cached groups by EpdFontData pointer.
+ */
+class EpdFontFile final : public EpdFontGroupSource {
+ public:
+  static constexpr uint16_t VERSION = 1;
+  // Cap the RAM taken by the tables that stay resident (12 bytes per interval, 16 bytes per group)
+  static constexpr uint32_t MAX_INTERVALS = 2048;
+  static constexpr uint32_t MAX_GROUPS = 1024;
+  // Glyph metric pages: 32 slots of 16 glyphs take about 9.5KB
+  static constexpr uint32_t GLYPHS_PER_PAGE = 16;
+  static constexpr uint8_t PAGE_SLOTS = 32;
+
+  EpdFontFile() = default;
+  ~EpdFontFile() override { close(); }
+  EpdFontFile(const EpdFontFile&) = delete;
+  EpdFontFile& operator=(const EpdFontFile&) = delete;
+
+  bool open(const std::string& path);
+  void close();
+  bool isOpen() const { return file.isOpen(); }
+  const EpdFontData* getData() const { return &data; }
+
+  bool readCompressed(uint32_t offset, uint32_t size, uint8_t* out) override;
+  const EpdGlyph* getGlyph(uint32_t glyphIndex) override;
+  uint16_t getGroupIndex(const EpdGlyph* glyph) const override;
+  uint32_t getGlyphIndex(const EpdGlyph* glyph) const override;
+
+ private:
+  struct GlyphPage {
+    uint32_t page = UINT32_MAX;  // Glyph index / GLYPHS_PER_PAGE, UINT32_MAX when the slot is empty
+    uint32_t lastUsed = 0;
+    EpdGlyph glyphs[GLYPHS_PER_PAGE];
+    uint16_t groups[GLYPHS_PER_PAGE];
+  };
+
+  FsFile file;
+  uint32_t glyphCount = 0;
+  uint32_t glyphsOffset = 0;
+  uint32_t glyphToGroupOffset = 0;
+  uint32_t bitmapOffset = 0;
+  uint32_t bitmapSize = 0;
+  std::vector<EpdUnicodeInterval> intervals;
+  std::vector<EpdFontGroup> groups;
+  std::vector<GlyphPage> pages;
+  uint8_t lastPageSlot = 0;
+  uint32_t accessCounter = 0;
+  EpdFontData data = {};
+
+  template <typename T>
+  bool readTable(uint32_t offset, std::vector<T>& table, uint32_t count);
+  bool loadPage(GlyphPage& slot, uint32_t page);
+};
@@ -29,7 +29,15 @@ void FontDecompressor::clearCache() {
   accessCounter = 0;
 }
 
-uint16_t FontDecompressor::getGroupIndex(const EpdFontData* fontData, uint16_t glyphIndex) {
+uint16_t FontDecompressor::getGroupIndex(const EpdFontData* fontData, const EpdGlyph* glyph, uint32_t glyphIndex) {
+  if (!fontData->glyph && fontData->groupSource) {
+    return fontData->groupSource->getGroupIndex(glyph);
+  }
+  // Generated fonts carry a direct glyph -> group table. The scan fallback only works for contiguous (script-based)
+  // groups, frequency-grouped fonts always ship the table.
+  if (fontData->glyphToGroup) {
+    return fontData->glyphToGroup[glyphIndex];
+  }
   for (uint16_t i = 0; i < fontData->groupCount; i++) {
     uint16_t first = fontData->groups[i].firstGlyphIndex;
     if (glyphIndex >= first && glyphIndex < first + fontData->groups[i].glyphCount) {
@@ -82,9 +90,28 @@ bool FontDecompressor::decompressGroup(const EpdFontData* fontData, uint16_t gro
     return false;
   }
 
-  // Decompress using uzlib
-  const uint8_t* inputBuf = &fontData->bitmap[group.compressedOffset];
+  // Fonts that are not memory mapped (SD card font packs) page the compressed group into a temporary buffer
+  uint8_t* pagedBuf = nullptr;
+  const uint8_t* inputBuf;
+  if (fontData->groupSource) {
+    pagedBuf = static_cast<uint8_t*>(malloc(group.compressedSize));
+    if (!pagedBuf) {
+      LOG_ERR("FDC", "Failed to allocate %u bytes to page in group %u", group.compressedSize, groupIndex);
+      free(outBuf);
+      return false;
+    }
+    if (!fontData->groupSource->readCompressed(group.compressedOffset, group.compressedSize, pagedBuf)) {
+      LOG_ERR("FDC", "Failed to read group %u from font source", groupIndex);
+      free(pagedBuf);
+      free(outBuf);
+      return false;
+    }
+    inputBuf = pagedBuf;
+  } else {
+    inputBuf = &fontData->bitmap[group.compressedOffset];
+  }
 
+  // Decompress using uzlib
   uzlib_uncompress_init(&decomp, NULL, 0);
   decomp.source = inputBuf;
   decomp.source_limit = inputBuf + group.compressedSize;
@@ -93,6 +120,7 @@ bool FontDecompressor::decompressGroup(const EpdFontData* fontData, uint16_t gro
   decomp.dest_limit = outBuf + group.uncompressedSize;
 
   int res = uzlib_uncompress(&decomp);
+  free(pagedBuf);
 
   if (res < 0 || decomp.dest != decomp.dest_limit) {
     LOG_ERR("FDC", "Decompression failed for group %u (status %d)", groupIndex, res);
@@ -108,14 +136,14 @@ bool FontDecompressor::decompressGroup(const EpdFontData* fontData, uint16_t gro
   return true;
 }
 
-const uint8_t* FontDecompressor::getBitmap(const EpdFontData* fontData, const EpdGlyph* glyph, uint16_t glyphIndex) {
+const uint8_t* FontDecompressor::getBitmap(const EpdFontData* fontData, const EpdGlyph* glyph, uint32_t glyphIndex) {
   if (!fontData->groups || fontData->groupCount == 0) {
     return &fontData->bitmap[glyph->dataOffset];
   }
 
-  uint16_t groupIndex = getGroupIndex(fontData, glyphIndex);
+  uint16_t groupIndex = getGroupIndex(fontData, glyph, glyphIndex);
   if (groupIndex >= fontData->groupCount) {
-    LOG_ERR("FDC", "Glyph %u not found in any group", glyphIndex);
+    LOG_ERR("FDC", "Glyph %lu not found in any group", static_cast<unsigned long>(glyphIndex));
     return nullptr;
   }
 
@@ -13,7 +13,8 @@ class FontDecompressor {
 
   // Returns pointer to decompressed bitmap data for the given glyph.
   // Valid until LRU eviction (safe for the duration of one glyph render).
-  const uint8_t* getBitmap(const EpdFontData* fontData, const EpdGlyph* glyph, uint16_t glyphIndex);
+  // Fonts paged from a groupSource know the group of each glyph they hand out; `glyphIndex` only names it in errors.
+  const uint8_t* getBitmap(const EpdFontData* fontData, const EpdGlyph* glyph, uint32_t glyphIndex);
 
   // Evict all cached decompressed groups (call between pages for within-page-only caching).
   void clearCache();
@@ -35,7 +36,7 @@ class FontDecompressor {
   uint32_t accessCounter = 0;
 
   void freeAllEntries();
-  uint16_t getGroupIndex(const EpdFontData* fontData, uint16_t glyphIndex);
+  uint16_t getGroupIndex(const EpdFontData* fontData, const EpdGlyph* glyph, uint32_t glyphIndex);
   CacheEntry* findInCache(const EpdFontData* fontData, uint16_t groupIndex);
   CacheEntry* findEvictionCandidate();
   bool decompressGroup(const EpdFontData* fontData, uint16_t groupIndex, CacheEntry* entry);
@@ -0,0 +1,53 @@
+"""
+Writer for the binary .epdfont font pack format read by EpdFontFile on the device (see docs/file-formats.md).
+
+All values are little-endian. Tables use the in-memory layout of the matching EpdFontData.h structs so the device can
+read them straight into RAM.
+"""
+import struct
+
+MAGIC = b"EPDF"
+VERSION = 1
+FLAG_2BIT = 0x01
+
+HEADER_FORMAT = "<4sHBBhhIIIIIIIII"
+INTERVAL_FORMAT = "<III"          # EpdUnicodeInterval: first, last, offset
+GLYPH_FORMAT = "<BBBxhhHxxI"      # EpdGlyph: width, height, advanceX, left, top, dataLength, dataOffset
+GROUP_FORMAT = "<IIIHH"           # EpdFontGroup: compressedOffset, compressedSize, uncompressedSize, glyphCount, firstGlyphIndex
+
+
+def _align(data, alignment=4):
+    return data + b"\0" * (-len(data) % alignment)
+
+
+def write_epdfont(path, *, is2Bit, advance_y, ascender, descender, intervals, glyphs, groups, glyph_to_group,
+                  compressed_data):
+    """
+    intervals:      list of (first, last, offset)
+    glyphs:         list of (width, height, advance_x, left, top, data_length, data_offset) with in-group offsets
+    groups:         list of (compressed_offset, compressed_size, uncompressed_size, glyph_count, first_glyph_index)
+    glyph_to_group: list of group indices, one per glyph
+    """
+    header_size = struct.calcsize(HEADER_FORMAT)
+    interval_table = b"".join(struct.pack(INTERVAL_FORMAT, *i) for i in intervals)
+    glyph_table = b"".join(struct.pack(GLYPH_FORMAT, *g) for g in glyphs)
+    group_table = b"".join(struct.pack(GROUP_FORMAT, *g) for g in groups)
+    mapping_table = _align(b"".join(struct.pack("<H", g) for g in glyph_to_group))
+
+    intervals_offset = header_size
+    glyphs_offset = intervals_offset + len(interval_table)
+    groups_offset = glyphs_offset + len(glyph_table)
+    glyph_to_group_offset = groups_offset + len(group_table)
+    bitmap_offset = glyph_to_group_offset + len(mapping_table)
+
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, FLAG_2BIT if is2Bit else 0, advance_y, ascender, descender,
+                         len(intervals), len(glyphs), len(groups), intervals_offset, glyphs_offset, groups_offset,
+                         glyph_to_group_offset, bitmap_offset, len(compressed_data))
+
+    with open(path, "wb") as f:
+        f.write(header)
+        f.write(interval_table)
+        f.write(glyph_table)
+        f.write(group_table)
+        f.write(mapping_table)
+        f.write(bytes(compressed_data))
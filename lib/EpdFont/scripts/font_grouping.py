@@ -0,0 +1,179 @@
+"""
+Glyph grouping strategies for compressed fonts.
+
+Shared by fontconvert.py (to build the groups it compresses) and simulate_group_cache.py (to compare strategies
+against sample text without needing the font sources). A group is a sorted list of glyph indices; its bitmaps
+are concatenated in that order and compressed as one DEFLATE stream.
+"""
+import html.parser
+import posixpath
+import re
+import zipfile
+from collections import Counter
+
+# Script-based grouping: glyphs in the same Unicode block are grouped together.
+SCRIPT_GROUP_RANGES = [
+    (0x0000, 0x007F),   # ASCII
+    (0x0080, 0x00FF),   # Latin-1 Supplement
+    (0x0100, 0x017F),   # Latin Extended-A
+    (0x0300, 0x036F),   # Combining Diacritical Marks
+    (0x0400, 0x04FF),   # Cyrillic
+    (0x2000, 0x206F),   # General Punctuation
+    (0x2070, 0x209F),   # Superscripts & Subscripts
+    (0x20A0, 0x20CF),   # Currency Symbols
+    (0x2190, 0x21FF),   # Arrows
+    (0x2200, 0x22FF),   # Math Operators
+    (0xFFFD, 0xFFFD),   # Replacement Character
+]
+
+# Matches FontDecompressor::CACHE_SLOTS on the device
+RUNTIME_CACHE_SLOTS = 4
+
+# Default uncompressed size cap for frequency groups. Each cache slot holds one decompressed group, so this bounds
+# the RAM a page of common text needs.
+DEFAULT_GROUP_BUDGET = 12 * 1024
+
+# Approximate number of characters on a reader page, used to split corpora into pages
+DEFAULT_PAGE_CHARS = 1500
+
+
+def get_script_group(code_point):
+    for i, (start, end) in enumerate(SCRIPT_GROUP_RANGES):
+        if start <= code_point <= end:
+            return i
+    return -1
+
+
+def script_groups(code_points, glyph_indices=None):
+    """Split glyphs into runs of the same Unicode block. code_points is indexed by glyph index and must be sorted."""
+    if glyph_indices is None:
+        glyph_indices = range(len(code_points))
+
+    groups = []
+    current_group_id = None
+    for gi in glyph_indices:
+        sg = get_script_group(code_points[gi])
+        if groups and sg == current_group_id:
+            groups[-1].append(gi)
+        else:
+            groups.append([gi])
+            current_group_id = sg
+    return groups
+
+
+def frequency_groups(code_points, data_lengths, page_frequency, group_budget=DEFAULT_GROUP_BUDGET):
+    """
+    Pack glyphs by how many corpus pages they appear on.
+
+    Glyphs seen in the corpus are ranked by page frequency, so the glyphs that co-occur on nearly every page of the
+    language land in the first group. Groups are filled in rank order until the next glyph would push the
+    uncompressed size over group_budget. Glyphs never seen in the corpus fall back to script-based groups after the
+    frequency groups.
+    """
+    seen = [gi for gi, cp in enumerate(code_points) if page_frequency.get(cp, 0) > 0]
+    seen.sort(key=lambda gi: (-page_frequency[code_points[gi]], code_points[gi]))
+
+    groups = []
+    current = []
+    current_size = 0
+    for gi in seen:
+        if current and current_size + data_lengths[gi] > group_budget:
+            groups.append(sorted(current))
+            current = []
+            current_size = 0
+        current.append(gi)
+        current_size += data_lengths[gi]
+    if current:
+        groups.append(sorted(current))
+
+    seen_set = set(seen)
+    unseen = [gi for gi in range(len(code_points)) if gi not in seen_set]
+    groups.extend(script_groups(code_points, unseen))
+    return groups
+
+
+class _TextExtractor(html.parser.HTMLParser):
+    def __init__(self):
+        super().__init__()
+        self.parts = []
+        self.skip = 0
+
+    def handle_starttag(self, tag, attrs):
+        if tag in ("script", "style", "head"):
+            self.skip += 1
+
+    def handle_endtag(self, tag):
+        if tag in ("script", "style", "head") and self.skip > 0:
+            self.skip -= 1
+        elif tag in ("p", "div", "br", "li", "h1", "h2", "h3", "h4", "h5", "h6"):
+            self.parts.append("\n")
+
+    def handle_data(self, data):
+        if not self.skip:
+            self.parts.append(data)
+
+
+def html_to_text(markup):
+    extractor = _TextExtractor()
+    extractor.feed(markup)
+    return "".join(extractor.parts)
+
+
+def epub_chapters(path):
+    """Yield the plain text of each spine item of an EPUB, in reading order."""
+    with zipfile.ZipFile(path) as z:
+        container = z.read("META-INF/container.xml").decode("utf-8")
+        opf_path = re.search(r'full-path="([^"]+)"', container).group(1)
+        opf = z.read(opf_path).decode("utf-8")
+        base = posixpath.dirname(opf_path)
+
+        manifest = {}
+        for item in re.finditer(r"<item\b[^>]*>", opf):
+            tag = item.group(0)
+            item_id = re.search(r'\bid="([^"]+)"', tag)
+            href = re.search(r'\bhref="([^"]+)"', tag)
+            if item_id and href:
+                manifest[item_id.group(1)] = posixpath.normpath(posixpath.join(base, href.group(1)))
+
+        for ref in re.finditer(r'<itemref\b[^>]*\bidref="([^"]+)"', opf):
+            href = manifest.get(ref.group(1))
+            if href and href in z.namelist():
+                yield html_to_text(z.read(href).decode("utf-8", errors="replace"))
+
+
+def load_chapters(paths):
+    """Load sample chapters from .epub files (one chapter per spine item) or plain text files (one chapter each)."""
+    chapters = []
+    for path in paths:
+        if path.lower().endswith(".epub"):
+            chapters.extend(epub_chapters(path))
+        else:
+            with open(path, encoding="utf-8", errors="replace") as f:
+                chapters.append(f.read())
+    return chapters
+
+
+def paginate(text, page_chars=DEFAULT_PAGE_CHARS):
+    """Split text into pages of roughly page_chars characters on word boundaries, like the reader's layout."""
+    pages = []
+    current = []
+    current_len = 0
+    for word in text.split():
+        if current and current_len + len(word) + 1 > page_chars:
+            pages.append(" ".join(current))
+            current = []
+            current_len = 0
+        current.append(word)
+        current_len += len(word) + 1
+    if current:
+        pages.append(" ".join(current))
+    return pages
+
+
+def corpus_page_frequency(chapters, page_chars=DEFAULT_PAGE_CHARS):
+    """Count, for each code point, the number of pages it appears on."""
+    frequency = Counter()
+    for chapter in chapters:
+        for page in paginate(chapter, page_chars):
+            frequency.update(set(ord(c) for c in page))
+    return frequency
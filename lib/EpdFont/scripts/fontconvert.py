@@ -6,6 +6,8 @@ import re
 import math
 import argparse
 from collections import namedtuple
+from epdfont_format import write_epdfont
+from font_grouping import DEFAULT_GROUP_BUDGET, corpus_page_frequency, frequency_groups, load_chapters, script_groups
 
 # Originally from https://github.com/vroland/epdiy
 
@@ -16,7 +18,12 @@ parser.add_argument("fontstack", action="store", nargs='+', help="list of font f
 parser.add_argument("--2bit", dest="is2Bit", action="store_true", help="generate 2-bit greyscale bitmap instead of 1-bit black and white.")
 parser.add_argument("--additional-intervals", dest="additional_intervals", action="append", help="Additional code point intervals to export as min,max. This argument can be repeated.")
 parser.add_argument("--compress", dest="compress", action="store_true", help="Compress glyph bitmaps using DEFLATE with group-based compression.")
+parser.add_argument("--group-corpus", dest="group_corpus", action="append", help="Text or EPUB file used to group glyphs by how often they appear together on a page (requires --compress). This argument can be repeated.")
+parser.add_argument("--group-budget", dest="group_budget", type=int, default=DEFAULT_GROUP_BUDGET, help=f"Maximum uncompressed bytes per frequency group (default {DEFAULT_GROUP_BUDGET}).")
+parser.add_argument("--epdfont", dest="epdfont", help="Also write the font as a binary .epdfont font pack to this path, for loading from the SD card (requires --compress).")
 args = parser.parse_args()
+if args.epdfont and not args.compress:
+    parser.error("--epdfont requires --compress")
 
 GlyphProps = namedtuple("GlyphProps", ["width", "height", "advance_x", "left", "top", "data_length", "data_offset", "code_point"])
 
@@ -275,48 +282,19 @@ compress = args.compress
 
 # Build groups for compression
 if compress:
-    # Script-based grouping: glyphs that co-occur in typical text rendering
-    # are grouped together for efficient LRU caching on the embedded target.
-    # Since glyphs are in codepoint order, glyphs in the same Unicode block
-    # are contiguous in the array and form natural groups.
-    SCRIPT_GROUP_RANGES = [
-        (0x0000, 0x007F),   # ASCII
-        (0x0080, 0x00FF),   # Latin-1 Supplement
-        (0x0100, 0x017F),   # Latin Extended-A
-        (0x0300, 0x036F),   # Combining Diacritical Marks
-        (0x0400, 0x04FF),   # Cyrillic
-        (0x2000, 0x206F),   # General Punctuation
-        (0x2070, 0x209F),   # Superscripts & Subscripts
-        (0x20A0, 0x20CF),   # Currency Symbols
-        (0x2190, 0x21FF),   # Arrows
-        (0x2200, 0x22FF),   # Math Operators
-        (0xFFFD, 0xFFFD),   # Replacement Character
-    ]
-
-    def get_script_group(code_point):
-        for i, (start, end) in enumerate(SCRIPT_GROUP_RANGES):
-            if start <= code_point <= end:
-                return i
-        return -1
-
-    groups = []  # list of (first_glyph_index, glyph_count)
-    current_group_id = None
-    group_start = 0
-    group_count = 0
-
-    for i, (props, packed) in enumerate(all_glyphs):
-        sg = get_script_group(props.code_point)
-        if sg != current_group_id:
-            if group_count > 0:
-                groups.append((group_start, group_count))
-            current_group_id = sg
-            group_start = i
-            group_count = 1
-        else:
-            group_count += 1
-
-    if group_count > 0:
-        groups.append((group_start, group_count))
+    code_points = [props.code_point for props in glyph_props]
+    if args.group_corpus:
+        # Frequency-driven grouping: glyphs that appear on most pages of the corpus are packed into the first
+        # groups, so a typical page touches as few groups (and decompressions) as possible.
+        page_frequency = corpus_page_frequency(load_chapters(args.group_corpus))
+        data_lengths = [props.data_length for props in glyph_props]
+        groups = frequency_groups(code_points, data_lengths, page_frequency, args.group_budget)
+    else:
+        # Script-based grouping: glyphs that co-occur in typical text rendering
+        # are grouped together for efficient LRU caching on the embedded target.
+        # Since glyphs are in codepoint order, glyphs in the same Unicode block
+        # are contiguous in the array and form natural groups.
+        groups = script_groups(code_points)
 
     # Compress each group
     compressed_groups = []  # list of (compressed_bytes, uncompressed_size, glyph_count, first_glyph_index)
@@ -326,10 +304,10 @@ if compress:
     # Also build modified glyph props with within-group offsets
     modified_glyph_props = list(glyph_props)
 
-    for first_idx, count in groups:
+    for members in groups:
         # Concatenate bitmap data for this group
         group_data = b''
-        for gi in range(first_idx, first_idx + count):
+        for gi in members:
             props, packed = all_glyphs[gi]
             # Update glyph's dataOffset to be within-group offset
             within_group_offset = len(group_data)
@@ -350,7 +328,7 @@ if compress:
         compressor = zlib.compressobj(level=9, wbits=-15)
         compressed = compressor.compress(group_data) + compressor.flush()
 
-        compressed_groups.append((compressed, len(group_data), count, first_idx))
+        compressed_groups.append((compressed, len(group_data), len(members), members[0]))
         compressed_bitmap_data.extend(compressed)
         compressed_offset += len(compressed)
 
@@ -401,6 +379,17 @@ if compress:
         compressed_offset += len(compressed)
     print("};\n")
 
+    # Glyph index -> group index, so the runtime can find a glyph's group without scanning the group table
+    # (frequency groups are not contiguous in the glyph array, so this is the only complete mapping)
+    glyph_to_group = [0] * len(glyph_props)
+    for group_index, members in enumerate(groups):
+        for gi in members:
+            glyph_to_group[gi] = group_index
+    print(f"static const uint16_t {font_name}GlyphToGroup[{len(glyph_to_group)}] = {{")
+    for c in chunks(glyph_to_group, 16):
+        print("    " + " ".join(f"{g}," for g in c))
+    print("};\n")
+
 print(f"static const EpdFontData {font_name} = {{")
 print(f"    {font_name}Bitmaps,")
 print(f"    {font_name}Glyphs,")
@@ -413,7 +402,34 @@ print(f"    {'true' if is2Bit else 'false'},")
 if compress:
     print(f"    {font_name}Groups,")
     print(f"    {len(compressed_groups)},")
+    print(f"    {font_name}GlyphToGroup,")
 else:
     print(f"    nullptr,")
     print(f"    0,")
+    print(f"    nullptr,")
 print("};")
+
+if args.epdfont:
+    interval_rows = []
+    offset = 0
+    for i_start, i_end in intervals:
+        interval_rows.append((i_start, i_end, offset))
+        offset += i_end - i_start + 1
+    group_rows = []
+    compressed_offset = 0
+    for compressed, uncompressed_size, count, first_idx in compressed_groups:
+        group_rows.append((compressed_offset, len(compressed), uncompressed_size, count, first_idx))
+        compressed_offset += len(compressed)
+    write_epdfont(
+        args.epdfont,
+        is2Bit=is2Bit,
+        advance_y=norm_ceil(face.size.height),
+        ascender=norm_ceil(face.size.ascender),
+        descender=norm_floor(face.size.descender),
+        intervals=interval_rows,
+        glyphs=[tuple(g[:-1]) for g in glyph_props],
+        groups=group_rows,
+        glyph_to_group=glyph_to_group,
+        compressed_data=compressed_bitmap_data,
+    )
+    print(f"// Wrote {args.epdfont}", file=sys.stderr)
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""
+Convert a compressed font header generated by fontconvert.py into a binary .epdfont font pack.
+
+Useful to move a builtin font out of flash onto the SD card without the original font sources.
+
+Usage:
+  header_to_epdfont.py ../builtinFonts/bookerly_14_regular.h bookerly_14_regular.epdfont
+"""
+import re
+import sys
+
+from epdfont_format import write_epdfont
+from verify_compression import parse_glyph_to_group, parse_glyphs, parse_groups, parse_hex_array
+
+
+def array_body(content, c_type, name):
+    match = re.search(r'static const ' + c_type + r' ' + re.escape(name) + r'\[\d*\]\s*=\s*\{(.+?)\};', content,
+                      re.DOTALL)
+    if not match:
+        raise ValueError(f"could not find {name}")
+    return match.group(1)
+
+
+def convert(header_path, output_path):
+    with open(header_path, 'r', encoding='utf-8', errors='replace') as f:
+        content = f.read()
+
+    data_match = re.search(r'static const EpdFontData (\w+) = \{(.+?)\};', content, re.DOTALL)
+    font_name = data_match.group(1)
+    fields = [v.strip() for v in data_match.group(2).split(',') if v.strip()]
+    # bitmap, glyph, intervals, intervalCount, advanceY, ascender, descender, is2Bit, groups, groupCount, glyphToGroup
+    if len(fields) < 11 or fields[8] == 'nullptr':
+        raise ValueError(f"{font_name} is not a compressed font (regenerate it with --compress)")
+
+    intervals = [(int(a, 16), int(b, 16), int(c, 16)) for a, b, c in re.findall(
+        r'\{\s*0x([0-9A-F]+),\s*0x([0-9A-F]+),\s*0x([0-9A-F]+)\s*\}',
+        array_body(content, 'EpdUnicodeInterval', font_name + 'Intervals'))]
+    glyphs = [(g['width'], g['height'], g['advanceX'], g['left'], g['top'], g['dataLength'], g['dataOffset'])
+              for g in parse_glyphs(array_body(content, 'EpdGlyph', font_name + 'Glyphs'))]
+    groups = [(g['compressedOffset'], g['compressedSize'], g['uncompressedSize'], g['glyphCount'], g['firstGlyphIndex'])
+              for g in parse_groups(array_body(content, 'EpdFontGroup', font_name + 'Groups'))]
+    glyph_to_group = parse_glyph_to_group(array_body(content, 'uint16_t', font_name + 'GlyphToGroup'))
+    compressed_data = parse_hex_array(array_body(content, 'uint8_t', font_name + 'Bitmaps'))
+
+    write_epdfont(
+        output_path,
+        is2Bit=fields[7] == 'true',
+        advance_y=int(fields[4]),
+        ascender=int(fields[5]),
+        descender=int(fields[6]),
+        intervals=intervals,
+        glyphs=glyphs,
+        groups=groups,
+        glyph_to_group=glyph_to_group,
+        compressed_data=compressed_data,
+    )
+    print(f"{font_name}: {len(intervals)} intervals, {len(glyphs)} glyphs, {len(groups)} groups -> {output_path}")
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(f"Usage: {sys.argv[0]} <font_header.h> <output.epdfont>", file=sys.stderr)
+        sys.exit(1)
+    try:
+        convert(sys.argv[1], sys.argv[2])
+    except ValueError as e:
+        print(f"Error: {e}", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+Host simulation of the FontDecompressor group cache.
+
+Replays sample chapters page by page against one or more generated font headers and reports how many group
+decompressions each page costs under each grouping strategy:
+
+  header     the groups stored in the header as generated
+  script     Unicode-block groups (fontconvert.py --compress)
+  frequency  corpus-driven groups (fontconvert.py --compress --group-corpus ...)
+
+Like the reader, the cache holds RUNTIME_CACHE_SLOTS decompressed groups with LRU eviction and is cleared after
+every page. Spaces are not rendered as glyphs (words are drawn one by one), so they are not counted.
+
+Usage:
+  simulate_group_cache.py ../builtinFonts/bookerly_14_regular.h --text book.epub [--corpus other.epub]
+"""
+import argparse
+import os
+import re
+import sys
+
+from font_grouping import (DEFAULT_GROUP_BUDGET, DEFAULT_PAGE_CHARS, RUNTIME_CACHE_SLOTS, corpus_page_frequency,
+                           frequency_groups, load_chapters, paginate, script_groups)
+from verify_compression import parse_glyph_to_group, parse_glyphs, parse_groups
+
+REPLACEMENT_GLYPH = 0xFFFD
+
+
+def parse_font_header(filepath):
+    """Return (font_name, code_points, data_lengths, glyph_to_group or None) for a generated font header."""
+    with open(filepath, 'r', encoding='utf-8', errors='replace') as f:
+        content = f.read()
+
+    font_name = re.search(r'static const EpdFontData (\w+) = \{', content).group(1)
+
+    glyphs_match = re.search(r'static const EpdGlyph ' + re.escape(font_name) + r'Glyphs\[\]\s*=\s*\{(.+?)\};',
+                             content, re.DOTALL)
+    glyphs = parse_glyphs(glyphs_match.group(1))
+
+    intervals_match = re.search(
+        r'static const EpdUnicodeInterval ' + re.escape(font_name) + r'Intervals\[\]\s*=\s*\{(.+?)\};', content,
+        re.DOTALL)
+    code_points = [0] * len(glyphs)
+    for first, last, offset in re.findall(r'\{\s*0x([0-9A-F]+),\s*0x([0-9A-F]+),\s*0x([0-9A-F]+)\s*\}',
+                                          intervals_match.group(1)):
+        first, last, offset = int(first, 16), int(last, 16), int(offset, 16)
+        for i in range(last - first + 1):
+            code_points[offset + i] = first + i
+
+    glyph_to_group = None
+    mapping_match = re.search(
+        r'static const uint16_t ' + re.escape(font_name) + r'GlyphToGroup\[\d+\]\s*=\s*\{(.+?)\};', content, re.DOTALL)
+    if mapping_match:
+        glyph_to_group = parse_glyph_to_group(mapping_match.group(1))
+    else:
+        groups_match = re.search(r'static const EpdFontGroup ' + re.escape(font_name) + r'Groups\[\]\s*=\s*\{(.+?)\};',
+                                 content, re.DOTALL)
+        if groups_match:
+            glyph_to_group = [0] * len(glyphs)
+            for gi, group in enumerate(parse_groups(groups_match.group(1))):
+                for j in range(group['glyphCount']):
+                    glyph_to_group[group['firstGlyphIndex'] + j] = gi
+
+    return font_name, code_points, [g['dataLength'] for g in glyphs], glyph_to_group
+
+
+def groups_to_mapping(groups, glyph_count):
+    glyph_to_group = [0] * glyph_count
+    for group_index, members in enumerate(groups):
+        for gi in members:
+            glyph_to_group[gi] = group_index
+    return glyph_to_group
+
+
+def simulate(pages, cp_to_glyph, glyph_to_group, data_lengths):
+    """Return (decompressions per page list, inflated bytes per page list, peak cached bytes)."""
+    group_sizes = {}
+    for gi, group in enumerate(glyph_to_group):
+        group_sizes[group] = group_sizes.get(group, 0) + data_lengths[gi]
+
+    fallback = cp_to_glyph.get(REPLACEMENT_GLYPH)
+    decompressions = []
+    inflated = []
+    peak = 0
+    for page in pages:
+        cache = []  # most recently used last
+        misses = 0
+        page_bytes = 0
+        for ch in page:
+            if ch.isspace():
+                continue
+            glyph = cp_to_glyph.get(ord(ch), fallback)
+            if glyph is None:
+                continue
+            group = glyph_to_group[glyph]
+            if group in cache:
+                cache.remove(group)
+            else:
+                misses += 1
+                page_bytes += group_sizes[group]
+                if len(cache) >= RUNTIME_CACHE_SLOTS:
+                    cache.pop(0)
+            cache.append(group)
+            peak = max(peak, sum(group_sizes[g] for g in cache))
+        decompressions.append(misses)
+        inflated.append(page_bytes)
+    return decompressions, inflated, peak
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Simulate font group cache behaviour for sample chapters.")
+    parser.add_argument("headers", nargs='+', help="generated font headers (.h) to simulate")
+    parser.add_argument("--text", action="append", required=True,
+                        help="sample chapters to replay (.epub or plain text). This argument can be repeated.")
+    parser.add_argument("--corpus", action="append",
+                        help="corpus for the frequency strategy (.epub or plain text, defaults to --text). "
+                             "This argument can be repeated.")
+    parser.add_argument("--page-chars", type=int, default=DEFAULT_PAGE_CHARS,
+                        help=f"approximate characters per page (default {DEFAULT_PAGE_CHARS})")
+    parser.add_argument("--group-budget", type=int, default=DEFAULT_GROUP_BUDGET,
+                        help=f"maximum uncompressed bytes per frequency group (default {DEFAULT_GROUP_BUDGET})")
+    args = parser.parse_args()
+
+    pages = [page for chapter in load_chapters(args.text) for page in paginate(chapter, args.page_chars)]
+    if not pages:
+        print("No text found in the sample chapters", file=sys.stderr)
+        sys.exit(1)
+
+    if not args.corpus:
+        print("Note: no --corpus given, frequency groups are built from the replayed text itself\n")
+    page_frequency = corpus_page_frequency(load_chapters(args.corpus or args.text), args.page_chars)
+
+    print(f"{len(pages)} pages, {RUNTIME_CACHE_SLOTS} cache slots, cache cleared after every page\n")
+    print(f"{'font':<28} {'strategy':<10} {'groups':>6} {'decomp/page':>11} {'max/page':>8} {'KB inflated/page':>16} "
+          f"{'peak cache KB':>13}")
+
+    for header in args.headers:
+        font_name, code_points, data_lengths, header_mapping = parse_font_header(header)
+        cp_to_glyph = {cp: gi for gi, cp in enumerate(code_points)}
+
+        strategies = []
+        if header_mapping is not None:
+            strategies.append(("header", header_mapping))
+        strategies.append(("script", groups_to_mapping(script_groups(code_points), len(code_points))))
+        strategies.append(("frequency",
+                           groups_to_mapping(
+                               frequency_groups(code_points, data_lengths, page_frequency, args.group_budget),
+                               len(code_points))))
+
+        for strategy, glyph_to_group in strategies:
+            decompressions, inflated, peak = simulate(pages, cp_to_glyph, glyph_to_group, data_lengths)
+            print(f"{font_name:<28} {strategy:<10} {len(set(glyph_to_group)):>6} "
+                  f"{sum(decompressions) / len(pages):>11.2f} {max(decompressions):>8} "
+                  f"{sum(inflated) / len(pages) / 1024:>16.1f} {peak / 1024:>13.1f}")
+
+
+if __name__ == '__main__':
+    main()
@@ -4,7 +4,8 @@ Round-trip verification for compressed font headers.
 
 Parses each generated .h file in the given directory, identifies compressed fonts
 (those with a Groups array), decompresses each group, and verifies that
-decompression succeeds and all glyph offsets/lengths fall within bounds.
+decompression succeeds, the glyph -> group table agrees with the group table,
+and all glyph offsets/lengths fall within bounds.
 """
 import os
 import re
@@ -48,6 +49,34 @@ def parse_glyphs(text):
     return glyphs
 
 
+def parse_glyph_to_group(text):
+    """Parse GlyphToGroup array entries: one group index per glyph"""
+    return [int(v) for v in re.findall(r'(\d+)\s*,', text)]
+
+
+def verify_glyph_to_group(glyph_to_group, groups, glyphs):
+    """Check that the glyph -> group table agrees with the group table. Returns an error message or None."""
+    if len(glyph_to_group) != len(glyphs):
+        return f"GlyphToGroup has {len(glyph_to_group)} entries, expected {len(glyphs)}"
+
+    counts = [0] * len(groups)
+    first_seen = [None] * len(groups)
+    for glyph_idx, group_idx in enumerate(glyph_to_group):
+        if group_idx >= len(groups):
+            return f"glyph {glyph_idx}: mapped to group {group_idx}, only {len(groups)} groups"
+        counts[group_idx] += 1
+        if first_seen[group_idx] is None:
+            first_seen[group_idx] = glyph_idx
+
+    for gi, group in enumerate(groups):
+        if counts[gi] != group['glyphCount']:
+            return f"group {gi}: {counts[gi]} glyphs mapped, group table says {group['glyphCount']}"
+        if counts[gi] > 0 and first_seen[gi] != group['firstGlyphIndex']:
+            return f"group {gi}: first mapped glyph is {first_seen[gi]}, group table says {group['firstGlyphIndex']}"
+
+    return None
+
+
 def verify_font_file(filepath):
     """Verify a single font header file. Returns (font_name, success, message)."""
     with open(filepath, 'r') as f:
@@ -92,6 +121,19 @@ def verify_font_file(filepath):
 
     glyphs = parse_glyphs(glyphs_match.group(1))
 
+    # Extract glyph -> group table
+    glyph_to_group_match = re.search(
+        r'static const uint16_t ' + re.escape(font_name) + r'GlyphToGroup\[\d+\]\s*=\s*\{(.+?)\};',
+        content, re.DOTALL
+    )
+    if not glyph_to_group_match:
+        return (font_name, False, "could not find GlyphToGroup array")
+
+    glyph_to_group = parse_glyph_to_group(glyph_to_group_match.group(1))
+    mapping_error = verify_glyph_to_group(glyph_to_group, groups, glyphs)
+    if mapping_error:
+        return (font_name, False, mapping_error)
+
     # Verify each group
     for gi, group in enumerate(groups):
         # Extract compressed chunk
@@ -109,11 +151,9 @@ def verify_font_file(filepath):
             return (font_name, False, f"group {gi}: size mismatch (expected {group['uncompressedSize']}, got {len(decompressed)})")
 
         # Verify each glyph's data within the group
-        first = group['firstGlyphIndex']
-        for j in range(group['glyphCount']):
-            glyph_idx = first + j
-            if glyph_idx >= len(glyphs):
-                return (font_name, False, f"group {gi}: glyph index {glyph_idx} out of range")
+        for glyph_idx, group_idx in enumerate(glyph_to_group):
+            if group_idx != gi:
+                continue
 
             glyph = glyphs[glyph_idx]
             offset = glyph['dataOffset']
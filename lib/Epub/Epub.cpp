@@ -2,16 +2,46 @@
 
 #include <FsHelpers.h>
 #include <HalStorage.h>
+#include <ImageInput.h>
+#include <ImageProbe.h>
 #include <JpegToBmpConverter.h>
 #include <Logging.h>
 #include <PngToBmpConverter.h>
+#include <Trace.h>
 #include <ZipFile.h>
 
+#include "Epub/ImageCache.h"
 #include "Epub/parsers/ContainerParser.h"
 #include "Epub/parsers/ContentOpfParser.h"
 #include "Epub/parsers/TocNavParser.h"
 #include "Epub/parsers/TocNcxParser.h"
 
+namespace {
+// An EPUB entry inflated as the image decoder reads it
+class ZipEntryImageInput final : public ImageInput {
+ public:
+  explicit ZipEntryImageInput(ZipFile::EntryReader& entry) : entry(entry) {}
+  int read(uint8_t* buf, const size_t len) override { return entry.read(buf, len); }
+  bool skip(const uint32_t len) override { return entry.skip(len); }
+
+ private:
+  ZipFile::EntryReader& entry;
+};
+
+// Hands `use` the EPUB entry at `itemHref`, so an image is read straight from the zip with no temporary copy on the
+// SD card
+template <typename Use>
+bool withItemInput(const std::string& epubPath, const std::string& itemHref, Use&& use) {
+  ZipFile zip(epubPath);
+  ZipFile::EntryReader entry(zip);
+  if (!entry.open(FsHelpers::normalisePath(itemHref).c_str())) {
+    return false;
+  }
+  ZipEntryImageInput input(entry);
+  return use(input);
+}
+}  // namespace
+
 bool Epub::findContentOpfFile(std::string* contentOpfFile) const {
   const auto containerPath = "META-INF/container.xml";
   size_t containerSize;
@@ -45,6 +75,7 @@ bool Epub::findContentOpfFile(std::string* contentOpfFile) const {
 }
 
 bool Epub::parseContentOpf(BookMetadataCache::BookMetadata& bookMetadata) {
+  TRACE_SPAN("xml_parse_opf");
   std::string contentOpfFilePath;
   if (!findContentOpfFile(&contentOpfFilePath)) {
     LOG_ERR("EBP", "Could not find content.opf in zip");
@@ -144,6 +175,7 @@ bool Epub::parseContentOpf(BookMetadataCache::BookMetadata& bookMetadata) {
 }
 
 bool Epub::parseTocNcxFile() const {
+  TRACE_SPAN("xml_parse_ncx");
   // the ncx file should have been specified in the content.opf file
   if (tocNcxItem.empty()) {
     LOG_DBG("EBP", "No ncx file specified");
@@ -184,7 +216,7 @@ bool Epub::parseTocNcxFile() const {
     if (readSize == 0) break;
     const auto processedSize = ncxParser.write(ncxBuffer, readSize);
 
-    if (processedSize != readSize) {
+    if (processedSize != static_cast<size_t>(readSize)) {
       LOG_ERR("EBP", "Could not process all toc ncx data");
       free(ncxBuffer);
       tempNcxFile.close();
@@ -201,6 +233,7 @@ bool Epub::parseTocNcxFile() const {
 }
 
 bool Epub::parseTocNavFile() const {
+  TRACE_SPAN("xml_parse_nav");
   // the nav file should have been specified in the content.opf file (EPUB 3)
   if (tocNavItem.empty()) {
     LOG_DBG("EBP", "No nav file specified");
@@ -241,7 +274,7 @@ bool Epub::parseTocNavFile() const {
     const auto readSize = tempNavFile.read(navBuffer, 1024);
     const auto processedSize = navParser.write(navBuffer, readSize);
 
-    if (processedSize != readSize) {
+    if (processedSize != static_cast<size_t>(readSize)) {
       LOG_ERR("EBP", "Could not process all toc nav data");
       free(navBuffer);
       tempNavFile.close();
@@ -258,6 +291,7 @@ bool Epub::parseTocNavFile() const {
 }
 
 void Epub::parseCssFiles() const {
+  TRACE_SPAN("css_parse");
   // Maximum CSS file size we'll attempt to parse (uncompressed)
   // Larger files risk memory exhaustion on ESP32
   constexpr size_t MAX_CSS_FILE_SIZE = 128 * 1024;  // 128KB
@@ -372,7 +406,7 @@ bool Epub::load(const bool buildIfMissing, const bool skipLoadingCss) {
   LOG_DBG("EBP", "Cache not found, building spine/TOC cache");
   setupCacheDir();
 
-  const uint32_t indexingStart = millis();
+  [[maybe_unused]] const uint32_t indexingStart = millis();
 
   // Begin building cache - stream entries to disk immediately
   if (!bookMetadataCache->beginWrite()) {
@@ -381,7 +415,7 @@ bool Epub::load(const bool buildIfMissing, const bool skipLoadingCss) {
   }
 
   // OPF Pass
-  const uint32_t opfStart = millis();
+  [[maybe_unused]] const uint32_t opfStart = millis();
   BookMetadataCache::BookMetadata bookMetadata;
   if (!bookMetadataCache->beginContentOpfPass()) {
     LOG_ERR("EBP", "Could not begin writing content.opf pass");
@@ -398,7 +432,7 @@ bool Epub::load(const bool buildIfMissing, const bool skipLoadingCss) {
   LOG_DBG("EBP", "OPF pass completed in %lu ms", millis() - opfStart);
 
   // TOC Pass - try EPUB 3 nav first, fall back to NCX
-  const uint32_t tocStart = millis();
+  [[maybe_unused]] const uint32_t tocStart = millis();
   if (!bookMetadataCache->beginTocPass()) {
     LOG_ERR("EBP", "Could not begin writing toc pass");
     return false;
@@ -436,7 +470,7 @@ bool Epub::load(const bool buildIfMissing, const bool skipLoadingCss) {
   }
 
   // Build final book.bin
-  const uint32_t buildStart = millis();
+  [[maybe_unused]] const uint32_t buildStart = millis();
   if (!bookMetadataCache->buildBookBin(filepath, bookMetadata)) {
     LOG_ERR("EBP", "Could not update mappings and sizes");
     return false;
@@ -471,6 +505,9 @@ bool Epub::clearCache() const {
     return true;
   }
 
+  // Let go of the shared images this book uses before its list of them goes with the cache
+  ImageCache(imageCachePath, cachePath).releaseBook();
+
   if (!Storage.removeDir(cachePath.c_str())) {
     LOG_ERR("EPB", "Failed to clear cache");
     return false;
@@ -541,70 +578,27 @@ bool Epub::generateCoverBmp(bool cropped) const {
     return false;
   }
 
-  if (coverImageHref.substr(coverImageHref.length() - 4) == ".jpg" ||
-      coverImageHref.substr(coverImageHref.length() - 5) == ".jpeg") {
-    LOG_DBG("EBP", "Generating BMP from JPG cover image (%s mode)", cropped ? "cropped" : "fit");
-    const auto coverJpgTempPath = getCachePath() + "/.cover.jpg";
-
-    FsFile coverJpg;
-    if (!Storage.openFileForWrite("EBP", coverJpgTempPath, coverJpg)) {
-      return false;
-    }
-    readItemContentsToStream(coverImageHref, coverJpg, 1024);
-    coverJpg.close();
-
-    if (!Storage.openFileForRead("EBP", coverJpgTempPath, coverJpg)) {
-      return false;
-    }
+  const bool isJpeg = coverImageHref.substr(coverImageHref.length() - 4) == ".jpg" ||
+                     coverImageHref.substr(coverImageHref.length() - 5) == ".jpeg";
+  const bool isPng = coverImageHref.substr(coverImageHref.length() - 4) == ".png";
+  if (isJpeg || isPng) {
+    LOG_DBG("EBP", "Generating BMP from %s cover image (%s mode)", isJpeg ? "JPG" : "PNG", cropped ? "cropped" : "fit");
 
     FsFile coverBmp;
     if (!Storage.openFileForWrite("EBP", getCoverBmpPath(cropped), coverBmp)) {
-      coverJpg.close();
       return false;
     }
-    const bool success = JpegToBmpConverter::jpegFileToBmpStream(coverJpg, coverBmp, cropped);
-    coverJpg.close();
+    const bool success = withItemInput(filepath, coverImageHref, [&](ImageInput& image) {
+      return isJpeg ? JpegToBmpConverter::jpegToBmpStream(image, coverBmp, cropped)
+                    : PngToBmpConverter::pngToBmpStream(image, coverBmp, cropped);
+    });
     coverBmp.close();
-    Storage.remove(coverJpgTempPath.c_str());
 
     if (!success) {
       LOG_ERR("EBP", "Failed to generate BMP from cover image");
       Storage.remove(getCoverBmpPath(cropped).c_str());
     }
-    LOG_DBG("EBP", "Generated BMP from JPG cover image, success: %s", success ? "yes" : "no");
-    return success;
-  }
-
-  if (coverImageHref.substr(coverImageHref.length() - 4) == ".png") {
-    LOG_DBG("EBP", "Generating BMP from PNG cover image (%s mode)", cropped ? "cropped" : "fit");
-    const auto coverPngTempPath = getCachePath() + "/.cover.png";
-
-    FsFile coverPng;
-    if (!Storage.openFileForWrite("EBP", coverPngTempPath, coverPng)) {
-      return false;
-    }
-    readItemContentsToStream(coverImageHref, coverPng, 1024);
-    coverPng.close();
-
-    if (!Storage.openFileForRead("EBP", coverPngTempPath, coverPng)) {
-      return false;
-    }
-
-    FsFile coverBmp;
-    if (!Storage.openFileForWrite("EBP", getCoverBmpPath(cropped), coverBmp)) {
-      coverPng.close();
-      return false;
-    }
-    const bool success = PngToBmpConverter::pngFileToBmpStream(coverPng, coverBmp, cropped);
-    coverPng.close();
-    coverBmp.close();
-    Storage.remove(coverPngTempPath.c_str());
-
-    if (!success) {
-      LOG_ERR("EBP", "Failed to generate BMP from PNG cover image");
-      Storage.remove(getCoverBmpPath(cropped).c_str());
-    }
-    LOG_DBG("EBP", "Generated BMP from PNG cover image, success: %s", success ? "yes" : "no");
+    LOG_DBG("EBP", "Generated BMP from cover image, success: %s", success ? "yes" : "no");
     return success;
   }
 
@@ -630,75 +624,32 @@ bool Epub::generateThumbBmp(int height) const {
   if (coverImageHref.empty()) {
     LOG_DBG("EBP", "No known cover image for thumbnail");
   } else if (coverImageHref.substr(coverImageHref.length() - 4) == ".jpg" ||
-             coverImageHref.substr(coverImageHref.length() - 5) == ".jpeg") {
-    LOG_DBG("EBP", "Generating thumb BMP from JPG cover image");
-    const auto coverJpgTempPath = getCachePath() + "/.cover.jpg";
-
-    FsFile coverJpg;
-    if (!Storage.openFileForWrite("EBP", coverJpgTempPath, coverJpg)) {
-      return false;
-    }
-    readItemContentsToStream(coverImageHref, coverJpg, 1024);
-    coverJpg.close();
-
-    if (!Storage.openFileForRead("EBP", coverJpgTempPath, coverJpg)) {
-      return false;
-    }
+             coverImageHref.substr(coverImageHref.length() - 5) == ".jpeg" ||
+             coverImageHref.substr(coverImageHref.length() - 4) == ".png") {
+    const bool isPng = coverImageHref.substr(coverImageHref.length() - 4) == ".png";
+    LOG_DBG("EBP", "Generating thumb BMP from %s cover image", isPng ? "PNG" : "JPG");
 
     FsFile thumbBmp;
     if (!Storage.openFileForWrite("EBP", getThumbBmpPath(height), thumbBmp)) {
-      coverJpg.close();
       return false;
     }
     // Use smaller target size for Continue Reading card (half of screen: 240x400)
     // Generate 1-bit BMP for fast home screen rendering (no gray passes needed)
     int THUMB_TARGET_WIDTH = height * 0.6;
     int THUMB_TARGET_HEIGHT = height;
-    const bool success = JpegToBmpConverter::jpegFileTo1BitBmpStreamWithSize(coverJpg, thumbBmp, THUMB_TARGET_WIDTH,
-                                                                             THUMB_TARGET_HEIGHT);
-    coverJpg.close();
+    const bool success = withItemInput(filepath, coverImageHref, [&](ImageInput& image) {
+      return isPng ? PngToBmpConverter::pngTo1BitBmpStreamWithSize(image, thumbBmp, THUMB_TARGET_WIDTH,
+                                                                   THUMB_TARGET_HEIGHT)
+                   : JpegToBmpConverter::jpegTo1BitBmpStreamWithSize(image, thumbBmp, THUMB_TARGET_WIDTH,
+                                                                     THUMB_TARGET_HEIGHT);
+    });
     thumbBmp.close();
-    Storage.remove(coverJpgTempPath.c_str());
 
     if (!success) {
-      LOG_ERR("EBP", "Failed to generate thumb BMP from JPG cover image");
+      LOG_ERR("EBP", "Failed to generate thumb BMP from cover image");
       Storage.remove(getThumbBmpPath(height).c_str());
     }
-    LOG_DBG("EBP", "Generated thumb BMP from JPG cover image, success: %s", success ? "yes" : "no");
-    return success;
-  } else if (coverImageHref.substr(coverImageHref.length() - 4) == ".png") {
-    LOG_DBG("EBP", "Generating thumb BMP from PNG cover image");
-    const auto coverPngTempPath = getCachePath() + "/.cover.png";
-
-    FsFile coverPng;
-    if (!Storage.openFileForWrite("EBP", coverPngTempPath, coverPng)) {
-      return false;
-    }
-    readItemContentsToStream(coverImageHref, coverPng, 1024);
-    coverPng.close();
-
-    if (!Storage.openFileForRead("EBP", coverPngTempPath, coverPng)) {
-      return false;
-    }
-
-    FsFile thumbBmp;
-    if (!Storage.openFileForWrite("EBP", getThumbBmpPath(height), thumbBmp)) {
-      coverPng.close();
-      return false;
-    }
-    int THUMB_TARGET_WIDTH = height * 0.6;
-    int THUMB_TARGET_HEIGHT = height;
-    const bool success =
-        PngToBmpConverter::pngFileTo1BitBmpStreamWithSize(coverPng, thumbBmp, THUMB_TARGET_WIDTH, THUMB_TARGET_HEIGHT);
-    coverPng.close();
-    thumbBmp.close();
-    Storage.remove(coverPngTempPath.c_str());
-
-    if (!success) {
-      LOG_ERR("EBP", "Failed to generate thumb BMP from PNG cover image");
-      Storage.remove(getThumbBmpPath(height).c_str());
-    }
-    LOG_DBG("EBP", "Generated thumb BMP from PNG cover image, success: %s", success ? "yes" : "no");
+    LOG_DBG("EBP", "Generated thumb BMP from cover image, success: %s", success ? "yes" : "no");
     return success;
   } else {
     LOG_ERR("EBP", "Cover image is not a supported format, skipping thumbnail");
@@ -743,6 +694,16 @@ bool Epub::getItemSize(const std::string& itemHref, size_t* size) const {
   return ZipFile(filepath).getInflatedFileSize(path.c_str(), size);
 }
 
+bool Epub::getItemChecksum(const std::string& itemHref, uint32_t* crc, uint32_t* size) const {
+  const std::string path = FsHelpers::normalisePath(itemHref);
+  return ZipFile(filepath).getEntryChecksum(path.c_str(), crc, size);
+}
+
+bool Epub::getItemImageSize(const std::string& itemHref, int* width, int* height) const {
+  return withItemInput(filepath, itemHref,
+                       [&](ImageInput& image) { return ImageProbe::readSize(image, *width, *height); });
+}
+
 int Epub::getSpineItemsCount() const {
   if (!bookMetadataCache || !bookMetadataCache->isLoaded()) {
     return 0;
@@ -834,7 +795,7 @@ int Epub::getSpineIndexForTextReference() const {
   }
 
   // loop through spine items to get the correct index matching the text href
-  for (size_t i = 0; i < getSpineItemsCount(); i++) {
+  for (int i = 0; i < getSpineItemsCount(); i++) {
     if (getSpineItem(i).href == bookMetadataCache->coreMetadata.textReferenceHref) {
       LOG_DBG("EBP", "Text reference %s found at index %d", bookMetadataCache->coreMetadata.textReferenceHref.c_str(),
               i);
@@ -23,6 +23,8 @@ class Epub {
   std::string contentBasePath;
   // Uniq cache key based on filepath
   std::string cachePath;
+  // Inline images shared between books (ImageCache)
+  std::string imageCachePath;
   // Spine and TOC cache
   std::unique_ptr<BookMetadataCache> bookMetadataCache;
   // CSS parser for styling
@@ -40,6 +42,7 @@ class Epub {
   explicit Epub(std::string filepath, const std::string& cacheDir) : filepath(std::move(filepath)) {
     // create a cache key based on the filepath
     cachePath = cacheDir + "/epub_" + std::to_string(std::hash<std::string>{}(this->filepath));
+    imageCachePath = cacheDir + "/images";
   }
   ~Epub() = default;
   std::string& getBasePath() { return contentBasePath; }
@@ -47,6 +50,7 @@ class Epub {
   bool clearCache() const;
   void setupCacheDir() const;
   const std::string& getCachePath() const;
+  const std::string& getImageCachePath() const { return imageCachePath; }
   const std::string& getPath() const;
   const std::string& getTitle() const;
   const std::string& getAuthor() const;
@@ -60,6 +64,10 @@ class Epub {
                                    bool trailingNullByte = false) const;
   bool readItemContentsToStream(const std::string& itemHref, Print& out, size_t chunkSize) const;
   bool getItemSize(const std::string& itemHref, size_t* size) const;
+  // CRC32 and size of the item, which identify its content (ImageCache)
+  bool getItemChecksum(const std::string& itemHref, uint32_t* crc, uint32_t* size) const;
+  // Size of the image at `itemHref`, read from its header without extracting it
+  bool getItemImageSize(const std::string& itemHref, int* width, int* height) const;
   BookMetadataCache::SpineEntry getSpineItem(int spineIndex) const;
   BookMetadataCache::TocEntry getTocItem(int tocIndex) const;
   int getSpineItemsCount() const;
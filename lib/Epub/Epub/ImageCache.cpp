@@ -0,0 +1,227 @@
+#include "ImageCache.h"
+
+#include <HalStorage.h>
+#include <Logging.h>
+#include <Serialization.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+constexpr uint8_t IMAGE_CACHE_FILE_VERSION = 1;
+constexpr char REFS_FILE[] = "/refs.bin";
+constexpr char BOOK_IMAGES_FILE[] = "/images.bin";
+constexpr size_t KEY_RECORD_SIZE = 2 * sizeof(uint32_t);
+constexpr size_t REF_RECORD_SIZE = KEY_RECORD_SIZE + sizeof(uint16_t);
+
+// Files hold a version and a count before their records; a count the size does not match is a torn or corrupt write
+bool countMatchesSize(FsFile& file, const uint32_t count, const size_t recordSize) {
+  return file.size() == sizeof(uint8_t) + sizeof(uint32_t) + static_cast<uint64_t>(count) * recordSize;
+}
+}  // namespace
+
+std::string ImageCache::getKeyPrefix(const Key& key) {
+  char prefix[18];
+  snprintf(prefix, sizeof(prefix), "%08lx_%08lx", static_cast<unsigned long>(key.crc),
+           static_cast<unsigned long>(key.size));
+  return prefix;
+}
+
+std::string ImageCache::getImagePath(const Key& key, const std::string& extension) const {
+  return dir + "/" + getKeyPrefix(key) + extension;
+}
+
+bool ImageCache::addReference(const Key& key) {
+  if (!bookKeysLoaded) {
+    loadBookKeys();
+    bookKeysLoaded = true;
+  }
+  if (std::find(bookKeys.begin(), bookKeys.end(), key) == bookKeys.end() &&
+      std::find(pendingKeys.begin(), pendingKeys.end(), key) == pendingKeys.end()) {
+    pendingKeys.push_back(key);
+  }
+  return true;
+}
+
+bool ImageCache::commit() {
+  if (pendingKeys.empty()) {
+    return true;
+  }
+
+  Storage.mkdir(dir.c_str());
+  std::vector<RefCount> refs;
+  loadRefs(refs);
+  for (const Key& key : pendingKeys) {
+    auto it = std::find_if(refs.begin(), refs.end(), [&](const RefCount& ref) { return ref.key == key; });
+    if (it == refs.end()) {
+      refs.push_back({key, 1});
+    } else if (it->books < UINT16_MAX) {
+      it->books++;
+    }
+  }
+
+  // The book's list is written last: a book that lists an image always holds a count on it
+  bookKeys.insert(bookKeys.end(), pendingKeys.begin(), pendingKeys.end());
+  pendingKeys.clear();
+  return saveRefs(refs) && saveBookKeys();
+}
+
+bool ImageCache::releaseBook() {
+  if (!loadBookKeys() || bookKeys.empty()) {
+    return true;
+  }
+
+  std::vector<RefCount> refs;
+  loadRefs(refs);
+  std::vector<Key> unused;
+  for (const Key& key : bookKeys) {
+    auto it = std::find_if(refs.begin(), refs.end(), [&](const RefCount& ref) { return ref.key == key; });
+    if (it == refs.end()) {
+      continue;
+    }
+    if (it->books > 1) {
+      it->books--;
+    } else {
+      unused.push_back(key);
+      refs.erase(it);
+    }
+  }
+
+  const bool saved = saveRefs(refs);
+  removeImages(unused);
+  LOG_DBG("IMC", "Released %d image(s), %d no longer used", static_cast<int>(bookKeys.size()),
+          static_cast<int>(unused.size()));
+  bookKeys.clear();
+  Storage.remove((bookCachePath + BOOK_IMAGES_FILE).c_str());
+  return saved;
+}
+
+void ImageCache::removeImages(const std::vector<Key>& keys) const {
+  if (keys.empty()) {
+    return;
+  }
+  std::vector<std::string> prefixes;
+  prefixes.reserve(keys.size());
+  for (const Key& key : keys) {
+    prefixes.push_back(getKeyPrefix(key));
+  }
+
+  // An image has one extracted file and a pixel cache per render size and slice, all named after its key
+  auto root = Storage.open(dir.c_str());
+  if (!root || !root.isDirectory()) {
+    if (root) root.close();
+    return;
+  }
+  std::vector<std::string> doomed;
+  char name[64];
+  for (auto file = root.openNextFile(); file; file = root.openNextFile()) {
+    file.getName(name, sizeof(name));
+    file.close();
+    const bool unused = std::any_of(prefixes.begin(), prefixes.end(), [&](const std::string& prefix) {
+      return strncmp(name, prefix.c_str(), prefix.size()) == 0;
+    });
+    if (unused) {
+      doomed.push_back(dir + "/" + name);
+    }
+  }
+  root.close();
+  for (const std::string& path : doomed) {
+    Storage.remove(path.c_str());
+  }
+}
+
+bool ImageCache::loadBookKeys() {
+  bookKeys.clear();
+  FsFile file;
+  if (!Storage.exists((bookCachePath + BOOK_IMAGES_FILE).c_str()) ||
+      !Storage.openFileForRead("IMC", bookCachePath + BOOK_IMAGES_FILE, file)) {
+    return true;  // The book uses no shared images yet
+  }
+
+  uint8_t version;
+  serialization::readPod(file, version);
+  if (version != IMAGE_CACHE_FILE_VERSION) {
+    LOG_ERR("IMC", "Deserialization failed: Unknown version %u", version);
+    file.close();
+    return false;
+  }
+  uint32_t count;
+  serialization::readPod(file, count);
+  if (!countMatchesSize(file, count, KEY_RECORD_SIZE)) {
+    LOG_ERR("IMC", "Book image list has %lu entries but is %lu bytes", static_cast<unsigned long>(count),
+            static_cast<unsigned long>(file.size()));
+    file.close();
+    return false;
+  }
+  bookKeys.resize(count);
+  for (Key& key : bookKeys) {
+    serialization::readPod(file, key.crc);
+    serialization::readPod(file, key.size);
+  }
+  file.close();
+  return true;
+}
+
+bool ImageCache::saveBookKeys() const {
+  FsFile file;
+  if (!Storage.openFileForWrite("IMC", bookCachePath + BOOK_IMAGES_FILE, file)) {
+    return false;
+  }
+  serialization::writePod(file, IMAGE_CACHE_FILE_VERSION);
+  serialization::writePod(file, static_cast<uint32_t>(bookKeys.size()));
+  for (const Key& key : bookKeys) {
+    serialization::writePod(file, key.crc);
+    serialization::writePod(file, key.size);
+  }
+  file.close();
+  return true;
+}
+
+bool ImageCache::loadRefs(std::vector<RefCount>& refs) const {
+  refs.clear();
+  FsFile file;
+  if (!Storage.exists((dir + REFS_FILE).c_str()) || !Storage.openFileForRead("IMC", dir + REFS_FILE, file)) {
+    return false;
+  }
+
+  uint8_t version;
+  serialization::readPod(file, version);
+  if (version != IMAGE_CACHE_FILE_VERSION) {
+    LOG_ERR("IMC", "Deserialization failed: Unknown version %u", version);
+    file.close();
+    return false;
+  }
+  uint32_t count;
+  serialization::readPod(file, count);
+  if (!countMatchesSize(file, count, REF_RECORD_SIZE)) {
+    LOG_ERR("IMC", "Image index has %lu entries but is %lu bytes", static_cast<unsigned long>(count),
+            static_cast<unsigned long>(file.size()));
+    file.close();
+    return false;
+  }
+  refs.resize(count);
+  for (RefCount& ref : refs) {
+    serialization::readPod(file, ref.key.crc);
+    serialization::readPod(file, ref.key.size);
+    serialization::readPod(file, ref.books);
+  }
+  file.close();
+  return true;
+}
+
+bool ImageCache::saveRefs(const std::vector<RefCount>& refs) const {
+  FsFile file;
+  if (!Storage.openFileForWrite("IMC", dir + REFS_FILE, file)) {
+    return false;
+  }
+  serialization::writePod(file, IMAGE_CACHE_FILE_VERSION);
+  serialization::writePod(file, static_cast<uint32_t>(refs.size()));
+  for (const RefCount& ref : refs) {
+    serialization::writePod(file, ref.key.crc);
+    serialization::writePod(file, ref.key.size);
+    serialization::writePod(file, ref.books);
+  }
+  file.close();
+  return true;
+}
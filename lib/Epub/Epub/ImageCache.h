@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Inline images and their pixel caches (.pxc), stored once by content and shared by every section and book.
+//
+// An image is keyed by the CRC32 and size of its ZIP entry, both read from the central directory without inflating
+// anything, so an ornament, divider or logo repeated in every chapter, or in every book from one publisher, is
+// extracted, decoded and cached once. Pixel caches add the render size to the key (ImageBlock).
+//
+// Books hold references: each book lists the images it uses in its own cache directory, and the shared index counts
+// the books using each image. Clearing a book's cache releases its references, and an image's files are deleted when
+// the last book using it lets go, so clearing one book neither orphans nor deletes another book's images.
+//
+// Files, in the shared directory (/.crosspoint/images on the device):
+//   <crc>_<size>.<ext>                       the extracted image
+//   <crc>_<size>_<w>x<h>[_<sliceY>].pxc      its pixel caches
+//   refs.bin                                 version, count, then per image: crc, size, number of books using it
+// and in each book's cache directory:
+//   images.bin                               version, count, then the crc and size of each image the book uses
+class ImageCache {
+ public:
+  struct Key {
+    uint32_t crc;
+    uint32_t size;
+    bool operator==(const Key& other) const { return crc == other.crc && size == other.size; }
+  };
+
+  // `dir` is the shared directory, `bookCachePath` the cache directory of the book whose references this instance
+  // adds and releases
+  ImageCache(std::string dir, std::string bookCachePath)
+      : dir(std::move(dir)), bookCachePath(std::move(bookCachePath)) {}
+
+  // Path the image is extracted to; `extension` includes the dot
+  std::string getImagePath(const Key& key, const std::string& extension) const;
+  // Records that the book uses the image. A book counts once however many times it shows the image. The reference
+  // is kept in memory until commit().
+  bool addReference(const Key& key);
+  // Writes the references added since the last commit, once for all of them (after laying out a section)
+  bool commit();
+  // Drops all of the book's references and deletes the images no book uses any more
+  bool releaseBook();
+
+ private:
+  struct RefCount {
+    Key key;
+    uint16_t books;
+  };
+
+  bool loadBookKeys();
+  bool saveBookKeys() const;
+  bool loadRefs(std::vector<RefCount>& refs) const;
+  bool saveRefs(const std::vector<RefCount>& refs) const;
+  void removeImages(const std::vector<Key>& keys) const;
+  static std::string getKeyPrefix(const Key& key);
+
+  std::string dir;
+  std::string bookCachePath;
+  std::vector<Key> bookKeys;
+  std::vector<Key> pendingKeys;  // Added but not yet written
+  bool bookKeysLoaded = false;
+};
@@ -2,6 +2,7 @@
 
 #include <Logging.h>
 #include <Serialization.h>
+#include <Trace.h>
 
 void PageLine::render(GfxRenderer& renderer, const int fontId, const int xOffset, const int yOffset) {
   block->render(renderer, fontId, xPos + xOffset, yPos + yOffset);
@@ -25,7 +26,7 @@ std::unique_ptr<PageLine> PageLine::deserialize(FsFile& file) {
   return std::unique_ptr<PageLine>(new PageLine(std::move(tb), xPos, yPos));
 }
 
-void PageImage::render(GfxRenderer& renderer, const int fontId, const int xOffset, const int yOffset) {
+void PageImage::render(GfxRenderer& renderer, const int /*fontId*/, const int xOffset, const int yOffset) {
   // Images don't use fontId or text rendering
   imageBlock->render(renderer, xPos + xOffset, yPos + yOffset);
 }
@@ -49,12 +50,14 @@ std::unique_ptr<PageImage> PageImage::deserialize(FsFile& file) {
 }
 
 void Page::render(GfxRenderer& renderer, const int fontId, const int xOffset, const int yOffset) const {
+  TRACE_SPAN("render_page");
   for (auto& element : elements) {
     element->render(renderer, fontId, xOffset, yOffset);
   }
 }
 
 bool Page::serialize(FsFile& file) const {
+  TRACE_SPAN("serialize_page");
   const uint16_t count = elements.size();
   serialization::writePod(file, count);
 
@@ -71,6 +74,7 @@ bool Page::serialize(FsFile& file) const {
 }
 
 std::unique_ptr<Page> Page::deserialize(FsFile& file) {
+  TRACE_SPAN("load_page");
   auto page = std::unique_ptr<Page>(new Page());
 
   uint16_t count;
@@ -4,13 +4,14 @@
 #include <Logging.h>
 #include <Serialization.h>
 
+#include "Epub/ImageCache.h"
 #include "Epub/css/CssParser.h"
 #include "Page.h"
 #include "hyphenation/Hyphenator.h"
 #include "parsers/ChapterHtmlSlimParser.h"
 
 namespace {
-constexpr uint8_t SECTION_FILE_VERSION = 13;
+constexpr uint8_t SECTION_FILE_VERSION = 16;
 constexpr uint32_t HEADER_SIZE = sizeof(uint8_t) + sizeof(int) + sizeof(float) + sizeof(bool) + sizeof(uint8_t) +
                                  sizeof(uint16_t) + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(bool) + sizeof(bool) +
                                  sizeof(uint32_t);
@@ -141,7 +142,7 @@ bool Section::createSectionFile(const int fontId, const float lineCompression, c
 
   // Retry logic for SD card timing issues
   bool success = false;
-  uint32_t fileSize = 0;
+  [[maybe_unused]] uint32_t fileSize = 0;
   for (int attempt = 0; attempt < 3 && !success; attempt++) {
     if (attempt > 0) {
       LOG_DBG("SCT", "Retrying stream (attempt %d)...", attempt + 1);
@@ -182,10 +183,10 @@ bool Section::createSectionFile(const int fontId, const float lineCompression, c
                          viewportHeight, hyphenationEnabled, embeddedStyle);
   std::vector<uint32_t> lut = {};
 
-  // Derive the content base directory and image cache path prefix for the parser
+  // Derive the content base directory for the parser; images go to the cache shared between books
   size_t lastSlash = localPath.find_last_of('/');
   std::string contentBase = (lastSlash != std::string::npos) ? localPath.substr(0, lastSlash + 1) : "";
-  std::string imageBasePath = epub->getCachePath() + "/img_" + std::to_string(spineIndex) + "_";
+  ImageCache imageCache(epub->getImageCachePath(), epub->getCachePath());
 
   CssParser* cssParser = nullptr;
   if (embeddedStyle) {
@@ -201,7 +202,7 @@ bool Section::createSectionFile(const int fontId, const float lineCompression, c
       epub, tmpHtmlPath, renderer, fontId, lineCompression, extraParagraphSpacing, paragraphAlignment, viewportWidth,
       viewportHeight, hyphenationEnabled,
       [this, &lut](std::unique_ptr<Page> page) { lut.emplace_back(this->onPageComplete(std::move(page))); },
-      embeddedStyle, contentBase, imageBasePath, popupFn, cssParser);
+      embeddedStyle, contentBase, imageCache, popupFn, cssParser);
   Hyphenator::setPreferredLanguage(epub->getLanguage());
   success = visitor.parseAndBuildPages();
 
@@ -216,6 +217,11 @@ bool Section::createSectionFile(const int fontId, const float lineCompression, c
     return false;
   }
 
+  // The images the section shows are counted once it is laid out, in one write of the shared index
+  if (!imageCache.commit()) {
+    LOG_ERR("SCT", "Failed to record the section's images");
+  }
+
   const uint32_t lutOffset = file.position();
   bool hasFailedLutRecords = false;
   // Write LUT
@@ -260,5 +266,33 @@ std::unique_ptr<Page> Section::loadPageFromSectionFile() {
 
   auto page = Page::deserialize(file);
   file.close();
+  if (page) {
+    extractPageImages(*page);
+  }
   return page;
 }
+
+void Section::extractPageImages(const Page& page) const {
+  // Sections are laid out from the image headers alone; each image is extracted from the EPUB the first time a page
+  // showing it is loaded, and decoded (then drawn from its pixel cache) when the page renders
+  for (const auto& element : page.elements) {
+    if (element->getTag() != TAG_PageImage) {
+      continue;
+    }
+    const ImageBlock& image = static_cast<const PageImage&>(*element).getImageBlock();
+    if (image.getItemHref().empty() || Storage.exists(image.getImagePath().c_str())) {
+      continue;
+    }
+
+    FsFile imageFile;
+    if (!Storage.openFileForWrite("SCT", image.getImagePath(), imageFile)) {
+      continue;
+    }
+    const bool extracted = epub->readItemContentsToStream(image.getItemHref(), imageFile, 4096);
+    imageFile.close();
+    if (!extracted) {
+      LOG_ERR("SCT", "Failed to extract image: %s", image.getItemHref().c_str());
+      Storage.remove(image.getImagePath().c_str());
+    }
+  }
+}
@@ -18,6 +18,7 @@ class Section {
                               uint16_t viewportWidth, uint16_t viewportHeight, bool hyphenationEnabled,
                               bool embeddedStyle);
   uint32_t onPageComplete(std::unique_ptr<Page> page);
+  void extractPageImages(const Page& page) const;
 
  public:
   uint16_t pageCount = 0;
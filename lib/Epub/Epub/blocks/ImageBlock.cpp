@@ -5,88 +5,80 @@
 #include <SDCardManager.h>
 #include <Serialization.h>
 
-#include "../converters/DitherUtils.h"
 #include "../converters/ImageDecoderFactory.h"
+#include "../converters/PixelCache.h"
 
-// Cache file format:
-// - uint16_t width
-// - uint16_t height
-// - uint8_t pixels[...] - 2 bits per pixel, packed (4 pixels per byte), row-major order
+ImageBlock::ImageBlock(const std::string& imagePath, const std::string& itemHref, int16_t width, int16_t height)
+    : imagePath(imagePath), itemHref(itemHref), width(width), height(height), imageHeight(height) {}
 
-ImageBlock::ImageBlock(const std::string& imagePath, int16_t width, int16_t height)
-    : imagePath(imagePath), width(width), height(height) {}
+ImageBlock::ImageBlock(const std::string& imagePath, const std::string& itemHref, int16_t width, int16_t height,
+                       int16_t sliceY, int16_t imageHeight)
+    : imagePath(imagePath),
+      itemHref(itemHref),
+      width(width),
+      height(height),
+      sliceY(sliceY),
+      imageHeight(imageHeight) {}
 
 bool ImageBlock::imageExists() const { return Storage.exists(imagePath.c_str()); }
 
 namespace {
 
-std::string getCachePath(const std::string& imagePath) {
-  // Replace extension with .pxc (pixel cache)
+std::string getCachePath(const std::string& imagePath, const ImageBlock& block) {
+  // Replace extension with .pxc (pixel cache). Images are shared, so the render size is part of the name; each slice
+  // of a sliced image has its own
   size_t dotPos = imagePath.rfind('.');
-  if (dotPos != std::string::npos) {
-    return imagePath.substr(0, dotPos) + ".pxc";
+  std::string base = dotPos != std::string::npos ? imagePath.substr(0, dotPos) : imagePath;
+  base += "_" + std::to_string(block.getWidth()) + "x" + std::to_string(block.getImageHeight());
+  if (block.isSlice()) {
+    base += "_" + std::to_string(block.getSliceY());
   }
-  return imagePath + ".pxc";
+  return base + ".pxc";
 }
 
 bool renderFromCache(GfxRenderer& renderer, const std::string& cachePath, int x, int y, int expectedWidth,
                      int expectedHeight) {
-  FsFile cacheFile;
-  if (!Storage.openFileForRead("IMG", cachePath, cacheFile)) {
-    return false;
-  }
-
-  uint16_t cachedWidth, cachedHeight;
-  if (cacheFile.read(&cachedWidth, 2) != 2 || cacheFile.read(&cachedHeight, 2) != 2) {
-    cacheFile.close();
+  PixelCacheReader cache;
+  if (!cache.open(cachePath)) {
     return false;
   }
 
   // Verify dimensions are close (allow 1 pixel tolerance for rounding differences)
-  int widthDiff = abs(cachedWidth - expectedWidth);
-  int heightDiff = abs(cachedHeight - expectedHeight);
-  if (widthDiff > 1 || heightDiff > 1) {
+  const int cachedWidth = cache.getWidth();
+  const int cachedHeight = cache.getHeight();
+  if (abs(cachedWidth - expectedWidth) > 1 || abs(cachedHeight - expectedHeight) > 1) {
     LOG_ERR("IMG", "Cache dimension mismatch: %dx%d vs %dx%d", cachedWidth, cachedHeight, expectedWidth,
             expectedHeight);
-    cacheFile.close();
     return false;
   }
 
-  // Use cached dimensions for rendering (they're the actual decoded size)
-  expectedWidth = cachedWidth;
-  expectedHeight = cachedHeight;
-
   LOG_DBG("IMG", "Loading from cache: %s (%dx%d)", cachePath.c_str(), cachedWidth, cachedHeight);
 
-  // Read and render row by row to minimize memory usage
-  const int bytesPerRow = (cachedWidth + 3) / 4;  // 2 bits per pixel, 4 pixels per byte
-  uint8_t* rowBuffer = (uint8_t*)malloc(bytesPerRow);
-  if (!rowBuffer) {
+  // Only this pass's mask is read; the cache stores one per render mode, in RenderMode order
+  const GfxRenderer::RenderMode mode = renderer.getRenderMode();
+  auto* mask = static_cast<uint8_t*>(malloc(cache.getMaskBytes()));
+  if (!mask) {
     LOG_ERR("IMG", "Failed to allocate row buffer");
-    cacheFile.close();
     return false;
   }
 
+  bool complete = true;
   for (int row = 0; row < cachedHeight; row++) {
-    if (cacheFile.read(rowBuffer, bytesPerRow) != bytesPerRow) {
+    bool drawn = false;
+    if (!cache.readRow(mode, mask, drawn)) {
       LOG_ERR("IMG", "Cache read error at row %d", row);
-      free(rowBuffer);
-      cacheFile.close();
-      return false;
+      complete = false;
+      break;
     }
-
-    int destY = y + row;
-    for (int col = 0; col < cachedWidth; col++) {
-      int byteIdx = col / 4;
-      int bitShift = 6 - (col % 4) * 2;  // MSB first within byte
-      uint8_t pixelValue = (rowBuffer[byteIdx] >> bitShift) & 0x03;
-
-      drawPixelWithRenderMode(renderer, x + col, destY, pixelValue);
+    if (drawn) {
+      renderer.drawMaskRow(x, y + row, mask, cachedWidth, mode == GfxRenderer::BW);
     }
   }
 
-  free(rowBuffer);
-  cacheFile.close();
+  free(mask);
+  if (!complete) {
+    return false;
+  }
   LOG_DBG("IMG", "Cache render complete");
   return true;
 }
@@ -94,7 +86,8 @@ bool renderFromCache(GfxRenderer& renderer, const std::string& cachePath, int x,
 }  // namespace
 
 void ImageBlock::render(GfxRenderer& renderer, const int x, const int y) {
-  LOG_DBG("IMG", "Rendering image at %d,%d: %s (%dx%d)", x, y, imagePath.c_str(), width, height);
+  LOG_DBG("IMG", "Rendering image at %d,%d: %s (%dx%d, rows %d-%d of %d)", x, y, imagePath.c_str(), width, height,
+          sliceY, sliceY + height, imageHeight);
 
   const int screenWidth = renderer.getScreenWidth();
   const int screenHeight = renderer.getScreenHeight();
@@ -107,7 +100,7 @@ void ImageBlock::render(GfxRenderer& renderer, const int x, const int y) {
   }
 
   // Try to render from cache first
-  std::string cachePath = getCachePath(imagePath);
+  std::string cachePath = getCachePath(imagePath, *this);
   if (renderFromCache(renderer, cachePath, x, y, width, height)) {
     return;  // Successfully rendered from cache
   }
@@ -133,12 +126,14 @@ void ImageBlock::render(GfxRenderer& renderer, const int x, const int y) {
   config.x = x;
   config.y = y;
   config.maxWidth = width;
-  config.maxHeight = height;
+  config.maxHeight = imageHeight;
   config.useGrayscale = true;
   config.useDithering = true;
   config.performanceMode = false;
   config.useExactDimensions = true;  // Use pre-calculated dimensions to avoid rounding mismatches
   config.cachePath = cachePath;      // Enable caching during decode
+  config.sliceY = sliceY;
+  config.sliceHeight = height;
 
   ImageToFramebufferDecoder* decoder = ImageDecoderFactory::getDecoder(imagePath);
   if (!decoder) {
@@ -159,16 +154,22 @@ void ImageBlock::render(GfxRenderer& renderer, const int x, const int y) {
 
 bool ImageBlock::serialize(FsFile& file) {
   serialization::writeString(file, imagePath);
+  serialization::writeString(file, itemHref);
   serialization::writePod(file, width);
   serialization::writePod(file, height);
+  serialization::writePod(file, sliceY);
+  serialization::writePod(file, imageHeight);
   return true;
 }
 
 std::unique_ptr<ImageBlock> ImageBlock::deserialize(FsFile& file) {
-  std::string path;
+  std::string path, href;
   serialization::readString(file, path);
-  int16_t w, h;
+  serialization::readString(file, href);
+  int16_t w, h, sliceY, imageHeight;
   serialization::readPod(file, w);
   serialization::readPod(file, h);
-  return std::unique_ptr<ImageBlock>(new ImageBlock(path, w, h));
+  serialization::readPod(file, sliceY);
+  serialization::readPod(file, imageHeight);
+  return std::unique_ptr<ImageBlock>(new ImageBlock(path, href, w, h, sliceY, imageHeight));
 }
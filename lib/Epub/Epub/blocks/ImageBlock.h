@@ -8,12 +8,22 @@
 
 class ImageBlock final : public Block {
  public:
-  ImageBlock(const std::string& imagePath, int16_t width, int16_t height);
+  // `imagePath` is where the image is extracted to on the SD card, `itemHref` the image inside the EPUB
+  ImageBlock(const std::string& imagePath, const std::string& itemHref, int16_t width, int16_t height);
+  // One page-sized slice of an image taller than a page: rows [sliceY, sliceY + height) of the image scaled to
+  // width x imageHeight
+  ImageBlock(const std::string& imagePath, const std::string& itemHref, int16_t width, int16_t height, int16_t sliceY,
+             int16_t imageHeight);
   ~ImageBlock() override = default;
 
   const std::string& getImagePath() const { return imagePath; }
+  const std::string& getItemHref() const { return itemHref; }
   int16_t getWidth() const { return width; }
+  // Height drawn on the page, the slice's when the image is sliced
   int16_t getHeight() const { return height; }
+  int16_t getSliceY() const { return sliceY; }
+  int16_t getImageHeight() const { return imageHeight; }
+  bool isSlice() const { return height != imageHeight; }
 
   bool imageExists() const;
 
@@ -26,6 +36,9 @@ class ImageBlock final : public Block {
 
  private:
   std::string imagePath;
+  std::string itemHref;
   int16_t width;
   int16_t height;
+  int16_t sliceY = 0;
+  int16_t imageHeight;
 };
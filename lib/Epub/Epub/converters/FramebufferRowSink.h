@@ -0,0 +1,78 @@
+#pragma once
+
+#include <GfxRenderer.h>
+#include <ImagePipeline.h>
+#include <Logging.h>
+
+#include <cstdlib>
+
+#include "DitherUtils.h"
+#include "PixelCache.h"
+
+// Pipeline sink for inline images: draws each row at (x, y) in the renderer's current render mode, clipped to the
+// screen, and keeps the same 2-bit levels in the pixel cache (.pxc) when one is given.
+//
+// An image taller than a page is drawn a slice at a time: the sink takes rows [firstRow, firstRow + rowCount) of the
+// scaled image, draws the first of them at (x, y) and caches only those. The rows above are dropped as they stream
+// past, and the decode is stopped once the slice is complete, so a slice costs no more memory than a whole image.
+class FramebufferRowSink final : public GrayRowSink {
+ public:
+  FramebufferRowSink(GfxRenderer& renderer, int x, int y, RowDitherer& ditherer, PixelCache* cache, int firstRow = 0,
+                     int rowCount = 0)
+      : renderer(renderer),
+        originX(x),
+        originY(y),
+        ditherer(ditherer),
+        cache(cache),
+        firstRow(firstRow),
+        rowCount(rowCount) {}
+  ~FramebufferRowSink() override { free(levels); }
+  FramebufferRowSink(const FramebufferRowSink&) = delete;
+  FramebufferRowSink& operator=(const FramebufferRowSink&) = delete;
+
+  bool begin(int imageWidth, int height) override {
+    width = imageWidth;
+    if (rowCount <= 0 || firstRow + rowCount > height) rowCount = height - firstRow;
+    levels = static_cast<uint8_t*>(malloc(width));
+    if (!levels) {
+      LOG_ERR("IMG", "Failed to allocate row buffer for width %d", width);
+      return false;
+    }
+    return true;
+  }
+
+  // Returns false once the slice is complete, which ends the decode early; check isComplete() to tell the two apart
+  bool writeRow(const uint8_t* gray, int y) override {
+    if (y < firstRow) return true;
+    if (y >= firstRow + rowCount) return false;
+
+    ditherer.ditherRow(gray, levels, width, y);
+    // A failed cache write only costs the cache; the image is still drawn
+    if (cache && !cache->writeRow(levels)) cache = nullptr;
+
+    rowsDrawn++;
+    const int outY = originY + y - firstRow;
+    if (outY >= renderer.getScreenHeight()) return true;
+    const int screenRight = renderer.getScreenWidth() - originX;
+    const int visible = width < screenRight ? width : screenRight;
+    renderer.withRenderMode([&]<GfxRenderer::RenderMode mode>() {
+      for (int x = 0; x < visible; x++) drawPixelWithRenderMode<mode>(renderer, originX + x, outY, levels[x]);
+    });
+    return true;
+  }
+
+  // Every row of the slice (the whole image when there is no slice) has been drawn
+  bool isComplete() const { return rowCount > 0 && rowsDrawn == rowCount; }
+
+ private:
+  GfxRenderer& renderer;
+  int originX;
+  int originY;
+  RowDitherer& ditherer;
+  PixelCache* cache;
+  int firstRow;
+  int rowCount;
+  int width = 0;
+  int rowsDrawn = 0;
+  uint8_t* levels = nullptr;
+};
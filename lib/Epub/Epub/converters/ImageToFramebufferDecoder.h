@@ -19,6 +19,10 @@ struct RenderConfig {
   bool performanceMode = false;
   bool useExactDimensions = false;  // If true, use maxWidth/maxHeight as exact output size (no recalculation)
   std::string cachePath;            // If non-empty, decoder will write pixel cache to this path
+  // Slice of an image taller than a page: rows [sliceY, sliceY + sliceHeight) of the maxWidth x maxHeight output are
+  // drawn at (x, y) and cached. A sliceHeight of 0 draws the whole image.
+  int sliceY = 0;
+  int sliceHeight = 0;
 };
 
 class ImageToFramebufferDecoder {
@@ -32,8 +36,10 @@ class ImageToFramebufferDecoder {
   virtual const char* getFormatName() const = 0;
 
  protected:
-  // Size validation helpers
-  static constexpr int MAX_SOURCE_PIXELS = 3145728;  // 2048 * 1536
+  // Size validation helpers. Rows are streamed, so memory grows with the width only; the height limit bounds the time
+  // it takes to reach the last slice of a very tall image.
+  static constexpr int MAX_SOURCE_WIDTH = 2048;
+  static constexpr int MAX_SOURCE_HEIGHT = 16384;
 
   bool validateImageDimensions(int width, int height, const std::string& format);
   void warnUnsupportedFeature(const std::string& feature, const std::string& imagePath);
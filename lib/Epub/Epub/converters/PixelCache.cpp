@@ -0,0 +1,200 @@
+#include "PixelCache.h"
+
+#include <GfxRenderer.h>
+#include <Logging.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+constexpr char MAGIC[4] = {'P', 'X', 'C', '2'};
+
+int packedBound(const int length) { return length + (length + 127) / 128; }
+
+bool isBlank(const uint8_t* mask, const int length) {
+  for (int i = 0; i < length; i++) {
+    if (mask[i]) return false;
+  }
+  return true;
+}
+}  // namespace
+
+size_t PixelCache::packRow(const uint8_t* in, const int length, uint8_t* out) {
+  size_t outPos = 0;
+  int i = 0;
+  while (i < length) {
+    int run = 1;
+    while (i + run < length && run < 128 && in[i + run] == in[i]) run++;
+    if (run >= 3) {
+      out[outPos++] = static_cast<uint8_t>(257 - run);
+      out[outPos++] = in[i];
+      i += run;
+      continue;
+    }
+
+    // Literals up to the next run of three or more
+    const int start = i;
+    while (i < length && i - start < 128) {
+      if (i + 2 < length && in[i] == in[i + 1] && in[i] == in[i + 2]) break;
+      i++;
+    }
+    out[outPos++] = static_cast<uint8_t>(i - start - 1);
+    memcpy(out + outPos, in + start, i - start);
+    outPos += i - start;
+  }
+  return outPos;
+}
+
+bool PixelCache::unpackRow(const uint8_t* in, const size_t packedLength, uint8_t* out, const int length) {
+  size_t inPos = 0;
+  int outPos = 0;
+  while (inPos < packedLength) {
+    const uint8_t header = in[inPos++];
+    if (header < 128) {
+      const int count = header + 1;
+      if (outPos + count > length || inPos + count > packedLength) return false;
+      memcpy(out + outPos, in + inPos, count);
+      inPos += count;
+      outPos += count;
+    } else if (header > 128) {
+      const int count = 257 - header;
+      if (outPos + count > length || inPos >= packedLength) return false;
+      memset(out + outPos, in[inPos++], count);
+      outPos += count;
+    }
+  }
+  return outPos == length;
+}
+
+PixelCache::~PixelCache() {
+  if (file) abandon();
+  free(masks);
+  free(packed);
+}
+
+bool PixelCache::begin(const std::string& cachePath, const int imageWidth, const int imageHeight) {
+  path = cachePath;
+  width = imageWidth;
+  height = imageHeight;
+  maskBytes = (width + 7) / 8;
+  packedBytes = packedBound(maskBytes);
+  rowsWritten = 0;
+  failed = false;
+
+  masks = static_cast<uint8_t*>(malloc(PLANES * maskBytes));
+  packed = static_cast<uint8_t*>(malloc(PLANES * packedBytes));
+  if (!masks || !packed) {
+    LOG_ERR("IMG", "Failed to allocate cache rows for width %d", width);
+    return false;
+  }
+  if (!Storage.openFileForWrite("IMG", path, file)) {
+    LOG_ERR("IMG", "Failed to open cache file for writing: %s", path.c_str());
+    return false;
+  }
+
+  const uint16_t size[2] = {static_cast<uint16_t>(width), static_cast<uint16_t>(height)};
+  if (file.write(MAGIC, sizeof(MAGIC)) != sizeof(MAGIC) || file.write(size, sizeof(size)) != sizeof(size)) {
+    abandon();
+    return false;
+  }
+  return true;
+}
+
+bool PixelCache::writeRow(const uint8_t* levels) {
+  if (!file || failed) return false;
+
+  memset(masks, 0, PLANES * maskBytes);
+  uint8_t* bw = masks;
+  uint8_t* lsb = masks + maskBytes;
+  uint8_t* msb = masks + 2 * maskBytes;
+  for (int x = 0; x < width; x++) {
+    const uint8_t level = levels[x] & 0x03;
+    const uint8_t bit = 0x80 >> (x & 7);
+    if (GfxRenderer::drawsGrayLevel<GfxRenderer::BW>(level)) bw[x >> 3] |= bit;
+    if (GfxRenderer::drawsGrayLevel<GfxRenderer::GRAYSCALE_LSB>(level)) lsb[x >> 3] |= bit;
+    if (GfxRenderer::drawsGrayLevel<GfxRenderer::GRAYSCALE_MSB>(level)) msb[x >> 3] |= bit;
+  }
+
+  uint16_t lengths[PLANES];
+  for (int plane = 0; plane < PLANES; plane++) {
+    const uint8_t* mask = masks + plane * maskBytes;
+    lengths[plane] = isBlank(mask, maskBytes) ? 0 : packRow(mask, maskBytes, packed + plane * packedBytes);
+  }
+
+  bool ok = file.write(lengths, sizeof(lengths)) == sizeof(lengths);
+  for (int plane = 0; ok && plane < PLANES; plane++) {
+    ok = file.write(packed + plane * packedBytes, lengths[plane]) == lengths[plane];
+  }
+  if (!ok) {
+    LOG_ERR("IMG", "Cache write failed at row %d: %s", rowsWritten, path.c_str());
+    failed = true;
+    return false;
+  }
+  rowsWritten++;
+  return true;
+}
+
+bool PixelCache::finish() {
+  if (!file) return false;
+  if (failed || rowsWritten != height) {
+    abandon();
+    return false;
+  }
+  LOG_DBG("IMG", "Cache written: %s (%dx%d, %d bytes)", path.c_str(), width, height, static_cast<int>(file.size()));
+  file.close();
+  return true;
+}
+
+void PixelCache::abandon() {
+  file.close();
+  Storage.remove(path.c_str());
+  LOG_DBG("IMG", "Discarded incomplete cache: %s", path.c_str());
+}
+
+PixelCacheReader::~PixelCacheReader() { free(packed); }
+
+bool PixelCacheReader::open(const std::string& path) {
+  if (!Storage.openFileForRead("IMG", path, file)) {
+    return false;
+  }
+
+  char magic[sizeof(MAGIC)];
+  uint16_t size[2];
+  if (file.read(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      file.read(size, sizeof(size)) != sizeof(size)) {
+    LOG_DBG("IMG", "Not a current pixel cache: %s", path.c_str());
+    file.close();
+    return false;
+  }
+  width = size[0];
+  height = size[1];
+  maskBytes = (width + 7) / 8;
+  packed = static_cast<uint8_t*>(malloc(packedBound(maskBytes)));
+  if (!packed) {
+    LOG_ERR("IMG", "Failed to allocate cache row buffer");
+    file.close();
+    return false;
+  }
+  return true;
+}
+
+bool PixelCacheReader::readRow(const int plane, uint8_t* mask, bool& drawn) {
+  uint16_t lengths[PixelCache::PLANES];
+  if (file.read(lengths, sizeof(lengths)) != sizeof(lengths)) return false;
+
+  int before = 0;
+  int after = 0;
+  for (int i = 0; i < PixelCache::PLANES; i++) {
+    if (i < plane) before += lengths[i];
+    if (i > plane) after += lengths[i];
+  }
+  const int length = lengths[plane];
+  if (length > packedBound(maskBytes)) return false;
+
+  if (before && !file.seekCur(before)) return false;
+  if (file.read(packed, length) != length) return false;
+  if (after && !file.seekCur(after)) return false;
+
+  drawn = length > 0;
+  return !drawn || PixelCache::unpackRow(packed, length, mask, maskBytes);
+}
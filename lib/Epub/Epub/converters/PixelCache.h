@@ -1,82 +1,82 @@
 #pragma once
 
 #include <HalStorage.h>
-#include <Logging.h>
 #include <stdint.h>
 
-#include <cstring>
 #include <string>
 
-// Cache buffer for storing 2-bit pixels (4 levels) during decode.
-// Packs 4 pixels per byte, MSB first.
-struct PixelCache {
-  uint8_t* buffer;
-  int width;
-  int height;
-  int bytesPerRow;
-  int originX;  // config.x - to convert screen coords to cache coords
-  int originY;  // config.y
+// Pixel cache (.pxc) of a decoded inline image, so the page is redrawn without decoding the image again.
+//
+// The 2-bit levels are kept pre-split into the three masks the render passes draw, one bit per pixel MSB first and in
+// GfxRenderer::RenderMode order: BW (every level but white), GRAYSCALE_LSB (dark gray) and GRAYSCALE_MSB (dark and
+// light gray). Each mask row is PackBits-compressed, so the white around an illustration costs next to nothing, and a
+// pass reads and draws its own mask only, a byte at a time through GfxRenderer::drawMaskRow.
+//
+// File layout:
+//   char magic[4]                   "PXC2"
+//   uint16_t width, height
+//   per row: uint16_t length[3]     packed size of each mask, 0 when the pass draws nothing on this row
+//            uint8_t packed[...]    the three packed masks, one after the other
+//
+// The file is written row by row while the image decodes, so there is no size limit and no whole-image buffer.
+class PixelCache {
+ public:
+  static constexpr int PLANES = 3;
 
-  PixelCache() : buffer(nullptr), width(0), height(0), bytesPerRow(0), originX(0), originY(0) {}
+  PixelCache() = default;
+  ~PixelCache();
   PixelCache(const PixelCache&) = delete;
   PixelCache& operator=(const PixelCache&) = delete;
 
-  static constexpr size_t MAX_CACHE_BYTES = 256 * 1024;  // 256KB limit for embedded targets
+  // Creates the cache file for a `width` x `height` image
+  bool begin(const std::string& path, int width, int height);
+  // Appends the next row of 2-bit levels (0 black .. 3 white)
+  bool writeRow(const uint8_t* levels);
+  // Closes the file once every row is written. An unfinished or failed cache is deleted instead.
+  bool finish();
 
-  bool allocate(int w, int h, int ox, int oy) {
-    width = w;
-    height = h;
-    originX = ox;
-    originY = oy;
-    bytesPerRow = (w + 3) / 4;  // 2 bits per pixel, 4 pixels per byte
-    size_t bufferSize = (size_t)bytesPerRow * h;
-    if (bufferSize > MAX_CACHE_BYTES) {
-      LOG_ERR("IMG", "Cache buffer too large: %d bytes for %dx%d (limit %d)", bufferSize, w, h, MAX_CACHE_BYTES);
-      return false;
-    }
-    buffer = (uint8_t*)malloc(bufferSize);
-    if (buffer) {
-      memset(buffer, 0, bufferSize);
-      LOG_DBG("IMG", "Allocated cache buffer: %d bytes for %dx%d", bufferSize, w, h);
-    }
-    return buffer != nullptr;
-  }
+  // PackBits: a header n < 128 is followed by n + 1 literal bytes, n > 128 by one byte repeated 257 - n times.
+  // `out` needs room for `length + (length + 127) / 128` bytes.
+  static size_t packRow(const uint8_t* in, int length, uint8_t* out);
+  static bool unpackRow(const uint8_t* in, size_t packedLength, uint8_t* out, int length);
 
-  void setPixel(int screenX, int screenY, uint8_t value) {
-    if (!buffer) return;
-    int localX = screenX - originX;
-    int localY = screenY - originY;
-    if (localX < 0 || localX >= width || localY < 0 || localY >= height) return;
+ private:
+  void abandon();
 
-    int byteIdx = localY * bytesPerRow + localX / 4;
-    int bitShift = 6 - (localX % 4) * 2;  // MSB first: pixel 0 at bits 6-7
-    buffer[byteIdx] = (buffer[byteIdx] & ~(0x03 << bitShift)) | ((value & 0x03) << bitShift);
-  }
-
-  bool writeToFile(const std::string& cachePath) {
-    if (!buffer) return false;
+  FsFile file;
+  std::string path;
+  int width = 0;
+  int height = 0;
+  int maskBytes = 0;
+  int rowsWritten = 0;
+  uint8_t* masks = nullptr;   // PLANES masks of maskBytes
+  uint8_t* packed = nullptr;  // PLANES packed masks, each at most packedBytes
+  int packedBytes = 0;
+  bool failed = false;
+};
 
-    FsFile cacheFile;
-    if (!Storage.openFileForWrite("IMG", cachePath, cacheFile)) {
-      LOG_ERR("IMG", "Failed to open cache file for writing: %s", cachePath.c_str());
-      return false;
-    }
+// Reads a pixel cache back one row and one pass at a time
+class PixelCacheReader {
+ public:
+  PixelCacheReader() = default;
+  ~PixelCacheReader();
+  PixelCacheReader(const PixelCacheReader&) = delete;
+  PixelCacheReader& operator=(const PixelCacheReader&) = delete;
 
-    uint16_t w = width;
-    uint16_t h = height;
-    cacheFile.write(&w, 2);
-    cacheFile.write(&h, 2);
-    cacheFile.write(buffer, bytesPerRow * height);
-    cacheFile.close();
+  // Returns false if the file is missing or not a pixel cache of this format
+  bool open(const std::string& path);
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+  int getMaskBytes() const { return maskBytes; }
 
-    LOG_DBG("IMG", "Cache written: %s (%dx%d, %d bytes)", cachePath.c_str(), width, height, 4 + bytesPerRow * height);
-    return true;
-  }
+  // Unpacks the next row's mask for render pass `plane` into `mask` (getMaskBytes() bytes). `drawn` is false when the
+  // pass draws nothing on this row, and `mask` is then left as it is.
+  bool readRow(int plane, uint8_t* mask, bool& drawn);
 
-  ~PixelCache() {
-    if (buffer) {
-      free(buffer);
-      buffer = nullptr;
-    }
-  }
+ private:
+  FsFile file;
+  int width = 0;
+  int height = 0;
+  int maskBytes = 0;
+  uint8_t* packed = nullptr;
 };
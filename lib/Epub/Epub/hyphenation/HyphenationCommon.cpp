@@ -171,10 +171,14 @@ std::vector<CodepointInfo> collectCodepoints(const std::string& word) {
 
   const unsigned char* base = reinterpret_cast<const unsigned char*>(word.c_str());
   const unsigned char* ptr = base;
-  while (*ptr != 0) {
-    const unsigned char* current = ptr;
-    const uint32_t cp = utf8NextCodepoint(&ptr);
-    cps.push_back({cp, static_cast<size_t>(current - base)});
+  size_t byteOffset = 0;
+  uint32_t span[UTF8_SPAN_MAX];
+  size_t count;
+  while ((count = utf8NextCodepoints(&ptr, span, UTF8_SPAN_MAX))) {
+    for (size_t i = 0; i < count; i++) {
+      cps.push_back({span[i], byteOffset});
+      byteOffset += utf8CodepointLen(base[byteOffset]);
+    }
   }
 
   return cps;
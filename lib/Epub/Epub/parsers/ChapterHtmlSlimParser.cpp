@@ -4,9 +4,11 @@
 #include <GfxRenderer.h>
 #include <HalStorage.h>
 #include <Logging.h>
+#include <Trace.h>
 #include <expat.h>
 
 #include "../../Epub.h"
+#include "../ImageCache.h"
 #include "../Page.h"
 #include "../converters/ImageDecoderFactory.h"
 #include "../converters/ImageToFramebufferDecoder.h"
@@ -19,6 +21,11 @@ constexpr int NUM_HEADER_TAGS = sizeof(HEADER_TAGS) / sizeof(HEADER_TAGS[0]);
 constexpr size_t MIN_SIZE_FOR_POPUP = 10 * 1024;  // 10KB
 constexpr size_t PARSE_BUFFER_SIZE = 1024;
 
+// An image that would have to shrink to under half the page width to fit on one page is instead drawn at the width
+// of the page and split into page-high slices, up to this many pages (e.g. comic strips, tables saved as images)
+constexpr int TALL_IMAGE_MIN_PAGES = 2;
+constexpr int MAX_IMAGE_SLICES = 12;
+
 const char* BLOCK_TAGS[] = {"p", "li", "div", "br", "blockquote"};
 constexpr int NUM_BLOCK_TAGS = sizeof(BLOCK_TAGS) / sizeof(BLOCK_TAGS[0]);
 
@@ -232,29 +239,27 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
           std::string resolvedPath = FsHelpers::normalisePath(self->contentBase + src);
 
           if (ImageDecoderFactory::isFormatSupported(resolvedPath)) {
-            // Create a unique filename for the cached image
+            // Cached by content, so an image repeated across chapters or books is extracted and decoded once
             std::string ext;
             size_t extPos = resolvedPath.rfind('.');
             if (extPos != std::string::npos) {
               ext = resolvedPath.substr(extPos);
             }
-            std::string cachedImagePath = self->imageBasePath + std::to_string(self->imageCounter++) + ext;
-
-            // Extract image to cache file
-            FsFile cachedImageFile;
-            bool extractSuccess = false;
-            if (Storage.openFileForWrite("EHP", cachedImagePath, cachedImageFile)) {
-              extractSuccess = self->epub->readItemContentsToStream(resolvedPath, cachedImageFile, 4096);
-              cachedImageFile.flush();
-              cachedImageFile.close();
-              delay(50);  // Give SD card time to sync
+            ImageCache::Key key = {};
+            std::string cachedImagePath;
+            if (self->epub->getItemChecksum(resolvedPath, &key.crc, &key.size)) {
+              cachedImagePath = self->imageCache.getImagePath(key, ext);
             }
 
-            if (extractSuccess) {
-              // Get image dimensions
-              ImageDimensions dims = {0, 0};
-              ImageToFramebufferDecoder* decoder = ImageDecoderFactory::getDecoder(cachedImagePath);
-              if (decoder && decoder->getDimensions(cachedImagePath, dims)) {
+            {
+              // Only the header is read to lay the image out; it is extracted to cachedImagePath when a page
+              // showing it is first loaded (Section::loadPageFromSectionFile)
+              int width = 0;
+              int height = 0;
+              if (!cachedImagePath.empty() && self->epub->getItemImageSize(resolvedPath, &width, &height)) {
+                self->imageCache.addReference(key);
+                const ImageDimensions dims = {static_cast<int16_t>(std::min(width, INT16_MAX)),
+                                              static_cast<int16_t>(std::min(height, INT16_MAX))};
                 LOG_DBG("EHP", "Image dimensions: %dx%d", dims.width, dims.height);
 
                 int displayWidth = 0;
@@ -331,6 +336,20 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
                   }
                   if (displayHeight < 1) displayHeight = 1;
                   LOG_DBG("EHP", "Display size from CSS width: %dx%d", displayWidth, displayHeight);
+                } else if (dims.width > 0 &&
+                           static_cast<int64_t>(dims.height) * std::min<int>(dims.width, self->viewportWidth) >
+                               static_cast<int64_t>(dims.width) * self->viewportHeight * TALL_IMAGE_MIN_PAGES) {
+                  // Too tall for one page: fit the width and slice it across pages
+                  displayWidth = std::min<int>(dims.width, self->viewportWidth);
+                  displayHeight = static_cast<int>(static_cast<int64_t>(dims.height) * displayWidth / dims.width);
+                  const int maxHeight = self->viewportHeight * MAX_IMAGE_SLICES;
+                  if (displayHeight > maxHeight) {
+                    displayWidth = std::max(1, static_cast<int>(static_cast<int64_t>(dims.width) * maxHeight /
+                                                                dims.height));
+                    displayHeight = maxHeight;
+                  }
+                  LOG_DBG("EHP", "Display size: %dx%d in %d slices", displayWidth, displayHeight,
+                          (displayHeight + self->viewportHeight - 1) / self->viewportHeight);
                 } else {
                   // Scale to fit viewport while maintaining aspect ratio
                   int maxWidth = self->viewportWidth;
@@ -345,6 +364,38 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
                   LOG_DBG("EHP", "Display size: %dx%d (scale %.2f)", displayWidth, displayHeight, scale);
                 }
 
+                // Lay out the text before the image first, or it would be placed after it
+                if (self->partWordBufferIndex > 0) {
+                  self->flushPartWordBuffer();
+                }
+                if (self->currentTextBlock && !self->currentTextBlock->isEmpty()) {
+                  self->startNewTextBlock(self->currentTextBlock->getBlockStyle());
+                }
+
+                int xPos = (self->viewportWidth - displayWidth) / 2;
+                if (displayHeight > self->viewportHeight) {
+                  // One slice per page, starting on a fresh page. Each slice decodes only as far as its own last
+                  // row and has its own pixel cache.
+                  for (int sliceY = 0; sliceY < displayHeight; sliceY += self->viewportHeight) {
+                    if (self->currentPage && !self->currentPage->elements.empty()) {
+                      self->completePageFn(std::move(self->currentPage));
+                    }
+                    self->currentPage.reset(new Page());
+                    if (!self->currentPage) {
+                      LOG_ERR("EHP", "Failed to create new page");
+                      return;
+                    }
+                    const int sliceHeight = std::min<int>(self->viewportHeight, displayHeight - sliceY);
+                    auto imageBlock = std::make_shared<ImageBlock>(cachedImagePath, resolvedPath, displayWidth,
+                                                                   sliceHeight, sliceY, displayHeight);
+                    self->currentPage->elements.push_back(std::make_shared<PageImage>(imageBlock, xPos, 0));
+                    self->currentPageNextY = sliceHeight;
+                  }
+
+                  self->depth += 1;
+                  return;
+                }
+
                 // Create page for image - only break if image won't fit remaining space
                 if (self->currentPage && !self->currentPage->elements.empty() &&
                     (self->currentPageNextY + displayHeight > self->viewportHeight)) {
@@ -365,12 +416,12 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
                 }
 
                 // Create ImageBlock and add to page
-                auto imageBlock = std::make_shared<ImageBlock>(cachedImagePath, displayWidth, displayHeight);
+                auto imageBlock =
+                    std::make_shared<ImageBlock>(cachedImagePath, resolvedPath, displayWidth, displayHeight);
                 if (!imageBlock) {
                   LOG_ERR("EHP", "Failed to create ImageBlock");
                   return;
                 }
-                int xPos = (self->viewportWidth - displayWidth) / 2;
                 auto pageImage = std::make_shared<PageImage>(imageBlock, xPos, self->currentPageNextY);
                 if (!pageImage) {
                   LOG_ERR("EHP", "Failed to create PageImage");
@@ -383,10 +434,7 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
                 return;
               } else {
                 LOG_ERR("EHP", "Failed to get image dimensions");
-                Storage.remove(cachedImagePath.c_str());
               }
-            } else {
-              LOG_ERR("EHP", "Failed to extract image");
             }
           }  // isFormatSupported
         }
@@ -421,8 +469,8 @@ void XMLCALL ChapterHtmlSlimParser::startElement(void* userData, const XML_Char*
   // Skip blocks with role="doc-pagebreak" and epub:type="pagebreak"
   if (atts != nullptr) {
     for (int i = 0; atts[i]; i += 2) {
-      if (strcmp(atts[i], "role") == 0 && strcmp(atts[i + 1], "doc-pagebreak") == 0 ||
-          strcmp(atts[i], "epub:type") == 0 && strcmp(atts[i + 1], "pagebreak") == 0) {
+      if ((strcmp(atts[i], "role") == 0 && strcmp(atts[i + 1], "doc-pagebreak") == 0) ||
+          (strcmp(atts[i], "epub:type") == 0 && strcmp(atts[i + 1], "pagebreak") == 0)) {
         self->skipUntilDepth = self->depth;
         self->depth += 1;
         return;
@@ -761,6 +809,7 @@ void XMLCALL ChapterHtmlSlimParser::endElement(void* userData, const XML_Char* n
 }
 
 bool ChapterHtmlSlimParser::parseAndBuildPages() {
+  TRACE_SPAN("xml_parse_chapter");
   auto paragraphAlignmentBlockStyle = BlockStyle();
   paragraphAlignmentBlockStyle.textAlignDefined = true;
   // Resolve None sentinel to Justify for initial block (no CSS context yet)
@@ -798,7 +847,7 @@ bool ChapterHtmlSlimParser::parseAndBuildPages() {
   XML_SetCharacterDataHandler(parser, characterData);
 
   // Compute the time taken to parse and build pages
-  const uint32_t chapterStartTime = millis();
+  [[maybe_unused]] const uint32_t chapterStartTime = millis();
   do {
     void* const buf = XML_GetBuffer(parser, PARSE_BUFFER_SIZE);
     if (!buf) {
@@ -15,6 +15,7 @@
 class Page;
 class GfxRenderer;
 class Epub;
+class ImageCache;
 
 #define MAX_WORD_SIZE 200
 
@@ -47,8 +48,7 @@ class ChapterHtmlSlimParser {
   const CssParser* cssParser;
   bool embeddedStyle;
   std::string contentBase;
-  std::string imageBasePath;
-  int imageCounter = 0;
+  ImageCache& imageCache;
 
   // Style tracking (replaces depth-based approach)
   struct StyleStackEntry {
@@ -83,12 +83,14 @@ class ChapterHtmlSlimParser {
                                  const uint16_t viewportHeight, const bool hyphenationEnabled,
                                  const std::function<void(std::unique_ptr<Page>)>& completePageFn,
                                  const bool embeddedStyle, const std::string& contentBase,
-                                 const std::string& imageBasePath, const std::function<void()>& popupFn = nullptr,
+                                 ImageCache& imageCache, const std::function<void()>& popupFn = nullptr,
                                  const CssParser* cssParser = nullptr)
 
       : epub(epub),
         filepath(filepath),
         renderer(renderer),
+        completePageFn(completePageFn),
+        popupFn(popupFn),
         fontId(fontId),
         lineCompression(lineCompression),
         extraParagraphSpacing(extraParagraphSpacing),
@@ -96,12 +98,10 @@ class ChapterHtmlSlimParser {
         viewportWidth(viewportWidth),
         viewportHeight(viewportHeight),
         hyphenationEnabled(hyphenationEnabled),
-        completePageFn(completePageFn),
-        popupFn(popupFn),
         cssParser(cssParser),
         embeddedStyle(embeddedStyle),
         contentBase(contentBase),
-        imageBasePath(imageBasePath) {}
+        imageCache(imageCache) {}
 
   ~ChapterHtmlSlimParser() = default;
   bool parseAndBuildPages();
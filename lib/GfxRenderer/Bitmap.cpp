@@ -177,6 +177,47 @@ BmpReaderError Bitmap::parseHeaders() {
   return BmpReaderError::Ok;
 }
 
+// Calls fn(luminance) for each pixel of a raw row, left to right
+template <typename Fn>
+bool Bitmap::forEachLum(const uint8_t* rowBuffer, Fn&& fn) const {
+  switch (bpp) {
+    case 32: {
+      const uint8_t* p = rowBuffer;
+      for (int x = 0; x < width; x++) {
+        fn(static_cast<uint8_t>((77u * p[2] + 150u * p[1] + 29u * p[0]) >> 8));
+        p += 4;
+      }
+      return true;
+    }
+    case 24: {
+      const uint8_t* p = rowBuffer;
+      for (int x = 0; x < width; x++) {
+        fn(static_cast<uint8_t>((77u * p[2] + 150u * p[1] + 29u * p[0]) >> 8));
+        p += 3;
+      }
+      return true;
+    }
+    case 8:
+      for (int x = 0; x < width; x++) fn(paletteLum[rowBuffer[x]]);
+      return true;
+    case 4:
+      for (int x = 0; x < width; x++) {
+        const uint8_t nibble = (x & 1) ? (rowBuffer[x >> 1] & 0x0F) : (rowBuffer[x >> 1] >> 4);
+        fn(paletteLum[nibble]);
+      }
+      return true;
+    case 2:
+      for (int x = 0; x < width; x++) fn(paletteLum[(rowBuffer[x >> 2] >> (6 - ((x & 3) * 2))) & 0x03]);
+      return true;
+    case 1:
+      // Palette lookup for proper black/white mapping
+      for (int x = 0; x < width; x++) fn(paletteLum[(rowBuffer[x >> 3] & (0x80 >> (x & 7))) ? 1 : 0]);
+      return true;
+    default:
+      return false;
+  }
+}
+
 // packed 2bpp output, 0 = black, 1 = dark gray, 2 = light gray, 3 = white
 BmpReaderError Bitmap::readNextRow(uint8_t* data, uint8_t* rowBuffer) const {
   // Note: rowBuffer should be pre-allocated by the caller to size 'rowBytes'
@@ -216,60 +257,7 @@ BmpReaderError Bitmap::readNextRow(uint8_t* data, uint8_t* rowBuffer) const {
     currentX++;
   };
 
-  uint8_t lum;
-
-  switch (bpp) {
-    case 32: {
-      const uint8_t* p = rowBuffer;
-      for (int x = 0; x < width; x++) {
-        lum = (77u * p[2] + 150u * p[1] + 29u * p[0]) >> 8;
-        packPixel(lum);
-        p += 4;
-      }
-      break;
-    }
-    case 24: {
-      const uint8_t* p = rowBuffer;
-      for (int x = 0; x < width; x++) {
-        lum = (77u * p[2] + 150u * p[1] + 29u * p[0]) >> 8;
-        packPixel(lum);
-        p += 3;
-      }
-      break;
-    }
-    case 8: {
-      for (int x = 0; x < width; x++) {
-        packPixel(paletteLum[rowBuffer[x]]);
-      }
-      break;
-    }
-    case 4: {
-      for (int x = 0; x < width; x++) {
-        const uint8_t nibble = (x & 1) ? (rowBuffer[x >> 1] & 0x0F) : (rowBuffer[x >> 1] >> 4);
-        packPixel(paletteLum[nibble]);
-      }
-      break;
-    }
-    case 2: {
-      for (int x = 0; x < width; x++) {
-        lum = paletteLum[(rowBuffer[x >> 2] >> (6 - ((x & 3) * 2))) & 0x03];
-        packPixel(lum);
-      }
-      break;
-    }
-    case 1: {
-      for (int x = 0; x < width; x++) {
-        // Get palette index (0 or 1) from bit at position x
-        const uint8_t palIndex = (rowBuffer[x >> 3] & (0x80 >> (x & 7))) ? 1 : 0;
-        // Use palette lookup for proper black/white mapping
-        lum = paletteLum[palIndex];
-        packPixel(lum);
-      }
-      break;
-    }
-    default:
-      return BmpReaderError::UnsupportedBpp;
-  }
+  if (!forEachLum(rowBuffer, packPixel)) return BmpReaderError::UnsupportedBpp;
 
   if (atkinsonDitherer)
     atkinsonDitherer->nextRow();
@@ -282,6 +270,15 @@ BmpReaderError Bitmap::readNextRow(uint8_t* data, uint8_t* rowBuffer) const {
   return BmpReaderError::Ok;
 }
 
+BmpReaderError Bitmap::readGrayRow(const int y, uint8_t* gray, uint8_t* rowBuffer) const {
+  const int fileRow = topDown ? y : height - 1 - y;
+  if (!file.seek(bfOffBits + static_cast<uint32_t>(fileRow) * rowBytes)) return BmpReaderError::SeekPixelDataFailed;
+  if (file.read(rowBuffer, rowBytes) != rowBytes) return BmpReaderError::ShortReadRow;
+
+  if (!forEachLum(rowBuffer, [&gray](const uint8_t lum) { *gray++ = lum; })) return BmpReaderError::UnsupportedBpp;
+  return BmpReaderError::Ok;
+}
+
 BmpReaderError Bitmap::rewindToData() const {
   if (!file.seek(bfOffBits)) {
     return BmpReaderError::SeekPixelDataFailed;
@@ -36,6 +36,9 @@ class Bitmap {
   ~Bitmap();
   BmpReaderError parseHeaders();
   BmpReaderError readNextRow(uint8_t* data, uint8_t* rowBuffer) const;
+  // Reads row `y` (0 = top, whichever way the file stores rows) as 8-bit gray, undithered. rowBuffer must hold
+  // getRowBytes() bytes.
+  BmpReaderError readGrayRow(int y, uint8_t* gray, uint8_t* rowBuffer) const;
   BmpReaderError rewindToData() const;
   int getWidth() const { return width; }
   int getHeight() const { return height; }
@@ -48,6 +51,8 @@ class Bitmap {
  private:
   static uint16_t readLE16(FsFile& f);
   static uint32_t readLE32(FsFile& f);
+  template <typename Fn>
+  bool forEachLum(const uint8_t* rowBuffer, Fn&& fn) const;
 
   FsFile& file;
   bool dithering = false;
@@ -0,0 +1,150 @@
+#include "FrameStash.h"
+
+#include <Logging.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+constexpr size_t FRAME_SIZE = HalDisplay::BUFFER_SIZE;
+constexpr uint8_t WHITE = 0xFF;
+constexpr size_t GROUP_SIZE = 8;
+constexpr size_t GROUP_COUNT = FRAME_SIZE / GROUP_SIZE;
+constexpr size_t MAX_BLANK_REPEAT = 255;
+constexpr uint8_t RAW_FRAME = 0;
+constexpr uint8_t MASKED_FRAME = 1;
+static_assert(FRAME_SIZE % GROUP_SIZE == 0, "frame must split into whole groups");
+
+uint8_t groupMask(const uint8_t* group) {
+  uint8_t mask = 0;
+  for (size_t k = 0; k < GROUP_SIZE; k++) {
+    if (group[k] != WHITE) mask |= 1 << k;
+  }
+  return mask;
+}
+
+// Blank groups following `group`, up to what one repeat byte can count
+size_t blankRepeat(const uint8_t* frame, const size_t group) {
+  size_t repeat = 0;
+  while (group + repeat + 1 < GROUP_COUNT && repeat < MAX_BLANK_REPEAT &&
+         groupMask(frame + (group + repeat + 1) * GROUP_SIZE) == 0) {
+    repeat++;
+  }
+  return repeat;
+}
+
+size_t maskedSize(const uint8_t* frame) {
+  size_t size = 1;
+  for (size_t group = 0; group < GROUP_COUNT; group++) {
+    const uint8_t mask = groupMask(frame + group * GROUP_SIZE);
+    if (mask == 0) {
+      group += blankRepeat(frame, group);
+      size += 2;
+    } else {
+      size += 1 + __builtin_popcount(mask);
+    }
+  }
+  return size;
+}
+}  // namespace
+
+bool FrameStash::store(const uint8_t* frame) {
+  stored = false;
+  size_t chunk = 0;
+  size_t offset = 0;
+  size_t total = 0;
+  // Appends `count` bytes, moving on to the next chunk (allocating it if need be) when the current one is full
+  auto put = [&](const uint8_t* bytes, size_t count) {
+    while (count > 0) {
+      if (offset == CHUNK_SIZE) {
+        chunk++;
+        offset = 0;
+      }
+      if (chunk == chunkCount) {
+        if (chunkCount == MAX_CHUNKS) return false;
+        chunks[chunkCount] = static_cast<uint8_t*>(malloc(CHUNK_SIZE));
+        if (!chunks[chunkCount]) {
+          LOG_ERR("FST", "Failed to allocate stash chunk %zu (%zu bytes)", chunkCount, CHUNK_SIZE);
+          return false;
+        }
+        chunkCount++;
+      }
+      const size_t n = std::min(count, CHUNK_SIZE - offset);
+      memcpy(chunks[chunk] + offset, bytes, n);
+      offset += n;
+      total += n;
+      bytes += n;
+      count -= n;
+    }
+    return true;
+  };
+
+  // Frames with little white (dithered covers) are kept as they are rather than grown by the masks
+  if (maskedSize(frame) >= FRAME_SIZE) {
+    if (!put(&RAW_FRAME, 1) || !put(frame, FRAME_SIZE)) return false;
+  } else {
+    if (!put(&MASKED_FRAME, 1)) return false;
+    for (size_t group = 0; group < GROUP_COUNT; group++) {
+      const uint8_t* bytes = frame + group * GROUP_SIZE;
+      const uint8_t mask = groupMask(bytes);
+      if (mask == 0) {
+        const uint8_t token[2] = {0, static_cast<uint8_t>(blankRepeat(frame, group))};
+        if (!put(token, 2)) return false;
+        group += token[1];
+        continue;
+      }
+      if (!put(&mask, 1)) return false;
+      for (size_t k = 0; k < GROUP_SIZE; k++) {
+        if ((mask & (1 << k)) && !put(bytes + k, 1)) return false;
+      }
+    }
+  }
+
+  encodedSize = total;
+  stored = true;
+  LOG_DBG("FST", "Stored frame in %zu bytes (%zu chunks held)", encodedSize, chunkCount);
+  return true;
+}
+
+bool FrameStash::restore(uint8_t* frame) const {
+  if (!stored) return false;
+
+  size_t chunk = 0;
+  size_t offset = 0;
+  auto next = [&]() {
+    if (offset == CHUNK_SIZE) {
+      chunk++;
+      offset = 0;
+    }
+    return chunks[chunk][offset++];
+  };
+
+  if (next() == RAW_FRAME) {
+    for (size_t i = 0; i < FRAME_SIZE; i++) frame[i] = next();
+    return true;
+  }
+  memset(frame, WHITE, FRAME_SIZE);
+  for (size_t group = 0; group < GROUP_COUNT; group++) {
+    const uint8_t mask = next();
+    if (mask == 0) {
+      group += next();
+      continue;
+    }
+    uint8_t* bytes = frame + group * GROUP_SIZE;
+    for (size_t k = 0; k < GROUP_SIZE; k++) {
+      if (mask & (1 << k)) bytes[k] = next();
+    }
+  }
+  return true;
+}
+
+void FrameStash::release() {
+  for (size_t i = 0; i < chunkCount; i++) {
+    free(chunks[i]);
+    chunks[i] = nullptr;
+  }
+  chunkCount = 0;
+  encodedSize = 0;
+  stored = false;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <HalDisplay.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Keeps a copy of a panel frame buffer, packed into 4KB chunks that stay allocated between stores.
+//
+// BW frames are mostly white bytes, so only the others are kept: each group of 8 frame bytes is written as a mask byte
+// (bit k set when byte k is not 0xFF) followed by those bytes, and a blank group as a zero mask plus a count of the
+// blank groups after it. A page of text packs to a third of the frame or less, a blank one to a few dozen bytes.
+// Frames the masks would grow (dithered covers) are kept as they are. Chunks are only added when a frame does not fit
+// the ones held already, which keeps the heap from churning when the same kind of frame is stored over and over (e.g.
+// on every anti-aliased page), and no allocation is ever larger than one chunk.
+class FrameStash {
+ public:
+  static constexpr size_t CHUNK_SIZE = 4096;
+  // A frame kept as it is, after the byte telling the two layouts apart
+  static constexpr size_t MAX_ENCODED_SIZE = HalDisplay::BUFFER_SIZE + 1;
+  static constexpr size_t MAX_CHUNKS = (MAX_ENCODED_SIZE + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  FrameStash() = default;
+  ~FrameStash() { release(); }
+  FrameStash(const FrameStash&) = delete;
+  FrameStash& operator=(const FrameStash&) = delete;
+
+  // Encodes a BUFFER_SIZE frame, replacing any stored one. Returns false (and holds no frame) if a chunk could not be
+  // allocated.
+  bool store(const uint8_t* frame);
+  // Decodes the stored frame into `frame`. Returns false if nothing is stored.
+  bool restore(uint8_t* frame) const;
+  bool hasFrame() const { return stored; }
+  // Forgets the frame but keeps the chunks for the next store
+  void clear() { stored = false; }
+  // Forgets the frame and frees the chunks
+  void release();
+
+  size_t getEncodedSize() const { return stored ? encodedSize : 0; }
+  size_t getReservedSize() const { return chunkCount * CHUNK_SIZE; }
+
+ private:
+  uint8_t* chunks[MAX_CHUNKS] = {};
+  size_t chunkCount = 0;
+  size_t encodedSize = 0;
+  bool stored = false;
+};
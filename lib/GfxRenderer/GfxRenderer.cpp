@@ -3,13 +3,17 @@
 #include <Logging.h>
 #include <Utf8.h>
 
+#include <vector>
+
 const uint8_t* GfxRenderer::getGlyphBitmap(const EpdFontData* fontData, const EpdGlyph* glyph) const {
   if (fontData->groups != nullptr) {
     if (!fontDecompressor) {
       LOG_ERR("GFX", "Compressed font but no FontDecompressor set");
       return nullptr;
     }
-    uint16_t glyphIndex = static_cast<uint16_t>(glyph - fontData->glyph);
+    // Paged fonts (no glyph table in RAM) know the index of each glyph they hand out
+    const uint32_t glyphIndex = fontData->glyph ? static_cast<uint32_t>(glyph - fontData->glyph)
+                                                : fontData->groupSource->getGlyphIndex(glyph);
     return fontDecompressor->getBitmap(fontData, glyph, glyphIndex);
   }
   return &fontData->bitmap[glyph->dataOffset];
@@ -59,14 +63,39 @@ static inline void rotateCoordinates(const GfxRenderer::Orientation orientation,
   }
 }
 
+// Inverse of rotateCoordinates: physical panel coordinates back to logical (x,y)
+static inline void unrotateCoordinates(const GfxRenderer::Orientation orientation, const int phyX, const int phyY,
+                                       int* x, int* y) {
+  switch (orientation) {
+    case GfxRenderer::Portrait:
+      *x = HalDisplay::DISPLAY_HEIGHT - 1 - phyY;
+      *y = phyX;
+      break;
+    case GfxRenderer::LandscapeClockwise:
+      *x = HalDisplay::DISPLAY_WIDTH - 1 - phyX;
+      *y = HalDisplay::DISPLAY_HEIGHT - 1 - phyY;
+      break;
+    case GfxRenderer::PortraitInverted:
+      *x = phyY;
+      *y = HalDisplay::DISPLAY_WIDTH - 1 - phyX;
+      break;
+    case GfxRenderer::LandscapeCounterClockwise:
+      *x = phyX;
+      *y = phyY;
+      break;
+  }
+}
+
 enum class TextRotation { None, Rotated90CW };
 
 // Shared glyph rendering logic for normal and rotated text.
-// Coordinate mapping and cursor advance direction are selected at compile time via the template parameter.
-template <TextRotation rotation>
-static void renderCharImpl(const GfxRenderer& renderer, GfxRenderer::RenderMode renderMode,
-                           const EpdFontFamily& fontFamily, const uint32_t cp, int* cursorX, int* cursorY,
-                           const bool pixelState, const EpdFontFamily::Style style) {
+// Coordinate mapping, cursor advance direction and the render mode are selected at compile time via the template
+// parameters. Pixels are handed to `plot(x, y, state)`, which draws them to the frame buffer or composes a word run
+// mask.
+template <TextRotation rotation, GfxRenderer::RenderMode renderMode, typename PlotPixel>
+static void renderCharImpl(const GfxRenderer& renderer, const EpdFontFamily& fontFamily, const uint32_t cp,
+                           int* cursorX, int* cursorY, const bool pixelState, const EpdFontFamily::Style style,
+                           PlotPixel&& plot) {
   const EpdGlyph* glyph = fontFamily.getGlyph(cp, style);
   if (!glyph) {
     glyph = fontFamily.getGlyph(REPLACEMENT_GLYPH, style);
@@ -119,16 +148,9 @@ static void renderCharImpl(const GfxRenderer& renderer, GfxRenderer::RenderMode
           // 0 -> black, 1 -> dark grey, 2 -> light grey, 3 -> white
           const uint8_t bmpVal = 3 - ((byte >> bit_index) & 0x3);
 
-          if (renderMode == GfxRenderer::BW && bmpVal < 3) {
-            // Black (also paints over the grays in BW mode)
-            renderer.drawPixel(screenX, screenY, pixelState);
-          } else if (renderMode == GfxRenderer::GRAYSCALE_MSB && (bmpVal == 1 || bmpVal == 2)) {
-            // Light gray (also mark the MSB if it's going to be a dark gray too)
-            // We have to flag pixels in reverse for the gray buffers, as 0 leave alone, 1 update
-            renderer.drawPixel(screenX, screenY, false);
-          } else if (renderMode == GfxRenderer::GRAYSCALE_LSB && bmpVal == 1) {
-            // Dark gray
-            renderer.drawPixel(screenX, screenY, false);
+          // BW paints the grays black too; the MSB pass marks light and dark gray, the LSB pass dark gray only
+          if (GfxRenderer::drawsGrayLevel<renderMode>(bmpVal)) {
+            plot(screenX, screenY, renderMode == GfxRenderer::BW ? pixelState : false);
           }
         }
       }
@@ -150,7 +172,7 @@ static void renderCharImpl(const GfxRenderer& renderer, GfxRenderer::RenderMode
           const uint8_t bit_index = 7 - (pixelPosition & 7);
 
           if ((byte >> bit_index) & 1) {
-            renderer.drawPixel(screenX, screenY, pixelState);
+            plot(screenX, screenY, pixelState);
           }
         }
       }
@@ -167,6 +189,21 @@ static void renderCharImpl(const GfxRenderer& renderer, GfxRenderer::RenderMode
 // IMPORTANT: This function is in critical rendering path and is called for every pixel. Please keep it as simple and
 // efficient as possible.
 void GfxRenderer::drawPixel(const int x, const int y, const bool state) const {
+  if (usesLogicalBuffer()) {
+    if (x < 0 || x >= logicalRowBytes * 8 || y < 0 || y >= logicalHeight) {
+      LOG_ERR("GFX", "!! Outside range (%d, %d)", x, y);
+      return;
+    }
+    markDirty(x, y, x, y);
+    uint8_t* byte = logicalRows[y] + (x >> 3);
+    if (state) {
+      *byte &= ~(0x80 >> (x & 7));  // Clear bit
+    } else {
+      *byte |= 0x80 >> (x & 7);  // Set bit
+    }
+    return;
+  }
+
   int phyX = 0;
   int phyY = 0;
 
@@ -178,6 +215,7 @@ void GfxRenderer::drawPixel(const int x, const int y, const bool state) const {
     LOG_ERR("GFX", "!! Outside range (%d, %d) -> (%d, %d)", x, y, phyX, phyY);
     return;
   }
+  markDirty(x, y, x, y);
 
   // Calculate byte position and bit position
   const uint16_t byteIndex = phyY * HalDisplay::DISPLAY_WIDTH_BYTES + (phyX / 8);
@@ -225,10 +263,96 @@ void GfxRenderer::drawText(const int fontId, const int x, const int y, const cha
   }
   const auto& font = fontIt->second;
 
-  uint32_t cp;
-  while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
-    renderChar(font, cp, &xpos, &yPos, black, style);
+  if (wordRunCache && drawCachedRun(font, xpos, yPos, text, black, style)) {
+    return;
   }
+
+  withRenderMode([&]<RenderMode mode>() {
+    uint32_t span[UTF8_SPAN_MAX];
+    size_t count;
+    while ((count = utf8NextCodepoints(reinterpret_cast<const uint8_t**>(&text), span, UTF8_SPAN_MAX))) {
+      for (size_t i = 0; i < count; i++) {
+        renderCharImpl<TextRotation::None, mode>(*this, font, span[i], &xpos, &yPos, black, style,
+                                                 [this](int px, int py, bool state) { drawPixel(px, py, state); });
+      }
+    }
+  });
+}
+
+// Draws `text` from the word run cache, composing and inserting the run if the word is drawn often enough.
+// Returns false if the caller should draw the text glyph by glyph instead.
+bool GfxRenderer::drawCachedRun(const EpdFontFamily& font, const int x, const int baselineY, const char* text,
+                                const bool black, const EpdFontFamily::Style style) const {
+  const size_t length = strlen(text);
+  if (length > WordRunCache::MAX_TEXT_BYTES) {
+    return false;
+  }
+
+  const EpdFontData* fontData = font.getData(style);
+  // Gray passes of 2-bit fonts flag their pixels in reverse, see renderCharImpl
+  const bool state = (fontData->is2Bit && renderMode != BW) ? false : black;
+
+  WordRunCache::Run run;
+  if (!wordRunCache->find(fontData, renderMode, text, length, &run)) {
+    if (!wordRunCache->admit(fontData, renderMode, text, length)) {
+      return false;
+    }
+
+    // Bounding box of all glyphs relative to the pen position on the baseline
+    int minX = INT32_MAX, minY = INT32_MAX, maxX = INT32_MIN, maxY = INT32_MIN;
+    int penX = 0;
+    const char* p = text;
+    uint32_t span[UTF8_SPAN_MAX];
+    size_t count;
+    while ((count = utf8NextCodepoints(reinterpret_cast<const uint8_t**>(&p), span, UTF8_SPAN_MAX))) {
+      for (size_t i = 0; i < count; i++) {
+        const EpdGlyph* glyph = font.getGlyph(span[i], style);
+        if (!glyph) glyph = font.getGlyph(REPLACEMENT_GLYPH, style);
+        if (!glyph) continue;
+        if (glyph->width > 0 && glyph->height > 0) {
+          minX = std::min(minX, penX + glyph->left);
+          maxX = std::max(maxX, penX + glyph->left + glyph->width);
+          minY = std::min(minY, -glyph->top);
+          maxY = std::max(maxY, -glyph->top + glyph->height);
+        }
+        penX += glyph->advanceX;
+      }
+    }
+    if (minX >= maxX || minY >= maxY) {
+      return false;
+    }
+
+    const uint16_t width = maxX - minX;
+    const uint16_t height = maxY - minY;
+    const int rowBytes = (width + 7) / 8;
+    uint8_t* mask = wordRunCache->insert(fontData, renderMode, text, length, minX, minY, width, height);
+    if (!mask) {
+      return false;
+    }
+
+    int cursorX = -minX;
+    int cursorY = -minY;
+    p = text;
+    withRenderMode([&]<RenderMode mode>() {
+      while ((count = utf8NextCodepoints(reinterpret_cast<const uint8_t**>(&p), span, UTF8_SPAN_MAX))) {
+        for (size_t i = 0; i < count; i++) {
+          renderCharImpl<TextRotation::None, mode>(*this, font, span[i], &cursorX, &cursorY, black, style,
+                                                   [mask, rowBytes](int px, int py, bool) {
+                                                     mask[py * rowBytes + (px >> 3)] |= 0x80 >> (px & 7);
+                                                   });
+        }
+      }
+    });
+
+    run = {static_cast<int16_t>(minX), static_cast<int16_t>(minY), width, height, mask};
+  }
+
+  const int rowBytes = (run.width + 7) / 8;
+  const uint8_t* row = run.bits;
+  for (int runY = 0; runY < run.height; runY++, row += rowBytes) {
+    drawMaskRow(x + run.offsetX, baselineY + run.offsetY + runY, row, run.width, state);
+  }
+  return true;
 }
 
 void GfxRenderer::drawLine(int x1, int y1, int x2, int y2, const bool state) const {
@@ -236,16 +360,12 @@ void GfxRenderer::drawLine(int x1, int y1, int x2, int y2, const bool state) con
     if (y2 < y1) {
       std::swap(y1, y2);
     }
-    for (int y = y1; y <= y2; y++) {
-      drawPixel(x1, y, state);
-    }
+    fillRect(x1, y1, 1, y2 - y1 + 1, state);
   } else if (y1 == y2) {
     if (x2 < x1) {
       std::swap(x1, x2);
     }
-    for (int x = x1; x <= x2; x++) {
-      drawPixel(x, y1, state);
-    }
+    fillRect(x1, y1, x2 - x1 + 1, 1, state);
   } else {
     // Bresenham's line algorithm — integer arithmetic only
     int dx = x2 - x1;
@@ -296,23 +416,39 @@ void GfxRenderer::drawRect(const int x, const int y, const int width, const int
   }
 }
 
+namespace {
+// Quarter-circle span table: row dy covers dx = 0..spans[dy], the largest dx with dx * dx + dy * dy <= radiusSq, or
+// -1 once the row misses the circle. Built once per corner radius so corners are filled row by row instead of testing
+// every pixel against the radius. Small radii (all the themes use) stay on the stack.
+class ArcSpans {
+ public:
+  ArcSpans(const int radiusSq, const int rows) {
+    spans = rows <= INLINE_ROWS ? inlineSpans : (heapSpans.resize(rows), heapSpans.data());
+    int dx = 0;
+    while ((dx + 1) * (dx + 1) <= radiusSq) dx++;
+    for (int dy = 0; dy < rows; dy++) {
+      while (dx >= 0 && dx * dx + dy * dy > radiusSq) dx--;
+      spans[dy] = static_cast<int16_t>(dx);
+    }
+  }
+  const int16_t* data() const { return spans; }
+
+ private:
+  static constexpr int INLINE_ROWS = 64;
+  int16_t inlineSpans[INLINE_ROWS];
+  std::vector<int16_t> heapSpans;
+  int16_t* spans;
+};
+}  // namespace
+
 void GfxRenderer::drawArc(const int maxRadius, const int cx, const int cy, const int xDir, const int yDir,
                           const int lineWidth, const bool state) const {
   const int stroke = std::min(lineWidth, maxRadius);
   const int innerRadius = std::max(maxRadius - stroke, 0);
-  const int outerRadiusSq = maxRadius * maxRadius;
-  const int innerRadiusSq = innerRadius * innerRadius;
-  for (int dy = 0; dy <= maxRadius; ++dy) {
-    for (int dx = 0; dx <= maxRadius; ++dx) {
-      const int distSq = dx * dx + dy * dy;
-      if (distSq > outerRadiusSq || distSq < innerRadiusSq) {
-        continue;
-      }
-      const int px = cx + xDir * dx;
-      const int py = cy + yDir * dy;
-      drawPixel(px, py, state);
-    }
-  }
+  const ArcSpans outer(maxRadius * maxRadius, maxRadius + 1);
+  // Pixels closer than the inner radius are skipped: those are the ones within (innerRadius^2 - 1)
+  const ArcSpans inner(innerRadius > 0 ? innerRadius * innerRadius - 1 : -1, maxRadius + 1);
+  fillArcSpans(outer.data(), inner.data(), maxRadius, cx, cy, xDir, yDir, state ? Color::Black : Color::White);
 };
 
 // Border is inside the rectangle, rounded corners
@@ -359,86 +495,165 @@ void GfxRenderer::drawRoundedRect(const int x, const int y, const int width, con
     }
   }
 
+  // All four corners share one pair of span tables
+  const int innerRadius = maxRadius - stroke;
+  const ArcSpans outer(maxRadius * maxRadius, maxRadius + 1);
+  const ArcSpans inner(innerRadius > 0 ? innerRadius * innerRadius - 1 : -1, maxRadius + 1);
+  const Color color = state ? Color::Black : Color::White;
   if (roundTopLeft) {
-    drawArc(maxRadius, x + maxRadius, y + maxRadius, -1, -1, lineWidth, state);
+    fillArcSpans(outer.data(), inner.data(), maxRadius, x + maxRadius, y + maxRadius, -1, -1, color);
   }
   if (roundTopRight) {
-    drawArc(maxRadius, right - maxRadius, y + maxRadius, 1, -1, lineWidth, state);
+    fillArcSpans(outer.data(), inner.data(), maxRadius, right - maxRadius, y + maxRadius, 1, -1, color);
   }
   if (roundBottomRight) {
-    drawArc(maxRadius, right - maxRadius, bottom - maxRadius, 1, 1, lineWidth, state);
+    fillArcSpans(outer.data(), inner.data(), maxRadius, right - maxRadius, bottom - maxRadius, 1, 1, color);
   }
   if (roundBottomLeft) {
-    drawArc(maxRadius, x + maxRadius, bottom - maxRadius, -1, 1, lineWidth, state);
+    fillArcSpans(outer.data(), inner.data(), maxRadius, x + maxRadius, bottom - maxRadius, -1, 1, color);
   }
 }
 
 void GfxRenderer::fillRect(const int x, const int y, const int width, const int height, const bool state) const {
-  for (int fillY = y; fillY < y + height; fillY++) {
-    drawLine(x, fillY, x + width - 1, fillY, state);
-  }
+  fillPatternRect(x, y, width, height, state ? Color::Black : Color::White);
 }
 
-// NOTE: Those are in critical path, and need to be templated to avoid runtime checks for every pixel.
-// Any branching must be done outside the loops to avoid performance degradation.
-template <>
-void GfxRenderer::drawPixelDither<Color::Clear>(const int x, const int y) const {
-  // Do nothing
+// 8-pixel dither pattern for a logical row, starting at an even x. Set bits are white like in the frame buffer, so a
+// pattern byte is stored as is. LightGray is black where x and y are both even, DarkGray is black where x + y is even.
+static inline uint8_t ditherPattern(const Color color, const int y) {
+  switch (color) {
+    case Color::Black:
+      return 0x00;
+    case Color::LightGray:
+      return (y & 1) ? 0xFF : 0x55;
+    case Color::DarkGray:
+      return (y & 1) ? 0xAA : 0x55;
+    default:
+      return 0xFF;
+  }
 }
 
-template <>
-void GfxRenderer::drawPixelDither<Color::Black>(const int x, const int y) const {
-  drawPixel(x, y, true);
+// Dither pattern for a panel row in a rotated orientation. Both patterns repeat every 2 pixels along either axis, so
+// the first 8 pixels of the row describe all of it.
+static uint8_t panelDitherPattern(const GfxRenderer::Orientation orientation, const Color color, const int phyY) {
+  uint8_t pattern = 0;
+  for (int phyX = 0; phyX < 8; phyX++) {
+    int x = 0;
+    int y = 0;
+    unrotateCoordinates(orientation, phyX, phyY, &x, &y);
+    pattern |= ((ditherPattern(color, y) >> (7 - (x & 7))) & 1) << (7 - phyX);
+  }
+  return pattern;
 }
 
-template <>
-void GfxRenderer::drawPixelDither<Color::White>(const int x, const int y) const {
-  drawPixel(x, y, false);
+// Write pixels x0..x1 of a packed row: partial bytes at either end are merged through edge masks and the whole bytes in
+// between are a single memset
+static inline void fillRowSpan(uint8_t* row, const int x0, const int x1, const uint8_t pattern) {
+  const int firstByte = x0 >> 3;
+  const int lastByte = x1 >> 3;
+  const uint8_t firstMask = 0xFF >> (x0 & 7);
+  const auto lastMask = static_cast<uint8_t>(0xFF << (7 - (x1 & 7)));
+  if (firstByte == lastByte) {
+    const uint8_t mask = firstMask & lastMask;
+    row[firstByte] = (row[firstByte] & ~mask) | (pattern & mask);
+    return;
+  }
+  row[firstByte] = (row[firstByte] & ~firstMask) | (pattern & firstMask);
+  memset(row + firstByte + 1, pattern, lastByte - firstByte - 1);
+  row[lastByte] = (row[lastByte] & ~lastMask) | (pattern & lastMask);
 }
 
-template <>
-void GfxRenderer::drawPixelDither<Color::LightGray>(const int x, const int y) const {
-  drawPixel(x, y, x % 2 == 0 && y % 2 == 0);
+// Merge the mask bits landing on pixels x0..x1 of a packed row, where mask bit 0 lands on pixel x. Each destination
+// byte takes 8 mask bits at once; bits before the mask or past its last byte read as clear.
+static inline void blitMaskSpan(uint8_t* row, const int x, const int x0, const int x1, const uint8_t* mask,
+                                const int maskBytes, const bool state) {
+  const int firstByte = x0 >> 3;
+  const int lastByte = x1 >> 3;
+  for (int byte = firstByte; byte <= lastByte; byte++) {
+    const int bitOffset = byte * 8 - x;  // Mask bit drawn at the first pixel of this byte
+    const int maskByte = bitOffset >> 3;
+    const uint8_t hi = maskByte >= 0 && maskByte < maskBytes ? mask[maskByte] : 0;
+    const uint8_t lo = maskByte + 1 >= 0 && maskByte + 1 < maskBytes ? mask[maskByte + 1] : 0;
+    auto bits = static_cast<uint8_t>(((hi << 8 | lo) << (bitOffset & 7)) >> 8);
+    if (byte == firstByte) bits &= 0xFF >> (x0 & 7);
+    if (byte == lastByte) bits &= static_cast<uint8_t>(0xFF << (7 - (x1 & 7)));
+    if (state) {
+      row[byte] &= ~bits;  // Black
+    } else {
+      row[byte] |= bits;  // White
+    }
+  }
 }
 
-template <>
-void GfxRenderer::drawPixelDither<Color::DarkGray>(const int x, const int y) const {
-  drawPixel(x, y, (x + y) % 2 == 0);  // TODO: maybe find a better pattern?
-}
+void GfxRenderer::drawMaskRow(const int x, const int y, const uint8_t* mask, const int width,
+                              const bool state) const {
+  const int x0 = std::max(x, 0);
+  const int x1 = std::min(x + width, getScreenWidth()) - 1;
+  if (y < 0 || y >= getScreenHeight() || x1 < x0) {
+    return;
+  }
 
-void GfxRenderer::fillRectDither(const int x, const int y, const int width, const int height, Color color) const {
-  if (color == Color::Clear) {
-  } else if (color == Color::Black) {
-    fillRect(x, y, width, height, true);
-  } else if (color == Color::White) {
-    fillRect(x, y, width, height, false);
-  } else if (color == Color::LightGray) {
-    for (int fillY = y; fillY < y + height; fillY++) {
-      for (int fillX = x; fillX < x + width; fillX++) {
-        drawPixelDither<Color::LightGray>(fillX, fillY);
-      }
+  uint8_t* row = nullptr;
+  if (usesLogicalBuffer()) {
+    row = logicalRows[y];
+  } else if (orientation == LandscapeCounterClockwise) {
+    row = frameBuffer + y * HalDisplay::DISPLAY_WIDTH_BYTES;
+  } else {
+    // Rotated panel rows run across the image; plot the set bits one by one
+    for (int col = x0; col <= x1; col++) {
+      if (mask[(col - x) >> 3] & (0x80 >> ((col - x) & 7))) drawPixel(col, y, state);
     }
-  } else if (color == Color::DarkGray) {
-    for (int fillY = y; fillY < y + height; fillY++) {
-      for (int fillX = x; fillX < x + width; fillX++) {
-        drawPixelDither<Color::DarkGray>(fillX, fillY);
-      }
+    return;
+  }
+  markDirty(x0, y, x1, y);
+  blitMaskSpan(row, x, x0, x1, mask, (width + 7) / 8, state);
+}
+
+void GfxRenderer::fillPatternRect(const int x, const int y, const int width, const int height,
+                                  const Color color) const {
+  // Clip to the logical screen; drawPixel drops pixels outside of it as well
+  const int x0 = std::max(x, 0);
+  const int y0 = std::max(y, 0);
+  const int x1 = std::min(x + width, getScreenWidth()) - 1;
+  const int y1 = std::min(y + height, getScreenHeight()) - 1;
+  if (color == Color::Clear || x1 < x0 || y1 < y0) {
+    return;
+  }
+  markDirty(x0, y0, x1, y1);
+
+  if (usesLogicalBuffer()) {
+    for (int row = y0; row <= y1; row++) {
+      fillRowSpan(logicalRows[row], x0, x1, ditherPattern(color, row));
     }
+    return;
+  }
+
+  // Rotation maps the rectangle onto a panel rectangle, which is filled in panel rows
+  int ax = 0, ay = 0, bx = 0, by = 0;
+  rotateCoordinates(orientation, x0, y0, &ax, &ay);
+  rotateCoordinates(orientation, x1, y1, &bx, &by);
+  const bool solid = color == Color::Black || color == Color::White;
+  for (int phyY = std::min(ay, by); phyY <= std::max(ay, by); phyY++) {
+    const uint8_t pattern = solid ? ditherPattern(color, 0) : panelDitherPattern(orientation, color, phyY);
+    fillRowSpan(frameBuffer + phyY * HalDisplay::DISPLAY_WIDTH_BYTES, std::min(ax, bx), std::max(ax, bx), pattern);
   }
 }
 
-template <Color color>
-void GfxRenderer::fillArc(const int maxRadius, const int cx, const int cy, const int xDir, const int yDir) const {
-  const int radiusSq = maxRadius * maxRadius;
+void GfxRenderer::fillRectDither(const int x, const int y, const int width, const int height, Color color) const {
+  fillPatternRect(x, y, width, height, color);
+}
+
+// Fills one corner row by row: row dy spans dx = innerSpans[dy] + 1 .. outerSpans[dy] (all of it without innerSpans)
+void GfxRenderer::fillArcSpans(const int16_t* outerSpans, const int16_t* innerSpans, const int maxRadius, const int cx,
+                               const int cy, const int xDir, const int yDir, const Color color) const {
   for (int dy = 0; dy <= maxRadius; ++dy) {
-    for (int dx = 0; dx <= maxRadius; ++dx) {
-      const int distSq = dx * dx + dy * dy;
-      const int px = cx + xDir * dx;
-      const int py = cy + yDir * dy;
-      if (distSq <= radiusSq) {
-        drawPixelDither<color>(px, py);
-      }
+    const int hi = outerSpans[dy];
+    const int lo = innerSpans ? innerSpans[dy] + 1 : 0;
+    if (hi < lo) {
+      continue;
     }
+    const int left = xDir < 0 ? cx - hi : cx + lo;
+    fillPatternRect(left, cy + yDir * dy, hi - lo + 1, 1, color);
   }
 }
 
@@ -479,39 +694,25 @@ void GfxRenderer::fillRoundedRect(const int x, const int y, const int width, con
     fillRectDither(x + width - maxRadius - 1, rightFillTop, maxRadius + 1, rightFillBottom - rightFillTop + 1, color);
   }
 
-  auto fillArcTemplated = [this](int maxRadius, int cx, int cy, int xDir, int yDir, Color color) {
-    switch (color) {
-      case Color::Clear:
-        break;
-      case Color::Black:
-        fillArc<Color::Black>(maxRadius, cx, cy, xDir, yDir);
-        break;
-      case Color::White:
-        fillArc<Color::White>(maxRadius, cx, cy, xDir, yDir);
-        break;
-      case Color::LightGray:
-        fillArc<Color::LightGray>(maxRadius, cx, cy, xDir, yDir);
-        break;
-      case Color::DarkGray:
-        fillArc<Color::DarkGray>(maxRadius, cx, cy, xDir, yDir);
-        break;
-    }
-  };
+  if (color == Color::Clear) {
+    return;
+  }
+  const ArcSpans spans(maxRadius * maxRadius, maxRadius + 1);
 
   if (roundTopLeft) {
-    fillArcTemplated(maxRadius, x + maxRadius, y + maxRadius, -1, -1, color);
+    fillArcSpans(spans.data(), nullptr, maxRadius, x + maxRadius, y + maxRadius, -1, -1, color);
   }
 
   if (roundTopRight) {
-    fillArcTemplated(maxRadius, x + width - maxRadius - 1, y + maxRadius, 1, -1, color);
+    fillArcSpans(spans.data(), nullptr, maxRadius, x + width - maxRadius - 1, y + maxRadius, 1, -1, color);
   }
 
   if (roundBottomRight) {
-    fillArcTemplated(maxRadius, x + width - maxRadius - 1, y + height - maxRadius - 1, 1, 1, color);
+    fillArcSpans(spans.data(), nullptr, maxRadius, x + width - maxRadius - 1, y + height - maxRadius - 1, 1, 1, color);
   }
 
   if (roundBottomLeft) {
-    fillArcTemplated(maxRadius, x + maxRadius, y + height - maxRadius - 1, -1, 1, color);
+    fillArcSpans(spans.data(), nullptr, maxRadius, x + maxRadius, y + height - maxRadius - 1, -1, 1, color);
   }
 }
 
@@ -535,13 +736,58 @@ void GfxRenderer::drawImage(const uint8_t bitmap[], const int x, const int y, co
       break;
   }
   // TODO: Rotate bits
+  markPanelRectDirty(rotatedX, rotatedY, width, height);
+  if (usesLogicalBuffer()) {
+    blitPanelImageLogical(bitmap, rotatedX, rotatedY, width, height, false);
+    return;
+  }
   display.drawImage(bitmap, rotatedX, rotatedY, width, height);
 }
 
 void GfxRenderer::drawIcon(const uint8_t bitmap[], const int x, const int y, const int width, const int height) const {
+  markPanelRectDirty(y, getScreenWidth() - width - x, height, width);
+  if (usesLogicalBuffer()) {
+    blitPanelImageLogical(bitmap, y, getScreenWidth() - width - x, height, width, true);
+    return;
+  }
   display.drawImageTransparent(bitmap, y, getScreenWidth() - width - x, height, width);
 }
 
+// The display driver blits images in panel space: byte aligned rows of width / 8 bytes, copied over the frame buffer
+// or, when transparent, only their black (clear) bits. This does the same through the logical buffer, one image pixel
+// at a time, so a small blit does not round-trip the whole buffer through the panel frame buffer.
+void GfxRenderer::blitPanelImageLogical(const uint8_t* bitmap, const int phyX, const int phyY, const int width,
+                                        const int height, const bool transparent) const {
+  const int rowBytes = width / 8;
+  const int firstX = (phyX / 8) * 8;
+  for (int row = 0; row < height; row++) {
+    const int panelY = phyY + row;
+    if (panelY < 0 || panelY >= HalDisplay::DISPLAY_HEIGHT) {
+      continue;
+    }
+    const uint8_t* src = bitmap + row * rowBytes;
+    for (int col = 0; col < rowBytes * 8; col++) {
+      const int panelX = firstX + col;
+      if (panelX < 0 || panelX >= HalDisplay::DISPLAY_WIDTH) {
+        continue;
+      }
+      const bool white = src[col >> 3] & (0x80 >> (col & 7));
+      if (transparent && white) {
+        continue;
+      }
+      int x = 0;
+      int y = 0;
+      unrotateCoordinates(orientation, panelX, panelY, &x, &y);
+      uint8_t* byte = logicalRows[y] + (x >> 3);
+      if (white) {
+        *byte |= 0x80 >> (x & 7);
+      } else {
+        *byte &= ~(0x80 >> (x & 7));
+      }
+    }
+  }
+}
+
 void GfxRenderer::drawBitmap(const Bitmap& bitmap, const int x, const int y, const int maxWidth, const int maxHeight,
                              const float cropX, const float cropY) const {
   // For 1-bit bitmaps, use optimized 1-bit rendering path (no crop support for 1-bit)
@@ -580,58 +826,54 @@ void GfxRenderer::drawBitmap(const Bitmap& bitmap, const int x, const int y, con
     return;
   }
 
-  for (int bmpY = 0; bmpY < (bitmap.getHeight() - cropPixY); bmpY++) {
-    // The BMP's (0, 0) is the bottom-left corner (if the height is positive, top-left if negative).
-    // Screen's (0, 0) is the top-left corner.
-    int screenY = -cropPixY + (bitmap.isTopDown() ? bmpY : bitmap.getHeight() - 1 - bmpY);
-    if (isScaled) {
-      screenY = std::floor(screenY * scale);
-    }
-    screenY += y;  // the offset should not be scaled
-    if (screenY >= getScreenHeight()) {
-      break;
-    }
-
-    if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
-      LOG_ERR("GFX", "Failed to read row %d from bitmap", bmpY);
-      free(outputRow);
-      free(rowBytes);
-      return;
-    }
-
-    if (screenY < 0) {
-      continue;
-    }
-
-    if (bmpY < cropPixY) {
-      // Skip the row if it's outside the crop area
-      continue;
-    }
-
-    for (int bmpX = cropPixX; bmpX < bitmap.getWidth() - cropPixX; bmpX++) {
-      int screenX = bmpX - cropPixX;
+  withRenderMode([&]<RenderMode mode>() {
+    for (int bmpY = 0; bmpY < (bitmap.getHeight() - cropPixY); bmpY++) {
+      // The BMP's (0, 0) is the bottom-left corner (if the height is positive, top-left if negative).
+      // Screen's (0, 0) is the top-left corner.
+      int screenY = -cropPixY + (bitmap.isTopDown() ? bmpY : bitmap.getHeight() - 1 - bmpY);
       if (isScaled) {
-        screenX = std::floor(screenX * scale);
+        screenY = std::floor(screenY * scale);
       }
-      screenX += x;  // the offset should not be scaled
-      if (screenX >= getScreenWidth()) {
+      screenY += y;  // the offset should not be scaled
+      if (screenY >= getScreenHeight()) {
         break;
       }
-      if (screenX < 0) {
+
+      if (bitmap.readNextRow(outputRow, rowBytes) != BmpReaderError::Ok) {
+        LOG_ERR("GFX", "Failed to read row %d from bitmap", bmpY);
+        return;
+      }
+
+      if (screenY < 0) {
         continue;
       }
 
-      const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
+      if (bmpY < cropPixY) {
+        // Skip the row if it's outside the crop area
+        continue;
+      }
 
-      if (renderMode == BW && val < 3) {
-        drawPixel(screenX, screenY);
-      } else if (renderMode == GRAYSCALE_MSB && (val == 1 || val == 2)) {
-        drawPixel(screenX, screenY, false);
-      } else if (renderMode == GRAYSCALE_LSB && val == 1) {
-        drawPixel(screenX, screenY, false);
+      for (int bmpX = cropPixX; bmpX < bitmap.getWidth() - cropPixX; bmpX++) {
+        int screenX = bmpX - cropPixX;
+        if (isScaled) {
+          screenX = std::floor(screenX * scale);
+        }
+        screenX += x;  // the offset should not be scaled
+        if (screenX >= getScreenWidth()) {
+          break;
+        }
+        if (screenX < 0) {
+          continue;
+        }
+
+        const uint8_t val = outputRow[bmpX / 4] >> (6 - ((bmpX * 2) % 8)) & 0x3;
+
+        if (drawsGrayLevel<mode>(val)) {
+          drawPixel(screenX, screenY, mode == BW);
+        }
       }
     }
-  }
+  });
 
   free(outputRow);
   free(rowBytes);
@@ -765,9 +1007,7 @@ void GfxRenderer::fillPolygon(const int* xPoints, const int* yPoints, int numPoi
       if (endX >= getScreenWidth()) endX = getScreenWidth() - 1;
 
       // Draw horizontal line
-      for (int x = startX; x <= endX; x++) {
-        drawPixel(x, scanY, state);
-      }
+      fillRect(startX, scanY, endX - startX + 1, 1, state);
     }
   }
 
@@ -780,18 +1020,133 @@ static unsigned long start_ms = 0;
 void GfxRenderer::clearScreen(const uint8_t color) const {
   start_ms = millis();
   display.clearScreen(color);
+  markAllDirty();
+  if (usesLogicalBuffer()) {
+    // Only uniform colors (0x00 / 0xFF) survive the transpose unchanged, which is all callers use
+    for (auto* chunk : logicalBufferChunks) {
+      memset(chunk, color, LOGICAL_BUFFER_CHUNK_SIZE);
+    }
+  }
 }
 
 void GfxRenderer::invertScreen() const {
-  for (int i = 0; i < HalDisplay::BUFFER_SIZE; i++) {
+  markAllDirty();
+  if (usesLogicalBuffer()) {
+    for (auto* chunk : logicalBufferChunks) {
+      for (size_t i = 0; i < LOGICAL_BUFFER_CHUNK_SIZE; i++) {
+        chunk[i] = ~chunk[i];
+      }
+    }
+    return;
+  }
+  for (uint32_t i = 0; i < HalDisplay::BUFFER_SIZE; i++) {
     frameBuffer[i] = ~frameBuffer[i];
   }
 }
 
 void GfxRenderer::displayBuffer(const HalDisplay::RefreshMode refreshMode) const {
-  auto elapsed = millis() - start_ms;
-  LOG_DBG("GFX", "Time = %lu ms from clearScreen to displayBuffer", elapsed);
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  LOG_DBG("GFX", "Time = %lu ms from clearScreen to displayBuffer", millis() - start_ms);
   display.displayBuffer(refreshMode, fadingFix);
+  if (refreshPlanner) refreshPlanner->record(frameBuffer, refreshMode);
+  clearDirty();
+}
+
+void GfxRenderer::displayAutoRefresh(const int halfRefreshEvery) const {
+  if (!refreshPlanner) {
+    displayBuffer(halfRefreshEvery <= 1 ? HalDisplay::HALF_REFRESH : HalDisplay::FAST_REFRESH);
+    return;
+  }
+
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  applyRefreshDecision(refreshPlanner->plan(frameBuffer, halfRefreshEvery));
+}
+
+// Carries out a RefreshPlanner decision on the (already flushed) panel frame buffer
+void GfxRenderer::applyRefreshDecision(const RefreshPlanner::Decision& decision) const {
+  switch (decision.action) {
+    case RefreshPlanner::SKIP:
+      break;
+    case RefreshPlanner::WINDOW:
+      display.displayWindow(decision.x, decision.y, decision.width, decision.height, fadingFix);
+      break;
+    case RefreshPlanner::FAST:
+      display.displayBuffer(HalDisplay::FAST_REFRESH, fadingFix);
+      break;
+    case RefreshPlanner::HALF:
+      display.displayBuffer(HalDisplay::HALF_REFRESH, fadingFix);
+      break;
+  }
+  clearDirty();
+}
+
+void GfxRenderer::displayWindow(const int x, const int y, const int width, const int height) const {
+  const int x0 = std::max(x, 0);
+  const int y0 = std::max(y, 0);
+  const int x1 = std::min(x + width, getScreenWidth()) - 1;
+  const int y1 = std::min(y + height, getScreenHeight()) - 1;
+  if (x1 < x0 || y1 < y0) {
+    return;
+  }
+
+  int ax = 0, ay = 0, bx = 0, by = 0;
+  rotateCoordinates(orientation, x0, y0, &ax, &ay);
+  rotateCoordinates(orientation, x1, y1, &bx, &by);
+  // The controller takes whole bytes along panel rows
+  const int phyX = std::min(ax, bx) & ~7;
+  const int phyY = std::min(ay, by);
+  const int phyWidth = (std::max(ax, bx) | 7) + 1 - phyX;
+  const int phyHeight = std::max(ay, by) + 1 - phyY;
+
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  LOG_DBG("GFX", "Window update: (%d, %d) %dx%d -> panel (%d, %d) %dx%d", x0, y0, x1 - x0 + 1, y1 - y0 + 1, phyX, phyY,
+          phyWidth, phyHeight);
+  display.displayWindow(phyX, phyY, phyWidth, phyHeight, fadingFix);
+  // Everything drawn is expected to lie inside the window, so the panel now shows the whole frame
+  if (refreshPlanner) refreshPlanner->record(frameBuffer, HalDisplay::FAST_REFRESH);
+  clearDirty();
+}
+
+void GfxRenderer::displayDirtyRegion() const {
+  int x, y, width, height;
+  if (!getDirtyRect(&x, &y, &width, &height)) {
+    return;
+  }
+  // A window only pays off while it is a small part of the screen
+  if (width * height * 2 <= getScreenWidth() * getScreenHeight()) {
+    displayWindow(x, y, width, height);
+    return;
+  }
+  if (!refreshPlanner) {
+    displayBuffer(HalDisplay::FAST_REFRESH);
+    return;
+  }
+  // A screen redrawn from scratch often changes a few rows only, e.g. a moved list selection
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  applyRefreshDecision(refreshPlanner->planFast(frameBuffer));
+}
+
+bool GfxRenderer::getDirtyRect(int* x, int* y, int* width, int* height) const {
+  const int x0 = std::max(dirtyMinX, 0);
+  const int y0 = std::max(dirtyMinY, 0);
+  const int x1 = std::min(dirtyMaxX, getScreenWidth() - 1);
+  const int y1 = std::min(dirtyMaxY, getScreenHeight() - 1);
+  if (x1 < x0 || y1 < y0) {
+    return false;
+  }
+  *x = x0;
+  *y = y0;
+  *width = x1 - x0 + 1;
+  *height = y1 - y0 + 1;
+  return true;
+}
+
+// Driver blits are placed in panel coordinates; mark their footprint in logical ones
+void GfxRenderer::markPanelRectDirty(const int phyX, const int phyY, const int width, const int height) const {
+  int ax = 0, ay = 0, bx = 0, by = 0;
+  unrotateCoordinates(orientation, phyX, phyY, &ax, &ay);
+  unrotateCoordinates(orientation, phyX + width - 1, phyY + height - 1, &bx, &by);
+  markDirty(std::min(ax, bx), std::min(ay, by), std::max(ax, bx), std::max(ay, by));
 }
 
 std::string GfxRenderer::truncatedText(const int fontId, const char* text, const int maxWidth,
@@ -860,13 +1215,16 @@ int GfxRenderer::getTextAdvanceX(const int fontId, const char* text, const EpdFo
     return 0;
   }
 
-  uint32_t cp;
+  uint32_t span[UTF8_SPAN_MAX];
+  size_t count;
   int width = 0;
   const auto& font = fontIt->second;
-  while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
-    const EpdGlyph* glyph = font.getGlyph(cp, style);
-    if (!glyph) glyph = font.getGlyph(REPLACEMENT_GLYPH, style);
-    if (glyph) width += glyph->advanceX;
+  while ((count = utf8NextCodepoints(reinterpret_cast<const uint8_t**>(&text), span, UTF8_SPAN_MAX))) {
+    for (size_t i = 0; i < count; i++) {
+      const EpdGlyph* glyph = font.getGlyph(span[i], style);
+      if (!glyph) glyph = font.getGlyph(REPLACEMENT_GLYPH, style);
+      if (glyph) width += glyph->advanceX;
+    }
   }
   return width;
 }
@@ -918,96 +1276,85 @@ void GfxRenderer::drawTextRotated90CW(const int fontId, const int x, const int y
   int xPos = x;
   int yPos = y;
 
-  uint32_t cp;
-  while ((cp = utf8NextCodepoint(reinterpret_cast<const uint8_t**>(&text)))) {
-    renderCharImpl<TextRotation::Rotated90CW>(*this, renderMode, font, cp, &xPos, &yPos, black, style);
-  }
+  withRenderMode([&]<RenderMode mode>() {
+    uint32_t span[UTF8_SPAN_MAX];
+    size_t count;
+    while ((count = utf8NextCodepoints(reinterpret_cast<const uint8_t**>(&text), span, UTF8_SPAN_MAX))) {
+      for (size_t i = 0; i < count; i++) {
+        renderCharImpl<TextRotation::Rotated90CW, mode>(
+            *this, font, span[i], &xPos, &yPos, black, style,
+            [this](int px, int py, bool state) { drawPixel(px, py, state); });
+      }
+    }
+  });
 }
 
-uint8_t* GfxRenderer::getFrameBuffer() const { return frameBuffer; }
+uint8_t* GfxRenderer::getFrameBuffer() const {
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  // Callers may write to the buffer directly
+  markAllDirty();
+  return frameBuffer;
+}
 
 size_t GfxRenderer::getBufferSize() { return HalDisplay::BUFFER_SIZE; }
 
 // unused
 // void GfxRenderer::grayscaleRevert() const { display.grayscaleRevert(); }
 
-void GfxRenderer::copyGrayscaleLsbBuffers() const { display.copyGrayscaleLsbBuffers(frameBuffer); }
+void GfxRenderer::copyGrayscaleLsbBuffers() const {
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  display.copyGrayscaleLsbBuffers(frameBuffer);
+}
 
-void GfxRenderer::copyGrayscaleMsbBuffers() const { display.copyGrayscaleMsbBuffers(frameBuffer); }
+void GfxRenderer::copyGrayscaleMsbBuffers() const {
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  display.copyGrayscaleMsbBuffers(frameBuffer);
+}
 
+// The refresh planner keeps the BW frame's signature: the gray pass only adds shades on top of that frame, and
+// restoreBwBuffer puts the same frame back before the next page is drawn
 void GfxRenderer::displayGrayBuffer() const { display.displayGrayBuffer(fadingFix); }
 
-void GfxRenderer::freeBwBufferChunks() {
-  for (auto& bwBufferChunk : bwBufferChunks) {
-    if (bwBufferChunk) {
-      free(bwBufferChunk);
-      bwBufferChunk = nullptr;
-    }
-  }
-}
-
 /**
  * This should be called before grayscale buffers are populated.
  * A `restoreBwBuffer` call should always follow the grayscale render if this method was called.
- * Uses chunked allocation to avoid needing 48KB of contiguous memory.
+ * Only the non-white bytes are kept, in chunks that stay allocated for the next page (see FrameStash), so a page of
+ * text needs a fraction of the frame and no allocation happens once the stash has grown to the pages being read.
  * Returns true if buffer was stored successfully, false if allocation failed.
  */
 bool GfxRenderer::storeBwBuffer() {
-  // Allocate and copy each chunk
-  for (size_t i = 0; i < BW_BUFFER_NUM_CHUNKS; i++) {
-    // Check if any chunks are already allocated
-    if (bwBufferChunks[i]) {
-      LOG_ERR("GFX", "!! BW buffer chunk %zu already stored - this is likely a bug, freeing chunk", i);
-      free(bwBufferChunks[i]);
-      bwBufferChunks[i] = nullptr;
-    }
-
-    const size_t offset = i * BW_BUFFER_CHUNK_SIZE;
-    bwBufferChunks[i] = static_cast<uint8_t*>(malloc(BW_BUFFER_CHUNK_SIZE));
-
-    if (!bwBufferChunks[i]) {
-      LOG_ERR("GFX", "!! Failed to allocate BW buffer chunk %zu (%zu bytes)", i, BW_BUFFER_CHUNK_SIZE);
-      // Free previously allocated chunks
-      freeBwBufferChunks();
-      return false;
-    }
-
-    memcpy(bwBufferChunks[i], frameBuffer + offset, BW_BUFFER_CHUNK_SIZE);
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  if (bwStash.hasFrame()) {
+    LOG_ERR("GFX", "!! BW buffer already stored - this is likely a bug, replacing it");
   }
-
-  LOG_DBG("GFX", "Stored BW buffer in %zu chunks (%zu bytes each)", BW_BUFFER_NUM_CHUNKS, BW_BUFFER_CHUNK_SIZE);
-  return true;
+  return bwStash.store(frameBuffer);
 }
 
 /**
  * This can only be called if `storeBwBuffer` was called prior to the grayscale render.
  * It should be called to restore the BW buffer state after grayscale rendering is complete.
- * Uses chunked restoration to match chunked storage.
  */
 void GfxRenderer::restoreBwBuffer() {
-  // Check if all chunks are allocated
-  bool missingChunks = false;
-  for (const auto& bwBufferChunk : bwBufferChunks) {
-    if (!bwBufferChunk) {
-      missingChunks = true;
-      break;
-    }
-  }
-
-  if (missingChunks) {
-    freeBwBufferChunks();
+  if (!restoreFrame(bwStash)) {
     return;
   }
-
-  for (size_t i = 0; i < BW_BUFFER_NUM_CHUNKS; i++) {
-    const size_t offset = i * BW_BUFFER_CHUNK_SIZE;
-    memcpy(frameBuffer + offset, bwBufferChunks[i], BW_BUFFER_CHUNK_SIZE);
-  }
-
   display.cleanupGrayscaleBuffers(frameBuffer);
+  LOG_DBG("GFX", "Restored BW buffer from %zu stashed bytes", bwStash.getEncodedSize());
+  bwStash.clear();
+}
+
+bool GfxRenderer::storeFrame(FrameStash& stash) const {
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  return stash.store(frameBuffer);
+}
 
-  freeBwBufferChunks();
-  LOG_DBG("GFX", "Restored and freed BW buffer chunks");
+bool GfxRenderer::restoreFrame(const FrameStash& stash) const {
+  if (!stash.restore(frameBuffer)) {
+    return false;
+  }
+  if (usesLogicalBuffer()) loadLogicalBuffer();
+  markAllDirty();
+  return true;
 }
 
 /**
@@ -1015,14 +1362,202 @@ void GfxRenderer::restoreBwBuffer() {
  * Use this when BW buffer was re-rendered instead of stored/restored.
  */
 void GfxRenderer::cleanupGrayscaleWithFrameBuffer() const {
+  if (usesLogicalBuffer()) flushLogicalBuffer();
   if (frameBuffer) {
     display.cleanupGrayscaleBuffers(frameBuffer);
   }
 }
 
-void GfxRenderer::renderChar(const EpdFontFamily& fontFamily, uint32_t cp, int* x, int* y, bool pixelState,
-                             EpdFontFamily::Style style) const {
-  renderCharImpl<TextRotation::None>(*this, renderMode, fontFamily, cp, x, y, pixelState, style);
+void GfxRenderer::setOrientation(const Orientation o) {
+  if (o == orientation) {
+    return;
+  }
+  // Logical coordinates change meaning, so anything drawn so far is kept as the whole screen
+  if (dirtyMinX <= dirtyMaxX) {
+    markAllDirty();
+  }
+  if (!logicalRows) {
+    orientation = o;
+    return;
+  }
+  // Hand the content over through the panel frame buffer so switching orientation keeps what has been drawn, exactly
+  // like drawing straight to the panel does
+  if (usesLogicalBuffer()) flushLogicalBuffer();
+  orientation = o;
+  layoutLogicalRows();
+  if (usesLogicalBuffer()) loadLogicalBuffer();
+}
+
+bool GfxRenderer::setLogicalBufferEnabled(const bool enabled) {
+  if (enabled == (logicalRows != nullptr)) {
+    return true;
+  }
+
+  if (!enabled) {
+    if (usesLogicalBuffer()) flushLogicalBuffer();
+    freeLogicalBuffer();
+    LOG_DBG("GFX", "Logical buffer disabled");
+    return true;
+  }
+
+  for (auto& chunk : logicalBufferChunks) {
+    chunk = static_cast<uint8_t*>(malloc(LOGICAL_BUFFER_CHUNK_SIZE));
+    if (!chunk) {
+      LOG_ERR("GFX", "!! Failed to allocate logical buffer chunk (%zu bytes)", LOGICAL_BUFFER_CHUNK_SIZE);
+      freeLogicalBuffer();
+      return false;
+    }
+  }
+  // Portrait has the most rows (DISPLAY_WIDTH)
+  logicalRows = static_cast<uint8_t**>(malloc(HalDisplay::DISPLAY_WIDTH * sizeof(uint8_t*)));
+  if (!logicalRows) {
+    LOG_ERR("GFX", "!! Failed to allocate logical buffer row table");
+    freeLogicalBuffer();
+    return false;
+  }
+
+  layoutLogicalRows();
+  if (usesLogicalBuffer()) loadLogicalBuffer();
+  LOG_DBG("GFX", "Logical buffer enabled (%zu chunks of %zu bytes)", LOGICAL_BUFFER_NUM_CHUNKS,
+          LOGICAL_BUFFER_CHUNK_SIZE);
+  return true;
+}
+
+void GfxRenderer::freeLogicalBuffer() {
+  for (auto& chunk : logicalBufferChunks) {
+    free(chunk);
+    chunk = nullptr;
+  }
+  free(logicalRows);
+  logicalRows = nullptr;
+  logicalRowBytes = 0;
+  logicalHeight = 0;
+}
+
+void GfxRenderer::layoutLogicalRows() {
+  logicalRowBytes = getScreenWidth() / 8;
+  logicalHeight = getScreenHeight();
+  const int rowsPerChunk = LOGICAL_BUFFER_CHUNK_SIZE / logicalRowBytes;
+  for (int y = 0; y < logicalHeight; y++) {
+    logicalRows[y] = logicalBufferChunks[y / rowsPerChunk] + (y % rowsPerChunk) * logicalRowBytes;
+  }
+}
+
+// Transposes an 8x8 bit matrix held in 8 bytes (MSB = leftmost pixel): bit (7 - j) of out[i] is bit (7 - i) of in[j].
+// Hacker's Delight, figure 7-3.
+static inline void transpose8x8(const uint8_t in[8], uint8_t out[8]) {
+  uint32_t x = (in[0] << 24) | (in[1] << 16) | (in[2] << 8) | in[3];
+  uint32_t y = (in[4] << 24) | (in[5] << 16) | (in[6] << 8) | in[7];
+  uint32_t t;
+
+  t = (x ^ (x >> 7)) & 0x00AA00AA;
+  x = x ^ t ^ (t << 7);
+  t = (y ^ (y >> 7)) & 0x00AA00AA;
+  y = y ^ t ^ (t << 7);
+
+  t = (x ^ (x >> 14)) & 0x0000CCCC;
+  x = x ^ t ^ (t << 14);
+  t = (y ^ (y >> 14)) & 0x0000CCCC;
+  y = y ^ t ^ (t << 14);
+
+  t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+  y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+  x = t;
+
+  out[0] = x >> 24;
+  out[1] = x >> 16;
+  out[2] = x >> 8;
+  out[3] = x;
+  out[4] = y >> 24;
+  out[5] = y >> 16;
+  out[6] = y >> 8;
+  out[7] = y;
+}
+
+static inline uint8_t reverseBits(uint8_t b) {
+  b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+  b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+  b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
+  return b;
+}
+
+// Copies the logical buffer into the panel frame buffer. For the 90° orientations every 8x8 pixel block is one bit
+// matrix transpose: 8 logical rows of one byte column become 8 panel rows of one byte column.
+void GfxRenderer::flushLogicalBuffer() const {
+  constexpr int panelRowBytes = HalDisplay::DISPLAY_WIDTH_BYTES;
+  uint8_t in[8], out[8];
+
+  switch (orientation) {
+    case Portrait:
+      // Logical (x, y) -> panel (y, 479 - x)
+      for (int c = 0; c < panelRowBytes; c++) {
+        for (int b = 0; b < logicalRowBytes; b++) {
+          for (int i = 0; i < 8; i++) in[i] = logicalRows[8 * c + i][b];
+          transpose8x8(in, out);
+          uint8_t* dst = frameBuffer + (HalDisplay::DISPLAY_HEIGHT - 1 - 8 * b) * panelRowBytes + c;
+          for (int j = 0; j < 8; j++) dst[-j * panelRowBytes] = out[j];
+        }
+      }
+      break;
+    case PortraitInverted:
+      // Logical (x, y) -> panel (799 - y, x)
+      for (int c = 0; c < panelRowBytes; c++) {
+        for (int b = 0; b < logicalRowBytes; b++) {
+          for (int i = 0; i < 8; i++) in[i] = logicalRows[HalDisplay::DISPLAY_WIDTH - 1 - (8 * c + i)][b];
+          transpose8x8(in, out);
+          for (int j = 0; j < 8; j++) frameBuffer[(8 * b + j) * panelRowBytes + c] = out[j];
+        }
+      }
+      break;
+    case LandscapeClockwise:
+      // Logical (x, y) -> panel (799 - x, 479 - y): rows and bytes in reverse order, bits mirrored
+      for (int r = 0; r < HalDisplay::DISPLAY_HEIGHT; r++) {
+        const uint8_t* src = logicalRows[HalDisplay::DISPLAY_HEIGHT - 1 - r];
+        uint8_t* dst = frameBuffer + r * panelRowBytes;
+        for (int c = 0; c < panelRowBytes; c++) dst[c] = reverseBits(src[panelRowBytes - 1 - c]);
+      }
+      break;
+    case LandscapeCounterClockwise:
+      // Same layout as the panel, nothing is buffered
+      break;
+  }
+}
+
+// Inverse of flushLogicalBuffer: picks up the panel frame buffer contents in logical orientation
+void GfxRenderer::loadLogicalBuffer() const {
+  constexpr int panelRowBytes = HalDisplay::DISPLAY_WIDTH_BYTES;
+  uint8_t in[8], out[8];
+
+  switch (orientation) {
+    case Portrait:
+      for (int c = 0; c < panelRowBytes; c++) {
+        for (int b = 0; b < logicalRowBytes; b++) {
+          const uint8_t* src = frameBuffer + (HalDisplay::DISPLAY_HEIGHT - 1 - 8 * b) * panelRowBytes + c;
+          for (int j = 0; j < 8; j++) in[j] = src[-j * panelRowBytes];
+          transpose8x8(in, out);
+          for (int i = 0; i < 8; i++) logicalRows[8 * c + i][b] = out[i];
+        }
+      }
+      break;
+    case PortraitInverted:
+      for (int c = 0; c < panelRowBytes; c++) {
+        for (int b = 0; b < logicalRowBytes; b++) {
+          for (int j = 0; j < 8; j++) in[j] = frameBuffer[(8 * b + j) * panelRowBytes + c];
+          transpose8x8(in, out);
+          for (int i = 0; i < 8; i++) logicalRows[HalDisplay::DISPLAY_WIDTH - 1 - (8 * c + i)][b] = out[i];
+        }
+      }
+      break;
+    case LandscapeClockwise:
+      for (int r = 0; r < HalDisplay::DISPLAY_HEIGHT; r++) {
+        const uint8_t* src = frameBuffer + r * panelRowBytes;
+        uint8_t* dst = logicalRows[HalDisplay::DISPLAY_HEIGHT - 1 - r];
+        for (int c = 0; c < panelRowBytes; c++) dst[panelRowBytes - 1 - c] = reverseBits(src[c]);
+      }
+      break;
+    case LandscapeCounterClockwise:
+      break;
+  }
 }
 
 void GfxRenderer::getOrientedViewableTRBL(int* outTop, int* outRight, int* outBottom, int* outLeft) const {
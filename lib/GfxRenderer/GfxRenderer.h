@@ -4,9 +4,14 @@
 #include <FontDecompressor.h>
 #include <HalDisplay.h>
 
+#include <algorithm>
+#include <climits>
 #include <map>
 
 #include "Bitmap.h"
+#include "FrameStash.h"
+#include "RefreshPlanner.h"
+#include "WordRunCache.h"
 
 // Color representation: uint8_t mapped to 4x4 Bayer matrix dithering levels
 // 0 = transparent, 1-16 = gray levels (white to black)
@@ -25,31 +30,63 @@ class GfxRenderer {
   };
 
  private:
-  static constexpr size_t BW_BUFFER_CHUNK_SIZE = 8000;  // 8KB chunks to allow for non-contiguous memory
-  static constexpr size_t BW_BUFFER_NUM_CHUNKS = HalDisplay::BUFFER_SIZE / BW_BUFFER_CHUNK_SIZE;
-  static_assert(BW_BUFFER_CHUNK_SIZE * BW_BUFFER_NUM_CHUNKS == HalDisplay::BUFFER_SIZE,
-                "BW buffer chunking does not line up with display buffer size");
+  // Logical back buffer chunks hold whole rows in both shapes: 100 portrait rows (60 bytes) or 60 landscape rows
+  // (100 bytes), so switching orientation never needs a reallocation
+  static constexpr size_t LOGICAL_BUFFER_CHUNK_SIZE = 6000;
+  static constexpr size_t LOGICAL_BUFFER_NUM_CHUNKS = HalDisplay::BUFFER_SIZE / LOGICAL_BUFFER_CHUNK_SIZE;
+  static_assert(LOGICAL_BUFFER_CHUNK_SIZE % (HalDisplay::DISPLAY_WIDTH / 8) == 0 &&
+                    LOGICAL_BUFFER_CHUNK_SIZE % (HalDisplay::DISPLAY_HEIGHT / 8) == 0 &&
+                    LOGICAL_BUFFER_CHUNK_SIZE * LOGICAL_BUFFER_NUM_CHUNKS == HalDisplay::BUFFER_SIZE,
+                "Logical buffer chunks must hold whole rows in both orientations");
 
   HalDisplay& display;
   RenderMode renderMode;
   Orientation orientation;
   bool fadingFix;
   uint8_t* frameBuffer = nullptr;
-  uint8_t* bwBufferChunks[BW_BUFFER_NUM_CHUNKS] = {nullptr};
+  FrameStash bwStash;  // BW frame kept across the grayscale passes
+  uint8_t* logicalBufferChunks[LOGICAL_BUFFER_NUM_CHUNKS] = {nullptr};
+  uint8_t** logicalRows = nullptr;  // Start of every logical row, rebuilt when the orientation changes
+  int logicalRowBytes = 0;
+  int logicalHeight = 0;
+  // Union of everything drawn since the last display call, in logical coordinates (mutable for const drawing calls)
+  mutable int dirtyMinX = INT_MAX;
+  mutable int dirtyMinY = INT_MAX;
+  mutable int dirtyMaxX = INT_MIN;
+  mutable int dirtyMaxY = INT_MIN;
   std::map<int, EpdFontFamily> fontMap;
   FontDecompressor* fontDecompressor = nullptr;
-  void renderChar(const EpdFontFamily& fontFamily, uint32_t cp, int* x, int* y, bool pixelState,
-                  EpdFontFamily::Style style) const;
-  void freeBwBufferChunks();
-  template <Color color>
-  void drawPixelDither(int x, int y) const;
-  template <Color color>
-  void fillArc(int maxRadius, int cx, int cy, int xDir, int yDir) const;
+  WordRunCache* wordRunCache = nullptr;
+  RefreshPlanner* refreshPlanner = nullptr;
+  bool drawCachedRun(const EpdFontFamily& font, int x, int baselineY, const char* text, bool black,
+                     EpdFontFamily::Style style) const;
+  void freeLogicalBuffer();
+  void layoutLogicalRows();
+  bool usesLogicalBuffer() const { return logicalRows && orientation != LandscapeCounterClockwise; }
+  void flushLogicalBuffer() const;
+  void loadLogicalBuffer() const;
+  void applyRefreshDecision(const RefreshPlanner::Decision& decision) const;
+  void blitPanelImageLogical(const uint8_t* bitmap, int phyX, int phyY, int width, int height, bool transparent) const;
+  void markDirty(const int x0, const int y0, const int x1, const int y1) const {
+    dirtyMinX = std::min(dirtyMinX, x0);
+    dirtyMinY = std::min(dirtyMinY, y0);
+    dirtyMaxX = std::max(dirtyMaxX, x1);
+    dirtyMaxY = std::max(dirtyMaxY, y1);
+  }
+  void markPanelRectDirty(int phyX, int phyY, int width, int height) const;
+  void markAllDirty() const { markDirty(0, 0, getScreenWidth() - 1, getScreenHeight() - 1); }
+  void clearDirty() const {
+    dirtyMinX = dirtyMinY = INT_MAX;
+    dirtyMaxX = dirtyMaxY = INT_MIN;
+  }
+  void fillPatternRect(int x, int y, int width, int height, Color color) const;
+  void fillArcSpans(const int16_t* outerSpans, const int16_t* innerSpans, int maxRadius, int cx, int cy, int xDir,
+                    int yDir, Color color) const;
 
  public:
   explicit GfxRenderer(HalDisplay& halDisplay)
       : display(halDisplay), renderMode(BW), orientation(Portrait), fadingFix(false) {}
-  ~GfxRenderer() { freeBwBufferChunks(); }
+  ~GfxRenderer() { freeLogicalBuffer(); }
 
   static constexpr int VIEWABLE_MARGIN_TOP = 9;
   static constexpr int VIEWABLE_MARGIN_RIGHT = 3;
@@ -63,11 +100,32 @@ class GfxRenderer {
   void clearFontCache() {
     if (fontDecompressor) fontDecompressor->clearCache();
   }
+  // Optional cache of composed word bitmaps used by drawText (nullptr disables it)
+  void setWordRunCache(WordRunCache* c) { wordRunCache = c; }
+  void clearWordRunCache() {
+    if (wordRunCache) wordRunCache->clear();
+  }
+  void logWordRunCacheStats() const {
+    if (wordRunCache) wordRunCache->logStats();
+  }
+  // Optional frame signature used by displayAutoRefresh; every displayed frame is recorded in it (nullptr disables it)
+  void setRefreshPlanner(RefreshPlanner* p) { refreshPlanner = p; }
+  // The next displayAutoRefresh is a half refresh (first page of a book)
+  void requestHalfRefresh() const {
+    if (refreshPlanner) refreshPlanner->requestHalfRefresh();
+  }
+  const RefreshPlanner* getRefreshPlanner() const { return refreshPlanner; }
 
   // Orientation control (affects logical width/height and coordinate transforms)
-  void setOrientation(const Orientation o) { orientation = o; }
+  void setOrientation(Orientation o);
   Orientation getOrientation() const { return orientation; }
 
+  // Logical back buffer: draw into a buffer laid out in logical orientation, so rows are contiguous in memory, and
+  // transpose it into the panel frame buffer when it is displayed or read. Costs an extra 48KB (in 8 chunks) while
+  // enabled. Returns false if the buffer could not be allocated, in which case drawing goes straight to the panel.
+  bool setLogicalBufferEnabled(bool enabled);
+  bool isLogicalBufferEnabled() const { return logicalRows != nullptr; }
+
   // Fading fix control
   void setFadingFix(const bool enabled) { fadingFix = enabled; }
 
@@ -75,8 +133,18 @@ class GfxRenderer {
   int getScreenWidth() const;
   int getScreenHeight() const;
   void displayBuffer(HalDisplay::RefreshMode refreshMode = HalDisplay::FAST_REFRESH) const;
-  // EXPERIMENTAL: Windowed update - display only a rectangular region
-  // void displayWindow(int x, int y, int width, int height) const;
+  // Let the refresh planner choose between skipping, a window, FAST and HALF refresh from what changed on the panel.
+  // halfRefreshEvery is the user's "half refresh every N pages" setting. Without a planner this is a FAST refresh (HALF
+  // when halfRefreshEvery is 1).
+  void displayAutoRefresh(int halfRefreshEvery) const;
+  // Windowed update: fast refresh of a logical rectangle only, widened to whole bytes of the panel
+  void displayWindow(int x, int y, int width, int height) const;
+  // Refresh only what has been drawn since the last display call, as a window when it is small enough. Screens redrawn
+  // from scratch (list menus) mark everything, so with a RefreshPlanner the window is narrowed to the tiles that differ
+  // from the displayed frame; without one they get a fast displayBuffer. Nothing drawn means nothing is refreshed.
+  void displayDirtyRegion() const;
+  // Bounding box of everything drawn since the last display call; false if nothing was drawn
+  bool getDirtyRect(int* x, int* y, int* width, int* height) const;
   void invertScreen() const;
   void clearScreen(uint8_t color = 0xFF) const;
   void getOrientedViewableTRBL(int* outTop, int* outRight, int* outBottom, int* outLeft) const;
@@ -98,6 +166,9 @@ class GfxRenderer {
                        bool roundBottomLeft, bool roundBottomRight, Color color) const;
   void drawImage(const uint8_t bitmap[], int x, int y, int width, int height) const;
   void drawIcon(const uint8_t bitmap[], int x, int y, int width, int height) const;
+  // Draws the set bits of a 1-bit row (`width` pixels, MSB first) at (x, y) with `state`; clear bits are left alone.
+  // With the logical buffer, or in the panel's own orientation, whole bytes are merged through edge masks.
+  void drawMaskRow(int x, int y, const uint8_t* mask, int width, bool state) const;
   void drawBitmap(const Bitmap& bitmap, int x, int y, int maxWidth, int maxHeight, float cropX = 0,
                   float cropY = 0) const;
   void drawBitmap1Bit(const Bitmap& bitmap, int x, int y, int maxWidth, int maxHeight) const;
@@ -124,17 +195,53 @@ class GfxRenderer {
   // Grayscale functions
   void setRenderMode(const RenderMode mode) { this->renderMode = mode; }
   RenderMode getRenderMode() const { return renderMode; }
+
+  // Whether render mode `mode` draws a 2-bit gray level (0 black, 1 dark gray, 2 light gray, 3 white). BW paints all
+  // but white black; the gray passes flag their levels in reverse (drawn with state false, 0 leave alone, 1 update).
+  template <RenderMode mode>
+  static constexpr bool drawsGrayLevel(const uint8_t level) {
+    if constexpr (mode == BW) {
+      return level < 3;
+    } else if constexpr (mode == GRAYSCALE_MSB) {
+      return level == 1 || level == 2;
+    } else {
+      return level == 1;
+    }
+  }
+
+  // Calls fn.template operator()<mode>() for the current render mode. Pixel loops take the mode as a template
+  // parameter and are picked once per draw call here, so their inner loops carry no mode checks.
+  template <typename Fn>
+  decltype(auto) withRenderMode(Fn&& fn) const {
+    switch (renderMode) {
+      case GRAYSCALE_LSB:
+        return fn.template operator()<GRAYSCALE_LSB>();
+      case GRAYSCALE_MSB:
+        return fn.template operator()<GRAYSCALE_MSB>();
+      case BW:
+      default:
+        return fn.template operator()<BW>();
+    }
+  }
   void copyGrayscaleLsbBuffers() const;
   void copyGrayscaleMsbBuffers() const;
   void displayGrayBuffer() const;
   bool storeBwBuffer();    // Returns true if buffer was stored successfully
-  void restoreBwBuffer();  // Restore and free the stored buffer
+  void restoreBwBuffer();  // Restore the stored buffer; its stash memory is kept for the next page
+  // Frees the memory storeBwBuffer keeps between pages, for when no more grayscale pages follow
+  void releaseBwBuffer() { bwStash.release(); }
+  // Copy the frame into a caller's stash and back, e.g. to redraw a screen around an expensive image. restoreFrame
+  // returns false if the stash holds no frame.
+  bool storeFrame(FrameStash& stash) const;
+  bool restoreFrame(const FrameStash& stash) const;
   void cleanupGrayscaleWithFrameBuffer() const;
 
   // Font helpers
   const uint8_t* getGlyphBitmap(const EpdFontData* fontData, const EpdGlyph* glyph) const;
 
   // Low level functions
+  // With the logical buffer enabled, the panel frame buffer is brought up to date first. Writes made through the
+  // returned pointer are not seen by later drawing calls.
   uint8_t* getFrameBuffer() const;
   static size_t getBufferSize();
 };
@@ -0,0 +1,148 @@
+#include "RefreshPlanner.h"
+
+#include <Logging.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr const char* ACTION_NAMES[] = {"SKIP", "WINDOW", "FAST", "HALF"};
+constexpr uint32_t PANEL_PIXELS = static_cast<uint32_t>(HalDisplay::DISPLAY_WIDTH) * HalDisplay::DISPLAY_HEIGHT;
+}  // namespace
+
+void RefreshPlanner::compare(const uint8_t* frame) {
+  int minTileX = TILE_COLUMNS, minTileY = TILE_ROWS, maxTileX = -1, maxTileY = -1;
+  uint16_t changedTiles = 0;
+  uint32_t erasedInk = 0;
+
+  for (int tileY = 0; tileY < TILE_ROWS; tileY++) {
+    // One row of tiles at a time: each panel row adds one 32-bit word to every tile in it
+    uint32_t hashes[TILE_COLUMNS];
+    uint16_t ink[TILE_COLUMNS] = {};
+    std::fill(hashes, hashes + TILE_COLUMNS, 2166136261u);
+    for (int y = tileY * TILE_SIZE; y < (tileY + 1) * TILE_SIZE; y++) {
+      const uint8_t* row = frame + y * HalDisplay::DISPLAY_WIDTH_BYTES;
+      for (int tileX = 0; tileX < TILE_COLUMNS; tileX++) {
+        uint32_t word;
+        memcpy(&word, row + tileX * (TILE_SIZE / 8), sizeof(word));
+        hashes[tileX] = ((hashes[tileX] << 5 | hashes[tileX] >> 27) ^ word) * 16777619u;
+        ink[tileX] += __builtin_popcount(~word);  // Black pixels are 0 bits
+      }
+    }
+
+    for (int tileX = 0; tileX < TILE_COLUMNS; tileX++) {
+      const int index = tileY * TILE_COLUMNS + tileX;
+      if (signatureValid && hashes[tileX] == tileHashes[index] && ink[tileX] == tileInk[index]) {
+        continue;
+      }
+      changedTiles++;
+      // Ink the tile loses is erased for sure. Ink in both frames mostly sits on the same text lines, and about half of
+      // it lands on pixels that were black already.
+      const uint16_t kept = std::min(ink[tileX], tileInk[index]);
+      erasedInk += tileInk[index] - kept + kept / 2;
+      minTileX = std::min(minTileX, tileX);
+      maxTileX = std::max(maxTileX, tileX);
+      minTileY = std::min(minTileY, tileY);
+      maxTileY = std::max(maxTileY, tileY);
+      tileHashes[index] = hashes[tileX];
+      tileInk[index] = ink[tileX];
+    }
+  }
+
+  Decision& d = lastDecision;
+  d.changedTiles = changedTiles;
+  // Without a signature the previous frame is unknown; assume it held a typical page
+  d.erasedInk = signatureValid ? erasedInk : typicalPageInk;
+  if (changedTiles) {
+    d.x = minTileX * TILE_SIZE;
+    d.y = minTileY * TILE_SIZE;
+    d.width = (maxTileX - minTileX + 1) * TILE_SIZE;
+    d.height = (maxTileY - minTileY + 1) * TILE_SIZE;
+  } else {
+    d.x = d.y = d.width = d.height = 0;
+  }
+  d.ghostScore = ghostScore;
+  signatureValid = true;
+}
+
+void RefreshPlanner::accountFastRefresh() {
+  ghostScore += lastDecision.erasedInk;
+  // Page turns keep the budget in step with how much ink the current book's pages hold
+  if (lastDecision.changedTiles * 2 >= TILE_COUNT) {
+    typicalPageInk = std::max(MIN_PAGE_INK, (typicalPageInk * 7 + lastDecision.erasedInk) / 8);
+  }
+}
+
+void RefreshPlanner::decideFast(const bool hadSignature) {
+  Decision& d = lastDecision;
+  if (hadSignature && d.changedTiles == 0) {
+    d.action = SKIP;
+    stats.skips++;
+  } else if (hadSignature && static_cast<uint32_t>(d.width) * d.height * 2 <= PANEL_PIXELS) {
+    d.action = WINDOW;
+    accountFastRefresh();
+    stats.windows++;
+  } else {
+    d.action = FAST;
+    accountFastRefresh();
+    stats.fastRefreshes++;
+  }
+}
+
+void RefreshPlanner::logDecision() const {
+  LOG_DBG("RFP", "%s: %u/%d tiles changed, erased %lu px, ghost %lu/%lu", ACTION_NAMES[lastDecision.action],
+          lastDecision.changedTiles, TILE_COUNT, static_cast<unsigned long>(lastDecision.erasedInk),
+          static_cast<unsigned long>(lastDecision.ghostScore), static_cast<unsigned long>(lastDecision.ghostBudget));
+}
+
+const RefreshPlanner::Decision& RefreshPlanner::plan(const uint8_t* frame, const int halfRefreshEvery) {
+  const bool hadSignature = signatureValid;
+  compare(frame);
+
+  Decision& d = lastDecision;
+  // "Every N pages" leaves N-1 fast page turns between half refreshes; a quarter page of slack absorbs the variation
+  // between pages of the same book
+  d.ghostBudget = static_cast<uint32_t>(std::max(halfRefreshEvery, 1) * 4 - 3) * typicalPageInk / 4;
+  const bool unchanged = hadSignature && d.changedTiles == 0;
+  if (halfRefreshDue || (!unchanged && (halfRefreshEvery <= 1 || ghostScore + d.erasedInk > d.ghostBudget))) {
+    d.action = HALF;
+    ghostScore = 0;
+    halfRefreshDue = false;
+    stats.halfRefreshes++;
+  } else {
+    decideFast(hadSignature);
+  }
+
+  logDecision();
+  return d;
+}
+
+const RefreshPlanner::Decision& RefreshPlanner::planFast(const uint8_t* frame) {
+  const bool hadSignature = signatureValid;
+  compare(frame);
+  lastDecision.ghostBudget = 0;
+  decideFast(hadSignature);
+  logDecision();
+  return lastDecision;
+}
+
+void RefreshPlanner::record(const uint8_t* frame, const HalDisplay::RefreshMode mode) {
+  compare(frame);
+  if (mode == HalDisplay::FAST_REFRESH) {
+    lastDecision.action = FAST;
+    accountFastRefresh();
+  } else {
+    lastDecision.action = HALF;
+    ghostScore = 0;
+    halfRefreshDue = false;
+  }
+  stats.externalRefreshes++;
+}
+
+void RefreshPlanner::logStats() const {
+  LOG_DBG("RFP", "Planned %lu skipped, %lu windowed, %lu fast, %lu half; %lu explicit; ghost %lu, page ink %lu",
+          static_cast<unsigned long>(stats.skips), static_cast<unsigned long>(stats.windows),
+          static_cast<unsigned long>(stats.fastRefreshes), static_cast<unsigned long>(stats.halfRefreshes),
+          static_cast<unsigned long>(stats.externalRefreshes), static_cast<unsigned long>(ghostScore),
+          static_cast<unsigned long>(typicalPageInk));
+}
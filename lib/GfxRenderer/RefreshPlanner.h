@@ -0,0 +1,94 @@
+#pragma once
+
+#include <HalDisplay.h>
+
+#include <cstdint>
+
+// Picks the panel refresh for GfxRenderer::displayAutoRefresh from a compact signature of the displayed frame.
+//
+// The panel is split into 32x32 pixel tiles and a hash plus the ink (black pixel count) of every tile is kept, about
+// 2KB in all. Comparing a new frame against it gives the changed tiles and an estimate of the ink they erase, which is
+// what a fast refresh leaves behind as ghosting, so it accumulates as the ghosting score until a half refresh clears
+// it. The budget is the ink that typical page turns of the current book erase between two half refreshes at the
+// configured page interval, so pages of average ink keep the usual "half refresh every N pages" cadence. Sparse pages,
+// small updates and unchanged frames use up less of it (or none), dense pages more.
+class RefreshPlanner {
+ public:
+  static constexpr int TILE_SIZE = 32;
+  static constexpr int TILE_COLUMNS = HalDisplay::DISPLAY_WIDTH / TILE_SIZE;
+  static constexpr int TILE_ROWS = HalDisplay::DISPLAY_HEIGHT / TILE_SIZE;
+  static constexpr int TILE_COUNT = TILE_COLUMNS * TILE_ROWS;
+  static_assert(TILE_COLUMNS * TILE_SIZE == HalDisplay::DISPLAY_WIDTH &&
+                    TILE_ROWS * TILE_SIZE == HalDisplay::DISPLAY_HEIGHT,
+                "Tiles must cover the panel exactly");
+
+  enum Action : uint8_t {
+    SKIP,    // Nothing changed
+    WINDOW,  // Fast refresh of the rectangle around the changed tiles
+    FAST,    // Fast refresh of the whole panel
+    HALF     // Half refresh, clears the ghosting score
+  };
+
+  // A refresh decision and the inputs it was based on
+  struct Decision {
+    Action action;
+    uint16_t changedTiles;
+    // Panel rectangle around the changed tiles, the refreshed area for WINDOW
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint32_t erasedInk;    // Ink the changed tiles held in the previous frame, in pixels
+    uint32_t ghostScore;   // Erased ink since the last half refresh, before this refresh
+    uint32_t ghostBudget;  // Score above which a half refresh is due
+  };
+
+  struct Stats {
+    uint32_t skips;
+    uint32_t windows;
+    uint32_t fastRefreshes;
+    uint32_t halfRefreshes;
+    uint32_t externalRefreshes;  // Refreshes with an explicit mode, recorded to keep the signature current
+  };
+
+  // Plans the refresh for `frame` and takes it as the displayed frame. The caller must carry the decision out.
+  // halfRefreshEvery is the number of typical pages between half refreshes; 1 asks for a half refresh every time.
+  const Decision& plan(const uint8_t* frame, int halfRefreshEvery);
+
+  // Plans a refresh for UI screens that never take a half refresh of their own (menus): SKIP, WINDOW around the changed
+  // tiles or FAST, and takes `frame` as the displayed frame. The caller must carry the decision out.
+  const Decision& planFast(const uint8_t* frame);
+
+  // Records a refresh the caller chose itself (FULL and HALF refreshes clear the ghosting score)
+  void record(const uint8_t* frame, HalDisplay::RefreshMode mode);
+
+  // Makes the next plan() a half refresh whatever changed, e.g. for the first page of a book. Also set on first use.
+  void requestHalfRefresh() { halfRefreshDue = true; }
+
+  const Decision& getLastDecision() const { return lastDecision; }
+  const Stats& getStats() const { return stats; }
+  void resetStats() { stats = {}; }
+  void logStats() const;
+
+ private:
+  // Ink erased by a typical page turn until page turns have been seen: 6% of the panel, a dense page of text. Blank
+  // pages do not bring the budget below a quarter of that.
+  static constexpr uint32_t DEFAULT_PAGE_INK = HalDisplay::DISPLAY_WIDTH * HalDisplay::DISPLAY_HEIGHT * 6 / 100;
+  static constexpr uint32_t MIN_PAGE_INK = DEFAULT_PAGE_INK / 4;
+
+  uint32_t tileHashes[TILE_COUNT] = {};
+  uint16_t tileInk[TILE_COUNT] = {};
+  bool signatureValid = false;
+  bool halfRefreshDue = true;
+  uint32_t ghostScore = 0;
+  uint32_t typicalPageInk = DEFAULT_PAGE_INK;
+  Decision lastDecision = {};
+  Stats stats = {};
+
+  // Compares `frame` against the signature, fills in the change part of lastDecision and stores the new signature
+  void compare(const uint8_t* frame);
+  void accountFastRefresh();
+  // Picks SKIP, WINDOW or FAST for the compared frame
+  void decideFast(bool hadSignature);
+  void logDecision() const;
+};
@@ -0,0 +1,160 @@
+#include "WordRunCache.h"
+
+#include <Logging.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+uint32_t WordRunCache::hashKey(const EpdFontData* font, const uint8_t renderMode, const char* text,
+                               const size_t length) {
+  // FNV-1a over the text, seeded with the font and render mode
+  uint32_t hash = 2166136261u ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(font)) ^ (renderMode << 24);
+  for (size_t i = 0; i < length; i++) {
+    hash ^= static_cast<uint8_t>(text[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+bool WordRunCache::find(const EpdFontData* font, const uint8_t renderMode, const char* text, const size_t length,
+                        Run* out) {
+  const uint32_t hash = hashKey(font, renderMode, text, length);
+  for (uint16_t i = 0; i < entryCount; i++) {
+    Entry& entry = entries[i];
+    if (entry.hash != hash || entry.font != font || entry.renderMode != renderMode || entry.textLength != length ||
+        memcmp(arena + entry.offset, text, length) != 0) {
+      continue;
+    }
+    entry.lastUsed = ++accessCounter;
+    out->offsetX = entry.offsetX;
+    out->offsetY = entry.offsetY;
+    out->width = entry.width;
+    out->height = entry.height;
+    out->bits = arena + entry.offset + entry.textLength;
+    stats.hits++;
+    return true;
+  }
+  stats.misses++;
+  return false;
+}
+
+bool WordRunCache::admit(const EpdFontData* font, const uint8_t renderMode, const char* text, const size_t length) {
+  if (length > MAX_TEXT_BYTES) {
+    return false;
+  }
+  const uint32_t hash = hashKey(font, renderMode, text, length);
+  for (const uint32_t recent : recentMisses) {
+    if (recent == hash) {
+      return true;
+    }
+  }
+  recentMisses[recentMissPos] = hash;
+  recentMissPos = (recentMissPos + 1) % RECENT_MISSES;
+  return false;
+}
+
+uint8_t* WordRunCache::insert(const EpdFontData* font, const uint8_t renderMode, const char* text, const size_t length,
+                              const int16_t offsetX, const int16_t offsetY, const uint16_t width,
+                              const uint16_t height) {
+  const size_t maskBytes = static_cast<size_t>((width + 7) / 8) * height;
+  const size_t dataSize = length + maskBytes;
+  if (length > MAX_TEXT_BYTES || maskBytes > MAX_RUN_BYTES || dataSize > budgetBytes) {
+    return nullptr;
+  }
+
+  while (entryCount > 0 && (entryCount == MAX_ENTRIES || stats.bytesUsed + dataSize > budgetBytes)) {
+    evictLeastRecentlyUsed();
+  }
+
+  if (!arena) {
+    arena = static_cast<uint8_t*>(malloc(budgetBytes));
+    if (!arena) {
+      LOG_ERR("WRC", "Failed to allocate %zu bytes for word runs", budgetBytes);
+      return nullptr;
+    }
+  }
+
+  // Runs are kept packed, so the free space is always at the end of the arena
+  uint8_t* data = arena + stats.bytesUsed;
+  memcpy(data, text, length);
+  memset(data + length, 0, maskBytes);
+
+  Entry& entry = entries[entryCount++];
+  entry.font = font;
+  entry.hash = hashKey(font, renderMode, text, length);
+  entry.lastUsed = ++accessCounter;
+  entry.offset = static_cast<uint32_t>(stats.bytesUsed);
+  entry.dataSize = static_cast<uint16_t>(dataSize);
+  entry.renderMode = renderMode;
+  entry.textLength = static_cast<uint8_t>(length);
+  entry.offsetX = offsetX;
+  entry.offsetY = offsetY;
+  entry.width = width;
+  entry.height = height;
+
+  stats.inserts++;
+  stats.entries = entryCount;
+  stats.bytesUsed += dataSize;
+  if (stats.bytesUsed > stats.peakBytes) {
+    stats.peakBytes = stats.bytesUsed;
+  }
+  return data + length;
+}
+
+void WordRunCache::evict(const uint16_t index) {
+  // Slide the runs stored after this one down over it
+  const uint32_t offset = entries[index].offset;
+  const uint16_t size = entries[index].dataSize;
+  memmove(arena + offset, arena + offset + size, stats.bytesUsed - offset - size);
+  for (uint16_t i = 0; i < entryCount; i++) {
+    if (entries[i].offset > offset) {
+      entries[i].offset -= size;
+    }
+  }
+  stats.bytesUsed -= size;
+  // Order does not matter, move the last entry into the hole
+  entries[index] = entries[--entryCount];
+  entries[entryCount] = {};
+  stats.entries = entryCount;
+}
+
+void WordRunCache::evictLeastRecentlyUsed() {
+  uint16_t lru = 0;
+  for (uint16_t i = 1; i < entryCount; i++) {
+    if (entries[i].lastUsed < entries[lru].lastUsed) {
+      lru = i;
+    }
+  }
+  evict(lru);
+  stats.evictions++;
+}
+
+void WordRunCache::clear() {
+  for (uint16_t i = 0; i < entryCount; i++) {
+    entries[i] = {};
+  }
+  entryCount = 0;
+  stats.entries = 0;
+  stats.bytesUsed = 0;
+  free(arena);
+  arena = nullptr;
+  memset(recentMisses, 0, sizeof(recentMisses));
+  recentMissPos = 0;
+  accessCounter = 0;
+}
+
+void WordRunCache::resetStats() {
+  const uint16_t entriesNow = stats.entries;
+  const size_t bytesNow = stats.bytesUsed;
+  stats = {};
+  stats.entries = entriesNow;
+  stats.bytesUsed = bytesNow;
+  stats.peakBytes = bytesNow;
+}
+
+void WordRunCache::logStats() const {
+  LOG_INF("WRC", "Word runs: %u/%u hits (%u%%), %u inserts, %u evictions, %u entries, %zu/%zu bytes (peak %zu)",
+          stats.hits, stats.hits + stats.misses, stats.hits * 100 / std::max(stats.hits + stats.misses, 1u),
+          stats.inserts, stats.evictions, stats.entries, stats.bytesUsed, budgetBytes, stats.peakBytes);
+}
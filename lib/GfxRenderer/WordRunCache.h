@@ -0,0 +1,95 @@
+#pragma once
+
+#include <EpdFontData.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// LRU cache of pre-composed word bitmaps ("runs") for GfxRenderer::drawText.
+//
+// Each run is the 1-bit mask of every pixel drawText would plot for a (font, render mode, text) key, stored as packed
+// MSB-first rows in logical coordinates relative to the pen position. Later occurrences of the same word blit the
+// mask directly, skipping glyph lookup and decompression. A run is only composed the second time its key is seen, so
+// one-off words never pay the composition cost or evict frequent words.
+//
+// Runs are packed back to back into a single budget-sized arena, allocated on the first insert and released by
+// clear(), so the cache never fragments the heap. Evicting a run slides the runs after it down over the hole.
+class WordRunCache {
+ public:
+  // Longest text (in bytes) and largest mask that will be cached. Longer words are drawn glyph by glyph.
+  static constexpr size_t MAX_TEXT_BYTES = 32;
+  static constexpr size_t MAX_RUN_BYTES = 1024;
+  static constexpr size_t DEFAULT_BUDGET_BYTES = 12 * 1024;
+
+  struct Run {
+    int16_t offsetX;  // Left edge of the mask relative to the pen x position
+    int16_t offsetY;  // Top edge of the mask relative to the baseline
+    uint16_t width;
+    uint16_t height;
+    const uint8_t* bits;  // height rows of (width + 7) / 8 bytes
+  };
+
+  struct Stats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t inserts;
+    uint32_t evictions;
+    uint16_t entries;
+    size_t bytesUsed;
+    size_t peakBytes;
+  };
+
+  explicit WordRunCache(size_t budgetBytes = DEFAULT_BUDGET_BYTES) : budgetBytes(budgetBytes) {}
+  ~WordRunCache() { clear(); }
+  WordRunCache(const WordRunCache&) = delete;
+  WordRunCache& operator=(const WordRunCache&) = delete;
+
+  // Looks up a run. Returns false on a miss. The run's bits stay valid until the next insert().
+  bool find(const EpdFontData* font, uint8_t renderMode, const char* text, size_t length, Run* out);
+
+  // Called after a miss. Returns true if the key has been missed recently and should now be composed and inserted.
+  bool admit(const EpdFontData* font, uint8_t renderMode, const char* text, size_t length);
+
+  // Reserves a zeroed mask for a new run, evicting least recently used runs to stay within budget.
+  // Returns nullptr if the run is too large to cache.
+  uint8_t* insert(const EpdFontData* font, uint8_t renderMode, const char* text, size_t length, int16_t offsetX,
+                  int16_t offsetY, uint16_t width, uint16_t height);
+
+  // Drops all runs. Must be called before a font's EpdFontData is freed or reused (e.g. closing an EpdFontFile).
+  void clear();
+
+  const Stats& getStats() const { return stats; }
+  void resetStats();
+  void logStats() const;
+
+ private:
+  static constexpr uint16_t MAX_ENTRIES = 128;
+  static constexpr uint16_t RECENT_MISSES = 128;
+
+  struct Entry {
+    const EpdFontData* font;
+    uint32_t hash;
+    uint32_t lastUsed;
+    uint32_t offset;  // Arena offset of the text bytes, followed by the mask
+    uint16_t dataSize;
+    uint8_t renderMode;
+    uint8_t textLength;
+    int16_t offsetX;
+    int16_t offsetY;
+    uint16_t width;
+    uint16_t height;
+  };
+
+  size_t budgetBytes;
+  uint8_t* arena = nullptr;
+  Entry entries[MAX_ENTRIES] = {};
+  uint16_t entryCount = 0;
+  uint32_t recentMisses[RECENT_MISSES] = {};
+  uint16_t recentMissPos = 0;
+  uint32_t accessCounter = 0;
+  Stats stats = {};
+
+  static uint32_t hashKey(const EpdFontData* font, uint8_t renderMode, const char* text, size_t length);
+  void evict(uint16_t index);
+  void evictLeastRecentlyUsed();
+};
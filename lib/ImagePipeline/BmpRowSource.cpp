@@ -0,0 +1,41 @@
+#include "BmpRowSource.h"
+
+#include <Logging.h>
+
+#include <cstdlib>
+
+bool BmpRowSource::open() {
+  const BmpReaderError err = bitmap.parseHeaders();
+  if (err != BmpReaderError::Ok) {
+    LOG_ERR("BMP", "Failed to parse BMP headers: %s", Bitmap::errorToString(err));
+    return false;
+  }
+  return true;
+}
+
+bool BmpRowSource::decode(GrayRowSink& sink) {
+  const int width = bitmap.getWidth();
+  auto* rowBuffer = static_cast<uint8_t*>(malloc(bitmap.getRowBytes()));
+  auto* gray = static_cast<uint8_t*>(malloc(width));
+  if (!rowBuffer || !gray) {
+    LOG_ERR("BMP", "Failed to allocate row buffers for width %d", width);
+    free(rowBuffer);
+    free(gray);
+    return false;
+  }
+
+  bool success = true;
+  for (int y = 0; y < bitmap.getHeight() && success; y++) {
+    const BmpReaderError err = bitmap.readGrayRow(y, gray, rowBuffer);
+    if (err != BmpReaderError::Ok) {
+      LOG_ERR("BMP", "Failed to read row %d: %s", y, Bitmap::errorToString(err));
+      success = false;
+    } else {
+      success = sink.writeRow(gray, y);
+    }
+  }
+
+  free(rowBuffer);
+  free(gray);
+  return success;
+}
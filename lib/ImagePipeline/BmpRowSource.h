@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Bitmap.h>
+
+#include "ImagePipeline.h"
+
+// Uncompressed BMP (1, 2, 4, 8, 24 or 32 bits) through Bitmap, emitted top to bottom whichever way the file stores
+// its rows
+class BmpRowSource final : public ImageRowSource {
+ public:
+  explicit BmpRowSource(FsFile& file) : bitmap(file) {}
+
+  // Reads the headers; the image size is known afterwards
+  bool open();
+
+  int getWidth() const override { return bitmap.getWidth(); }
+  int getHeight() const override { return bitmap.getHeight(); }
+  bool decode(GrayRowSink& sink) override;
+
+ private:
+  Bitmap bitmap;
+};
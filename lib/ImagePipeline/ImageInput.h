@@ -0,0 +1,27 @@
+#pragma once
+
+#include <HalStorage.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Forward-only byte input for the JPEG and PNG sources: a file on the SD card, or an entry inflated straight out of a
+// ZIP (EPUB covers) without extracting it first
+class ImageInput {
+ public:
+  virtual ~ImageInput() = default;
+  // Returns the number of bytes read: fewer than `len` only at the end of the input, negative on error
+  virtual int read(uint8_t* buf, size_t len) = 0;
+  // Skips `len` bytes forward
+  virtual bool skip(uint32_t len) = 0;
+};
+
+class FileImageInput final : public ImageInput {
+ public:
+  explicit FileImageInput(FsFile& file) : file(file) {}
+  int read(uint8_t* buf, const size_t len) override { return file.read(buf, len); }
+  bool skip(const uint32_t len) override { return file.seekCur(len); }
+
+ private:
+  FsFile& file;
+};
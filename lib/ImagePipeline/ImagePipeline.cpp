@@ -0,0 +1,232 @@
+#include "ImagePipeline.h"
+
+#include <Logging.h>
+#include <Print.h>
+
+#include <cstdlib>
+#include <cstring>
+
+AreaScaler::~AreaScaler() {
+  free(spanStart);
+  free(spanWidth);
+  free(rowAccum);
+  free(outRow);
+}
+
+bool AreaScaler::begin(const int width, const int height) {
+  spanStart = static_cast<uint16_t*>(malloc(outWidth * sizeof(uint16_t)));
+  spanWidth = static_cast<uint16_t*>(malloc(outWidth * sizeof(uint16_t)));
+  rowAccum = static_cast<uint32_t*>(calloc(outWidth, sizeof(uint32_t)));
+  outRow = static_cast<uint8_t*>(malloc(outWidth));
+  if (!spanStart || !spanWidth || !rowAccum || !outRow) {
+    LOG_ERR("IMG", "Failed to allocate scaler rows for width %d", outWidth);
+    return false;
+  }
+
+  // Source columns of each output column, worked out once instead of per row
+  const uint32_t scaleX_fp = (static_cast<uint32_t>(width) << 16) / outWidth;
+  for (int outX = 0; outX < outWidth; outX++) {
+    int start = (static_cast<uint32_t>(outX) * scaleX_fp) >> 16;
+    int end = (static_cast<uint32_t>(outX + 1) * scaleX_fp) >> 16;
+    if (start > width - 1) start = width - 1;
+    if (end > width) end = width;
+    spanStart[outX] = start;
+    spanWidth[outX] = end > start ? end - start : 1;
+  }
+
+  scaleY_fp = (static_cast<uint32_t>(height) << 16) / outHeight;
+  nextOutY_srcStart = scaleY_fp;
+  currentOutY = 0;
+  accumulatedRows = 0;
+  return out.begin(outWidth, outHeight);
+}
+
+bool AreaScaler::writeRow(const uint8_t* gray, const int y) {
+  for (int outX = 0; outX < outWidth; outX++) {
+    const uint8_t* src = gray + spanStart[outX];
+    uint32_t sum = 0;
+    for (int i = 0; i < spanWidth[outX]; i++) sum += src[i];
+    rowAccum[outX] += sum;
+  }
+  accumulatedRows++;
+
+  // Emit every output row whose source rows are complete; upscaling emits the same source data more than once
+  const uint32_t srcY_fp = static_cast<uint32_t>(y + 1) << 16;
+  while (srcY_fp >= nextOutY_srcStart && currentOutY < outHeight) {
+    emitRow();
+    if (!out.writeRow(outRow, currentOutY)) return false;
+    currentOutY++;
+    nextOutY_srcStart = static_cast<uint32_t>(currentOutY + 1) * scaleY_fp;
+    if (srcY_fp >= nextOutY_srcStart) continue;
+    memset(rowAccum, 0, outWidth * sizeof(uint32_t));
+    accumulatedRows = 0;
+  }
+  return true;
+}
+
+void AreaScaler::emitRow() {
+  for (int x = 0; x < outWidth; x++) {
+    outRow[x] = rowAccum[x] / (spanWidth[x] * accumulatedRows);
+  }
+}
+
+void AtkinsonRowDitherer::ditherRow(const uint8_t* gray, uint8_t* levels, const int width, int) {
+  for (int x = 0; x < width; x++) levels[x] = ditherer.processPixel(adjustPixel(gray[x]), x);
+  ditherer.nextRow();
+}
+
+void Atkinson1BitRowDitherer::ditherRow(const uint8_t* gray, uint8_t* levels, const int width, int) {
+  for (int x = 0; x < width; x++) levels[x] = ditherer.processPixel(gray[x], x);
+  ditherer.nextRow();
+}
+
+void FloydSteinbergRowDitherer::ditherRow(const uint8_t* gray, uint8_t* levels, const int width, int) {
+  if (ditherer.isReverseRow()) {
+    for (int x = width - 1; x >= 0; x--) levels[x] = ditherer.processPixel(adjustPixel(gray[x]), x);
+  } else {
+    for (int x = 0; x < width; x++) levels[x] = ditherer.processPixel(adjustPixel(gray[x]), x);
+  }
+  ditherer.nextRow();
+}
+
+void BayerRowDitherer::ditherRow(const uint8_t* gray, uint8_t* levels, const int width, const int y) {
+  for (int x = 0; x < width; x++) levels[x] = applyBayerDither4Level(gray[x], originX + x, originY + y);
+}
+
+void ThresholdRowDitherer::ditherRow(const uint8_t* gray, uint8_t* levels, const int width, int) {
+  for (int x = 0; x < width; x++) {
+    const uint8_t level = gray[x] / 85;
+    levels[x] = level > 3 ? 3 : level;
+  }
+}
+
+namespace {
+void write16(Print& out, const uint16_t value) {
+  out.write(value & 0xFF);
+  out.write((value >> 8) & 0xFF);
+}
+
+void write32(Print& out, const uint32_t value) {
+  out.write(value & 0xFF);
+  out.write((value >> 8) & 0xFF);
+  out.write((value >> 16) & 0xFF);
+  out.write((value >> 24) & 0xFF);
+}
+
+// BITMAPINFOHEADER with a negative height (top-down rows) and a gray palette of 2^bits entries
+void writeBmpHeader(Print& out, const int width, const int height, const int bits) {
+  const int colors = 1 << bits;
+  const uint32_t dataOffset = 14 + 40 + colors * 4;
+  const uint32_t imageSize = (width * bits + 31) / 32 * 4 * height;
+
+  out.write('B');
+  out.write('M');
+  write32(out, dataOffset + imageSize);
+  write32(out, 0);  // Reserved
+  write32(out, dataOffset);
+
+  write32(out, 40);
+  write32(out, static_cast<uint32_t>(width));
+  write32(out, static_cast<uint32_t>(-height));
+  write16(out, 1);  // Color planes
+  write16(out, bits);
+  write32(out, 0);  // BI_RGB (no compression)
+  write32(out, imageSize);
+  write32(out, 2835);  // 72 DPI
+  write32(out, 2835);
+  write32(out, colors);
+  write32(out, colors);
+
+  for (int i = 0; i < colors; i++) {
+    const uint8_t level = 255 * i / (colors - 1);
+    out.write(level);
+    out.write(level);
+    out.write(level);
+    out.write(static_cast<uint8_t>(0));
+  }
+}
+}  // namespace
+
+BmpRowSink::~BmpRowSink() {
+  free(levels);
+  free(rowBuffer);
+}
+
+bool BmpRowSink::begin(const int imageWidth, const int height) {
+  width = imageWidth;
+  bytesPerRow = (width * bits + 31) / 32 * 4;
+  levels = static_cast<uint8_t*>(malloc(width));
+  rowBuffer = static_cast<uint8_t*>(malloc(bytesPerRow));
+  if (!levels || !rowBuffer) {
+    LOG_ERR("IMG", "Failed to allocate BMP row buffers for width %d", width);
+    return false;
+  }
+  writeBmpHeader(out, width, height, bits);
+  return true;
+}
+
+bool BmpRowSink::writeRow(const uint8_t* gray, const int y) {
+  ditherer.ditherRow(gray, levels, width, y);
+
+  // Pack MSB first: 8 pixels per byte at 1 bit, 4 at 2 bits
+  memset(rowBuffer, 0, bytesPerRow);
+  if (bits == 1) {
+    for (int x = 0; x < width; x++) rowBuffer[x >> 3] |= levels[x] << (7 - (x & 7));
+  } else {
+    for (int x = 0; x < width; x++) rowBuffer[x >> 2] |= levels[x] << (6 - (x & 3) * 2);
+  }
+  return out.write(rowBuffer, bytesPerRow) == static_cast<size_t>(bytesPerRow);
+}
+
+void ImagePipeline::fitSize(const int srcWidth, const int srcHeight, const int targetWidth, const int targetHeight,
+                            const bool crop, int& outWidth, int& outHeight) {
+  outWidth = srcWidth;
+  outHeight = srcHeight;
+  if (targetWidth <= 0 || targetHeight <= 0 || (srcWidth == targetWidth && srcHeight == targetHeight)) return;
+
+  const float scaleToFitWidth = static_cast<float>(targetWidth) / srcWidth;
+  const float scaleToFitHeight = static_cast<float>(targetHeight) / srcHeight;
+  float scale;
+  if (crop) {  // cover the target, the overflow is cropped when drawn
+    scale = (scaleToFitWidth > scaleToFitHeight) ? scaleToFitWidth : scaleToFitHeight;
+  } else {  // fit inside the target
+    scale = (scaleToFitWidth < scaleToFitHeight) ? scaleToFitWidth : scaleToFitHeight;
+  }
+
+  outWidth = static_cast<int>(srcWidth * scale);
+  outHeight = static_cast<int>(srcHeight * scale);
+  if (outWidth < 1) outWidth = 1;
+  if (outHeight < 1) outHeight = 1;
+}
+
+bool ImagePipeline::run(ImageRowSource& source, const int outWidth, const int outHeight, GrayRowSink& sink) {
+  source.reduceFor(outWidth, outHeight);
+  const int srcWidth = source.getWidth();
+  const int srcHeight = source.getHeight();
+
+  if (srcWidth == outWidth && srcHeight == outHeight) {
+    return sink.begin(outWidth, outHeight) && source.decode(sink);
+  }
+
+  LOG_DBG("IMG", "Scaling %dx%d -> %dx%d", srcWidth, srcHeight, outWidth, outHeight);
+  AreaScaler scaler(outWidth, outHeight, sink);
+  return scaler.begin(srcWidth, srcHeight) && source.decode(scaler);
+}
+
+bool ImagePipeline::toBmp(ImageRowSource& source, Print& bmpOut, const int targetWidth, const int targetHeight,
+                          const bool oneBit, const bool crop) {
+  int outWidth;
+  int outHeight;
+  fitSize(source.getWidth(), source.getHeight(), targetWidth, targetHeight, crop, outWidth, outHeight);
+  LOG_DBG("IMG", "Converting %dx%d to %s BMP %dx%d", source.getWidth(), source.getHeight(), oneBit ? "1-bit" : "2-bit",
+          outWidth, outHeight);
+
+  if (oneBit) {
+    Atkinson1BitRowDitherer ditherer(outWidth);
+    BmpRowSink sink(bmpOut, 1, ditherer);
+    return run(source, outWidth, outHeight, sink);
+  }
+  AtkinsonRowDitherer ditherer(outWidth);
+  BmpRowSink sink(bmpOut, 2, ditherer);
+  return run(source, outWidth, outHeight, sink);
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <BitmapHelpers.h>
+
+#include <cstdint>
+
+class Print;
+
+// Row-streaming image pipeline shared by every image path: a source decodes rows of 8-bit gray top to bottom, the
+// area scaler resizes them, and a sink quantizes each output row with a pluggable ditherer and writes it out.
+//
+//   JpegRowSource / PngRowSource / BmpRowSource -> AreaScaler -> BmpRowSink / FramebufferRowSink
+//
+// Only one source row, one scaler accumulator row and one packed output row are held at a time.
+
+// Receives rows of 8-bit gray, top to bottom
+class GrayRowSink {
+ public:
+  virtual ~GrayRowSink() = default;
+  // Called once before the first row with the size of the rows that will follow
+  virtual bool begin(int /*width*/, int /*height*/) { return true; }
+  virtual bool writeRow(const uint8_t* gray, int y) = 0;
+};
+
+// Decodes an image into rows of 8-bit gray
+class ImageRowSource {
+ public:
+  virtual ~ImageRowSource() = default;
+  // Size of the rows decode() produces
+  virtual int getWidth() const = 0;
+  virtual int getHeight() const = 0;
+  // Lets a source decode at a reduced size that still covers `outWidth` x `outHeight` (JPEG does 1/2, 1/4 and 1/8)
+  virtual void reduceFor(int /*outWidth*/, int /*outHeight*/) {}
+  virtual bool decode(GrayRowSink& sink) = 0;
+};
+
+// Fixed-point (16.16) area averaging from the source size to the output size. Each output pixel is the mean of the
+// source pixels it covers; upscaling repeats the nearest source pixel.
+class AreaScaler final : public GrayRowSink {
+ public:
+  AreaScaler(int outWidth, int outHeight, GrayRowSink& out) : outWidth(outWidth), outHeight(outHeight), out(out) {}
+  ~AreaScaler() override;
+  AreaScaler(const AreaScaler&) = delete;
+  AreaScaler& operator=(const AreaScaler&) = delete;
+
+  bool begin(int width, int height) override;
+  bool writeRow(const uint8_t* gray, int y) override;
+
+ private:
+  void emitRow();
+
+  int outWidth;
+  int outHeight;
+  GrayRowSink& out;
+  uint32_t scaleY_fp = 0;
+  int currentOutY = 0;
+  uint32_t nextOutY_srcStart = 0;  // Source Y where the next output row starts (16.16)
+  int accumulatedRows = 0;
+  uint16_t* spanStart = nullptr;  // First source column of each output column
+  uint16_t* spanWidth = nullptr;  // Source columns averaged into each output column (at least 1)
+  uint32_t* rowAccum = nullptr;
+  uint8_t* outRow = nullptr;
+};
+
+// Quantizes rows of gray to display levels: 0-3 (black to white) for 2-bit output, 0-1 for 1-bit output
+class RowDitherer {
+ public:
+  virtual ~RowDitherer() = default;
+  virtual void ditherRow(const uint8_t* gray, uint8_t* levels, int width, int y) = 0;
+};
+
+// 2-bit Atkinson error diffusion with the X4-tuned levels, after the brightness/contrast adjustment (covers)
+class AtkinsonRowDitherer final : public RowDitherer {
+ public:
+  explicit AtkinsonRowDitherer(int width) : ditherer(width) {}
+  void ditherRow(const uint8_t* gray, uint8_t* levels, int width, int y) override;
+
+ private:
+  AtkinsonDitherer ditherer;
+};
+
+// 1-bit Atkinson error diffusion (thumbnails)
+class Atkinson1BitRowDitherer final : public RowDitherer {
+ public:
+  explicit Atkinson1BitRowDitherer(int width) : ditherer(width) {}
+  void ditherRow(const uint8_t* gray, uint8_t* levels, int width, int y) override;
+
+ private:
+  Atkinson1BitDitherer ditherer;
+};
+
+// 2-bit serpentine Floyd-Steinberg error diffusion
+class FloydSteinbergRowDitherer final : public RowDitherer {
+ public:
+  explicit FloydSteinbergRowDitherer(int width) : ditherer(width) {}
+  void ditherRow(const uint8_t* gray, uint8_t* levels, int width, int y) override;
+
+ private:
+  FloydSteinbergDitherer ditherer;
+};
+
+// 2-bit ordered (4x4 Bayer) dithering. Stateless, so images drawn in pieces line up; the pattern is anchored to the
+// screen through the origin of the image (inline images)
+class BayerRowDitherer final : public RowDitherer {
+ public:
+  explicit BayerRowDitherer(int originX = 0, int originY = 0) : originX(originX), originY(originY) {}
+  void ditherRow(const uint8_t* gray, uint8_t* levels, int width, int y) override;
+
+ private:
+  int originX;
+  int originY;
+};
+
+// 2-bit even quantization without dithering
+class ThresholdRowDitherer final : public RowDitherer {
+ public:
+  void ditherRow(const uint8_t* gray, uint8_t* levels, int width, int y) override;
+};
+
+// Writes a top-down 1- or 2-bit BMP (covers and thumbnails). The ditherer must produce levels for that bit depth.
+class BmpRowSink final : public GrayRowSink {
+ public:
+  BmpRowSink(Print& out, int bits, RowDitherer& ditherer) : out(out), bits(bits), ditherer(ditherer) {}
+  ~BmpRowSink() override;
+  BmpRowSink(const BmpRowSink&) = delete;
+  BmpRowSink& operator=(const BmpRowSink&) = delete;
+
+  bool begin(int width, int height) override;
+  bool writeRow(const uint8_t* gray, int y) override;
+
+ private:
+  Print& out;
+  int bits;
+  RowDitherer& ditherer;
+  int width = 0;
+  int bytesPerRow = 0;
+  uint8_t* levels = nullptr;
+  uint8_t* rowBuffer = nullptr;
+};
+
+namespace ImagePipeline {
+// Size of `srcWidth` x `srcHeight` scaled to fit inside (or, with `crop`, to cover) `targetWidth` x `targetHeight`,
+// keeping the aspect ratio. A target of 0 x 0 keeps the source size.
+void fitSize(int srcWidth, int srcHeight, int targetWidth, int targetHeight, bool crop, int& outWidth,
+             int& outHeight);
+
+// Runs `source` through the area scaler into `sink` at `outWidth` x `outHeight`
+bool run(ImageRowSource& source, int outWidth, int outHeight, GrayRowSink& sink);
+
+// Converts `source` to an Atkinson-dithered 2-bit or 1-bit BMP sized with fitSize()
+bool toBmp(ImageRowSource& source, Print& bmpOut, int targetWidth, int targetHeight, bool oneBit, bool crop);
+}  // namespace ImagePipeline
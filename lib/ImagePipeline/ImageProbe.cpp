@@ -0,0 +1,111 @@
+#include "ImageProbe.h"
+
+#include <Logging.h>
+
+#include "ImageInput.h"
+#include "PngRowSource.h"
+
+namespace {
+bool readBytes(ImageInput& input, uint8_t* buf, const size_t len) {
+  return input.read(buf, len) == static_cast<int>(len);
+}
+
+uint16_t be16(const uint8_t* p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+uint16_t le16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+uint32_t be32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 | static_cast<uint32_t>(p[2]) << 8 |
+         p[3];
+}
+uint32_t le32(const uint8_t* p) {
+  return p[0] | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+         static_cast<uint32_t>(p[3]) << 24;
+}
+
+// Walks the segments after SOI up to the first start-of-frame marker. Only frames picojpeg decodes give a size:
+// baseline (SOF0), 8-bit, with 1 or 3 components. Progressive, extended and arithmetic-coded frames fail here, so
+// callers fall back as they would for an undecodable image rather than laying out a box that stays blank.
+bool readJpegSize(ImageInput& input, int& width, int& height) {
+  uint8_t marker = 0;
+  while (true) {
+    // Markers may be padded with any number of 0xFF fill bytes
+    uint8_t byte;
+    if (!readBytes(input, &byte, 1)) return false;
+    if (byte != 0xFF) continue;
+    do {
+      if (!readBytes(input, &marker, 1)) return false;
+    } while (marker == 0xFF);
+
+    if (marker == 0x00 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) continue;  // No length
+    if (marker == 0xD9 || marker == 0xDA) return false;  // EOI or SOS before any frame header
+
+    uint8_t length[2];
+    if (!readBytes(input, length, 2) || be16(length) < 2) return false;
+    // SOF0-SOF15, except DHT (C4), JPG (C8) and DAC (CC)
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+      uint8_t frame[6];  // Precision, height, width, components
+      if (!readBytes(input, frame, sizeof(frame))) return false;
+      if (marker != 0xC0 || frame[0] != 8 || (frame[5] != 1 && frame[5] != 3)) {
+        LOG_DBG("IMG", "Unsupported JPEG frame: SOF%d, %d-bit, %d components", marker - 0xC0, frame[0], frame[5]);
+        return false;
+      }
+      height = be16(frame + 1);
+      width = be16(frame + 3);
+      return true;
+    }
+    if (!input.skip(be16(length) - 2)) return false;
+  }
+}
+}  // namespace
+
+bool ImageProbe::readSize(ImageInput& input, int& width, int& height, Format* format) {
+  uint8_t header[29];
+  if (!readBytes(input, header, 2)) return false;
+
+  Format found = Format::Unknown;
+  width = height = 0;
+  if (header[0] == 0xFF && header[1] == 0xD8) {
+    found = Format::Jpeg;
+    if (!readJpegSize(input, width, height)) return false;
+  } else if (header[0] == 0x89 && header[1] == 'P') {
+    // Signature (8), IHDR length (4) and type (4), width, height, then bit depth, color type, compression, filter and
+    // interlace. Only images PngRowSource decodes give a size, as for JPEG.
+    if (!readBytes(input, header + 2, 27) || header[2] != 'N' || header[3] != 'G' || be32(header + 12) != 0x49484452) {
+      return false;
+    }
+    if (header[28] != 0 || !PngRowSource::isSupportedFormat(header[24], header[25])) {
+      LOG_DBG("IMG", "Unsupported PNG: %d-bit, color type %d, interlace %d", header[24], header[25], header[28]);
+      return false;
+    }
+    found = Format::Png;
+    width = static_cast<int>(be32(header + 16));
+    height = static_cast<int>(be32(header + 20));
+  } else if (header[0] == 'G' && header[1] == 'I') {
+    // "GIF87a" or "GIF89a", then the logical screen width and height
+    if (!readBytes(input, header + 2, 8) || header[2] != 'F') return false;
+    found = Format::Gif;
+    width = le16(header + 6);
+    height = le16(header + 8);
+  } else if (header[0] == 'B' && header[1] == 'M') {
+    // File header (14), info header size, then the size: 16-bit in the old OS/2 header, signed 32-bit otherwise with a
+    // negative height for top-down rows
+    if (!readBytes(input, header + 2, 24)) return false;
+    found = Format::Bmp;
+    if (le32(header + 14) == 12) {
+      width = le16(header + 18);
+      height = le16(header + 20);
+    } else {
+      width = static_cast<int32_t>(le32(header + 18));
+      height = static_cast<int32_t>(le32(header + 22));
+      if (height < 0) height = -height;
+    }
+  } else {
+    return false;
+  }
+
+  if (width <= 0 || height <= 0) {
+    LOG_ERR("IMG", "Invalid image size in header: %dx%d", width, height);
+    return false;
+  }
+  if (format) *format = found;
+  return true;
+}
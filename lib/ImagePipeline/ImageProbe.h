@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+class ImageInput;
+
+// Reads an image's size from its header alone, without decoding it: the JPEG SOF segment, the PNG IHDR chunk, the GIF
+// logical screen descriptor or the BMP info header. Only the header is read, so an image still inside a ZIP is inflated
+// no further than that. JPEG frames and PNG headers the decoders reject have no size.
+namespace ImageProbe {
+enum class Format : uint8_t { Unknown, Jpeg, Png, Gif, Bmp };
+
+// Returns false if the input is not one of the formats above or ends before the size
+bool readSize(ImageInput& input, int& width, int& height, Format* format = nullptr);
+}  // namespace ImageProbe
@@ -0,0 +1,134 @@
+#include "JpegRowSource.h"
+
+#include <HalStorage.h>
+#include <Logging.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+// One MCU row of decoded gray is buffered; wider images are refused rather than exhausting the heap
+constexpr int MAX_MCU_ROW_BYTES = 65536;
+}  // namespace
+
+unsigned char JpegRowSource::readCallback(unsigned char* pBuf, const unsigned char buf_size,
+                                          unsigned char* pBytes_actually_read, void* pCallback_data) {
+  auto* source = static_cast<JpegRowSource*>(pCallback_data);
+  if (!source || !pBuf || !pBytes_actually_read) return PJPG_STREAM_READ_ERROR;
+
+  if (source->bufferPos >= source->bufferFilled) {
+    const int readCount = source->input.read(source->buffer, sizeof(source->buffer));
+    if (readCount <= 0) {
+      *pBytes_actually_read = 0;
+      return 0;  // EOF is reported to picojpeg as an empty read
+    }
+    source->bufferFilled = readCount;
+    source->bufferPos = 0;
+  }
+
+  const size_t available = source->bufferFilled - source->bufferPos;
+  const size_t toRead = available < buf_size ? available : buf_size;
+  memcpy(pBuf, source->buffer + source->bufferPos, toRead);
+  source->bufferPos += toRead;
+  *pBytes_actually_read = static_cast<unsigned char>(toRead);
+  return 0;
+}
+
+bool JpegRowSource::open() {
+  bufferPos = 0;
+  bufferFilled = 0;
+  reduction = 1;
+  const unsigned char status = pjpeg_decode_init(&imageInfo, readCallback, this, 0);
+  if (status != 0) {
+    LOG_ERR("JPG", "JPEG decode init failed with error code: %d", status);
+    return false;
+  }
+  LOG_DBG("JPG", "JPEG dimensions: %dx%d, components: %d, MCUs: %dx%d", imageInfo.m_width, imageInfo.m_height,
+          imageInfo.m_comps, imageInfo.m_MCUSPerRow, imageInfo.m_MCUSPerCol);
+  return true;
+}
+
+void JpegRowSource::reduceFor(const int outWidth, const int outHeight) {
+  reduction = 1;
+  while (reduction < maxReduction && imageInfo.m_width / (reduction * 2) >= outWidth &&
+         imageInfo.m_height / (reduction * 2) >= outHeight) {
+    reduction *= 2;
+  }
+  if (reduction > 1) {
+    LOG_DBG("JPG", "Decoding at 1/%d scale", reduction);
+  }
+}
+
+bool JpegRowSource::decode(GrayRowSink& sink) {
+  pjpeg_set_reduce(reduction == 1 ? 0 : 8 / reduction);
+
+  const int width = getWidth();
+  const int height = getHeight();
+  const int mcuRowHeight = imageInfo.m_MCUHeight / reduction;  // Decoded rows per MCU row
+  const int mcuColWidth = imageInfo.m_MCUWidth / reduction;    // Decoded columns per MCU
+  const int blockCols = imageInfo.m_MCUWidth / 8;
+  const int blockRows = imageInfo.m_MCUHeight / 8;
+  const int mcuRowPixels = width * mcuRowHeight;
+
+  if (mcuRowPixels > MAX_MCU_ROW_BYTES) {
+    LOG_ERR("JPG", "MCU row buffer too large (%d bytes), max: %d", mcuRowPixels, MAX_MCU_ROW_BYTES);
+    return false;
+  }
+  auto* mcuRow = static_cast<uint8_t*>(malloc(mcuRowPixels));
+  if (!mcuRow) {
+    LOG_ERR("JPG", "Failed to allocate MCU row buffer (%d bytes)", mcuRowPixels);
+    return false;
+  }
+
+  for (int mcuY = 0; mcuY < imageInfo.m_MCUSPerCol; mcuY++) {
+    for (int mcuX = 0; mcuX < imageInfo.m_MCUSPerRow; mcuX++) {
+      const unsigned char status = pjpeg_decode_mcu();
+      if (status != 0) {
+        if (status == PJPG_NO_MORE_BLOCKS) {
+          LOG_ERR("JPG", "Unexpected end of blocks at MCU (%d, %d)", mcuX, mcuY);
+        } else {
+          LOG_ERR("JPG", "JPEG decode MCU failed at (%d, %d) with error code: %d", mcuX, mcuY, status);
+        }
+        free(mcuRow);
+        return false;
+      }
+
+      // picojpeg lays the MCU out as 8x8 blocks two to a row whatever the sampling (H2V2 = 0,64,128,192, H2V1 = 0,64,
+      // H1V2 = 0,128). A reduced decode fills each block with reduction x reduction squares; read one from each.
+      for (int blockY = 0; blockY < blockRows; blockY++) {
+        for (int blockX = 0; blockX < blockCols; blockX++) {
+          const int blockOffset = (blockY * 2 + blockX) * 64;
+          const int outX0 = mcuX * mcuColWidth + blockX * 8 / reduction;
+          const int outY0 = blockY * 8 / reduction;
+          const int columns = width - outX0 < 8 / reduction ? width - outX0 : 8 / reduction;
+          for (int localY = 0; localY < 8; localY += reduction) {
+            uint8_t* out = mcuRow + (outY0 + localY / reduction) * width + outX0;
+            const uint8_t* r = imageInfo.m_pMCUBufR + blockOffset + localY * 8;
+            if (imageInfo.m_comps == 1) {
+              for (int i = 0; i < columns; i++) out[i] = r[i * reduction];
+              continue;
+            }
+            const uint8_t* g = imageInfo.m_pMCUBufG + blockOffset + localY * 8;
+            const uint8_t* b = imageInfo.m_pMCUBufB + blockOffset + localY * 8;
+            for (int i = 0; i < columns; i++) {
+              const int x = i * reduction;
+              out[i] = (r[x] * 77 + g[x] * 150 + b[x] * 29) >> 8;
+            }
+          }
+        }
+      }
+    }
+
+    for (int rowY = 0; rowY < mcuRowHeight; rowY++) {
+      const int y = mcuY * mcuRowHeight + rowY;
+      if (y >= height) break;
+      if (!sink.writeRow(mcuRow + rowY * width, y)) {
+        free(mcuRow);
+        return false;
+      }
+    }
+  }
+
+  free(mcuRow);
+  return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <picojpeg.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "ImageInput.h"
+#include "ImagePipeline.h"
+
+// Baseline JPEG through picojpeg, one MCU row at a time. picojpeg keeps its state in globals, so only one
+// JpegRowSource can be decoding at a time.
+class JpegRowSource final : public ImageRowSource {
+ public:
+  explicit JpegRowSource(FsFile& file) : fileInput(std::in_place, file), input(*fileInput) {}
+  explicit JpegRowSource(ImageInput& input) : input(input) {}
+  JpegRowSource(const JpegRowSource&) = delete;
+  JpegRowSource& operator=(const JpegRowSource&) = delete;
+
+  // Reads the headers; the image size is known afterwards
+  bool open();
+
+  // Size of the image in the file, before any reduction
+  int getImageWidth() const { return imageInfo.m_width; }
+  int getImageHeight() const { return imageInfo.m_height; }
+
+  int getWidth() const override { return (imageInfo.m_width + reduction - 1) / reduction; }
+  int getHeight() const override { return (imageInfo.m_height + reduction - 1) / reduction; }
+  // Decodes at 1/2, 1/4 or 1/8 scale while the reduced image still covers the output: picojpeg then runs a reduced
+  // IDCT (or none, at 1/8) and only the remaining fractional scale is left to the area scaler
+  void reduceFor(int outWidth, int outHeight) override;
+  bool decode(GrayRowSink& sink) override;
+
+  // Largest power-of-two reduction reduceFor() may pick (1 always decodes at full resolution)
+  void setMaxReduction(const int maxReduction) { this->maxReduction = maxReduction; }
+
+ private:
+  static unsigned char readCallback(unsigned char* pBuf, unsigned char buf_size, unsigned char* pBytes_actually_read,
+                                    void* pCallback_data);
+
+  std::optional<FileImageInput> fileInput;  // Set when reading a file directly
+  ImageInput& input;
+  uint8_t buffer[512] = {};
+  size_t bufferPos = 0;
+  size_t bufferFilled = 0;
+  pjpeg_image_info_t imageInfo = {};
+  int reduction = 1;
+  int maxReduction = 8;
+};
@@ -0,0 +1,375 @@
+#include "PngRowSource.h"
+
+#include <HalStorage.h>
+#include <Logging.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+constexpr uint8_t PNG_SIGNATURE[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+// Refuse rows that would not fit the heap next to the inflate state
+constexpr uint32_t MAX_RAW_ROW_BYTES = 16384;
+
+enum PngColorType : uint8_t {
+  PNG_COLOR_GRAYSCALE = 0,
+  PNG_COLOR_RGB = 2,
+  PNG_COLOR_PALETTE = 3,
+  PNG_COLOR_GRAYSCALE_ALPHA = 4,
+  PNG_COLOR_RGBA = 6,
+};
+
+enum PngFilter : uint8_t {
+  PNG_FILTER_NONE = 0,
+  PNG_FILTER_SUB = 1,
+  PNG_FILTER_UP = 2,
+  PNG_FILTER_AVERAGE = 3,
+  PNG_FILTER_PAETH = 4,
+};
+
+bool readBE32(ImageInput& input, uint32_t& value) {
+  uint8_t buf[4];
+  if (input.read(buf, 4) != 4) return false;
+  value = (static_cast<uint32_t>(buf[0]) << 24) | (static_cast<uint32_t>(buf[1]) << 16) |
+          (static_cast<uint32_t>(buf[2]) << 8) | buf[3];
+  return true;
+}
+
+inline uint8_t luma(const uint8_t r, const uint8_t g, const uint8_t b) { return (r * 77 + g * 150 + b * 29) >> 8; }
+
+// Gray over a white page
+inline uint8_t blendOverWhite(const uint8_t gray, const uint8_t alpha) { return 255 - (255 - gray) * alpha / 255; }
+
+inline uint8_t paethPredictor(const uint8_t a, const uint8_t b, const uint8_t c) {
+  const int p = static_cast<int>(a) + b - c;
+  const int pa = p > a ? p - a : a - p;
+  const int pb = p > b ? p - b : b - p;
+  const int pc = p > c ? p - c : c - p;
+  if (pa <= pb && pa <= pc) return a;
+  if (pb <= pc) return b;
+  return c;
+}
+}  // namespace
+
+PngRowSource::~PngRowSource() { release(); }
+
+bool PngRowSource::isSupportedFormat(const uint8_t bitDepth, const uint8_t colorType) {
+  switch (colorType) {
+    case PNG_COLOR_GRAYSCALE:
+      return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 || bitDepth == 16;
+    case PNG_COLOR_PALETTE:
+      return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8;
+    case PNG_COLOR_RGB:
+    case PNG_COLOR_GRAYSCALE_ALPHA:
+    case PNG_COLOR_RGBA:
+      return bitDepth == 8 || bitDepth == 16;
+    default:
+      return false;
+  }
+}
+
+void PngRowSource::release() {
+  if (inflating) mz_inflateEnd(&zstream);
+  inflating = false;
+  free(currentRow);
+  free(previousRow);
+  currentRow = nullptr;
+  previousRow = nullptr;
+}
+
+bool PngRowSource::open() {
+  uint8_t sig[8];
+  if (input.read(sig, 8) != 8 || memcmp(sig, PNG_SIGNATURE, 8) != 0) {
+    LOG_ERR("PNG", "Invalid PNG signature");
+    return false;
+  }
+
+  uint32_t ihdrLen;
+  uint8_t ihdrType[4];
+  if (!readBE32(input, ihdrLen) || input.read(ihdrType, 4) != 4 || memcmp(ihdrType, "IHDR", 4) != 0) {
+    LOG_ERR("PNG", "Missing IHDR chunk");
+    return false;
+  }
+
+  uint8_t ihdrRest[5];
+  if (!readBE32(input, width) || !readBE32(input, height) || input.read(ihdrRest, 5) != 5) return false;
+  bitDepth = ihdrRest[0];
+  colorType = ihdrRest[1];
+  const uint8_t compression = ihdrRest[2];
+  const uint8_t filter = ihdrRest[3];
+  const uint8_t interlace = ihdrRest[4];
+  input.skip(4);  // IHDR CRC
+
+  LOG_DBG("PNG", "Image: %ux%u, depth=%u, color=%u, interlace=%u", width, height, bitDepth, colorType, interlace);
+
+  if (compression != 0 || filter != 0) {
+    LOG_ERR("PNG", "Unsupported compression/filter method");
+    return false;
+  }
+  if (interlace != 0) {
+    LOG_ERR("PNG", "Interlaced PNGs not supported");
+    return false;
+  }
+  if (width == 0 || height == 0) {
+    LOG_ERR("PNG", "Zero image size (%ux%u)", width, height);
+    return false;
+  }
+  // The scanline conversion relies on this: a depth of 0 or a multi-channel pixel under 8 bits would divide by zero
+  // or read past the row
+  if (!isSupportedFormat(bitDepth, colorType)) {
+    LOG_ERR("PNG", "Unsupported bit depth %u for color type %u", bitDepth, colorType);
+    return false;
+  }
+
+  uint8_t channels;
+  switch (colorType) {
+    case PNG_COLOR_GRAYSCALE:
+    case PNG_COLOR_PALETTE:
+      channels = 1;
+      break;
+    case PNG_COLOR_GRAYSCALE_ALPHA:
+      channels = 2;
+      break;
+    case PNG_COLOR_RGB:
+      channels = 3;
+      break;
+    case PNG_COLOR_RGBA:
+      channels = 4;
+      break;
+    default:
+      LOG_ERR("PNG", "Unsupported color type: %d", colorType);
+      return false;
+  }
+  const uint32_t bitsPerPixel = channels * bitDepth;
+  bytesPerPixel = bitsPerPixel < 8 ? 1 : bitsPerPixel / 8;
+  rawRowBytes = (width * bitsPerPixel + 7) / 8;
+  if (rawRowBytes > MAX_RAW_ROW_BYTES) {
+    LOG_ERR("PNG", "Row too large: %u bytes", rawRowBytes);
+    return false;
+  }
+  return true;
+}
+
+// Collects PLTE and tRNS up to the first IDAT chunk
+bool PngRowSource::readChunksToImageData() {
+  uint8_t palette[256 * 3];
+  for (int i = 0; i < 256; i++) paletteAlpha[i] = 255;
+
+  while (true) {
+    uint32_t chunkLen;
+    uint8_t chunkType[4];
+    if (!readBE32(input, chunkLen) || input.read(chunkType, 4) != 4) break;
+
+    if (memcmp(chunkType, "IDAT", 4) == 0) {
+      chunkBytesRemaining = chunkLen;
+      for (int i = 0; i < paletteSize; i++) {
+        paletteGray[i] = blendOverWhite(luma(palette[i * 3], palette[i * 3 + 1], palette[i * 3 + 2]), paletteAlpha[i]);
+      }
+      return true;
+    }
+    if (memcmp(chunkType, "IEND", 4) == 0) break;
+
+    uint32_t consumed = 0;
+    if (memcmp(chunkType, "PLTE", 4) == 0) {
+      paletteSize = chunkLen / 3 > 256 ? 256 : chunkLen / 3;
+      consumed = paletteSize * 3;
+      if (input.read(palette, consumed) != static_cast<int>(consumed)) break;
+    } else if (memcmp(chunkType, "tRNS", 4) == 0 && colorType == PNG_COLOR_PALETTE) {
+      consumed = chunkLen > 256 ? 256 : chunkLen;
+      if (input.read(paletteAlpha, consumed) != static_cast<int>(consumed)) break;
+    }
+    // The rest of the chunk and its CRC
+    if (!input.skip(chunkLen - consumed + 4)) break;
+  }
+
+  LOG_ERR("PNG", "No IDAT chunk found");
+  return false;
+}
+
+// Refills the inflate input from the current IDAT chunk, moving on to the next one when it runs out. Returns the
+// number of bytes made available, 0 after the last IDAT chunk, or -1 on a read error.
+int PngRowSource::feedInflate() {
+  if (imageDataFinished) return 0;
+
+  while (chunkBytesRemaining == 0) {
+    // CRC of the finished chunk, then the next chunk header
+    uint32_t chunkLen;
+    uint8_t chunkType[4];
+    if (!input.skip(4) || !readBE32(input, chunkLen) || input.read(chunkType, 4) != 4 ||
+        memcmp(chunkType, "IDAT", 4) != 0) {
+      imageDataFinished = true;
+      return 0;
+    }
+    chunkBytesRemaining = chunkLen;
+  }
+
+  const size_t toRead = chunkBytesRemaining < sizeof(readBuf) ? chunkBytesRemaining : sizeof(readBuf);
+  const int bytesRead = input.read(readBuf, toRead);
+  if (bytesRead <= 0) return -1;
+
+  chunkBytesRemaining -= bytesRead;
+  zstream.next_in = readBuf;
+  zstream.avail_in = bytesRead;
+  return bytesRead;
+}
+
+bool PngRowSource::inflateBytes(uint8_t* dest, const size_t needed) {
+  zstream.next_out = dest;
+  zstream.avail_out = needed;
+
+  while (zstream.avail_out > 0) {
+    if (zstream.avail_in == 0) {
+      const int fed = feedInflate();
+      if (fed < 0) return false;
+      if (fed == 0) {
+        // No more input: whatever inflate still holds has to finish the request
+        mz_inflate(&zstream, MZ_SYNC_FLUSH);
+        return zstream.avail_out == 0;
+      }
+    }
+
+    const int ret = mz_inflate(&zstream, MZ_SYNC_FLUSH);
+    if (ret != MZ_OK && ret != MZ_STREAM_END && ret != MZ_BUF_ERROR) {
+      LOG_ERR("PNG", "zlib inflate error: %d", ret);
+      return false;
+    }
+    if (ret == MZ_STREAM_END) break;
+  }
+  return zstream.avail_out == 0;
+}
+
+// Inflates the filter byte and one scanline into currentRow and undoes the filter
+bool PngRowSource::decodeScanline() {
+  uint8_t filterType;
+  if (!inflateBytes(&filterType, 1) || !inflateBytes(currentRow, rawRowBytes)) return false;
+
+  const uint32_t bpp = bytesPerPixel;
+  uint8_t* row = currentRow;
+  const uint8_t* prev = previousRow;
+  switch (filterType) {
+    case PNG_FILTER_NONE:
+      break;
+    case PNG_FILTER_SUB:
+      for (uint32_t i = bpp; i < rawRowBytes; i++) row[i] += row[i - bpp];
+      break;
+    case PNG_FILTER_UP:
+      for (uint32_t i = 0; i < rawRowBytes; i++) row[i] += prev[i];
+      break;
+    case PNG_FILTER_AVERAGE:
+      for (uint32_t i = 0; i < bpp; i++) row[i] += prev[i] / 2;
+      for (uint32_t i = bpp; i < rawRowBytes; i++) row[i] += (row[i - bpp] + prev[i]) / 2;
+      break;
+    case PNG_FILTER_PAETH:
+      for (uint32_t i = 0; i < bpp; i++) row[i] += prev[i];
+      for (uint32_t i = bpp; i < rawRowBytes; i++) row[i] += paethPredictor(row[i - bpp], prev[i], prev[i - bpp]);
+      break;
+    default:
+      LOG_ERR("PNG", "Unknown filter type: %d", filterType);
+      return false;
+  }
+  return true;
+}
+
+// Branches once on the pixel format, then runs a tight loop for the whole row. 16-bit samples use their high byte.
+void PngRowSource::scanlineToGray(uint8_t* gray) const {
+  const uint8_t* src = currentRow;
+  const uint32_t w = width;
+  const uint32_t stride = bitDepth == 16 ? 2 : 1;  // Bytes per sample
+
+  switch (colorType) {
+    case PNG_COLOR_GRAYSCALE:
+      if (bitDepth == 8) {
+        memcpy(gray, src, w);
+      } else if (bitDepth == 16) {
+        for (uint32_t x = 0; x < w; x++) gray[x] = src[x * 2];
+      } else {
+        const int perByte = 8 / bitDepth;
+        const uint8_t mask = (1 << bitDepth) - 1;
+        for (uint32_t x = 0; x < w; x++) {
+          const int shift = (perByte - 1 - x % perByte) * bitDepth;
+          gray[x] = (src[x / perByte] >> shift & mask) * 255 / mask;
+        }
+      }
+      break;
+
+    case PNG_COLOR_PALETTE:
+      if (bitDepth == 8) {
+        for (uint32_t x = 0; x < w; x++) gray[x] = paletteGray[src[x]];
+      } else {
+        const int perByte = 8 / bitDepth;
+        const uint8_t mask = (1 << bitDepth) - 1;
+        for (uint32_t x = 0; x < w; x++) {
+          const int shift = (perByte - 1 - x % perByte) * bitDepth;
+          gray[x] = paletteGray[src[x / perByte] >> shift & mask];
+        }
+      }
+      break;
+
+    case PNG_COLOR_GRAYSCALE_ALPHA:
+      for (uint32_t x = 0; x < w; x++) gray[x] = blendOverWhite(src[x * 2 * stride], src[(x * 2 + 1) * stride]);
+      break;
+
+    case PNG_COLOR_RGB:
+      for (uint32_t x = 0; x < w; x++) {
+        const uint8_t* p = src + x * 3 * stride;
+        gray[x] = luma(p[0], p[stride], p[2 * stride]);
+      }
+      break;
+
+    case PNG_COLOR_RGBA:
+      for (uint32_t x = 0; x < w; x++) {
+        const uint8_t* p = src + x * 4 * stride;
+        gray[x] = blendOverWhite(luma(p[0], p[stride], p[2 * stride]), p[3 * stride]);
+      }
+      break;
+
+    default:
+      memset(gray, 128, w);
+      break;
+  }
+}
+
+bool PngRowSource::decode(GrayRowSink& sink) {
+  if (!readChunksToImageData()) return false;
+
+  currentRow = static_cast<uint8_t*>(malloc(rawRowBytes));
+  previousRow = static_cast<uint8_t*>(calloc(rawRowBytes, 1));
+  auto* gray = static_cast<uint8_t*>(malloc(width));
+  if (!currentRow || !previousRow || !gray) {
+    LOG_ERR("PNG", "Failed to allocate scanline buffers (%u bytes each)", rawRowBytes);
+    free(gray);
+    release();
+    return false;
+  }
+
+  memset(&zstream, 0, sizeof(zstream));
+  if (mz_inflateInit(&zstream) != MZ_OK) {
+    LOG_ERR("PNG", "Failed to initialize zlib");
+    free(gray);
+    release();
+    return false;
+  }
+  inflating = true;
+
+  bool success = true;
+  for (uint32_t y = 0; y < height; y++) {
+    if (!decodeScanline()) {
+      LOG_ERR("PNG", "Failed to decode scanline %u", y);
+      success = false;
+      break;
+    }
+    scanlineToGray(gray);
+    if (!sink.writeRow(gray, y)) {
+      success = false;
+      break;
+    }
+    uint8_t* temp = previousRow;
+    previousRow = currentRow;
+    currentRow = temp;
+  }
+
+  free(gray);
+  release();
+  return success;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <miniz.h>
+
+#include <cstdint>
+#include <optional>
+
+#include "ImageInput.h"
+#include "ImagePipeline.h"
+
+// Non-interlaced PNG of any color type and bit depth, one scanline at a time through miniz. Alpha channels and palette
+// transparency are blended over white (the page). Inflating needs about 43 KB while decode() runs.
+class PngRowSource final : public ImageRowSource {
+ public:
+  explicit PngRowSource(FsFile& file) : fileInput(std::in_place, file), input(*fileInput) {}
+  explicit PngRowSource(ImageInput& input) : input(input) {}
+  ~PngRowSource() override;
+  PngRowSource(const PngRowSource&) = delete;
+  PngRowSource& operator=(const PngRowSource&) = delete;
+
+  // Reads the signature and IHDR; the image size is known afterwards
+  bool open();
+  // Whether the IHDR bit depth and color type are a pair the PNG specification allows
+  static bool isSupportedFormat(uint8_t bitDepth, uint8_t colorType);
+
+  int getWidth() const override { return static_cast<int>(width); }
+  int getHeight() const override { return static_cast<int>(height); }
+  bool decode(GrayRowSink& sink) override;
+
+ private:
+  bool readChunksToImageData();
+  int feedInflate();
+  bool inflateBytes(uint8_t* dest, size_t needed);
+  bool decodeScanline();
+  void scanlineToGray(uint8_t* gray) const;
+  void release();
+
+  std::optional<FileImageInput> fileInput;  // Set when reading a file directly
+  ImageInput& input;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint8_t bitDepth = 0;
+  uint8_t colorType = 0;
+  uint8_t bytesPerPixel = 0;  // Filter stride: whole bytes per pixel, at least 1
+  uint32_t rawRowBytes = 0;   // Bytes per scanline without the filter byte
+
+  uint8_t* currentRow = nullptr;
+  uint8_t* previousRow = nullptr;
+  mz_stream zstream = {};
+  bool inflating = false;
+  uint32_t chunkBytesRemaining = 0;  // Left in the current IDAT chunk
+  bool imageDataFinished = false;
+  uint8_t readBuf[2048] = {};
+
+  // Palette entries as gray, blended with their tRNS alpha before the first scanline
+  uint8_t paletteGray[256] = {};
+  uint8_t paletteAlpha[256] = {};
+  int paletteSize = 0;
+};
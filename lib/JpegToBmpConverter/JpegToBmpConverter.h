@@ -1,13 +1,12 @@
 #pragma once
 
 class FsFile;
+class ImageInput;
 class Print;
 class ZipFile;
 
 class JpegToBmpConverter {
-  static unsigned char jpegReadCallback(unsigned char* pBuf, unsigned char buf_size,
-                                        unsigned char* pBytes_actually_read, void* pCallback_data);
-  static bool jpegFileToBmpStreamInternal(class FsFile& jpegFile, Print& bmpOut, int targetWidth, int targetHeight,
+  static bool jpegFileToBmpStreamInternal(ImageInput& jpeg, Print& bmpOut, int targetWidth, int targetHeight,
                                           bool oneBit, bool crop = true);
 
  public:
@@ -16,4 +15,10 @@ class JpegToBmpConverter {
   static bool jpegFileToBmpStreamWithSize(FsFile& jpegFile, Print& bmpOut, int targetMaxWidth, int targetMaxHeight);
   // Convert to 1-bit BMP (black and white only, no grays) for fast home screen rendering
   static bool jpegFileTo1BitBmpStreamWithSize(FsFile& jpegFile, Print& bmpOut, int targetMaxWidth, int targetMaxHeight);
+  // The same conversions from any input, e.g. an EPUB cover inflated straight out of the ZIP
+  static bool jpegToBmpStream(ImageInput& jpeg, Print& bmpOut, bool crop = true);
+  static bool jpegTo1BitBmpStreamWithSize(ImageInput& jpeg, Print& bmpOut, int targetMaxWidth, int targetMaxHeight);
+  // Largest power-of-two scale (1, 2, 4 or 8) a large JPEG may be decoded at before prescaling. Defaults to 8; 1
+  // decodes at full resolution, which the JPEG decode benchmark compares against.
+  static void setMaxDecodeReduction(int reduction);
 };
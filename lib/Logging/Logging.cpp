@@ -1,47 +1,211 @@
 #include "Logging.h"
 
-// Since logging can take a large amount of flash, we want to make the format string as short as possible.
-// This logPrintf prepend the timestamp, level and origin to the user-provided message, so that the user only needs to
-// provide the format string for the message itself.
-void logPrintf(const char* level, const char* origin, const char* format, ...) {
-  if (!logSerial) {
-    return;  // Serial not initialized, skip logging
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+
+namespace {
+// Two buffers: LOG_* calls append to one while logFlush() formats the other
+constexpr size_t BUFFER_SIZE = 2048;
+
+struct Record {
+  uint32_t timestampMs;
+  const char* level;
+  const char* origin;
+  const char* format;
+  uint16_t suppressed;
+  uint16_t argsSize;
+};
+
+uint8_t buffers[2][BUFFER_SIZE];
+uint8_t* filling = buffers[0];
+uint8_t* draining = buffers[1];
+size_t fillingSize = 0;
+std::atomic<bool> deferred{false};
+
+// Guards `filling` and its size
+SemaphoreHandle_t bufferMutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+// Held by whoever formats `draining`
+SemaphoreHandle_t flushMutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+// Reads the next argument; false when the record has run out
+bool nextArg(const uint8_t*& args, const uint8_t* end, uint8_t& tag, uint64_t& bits, const char*& string) {
+  if (args >= end) return false;
+  tag = *args++;
+  if (tag == logging::ARG_STRING) {
+    string = reinterpret_cast<const char*>(args);
+    args += strlen(string) + 1;
+    return true;
   }
-  va_list args;
-  va_start(args, format);
-  char buf[256];
-  char* c = buf;
-  // add the timestamp
-  {
-    unsigned long ms = millis();
-    int len = snprintf(c, sizeof(buf), "[%lu] ", ms);
-    if (len < 0) {
-      return;  // encoding error, skip logging
-    }
-    c += len;
+  memcpy(&bits, args, sizeof(bits));
+  args += sizeof(bits);
+  return true;
+}
+
+// Bytes printf would read for an integer conversion with this length modifier
+size_t integerWidth(const char* modifier, const size_t length) {
+  if (length == 0) return sizeof(int);
+  switch (modifier[0]) {
+    case 'h':
+      return length == 2 ? sizeof(char) : sizeof(short);
+    case 'l':
+      return length == 2 ? sizeof(long long) : sizeof(long);
+    case 'z':
+      return sizeof(size_t);
+    case 'j':
+      return sizeof(intmax_t);
+    case 't':
+      return sizeof(ptrdiff_t);
+    default:
+      return sizeof(long long);
   }
-  // add the level
-  {
-    const char* p = level;
-    size_t remaining = sizeof(buf) - (c - buf);
-    while (*p && remaining > 1) {
-      *c++ = *p++;
-      remaining--;
+}
+
+// printf for the stored arguments: each conversion is re-issued on its own with a long long or double argument,
+// truncated to the width its length modifier names, so it prints what printf would have at the call site
+int formatMessage(char* out, const size_t outSize, const char* format, const uint8_t* args, const size_t argsSize) {
+  const uint8_t* const end = args + argsSize;
+  size_t used = 0;
+  auto emit = [&](const int length) {
+    if (length > 0) used = std::min(used + static_cast<size_t>(length), outSize - 1);
+  };
+
+  for (const char* p = format; *p && used < outSize - 1; p++) {
+    if (*p != '%') {
+      out[used++] = *p;
+      continue;
     }
-    if (remaining > 1) {
-      *c++ = ' ';
+    if (p[1] == '%') {
+      out[used++] = '%';
+      p++;
+      continue;
     }
-  }
-  // add the origin
-  {
-    int len = snprintf(c, sizeof(buf) - (c - buf), "[%s] ", origin);
-    if (len < 0) {
-      return;  // encoding error, skip logging
+
+    // Flags, width and precision are kept, the length modifier is replaced
+    char spec[24] = "%";
+    size_t specLength = 1;
+    p++;
+    while (*p && strchr("-+ #0123456789.", *p) && specLength < sizeof(spec) - 4) spec[specLength++] = *p++;
+    const char* modifier = p;
+    while (*p && strchr("hlzjtL", *p)) p++;
+    const size_t width = integerWidth(modifier, p - modifier);
+    const char conversion = *p;
+    if (!conversion) break;
+
+    uint8_t tag = 0;
+    uint64_t bits = 0;
+    const char* string = nullptr;
+    if (!nextArg(args, end, tag, bits, string)) {
+      emit(snprintf(out + used, outSize - used, "?"));
+      continue;
     }
-    c += len;
+    double real;
+    memcpy(&real, &bits, sizeof(real));
+    const bool isReal = tag == logging::ARG_DOUBLE;
+    long long integer = isReal ? static_cast<long long>(real) : static_cast<long long>(bits);
+    unsigned long long unsignedInteger = static_cast<unsigned long long>(integer);
+    if (width < sizeof(long long)) {
+      const unsigned shift = (sizeof(long long) - width) * 8;
+      unsignedInteger = unsignedInteger << shift >> shift;
+      integer = static_cast<long long>(unsignedInteger << shift) >> shift;
+    }
+
+    if (strchr("di", conversion)) {
+      memcpy(spec + specLength, "lld", 4);
+      emit(snprintf(out + used, outSize - used, spec, integer));
+    } else if (strchr("ouxX", conversion)) {
+      const char modified[4] = {'l', 'l', conversion, '\0'};
+      memcpy(spec + specLength, modified, 4);
+      emit(snprintf(out + used, outSize - used, spec, unsignedInteger));
+    } else if (strchr("fFeEgGaA", conversion)) {
+      spec[specLength++] = conversion;
+      spec[specLength] = '\0';
+      emit(snprintf(out + used, outSize - used, spec, isReal ? real : static_cast<double>(integer)));
+    } else if (conversion == 'c') {
+      memcpy(spec + specLength, "c", 2);
+      emit(snprintf(out + used, outSize - used, spec, static_cast<int>(integer)));
+    } else if (conversion == 's') {
+      memcpy(spec + specLength, "s", 2);
+      emit(snprintf(out + used, outSize - used, spec, tag == logging::ARG_STRING ? string : "?"));
+    } else if (conversion == 'p') {
+      emit(snprintf(out + used, outSize - used, "0x%llx", static_cast<unsigned long long>(bits)));
+    } else {
+      emit(snprintf(out + used, outSize - used, "?"));
+    }
+  }
+  out[used] = '\0';
+  return static_cast<int>(used);
+}
+
+// Lines read "[timestamp] [LEVEL] [origin] message", timestamped when the LOG_* call was made
+void writeRecord(const Record& record, const uint8_t* args) {
+  char buf[256];
+  if (record.suppressed) {
+    snprintf(buf, sizeof(buf), "[%lu] %s [%s] (%u repeats suppressed)\n",
+             static_cast<unsigned long>(record.timestampMs), record.level, record.origin, record.suppressed);
+    logSerial.print(buf);
+  }
+  const int prefix = snprintf(buf, sizeof(buf), "[%lu] %s [%s] ", static_cast<unsigned long>(record.timestampMs),
+                              record.level, record.origin);
+  if (prefix < 0) {
+    return;  // encoding error, skip logging
   }
-  // add the user message
-  vsnprintf(c, sizeof(buf) - (c - buf), format, args);
-  va_end(args);
+  formatMessage(buf + prefix, sizeof(buf) - prefix, record.format, args, record.argsSize);
   logSerial.print(buf);
 }
+}  // namespace
+
+void logging::append(const char* level, const char* origin, const char* format, const uint16_t suppressed,
+                     const uint8_t* args, const size_t argsSize) {
+  const Record record = {static_cast<uint32_t>(millis()), level, origin, format, suppressed,
+                         static_cast<uint16_t>(argsSize)};
+  const size_t size = sizeof(record) + argsSize;
+
+  xSemaphoreTake(bufferMutex(), portMAX_DELAY);
+  while (fillingSize + size > BUFFER_SIZE) {
+    // Full: write out what is there now rather than drop the line
+    xSemaphoreGive(bufferMutex());
+    logFlush();
+    xSemaphoreTake(bufferMutex(), portMAX_DELAY);
+  }
+  memcpy(filling + fillingSize, &record, sizeof(record));
+  memcpy(filling + fillingSize + sizeof(record), args, argsSize);
+  fillingSize += size;
+  xSemaphoreGive(bufferMutex());
+
+  if (!deferred.load(std::memory_order_relaxed)) logFlush();
+}
+
+void logFlush() {
+  xSemaphoreTake(flushMutex(), portMAX_DELAY);
+  xSemaphoreTake(bufferMutex(), portMAX_DELAY);
+  std::swap(filling, draining);
+  const size_t size = fillingSize;
+  fillingSize = 0;
+  xSemaphoreGive(bufferMutex());
+
+  for (size_t offset = 0; offset < size;) {
+    Record record;
+    memcpy(&record, draining + offset, sizeof(record));
+    offset += sizeof(record);
+    writeRecord(record, draining + offset);
+    offset += record.argsSize;
+  }
+  xSemaphoreGive(flushMutex());
+}
+
+void logSetDeferred(const bool defer) {
+  deferred.store(defer, std::memory_order_relaxed);
+  if (!defer) logFlush();
+}
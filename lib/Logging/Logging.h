@@ -2,6 +2,10 @@
 
 #include <HardwareSerial.h>
 
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
 /*
 Define ENABLE_SERIAL_LOG to enable logging
 Can be set in platformio.ini build_flags or as a compile definition
@@ -27,23 +31,155 @@ won't trigger deprecation warnings.
 
 static HWCDC& logSerial = Serial;
 
-void logPrintf(const char* level, const char* origin, const char* format, ...);
+/*
+LOG_* calls do not format at the call site. The arguments are copied into a RAM buffer (string arguments by value,
+since they may not outlive the call) and logFlush() formats and writes the lines later. The firmware runs logFlush()
+from an idle-priority task once logSetDeferred(true) is called, so formatting and the USB CDC writes stay off the
+render path; until then, and on the host, every call flushes straight away. A call that finds the buffer full flushes
+it itself, so lines are never dropped, only written late.
+
+Each call site is rate limited: after LOG_SITE_BURST lines within a second the rest are counted, and the next line
+that gets through is preceded by "(N repeats suppressed)". A clipped glyph hitting the out-of-range check in
+GfxRenderer::drawPixel costs a counter increment per pixel instead of a formatted serial line.
+*/
+#define LOG_SITE_BURST 20
+#define LOG_SITE_WINDOW_MS 1000
+
+// Rate limit state of one LOG_* call site
+struct LogSite {
+  uint32_t windowStartMs = 0;
+  uint16_t count = 0;
+  uint16_t suppressed = 0;
+};
+
+namespace logging {
+// Argument kinds as stored in the buffer, each followed by its value
+enum ArgTag : uint8_t { ARG_INT, ARG_UINT, ARG_DOUBLE, ARG_STRING, ARG_POINTER };
+
+constexpr size_t MAX_STRING_ARG = 95;
+
+// Packs arguments into a buffer the caller sized with packedSize() for the whole argument list
+struct Args {
+  uint8_t* data;
+  size_t size = 0;
+
+  void put(const ArgTag tag, const void* value, const size_t length) {
+    data[size++] = tag;
+    memcpy(data + size, value, length);
+    size += length;
+  }
+  void putString(const char* value) {
+    if (!value) value = "(null)";
+    size_t length = 0;
+    while (length < MAX_STRING_ARG && value[length]) length++;
+    data[size++] = ARG_STRING;
+    memcpy(data + size, value, length);
+    size += length;
+    data[size++] = '\0';
+  }
+};
+
+template <typename T>
+constexpr bool isStringArg() {
+  using Type = std::decay_t<T>;
+  return std::is_same_v<Type, char*> || std::is_same_v<Type, const char*>;
+}
+
+// Largest number of bytes packArg() stores for an argument of type T
+template <typename T>
+constexpr size_t packedSize() {
+  return isStringArg<T>() ? 2 + MAX_STRING_ARG : 1 + sizeof(uint64_t);
+}
+
+template <typename T>
+void packArg(Args& args, const T& value) {
+  using Type = std::decay_t<T>;
+  if constexpr (isStringArg<T>()) {
+    args.putString(value);
+  } else if constexpr (std::is_enum_v<Type>) {
+    packArg(args, static_cast<std::underlying_type_t<Type>>(value));
+  } else if constexpr (std::is_floating_point_v<Type>) {
+    const double stored = value;
+    args.put(ARG_DOUBLE, &stored, sizeof(stored));
+  } else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>) {
+    const int64_t stored = value;
+    args.put(ARG_INT, &stored, sizeof(stored));
+  } else if constexpr (std::is_integral_v<Type>) {
+    const uint64_t stored = value;
+    args.put(ARG_UINT, &stored, sizeof(stored));
+  } else if constexpr (std::is_pointer_v<Type> || std::is_null_pointer_v<Type>) {
+    const uint64_t stored = reinterpret_cast<uintptr_t>(value);
+    args.put(ARG_POINTER, &stored, sizeof(stored));
+  } else {
+    static_assert(sizeof(Type) == 0, "LOG_* arguments must be numbers, enums, pointers or C strings");
+  }
+}
+
+// Returns false if the call site is over its rate limit; otherwise `suppressed` is the number of calls dropped since
+// the last line that got through
+inline bool admit(LogSite& site, uint16_t& suppressed) {
+  const uint32_t now = millis();
+  if (now - site.windowStartMs >= LOG_SITE_WINDOW_MS) {
+    site.windowStartMs = now;
+    site.count = 0;
+  }
+  if (site.count >= LOG_SITE_BURST) {
+    if (site.suppressed < UINT16_MAX) site.suppressed++;
+    return false;
+  }
+  site.count++;
+  suppressed = site.suppressed;
+  site.suppressed = 0;
+  return true;
+}
+
+void append(const char* level, const char* origin, const char* format, uint16_t suppressed, const uint8_t* args,
+            size_t argsSize);
+}  // namespace logging
+
+template <typename... Values>
+void logDeferred(LogSite& site, const char* level, const char* origin, const char* format, const Values&... values) {
+  if (!logSerial) {
+    return;  // Serial not initialized, skip logging
+  }
+  uint16_t suppressed;
+  if (!logging::admit(site, suppressed)) {
+    return;
+  }
+  // Sized for this argument list, so a line of numbers costs a few dozen bytes of stack rather than a fixed block
+  uint8_t data[(logging::packedSize<Values>() + ... + 1)];
+  logging::Args args{data};
+  (logging::packArg(args, values), ...);
+  logging::append(level, origin, format, suppressed, data, args.size);
+}
+
+// Formats and writes the buffered lines
+void logFlush();
+// Leaves flushing to the caller of logFlush() (the firmware's log task) instead of every LOG_* call
+void logSetDeferred(bool deferred);
+
+// One LogSite per expansion: each lambda expression is a distinct type with its own static
+#define LOG_SITE() ([]() -> LogSite& { \
+  static LogSite site;                  \
+  return site;                          \
+}())
+#define LOG_AT(level, origin, format, ...) logDeferred(LOG_SITE(), level, origin, format "\n", ##__VA_ARGS__)
 
 #ifdef ENABLE_SERIAL_LOG
 #if LOG_LEVEL >= 0
-#define LOG_ERR(origin, format, ...) logPrintf("[ERR]", origin, format "\n", ##__VA_ARGS__)
+#define LOG_ERR(origin, format, ...) LOG_AT("[ERR]", origin, format, ##__VA_ARGS__)
 #else
 #define LOG_ERR(origin, format, ...)
 #endif
 
 #if LOG_LEVEL >= 1
-#define LOG_INF(origin, format, ...) logPrintf("[INF]", origin, format "\n", ##__VA_ARGS__)
+#define LOG_INF(origin, format, ...) LOG_AT("[INF]", origin, format, ##__VA_ARGS__)
 #else
 #define LOG_INF(origin, format, ...)
 #endif
 
 #if LOG_LEVEL >= 2
-#define LOG_DBG(origin, format, ...) logPrintf("[DBG]", origin, format "\n", ##__VA_ARGS__)
+#define LOG_DBG(origin, format, ...) LOG_AT("[DBG]", origin, format, ##__VA_ARGS__)
 #else
 #define LOG_DBG(origin, format, ...)
 #endif
@@ -0,0 +1,58 @@
+#include "Trace.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Logging.h"
+
+std::atomic<bool> Trace::enabled{false};
+std::atomic<uint32_t> Trace::recorded{0};
+Trace::Event* Trace::events = nullptr;
+
+bool Trace::enable() {
+  if (!events) {
+    events = static_cast<Event*>(calloc(CAPACITY, sizeof(Event)));
+    if (!events) {
+      LOG_ERR("TRC", "Failed to allocate trace ring (%zu bytes)", CAPACITY * sizeof(Event));
+      return false;
+    }
+  }
+  enabled.store(true, std::memory_order_relaxed);
+  LOG_INF("TRC", "Tracing enabled, %zu event ring", CAPACITY);
+  return true;
+}
+
+size_t Trace::getEventCount() {
+  const uint32_t count = recorded.load(std::memory_order_relaxed);
+  return count < CAPACITY ? count : CAPACITY;
+}
+
+void Trace::record(const char* name, const uint32_t startUs, const uint32_t endUs) {
+  // Spans can end on the render task and the main loop at once; each claims its own slot
+  const uint32_t index = recorded.fetch_add(1, std::memory_order_relaxed) % CAPACITY;
+  events[index] = {name, startUs, endUs - startUs,
+                   static_cast<uint32_t>(reinterpret_cast<uintptr_t>(xTaskGetCurrentTaskHandle()))};
+}
+
+void Trace::writeChromeJson(const std::function<void(const char*)>& writeLine) {
+  const bool wasEnabled = enabled.exchange(false, std::memory_order_relaxed);
+  writeLine("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  if (events) {
+    const uint32_t count = recorded.load(std::memory_order_relaxed);
+    const uint32_t first = count > CAPACITY ? count - CAPACITY : 0;
+    char line[160];
+    for (uint32_t i = first; i < count; i++) {
+      const Event& event = events[i % CAPACITY];
+      snprintf(line, sizeof(line),
+               "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%" PRIu32 ",\"dur\":%" PRIu32 ",\"pid\":1,\"tid\":%" PRIu32 "}%s",
+               event.name, event.startUs, event.durationUs, event.task, i + 1 < count ? "," : "");
+      writeLine(line);
+    }
+  }
+  writeLine("]}");
+  enabled.store(wasEnabled, std::memory_order_relaxed);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/*
+Timing spans for the slow stages (zip inflate, XML parse, layout, serialize, render, display refresh, SD I/O).
+
+Wrap a stage in TRACE_SPAN("name") and the time until the end of the enclosing scope is recorded into a fixed ring of
+the most recent events, with microsecond timestamps and the FreeRTOS task it ran on. Recording is off until
+Trace::enable() (serial command TRACE_ON, or POST /api/trace on the web server); while off a span costs one flag test.
+The ring is allocated on first enable and kept afterwards.
+
+Trace::writeChromeJson() writes the events in Chrome trace-event format, one event per line, for chrome://tracing or
+ui.perfetto.dev. Serial command TRACE_DUMP frames it in TRACE_START / TRACE_END lines, which
+scripts/debugging_monitor.py saves to trace.json; GET /api/trace serves it directly.
+
+Span names are stored by pointer and written unescaped, so they must be string literals.
+*/
+class Trace {
+ public:
+  static constexpr size_t CAPACITY = 512;
+
+  // Starts recording. Returns false if the ring could not be allocated.
+  static bool enable();
+  static void disable() { enabled.store(false, std::memory_order_relaxed); }
+  static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+  // Drops the recorded events
+  static void clear() { recorded.store(0, std::memory_order_relaxed); }
+  // Events currently held (at most CAPACITY)
+  static size_t getEventCount();
+
+  static void record(const char* name, uint32_t startUs, uint32_t endUs);
+  // Writes the held events, oldest first, as lines of a Chrome trace-event JSON document. Recording is paused while
+  // writing so the ring is not overwritten under the reader.
+  static void writeChromeJson(const std::function<void(const char*)>& writeLine);
+
+ private:
+  struct Event {
+    const char* name;
+    uint32_t startUs;
+    uint32_t durationUs;
+    uint32_t task;
+  };
+
+  static std::atomic<bool> enabled;
+  static std::atomic<uint32_t> recorded;
+  static Event* events;
+};
+
+class TraceSpan {
+ public:
+  explicit TraceSpan(const char* spanName)
+      : name(Trace::isEnabled() ? spanName : nullptr), startUs(name ? micros() : 0) {}
+  ~TraceSpan() {
+    if (name) Trace::record(name, startUs, micros());
+  }
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  const char* name;
+  uint32_t startUs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
@@ -1,14 +1,18 @@
 #pragma once
 
 class FsFile;
+class ImageInput;
 class Print;
 
 class PngToBmpConverter {
-  static bool pngFileToBmpStreamInternal(FsFile& pngFile, Print& bmpOut, int targetWidth, int targetHeight, bool oneBit,
+  static bool pngFileToBmpStreamInternal(ImageInput& png, Print& bmpOut, int targetWidth, int targetHeight, bool oneBit,
                                          bool crop = true);
 
  public:
   static bool pngFileToBmpStream(FsFile& pngFile, Print& bmpOut, bool crop = true);
   static bool pngFileToBmpStreamWithSize(FsFile& pngFile, Print& bmpOut, int targetMaxWidth, int targetMaxHeight);
   static bool pngFileTo1BitBmpStreamWithSize(FsFile& pngFile, Print& bmpOut, int targetMaxWidth, int targetMaxHeight);
+  // The same conversions from any input, e.g. an EPUB cover inflated straight out of the ZIP
+  static bool pngToBmpStream(ImageInput& png, Print& bmpOut, bool crop = true);
+  static bool pngTo1BitBmpStreamWithSize(ImageInput& png, Print& bmpOut, int targetMaxWidth, int targetMaxHeight);
 };
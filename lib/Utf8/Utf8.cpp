@@ -1,5 +1,7 @@
 #include "Utf8.h"
 
+#include <cstring>
+
 int utf8CodepointLen(const unsigned char c) {
   if (c < 0x80) return 1;          // 0xxxxxxx
   if ((c >> 5) == 0x6) return 2;   // 110xxxxx
@@ -30,6 +32,66 @@ uint32_t utf8NextCodepoint(const unsigned char** string) {
   return cp;
 }
 
+namespace {
+// SWAR constants for the native word size (4 bytes on the device, 8 on 64-bit hosts)
+using Word = uintptr_t;
+constexpr Word ONES = ~Word{0} / 0xFF;   // 0x0101...01
+constexpr Word HIGH_BITS = ONES * 0x80;  // 0x8080...80
+
+// True if any byte of the word is zero
+inline bool hasZeroByte(const Word w) { return ((w - ONES) & ~w & HIGH_BITS) != 0; }
+}  // namespace
+
+size_t utf8NextCodepoints(const unsigned char** string, uint32_t* out, const size_t maxCount) {
+  const unsigned char* s = *string;
+  size_t count = 0;
+
+  while (count < maxCount) {
+    const unsigned char c = *s;
+    if (c < 0x80) {
+      if (c == 0) {
+        break;
+      }
+      // Only aligned words are loaded: they cannot cross into another page, so reading past the terminator within
+      // the word is safe (the same trick strlen implementations use).
+      if ((reinterpret_cast<uintptr_t>(s) & (sizeof(Word) - 1)) == 0 && maxCount - count >= sizeof(Word)) {
+        Word w;
+        memcpy(&w, s, sizeof(Word));
+        if ((w & HIGH_BITS) == 0 && !hasZeroByte(w)) {
+          for (size_t i = 0; i < sizeof(Word); i++) {
+            out[count++] = s[i];
+          }
+          s += sizeof(Word);
+          continue;
+        }
+      }
+      out[count++] = c;
+      s++;
+      continue;
+    }
+
+    // Two byte sequences (Latin supplements, Cyrillic, Greek) are the common non-ASCII case
+    if ((c >> 5) == 0x6 && s[1] != 0) {
+      out[count++] = ((c & 0x1F) << 6) | (s[1] & 0x3F);
+      s += 2;
+      continue;
+    }
+
+    const int bytes = utf8CodepointLen(c);
+    uint32_t cp = bytes == 1 ? c : c & ((1 << (7 - bytes)) - 1);  // mask header bits
+    int i = 1;
+    for (; i < bytes && s[i] != 0; i++) {
+      cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    // A sequence cut short by the terminator decodes to U+FFFD without consuming the terminator
+    out[count++] = i == bytes ? cp : REPLACEMENT_GLYPH;
+    s += i;
+  }
+
+  *string = s;
+  return count;
+}
+
 size_t utf8RemoveLastChar(std::string& str) {
   if (str.empty()) return 0;
   size_t pos = str.size() - 1;
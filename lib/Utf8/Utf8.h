@@ -4,7 +4,14 @@
 #include <string>
 #define REPLACEMENT_GLYPH 0xFFFD
 
+// Number of bytes in the UTF-8 sequence starting with lead byte `c` (1 for ASCII and invalid lead bytes)
+int utf8CodepointLen(unsigned char c);
 uint32_t utf8NextCodepoint(const unsigned char** string);
+// Decodes up to `maxCount` codepoints into `out` and advances `*string` past them. Returns the number of codepoints
+// decoded, 0 at the end of the string. ASCII runs are detected a machine word at a time, so loops over mostly ASCII
+// text should consume spans instead of calling utf8NextCodepoint for every character.
+constexpr size_t UTF8_SPAN_MAX = 32;
+size_t utf8NextCodepoints(const unsigned char** string, uint32_t* out, size_t maxCount);
 // Remove the last UTF-8 codepoint from a std::string and return the new size.
 size_t utf8RemoveLastChar(std::string& str);
 // Truncate string by removing N UTF-8 codepoints from the end.
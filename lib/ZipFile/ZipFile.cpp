@@ -2,6 +2,7 @@
 
 #include <HalStorage.h>
 #include <Logging.h>
+#include <Trace.h>
 #include <miniz.h>
 
 #include <algorithm>
@@ -59,7 +60,8 @@ bool ZipFile::loadAllFileStatSlims() {
 
     file.seekCur(6);
     file.read(&fileStat.method, 2);
-    file.seekCur(8);
+    file.seekCur(4);
+    file.read(&fileStat.crc, 4);
     file.read(&fileStat.compressedSize, 4);
     file.read(&fileStat.uncompressedSize, 4);
     uint16_t nameLen, m, k;
@@ -111,7 +113,6 @@ bool ZipFile::loadFileStatSlim(const char* filename, FileStatSlim* fileStat) {
 
   // Phase 1: Try scanning from cursor position first
   uint32_t startPos = lastCentralDirPosValid ? lastCentralDirPos : zipDetails.centralDirOffset;
-  uint32_t wrapPos = zipDetails.centralDirOffset;
   bool wrapped = false;
   bool found = false;
 
@@ -141,7 +142,8 @@ bool ZipFile::loadFileStatSlim(const char* filename, FileStatSlim* fileStat) {
 
     file.seekCur(6);
     file.read(&fileStat->method, 2);
-    file.seekCur(8);
+    file.seekCur(4);
+    file.read(&fileStat->crc, 4);
     file.read(&fileStat->compressedSize, 4);
     file.read(&fileStat->uncompressedSize, 4);
     uint16_t nameLen, m, k;
@@ -305,6 +307,17 @@ bool ZipFile::getInflatedFileSize(const char* filename, size_t* size) {
   return true;
 }
 
+bool ZipFile::getEntryChecksum(const char* filename, uint32_t* crc, uint32_t* size) {
+  FileStatSlim fileStat = {};
+  if (!loadFileStatSlim(filename, &fileStat)) {
+    return false;
+  }
+
+  *crc = fileStat.crc;
+  *size = fileStat.uncompressedSize;
+  return true;
+}
+
 int ZipFile::fillUncompressedSizes(std::vector<SizeTarget>& targets, std::vector<uint32_t>& sizes) {
   if (targets.empty()) {
     return 0;
@@ -380,6 +393,7 @@ int ZipFile::fillUncompressedSizes(std::vector<SizeTarget>& targets, std::vector
 }
 
 uint8_t* ZipFile::readFileToMemory(const char* filename, size_t* size, const bool trailingNullByte) {
+  TRACE_SPAN("zip_inflate");
   const bool wasOpen = isOpen();
   if (!wasOpen && !open()) {
     return nullptr;
@@ -476,6 +490,7 @@ uint8_t* ZipFile::readFileToMemory(const char* filename, size_t* size, const boo
 }
 
 bool ZipFile::readFileToStream(const char* filename, Print& out, const size_t chunkSize) {
+  TRACE_SPAN("zip_inflate_stream");
   const bool wasOpen = isOpen();
   if (!wasOpen && !open()) {
     return false;
@@ -659,3 +674,141 @@ bool ZipFile::readFileToStream(const char* filename, Print& out, const size_t ch
   LOG_ERR("ZIP", "Unsupported compression method");
   return false;
 }
+
+ZipFile::EntryReader::~EntryReader() { release(); }
+
+void ZipFile::EntryReader::release() {
+  free(inflator);
+  free(readBuffer);
+  free(dictionary);
+  inflator = nullptr;
+  readBuffer = nullptr;
+  dictionary = nullptr;
+  if (openedZip) {
+    zip.close();
+    openedZip = false;
+  }
+}
+
+bool ZipFile::EntryReader::open(const char* filename, const size_t chunkSize) {
+  release();
+  if (!zip.isOpen()) {
+    if (!zip.open()) return false;
+    openedZip = true;
+  }
+
+  FileStatSlim fileStat = {};
+  if (!zip.loadFileStatSlim(filename, &fileStat)) {
+    release();
+    return false;
+  }
+  const long fileOffset = zip.getDataOffset(fileStat);
+  if (fileOffset < 0 || !zip.file.seek(fileOffset)) {
+    release();
+    return false;
+  }
+
+  this->chunkSize = chunkSize;
+  uncompressedSize = fileStat.uncompressedSize;
+  compressedRemaining = fileStat.compressedSize;
+  finished = false;
+  readFilled = readCursor = 0;
+  dictCursor = pendingStart = pendingLength = 0;
+
+  if (fileStat.method == MZ_NO_COMPRESSION) {
+    deflated = false;
+    return true;
+  }
+  if (fileStat.method != MZ_DEFLATED) {
+    LOG_ERR("ZIP", "Unsupported compression method");
+    release();
+    return false;
+  }
+
+  deflated = true;
+  inflator = static_cast<tinfl_decompressor*>(malloc(sizeof(tinfl_decompressor)));
+  readBuffer = static_cast<uint8_t*>(malloc(chunkSize));
+  dictionary = static_cast<uint8_t*>(malloc(TINFL_LZ_DICT_SIZE));
+  if (!inflator || !readBuffer || !dictionary) {
+    LOG_ERR("ZIP", "Failed to allocate memory for entry inflation");
+    release();
+    return false;
+  }
+  tinfl_init(inflator);
+  return true;
+}
+
+// Runs the inflator until it produces output, finishes or fails
+bool ZipFile::EntryReader::inflateMore() {
+  while (pendingLength == 0 && !finished) {
+    if (readCursor >= readFilled && compressedRemaining > 0) {
+      const size_t toRead = compressedRemaining < chunkSize ? compressedRemaining : chunkSize;
+      const int bytesRead = zip.file.read(readBuffer, toRead);
+      if (bytesRead <= 0) {
+        LOG_ERR("ZIP", "Could not read more bytes");
+        return false;
+      }
+      readFilled = bytesRead;
+      readCursor = 0;
+      compressedRemaining -= bytesRead;
+    }
+
+    size_t inBytes = readFilled - readCursor;
+    size_t outBytes = TINFL_LZ_DICT_SIZE - dictCursor;
+    const tinfl_status status =
+        tinfl_decompress(inflator, readBuffer + readCursor, &inBytes, dictionary, dictionary + dictCursor, &outBytes,
+                         compressedRemaining > 0 ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+    readCursor += inBytes;
+    pendingStart = dictCursor;
+    pendingLength = outBytes;
+    dictCursor = (dictCursor + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+
+    const bool truncated = status == TINFL_STATUS_NEEDS_MORE_INPUT && compressedRemaining == 0 && outBytes == 0;
+    if (status < 0 || truncated) {
+      LOG_ERR("ZIP", "tinfl_decompress() failed with status %d", status);
+      return false;
+    }
+    if (status == TINFL_STATUS_DONE) finished = true;
+  }
+  return true;
+}
+
+int ZipFile::EntryReader::read(uint8_t* buf, const size_t len) {
+  if (!zip.isOpen()) return -1;
+
+  if (!deflated) {
+    const size_t toRead = len < compressedRemaining ? len : compressedRemaining;
+    if (toRead == 0) return 0;
+    const int bytesRead = zip.file.read(buf, toRead);
+    if (bytesRead > 0) compressedRemaining -= bytesRead;
+    return bytesRead;
+  }
+
+  size_t copied = 0;
+  while (copied < len) {
+    if (!inflateMore()) return -1;
+    if (pendingLength == 0) break;  // End of the entry
+    const size_t count = len - copied < pendingLength ? len - copied : pendingLength;
+    memcpy(buf + copied, dictionary + pendingStart, count);
+    copied += count;
+    pendingStart += count;
+    pendingLength -= count;
+  }
+  return static_cast<int>(copied);
+}
+
+bool ZipFile::EntryReader::skip(size_t len) {
+  if (!deflated) {
+    if (len > compressedRemaining || !zip.file.seekCur(len)) return false;
+    compressedRemaining -= len;
+    return true;
+  }
+
+  uint8_t scratch[64];
+  while (len > 0) {
+    const int bytesRead = read(scratch, len < sizeof(scratch) ? len : sizeof(scratch));
+    if (bytesRead <= 0) return false;
+    len -= bytesRead;
+  }
+  return true;
+}
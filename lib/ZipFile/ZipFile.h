@@ -5,10 +5,13 @@
 #include <unordered_map>
 #include <vector>
 
+struct tinfl_decompressor_tag;
+
 class ZipFile {
  public:
   struct FileStatSlim {
     uint16_t method;             // Compression method
+    uint32_t crc;                // CRC32 of the uncompressed data
     uint32_t compressedSize;     // Compressed size
     uint32_t uncompressedSize;   // Uncompressed size
     uint32_t localHeaderOffset;  // Offset of local file header
@@ -61,6 +64,8 @@ class ZipFile {
   bool close();
   bool loadAllFileStatSlims();
   bool getInflatedFileSize(const char* filename, size_t* size);
+  // CRC32 and uncompressed size of an entry, straight from the central directory: together they identify the content
+  bool getEntryChecksum(const char* filename, uint32_t* crc, uint32_t* size);
   // Batch lookup: scan ZIP central dir once and fill sizes for matching targets.
   // targets must be sorted by (hash, len). sizes[target.index] receives uncompressedSize.
   // Returns number of targets matched.
@@ -69,4 +74,41 @@ class ZipFile {
   // These functions will open and close the zip as needed
   uint8_t* readFileToMemory(const char* filename, size_t* size = nullptr, bool trailingNullByte = false);
   bool readFileToStream(const char* filename, Print& out, size_t chunkSize);
+
+  // Pulls one entry out of the zip, inflating only as much as each read() asks for, so a decoder can consume the
+  // entry directly instead of it being extracted to a file first. A deflated entry holds the inflator and its 32 KB
+  // dictionary until the reader is destroyed; the zip is opened for the reader's lifetime if it was not already.
+  class EntryReader {
+   public:
+    explicit EntryReader(ZipFile& zip) : zip(zip) {}
+    ~EntryReader();
+    EntryReader(const EntryReader&) = delete;
+    EntryReader& operator=(const EntryReader&) = delete;
+
+    bool open(const char* filename, size_t chunkSize = 1024);
+    size_t getSize() const { return uncompressedSize; }
+    // Returns the number of bytes read: fewer than `len` only at the end of the entry, negative on error
+    int read(uint8_t* buf, size_t len);
+    bool skip(size_t len);
+
+   private:
+    bool inflateMore();
+    void release();
+
+    ZipFile& zip;
+    bool openedZip = false;
+    bool deflated = false;
+    bool finished = false;
+    size_t uncompressedSize = 0;
+    size_t compressedRemaining = 0;  // Bytes of the entry's data not read from the zip yet
+    size_t chunkSize = 0;
+    tinfl_decompressor_tag* inflator = nullptr;
+    uint8_t* readBuffer = nullptr;
+    size_t readFilled = 0;
+    size_t readCursor = 0;
+    uint8_t* dictionary = nullptr;  // Circular inflate output; decoded bytes wait here until read
+    size_t dictCursor = 0;          // Where the inflator writes next
+    size_t pendingStart = 0;        // Decoded bytes not handed out yet
+    size_t pendingLength = 0;
+  };
 };
@@ -1,6 +1,7 @@
 #include "HalStorage.h"
 
 #include <SDCardManager.h>
+#include <Trace.h>
 
 #define SDCard SDCardManager::getInstance()
 
@@ -12,23 +13,37 @@ bool HalStorage::begin() { return SDCard.begin(); }
 
 bool HalStorage::ready() const { return SDCard.ready(); }
 
-std::vector<String> HalStorage::listFiles(const char* path, int maxFiles) { return SDCard.listFiles(path, maxFiles); }
+std::vector<String> HalStorage::listFiles(const char* path, int maxFiles) {
+  TRACE_SPAN("sd_list");
+  return SDCard.listFiles(path, maxFiles);
+}
 
-String HalStorage::readFile(const char* path) { return SDCard.readFile(path); }
+String HalStorage::readFile(const char* path) {
+  TRACE_SPAN("sd_read");
+  return SDCard.readFile(path);
+}
 
 bool HalStorage::readFileToStream(const char* path, Print& out, size_t chunkSize) {
+  TRACE_SPAN("sd_read");
   return SDCard.readFileToStream(path, out, chunkSize);
 }
 
 size_t HalStorage::readFileToBuffer(const char* path, char* buffer, size_t bufferSize, size_t maxBytes) {
+  TRACE_SPAN("sd_read");
   return SDCard.readFileToBuffer(path, buffer, bufferSize, maxBytes);
 }
 
-bool HalStorage::writeFile(const char* path, const String& content) { return SDCard.writeFile(path, content); }
+bool HalStorage::writeFile(const char* path, const String& content) {
+  TRACE_SPAN("sd_write");
+  return SDCard.writeFile(path, content);
+}
 
 bool HalStorage::ensureDirectoryExists(const char* path) { return SDCard.ensureDirectoryExists(path); }
 
-FsFile HalStorage::open(const char* path, const oflag_t oflag) { return SDCard.open(path, oflag); }
+FsFile HalStorage::open(const char* path, const oflag_t oflag) {
+  TRACE_SPAN("sd_open");
+  return SDCard.open(path, oflag);
+}
 
 bool HalStorage::mkdir(const char* path, const bool pFlag) { return SDCard.mkdir(path, pFlag); }
 
@@ -39,6 +54,7 @@ bool HalStorage::remove(const char* path) { return SDCard.remove(path); }
 bool HalStorage::rmdir(const char* path) { return SDCard.rmdir(path); }
 
 bool HalStorage::openFileForRead(const char* moduleName, const char* path, FsFile& file) {
+  TRACE_SPAN("sd_open");
   return SDCard.openFileForRead(moduleName, path, file);
 }
 
@@ -51,6 +67,7 @@ bool HalStorage::openFileForRead(const char* moduleName, const String& path, FsF
 }
 
 bool HalStorage::openFileForWrite(const char* moduleName, const char* path, FsFile& file) {
+  TRACE_SPAN("sd_open");
   return SDCard.openFileForWrite(moduleName, path, file);
 }
 
@@ -1324,6 +1324,84 @@ static void idctCols(void) {
   }
 }
 
+/*----------------------------------------------------------------------------*/
+// Reduced IDCT for the 1/2 and 1/4 scales: an N-point IDCT (N = gReduce, 4 or 2) of the block's lowest NxN
+// coefficients gives the block downscaled to NxN. The weights are cos((2i+1)u*pi/2N) / cos(u*pi/16) in 8.8 fixed
+// point; the divisor undoes the Winograd scale factor folded into the dequantized coefficients. Each output pixel is
+// replicated over (8/N)x(8/N) pixels of the block, so the colour conversion and chroma upsampling below are unchanged.
+
+// Rounds away the 8.8 weight scale
+static PJPG_INLINE long descaleWeight(long x) { return PJPG_ARITH_SHIFT_RIGHT_8_L(x + 128L); }
+
+// Column pass result to a pixel: drops the weight scale, then descales like PJPG_DESCALE ((2x + 128) >> 8 rounds
+// like (x + 64) >> 7, without overflowing int16)
+static PJPG_INLINE uint8 descaleReduced(long x) {
+  x = descaleWeight(x);
+  return clamp((int16)(PJPG_ARITH_SHIFT_RIGHT_8_L(x * 2 + 128L) + 128));
+}
+
+// 4-point IDCT in 8.8 fixed point
+static PJPG_INLINE void idct4(long s0, long s1, long s2, long s3, long* pOut) {
+  long e0 = s0 * 256L;
+  long e1 = s2 * 196L;
+  long o0 = s1 * 241L + s3 * 118L;
+  long o1 = s1 * 100L - s3 * 284L;
+
+  pOut[0] = e0 + e1 + o0;
+  pOut[1] = e0 - e1 + o1;
+  pOut[2] = e0 - e1 - o1;
+  pOut[3] = e0 + e1 - o0;
+}
+
+static void idctReduced4(void) {
+  long rows[4 * 4];
+  long sums[4];
+  uint8 x, y;
+
+  for (y = 0; y < 4; y++) {
+    const int16* pSrc = gCoeffBuf + y * 8;
+    long* pRow = rows + y * 4;
+    if ((pSrc[1] | pSrc[2] | pSrc[3]) == 0) {
+      pRow[0] = pRow[1] = pRow[2] = pRow[3] = pSrc[0];
+    } else {
+      idct4(pSrc[0], pSrc[1], pSrc[2], pSrc[3], sums);
+      for (x = 0; x < 4; x++) pRow[x] = descaleWeight(sums[x]);
+    }
+  }
+
+  for (x = 0; x < 4; x++) {
+    idct4(rows[x], rows[4 + x], rows[8 + x], rows[12 + x], sums);
+    for (y = 0; y < 4; y++) {
+      int16* pDst = gCoeffBuf + y * 16 + x * 2;
+      uint8 c = descaleReduced(sums[y]);
+      pDst[0] = c;
+      pDst[1] = c;
+      pDst[8] = c;
+      pDst[9] = c;
+    }
+  }
+}
+
+static void idctReduced2(void) {
+  long r0a = (long)gCoeffBuf[0] * 256L, r0b = (long)gCoeffBuf[1] * 185L;
+  long r1a = (long)gCoeffBuf[8] * 256L, r1b = (long)gCoeffBuf[9] * 185L;
+  long rows[4];
+  uint8 i, x, y;
+
+  rows[0] = descaleWeight(r0a + r0b);
+  rows[1] = descaleWeight(r0a - r0b);
+  rows[2] = descaleWeight(r1a + r1b);
+  rows[3] = descaleWeight(r1a - r1b);
+
+  for (i = 0; i < 4; i++) {
+    long a = rows[i & 1] * 256L, b = rows[2 + (i & 1)] * 185L;
+    uint8 c = descaleReduced((i & 2) ? a - b : a + b);
+    int16* pDst = gCoeffBuf + (i >> 1) * 32 + (i & 1) * 4;
+    for (y = 0; y < 4; y++)
+      for (x = 0; x < 4; x++) pDst[y * 8 + x] = c;
+  }
+}
+
 /*----------------------------------------------------------------------------*/
 static PJPG_INLINE uint8 addAndClamp(uint8 a, int16 b) {
   b = a + b;
@@ -1607,8 +1685,14 @@ static void convertCr(uint8 dstOfs) {
 }
 /*----------------------------------------------------------------------------*/
 static void transformBlock(uint8 mcuBlock) {
-  idctRows();
-  idctCols();
+  if (gReduce == 4) {
+    idctReduced4();
+  } else if (gReduce == 2) {
+    idctReduced2();
+  } else {
+    idctRows();
+    idctCols();
+  }
 
   switch (gScanType) {
     case PJPG_GRAYSCALE: {
@@ -1941,8 +2025,8 @@ static uint8 decodeNextMCU(void) {
 
     compACTab = gCompACTab[componentID];
 
-    if (gReduce) {
-      // Decode, but throw out the AC coefficients in reduce mode.
+    if (gReduce == 1) {
+      // Decode, but throw out the AC coefficients in DC-only mode.
       for (k = 1; k < 64; k++) {
         s = huffDecode(compACTab ? &gHuffTab3 : &gHuffTab2, compACTab ? gHuffVal3 : gHuffVal2);
 
@@ -2038,6 +2122,8 @@ unsigned char pjpeg_decode_mcu(void) {
   return 0;
 }
 //------------------------------------------------------------------------------
+void pjpeg_set_reduce(unsigned char reduce) { gReduce = reduce; }
+//------------------------------------------------------------------------------
 unsigned char pjpeg_decode_init(pjpeg_image_info_t* pInfo, pjpeg_need_bytes_callback_t pNeed_bytes_callback,
                                 void* pCallback_data, unsigned char reduce) {
   uint8 status;
@@ -108,10 +108,17 @@ typedef unsigned char (*pjpeg_need_bytes_callback_t)(unsigned char* pBuf, unsign
 // Initializes the decompressor. Returns 0 on success, or one of the above error codes on failure.
 // pNeed_bytes_callback will be called to fill the decompressor's internal input buffer.
 // If reduce is 1, only the first pixel of each block will be decoded. This mode is much faster because it skips the AC
-// dequantization, IDCT and chroma upsampling of every image pixel. Not thread safe.
+// dequantization, IDCT and chroma upsampling of every image pixel.
+// If reduce is 2 or 4, each 8x8 block is decoded at 2x2 or 4x4 (1/4 or 1/2 scale) by a reduced IDCT of its lowest
+// coefficients. Each reduced pixel fills a (8/reduce)x(8/reduce) square of the block, so the MCU buffers keep their
+// layout and the reduced image is read by sampling every (8/reduce)th pixel of it. Not thread safe.
 unsigned char pjpeg_decode_init(pjpeg_image_info_t* pInfo, pjpeg_need_bytes_callback_t pNeed_bytes_callback,
                                 void* pCallback_data, unsigned char reduce);
 
+// Changes the reduce mode given to pjpeg_decode_init, e.g. to pick a scale once the image size is known. Only valid
+// before the first pjpeg_decode_mcu call.
+void pjpeg_set_reduce(unsigned char reduce);
+
 // Decompresses the file's next MCU. Returns 0 on success, PJPG_NO_MORE_BLOCKS if no more blocks are available, or an
 // error code. Must be called a total of m_MCUSPerRow*m_MCUSPerCol times to completely decompress the image. Not thread
 // safe.
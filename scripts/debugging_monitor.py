@@ -11,6 +11,7 @@ Features:
 - Interactive memory usage graphing with matplotlib
 - Command input interface for sending commands to the ESP32 device
 - Screenshot capture and processing (1-bit black/white format)
+- Trace capture (TRACE_ON, TRACE_DUMP commands) saved as Chrome trace JSON
 - Graceful shutdown handling with Ctrl-C signal processing
 - Configurable filtering and suppression of log messages
 - Thread-safe operation with coordinated shutdown events
@@ -27,6 +28,7 @@ from __future__ import annotations
 
 import argparse
 import glob
+import json
 import platform
 import re
 import signal
@@ -148,6 +150,7 @@ COLOR_KEYWORDS: dict[str, list[str]] = {
         "E-INK",
     ],
     Fore.LIGHTGREEN_EX: ["[FNS]", "FOOTNOTE"],
+    Fore.LIGHTBLUE_EX: ["[TRC]", "TRACE"],
 }
 
 
@@ -189,6 +192,22 @@ def parse_memory_line(line: str) -> tuple[int | None, int | None]:
     return None, None
 
 
+def save_trace(trace_lines: list[str]) -> None:
+    """
+    Writes the lines of a TRACE_DUMP to trace.json after checking they form valid JSON.
+    Open the file in chrome://tracing or https://ui.perfetto.dev.
+    """
+    text = "\n".join(trace_lines)
+    try:
+        events = json.loads(text)["traceEvents"]
+    except (ValueError, KeyError) as e:
+        print(f"{Fore.RED}Trace dump is not valid JSON ({e}), saving it anyway{Style.RESET_ALL}")
+        events = []
+    with open("trace.json", "w", encoding="utf-8") as f:
+        f.write(text)
+    print(f"{Fore.GREEN}Trace with {len(events)} events saved to trace.json{Style.RESET_ALL}")
+
+
 def serial_worker(ser, kwargs: dict[str, str]) -> None:
     """
     Runs in a background thread. Handles reading serial data, printing to console,
@@ -216,6 +235,8 @@ def serial_worker(ser, kwargs: dict[str, str]) -> None:
     expecting_screenshot = False
     screenshot_size = 0
     screenshot_data = b""
+    expecting_trace = False
+    trace_lines: list[str] = []
 
     try:
         while not shutdown_event.is_set():
@@ -259,6 +280,20 @@ def serial_worker(ser, kwargs: dict[str, str]) -> None:
                     elif clean_line == "SCREENSHOT_END":
                         continue  # ignore
 
+                    if clean_line.startswith("TRACE_START:"):
+                        expecting_trace = True
+                        trace_lines = []
+                        continue
+                    if expecting_trace:
+                        if clean_line == "TRACE_END":
+                            save_trace(trace_lines)
+                            expecting_trace = False
+                            continue
+                        # Log lines from other tasks can land in the middle of the dump
+                        if not re.match(r"^\[\d+\]", clean_line):
+                            trace_lines.append(clean_line)
+                            continue
+
                     # Add PC timestamp
                     pc_time = datetime.now().strftime("%H:%M:%S")
                     formatted_line = re.sub(r"^\[\d+\]", f"[{pc_time}]", clean_line)
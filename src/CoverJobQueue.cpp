@@ -0,0 +1,223 @@
+#include "CoverJobQueue.h"
+
+#include <Epub.h>
+#include <HalStorage.h>
+#include <Logging.h>
+#include <Serialization.h>
+#include <Txt.h>
+#include <Xtc.h>
+
+#include <algorithm>
+
+#include "CrossPointSettings.h"
+#include "RecentBooksStore.h"
+#include "SleepImageLibrary.h"
+#include "components/UITheme.h"
+#include "util/StringUtils.h"
+
+namespace {
+constexpr uint8_t COVER_JOBS_FILE_VERSION = 1;
+constexpr char COVER_JOBS_FILE[] = "/.crosspoint/cover_jobs.bin";
+}  // namespace
+
+CoverJobQueue CoverJobQueue::instance;
+
+void CoverJobQueue::enqueue(const std::string& bookPath, const CoverJob::Kind kind, const uint16_t height,
+                            const uint8_t priority) {
+  const CoverJob job{bookPath, kind, height, priority, 0};
+  auto it = std::find_if(jobs.begin(), jobs.end(), [&](const CoverJob& queued) { return queued.sameWork(job); });
+  if (it != jobs.end()) {
+    if (it->priority >= priority) {
+      return;
+    }
+    it->priority = priority;
+  } else {
+    if (jobs.size() >= MAX_JOBS) {
+      // Make room by dropping the newest of the least urgent jobs, unless the new one is no more urgent
+      auto lowest = std::min_element(jobs.rbegin(), jobs.rend(), [](const CoverJob& a, const CoverJob& b) {
+        return a.priority < b.priority;
+      });
+      if (lowest->priority >= priority) {
+        LOG_DBG("CJQ", "Queue full, not queuing cover job for %s", bookPath.c_str());
+        return;
+      }
+      jobs.erase(std::next(lowest).base());
+    }
+    jobs.push_back(job);
+  }
+  LOG_DBG("CJQ", "Queued cover job %d for %s (priority %d, %d queued)", kind, bookPath.c_str(), priority,
+          static_cast<int>(jobs.size()));
+  saveToFile();
+}
+
+void CoverJobQueue::enqueueBookCovers(const std::string& bookPath) {
+  const bool epub = StringUtils::checkFileExtension(bookPath, ".epub");
+  const bool xtc =
+      StringUtils::checkFileExtension(bookPath, ".xtch") || StringUtils::checkFileExtension(bookPath, ".xtc");
+
+  if (SETTINGS.sleepScreen == CrossPointSettings::SLEEP_SCREEN_MODE::COVER ||
+      SETTINGS.sleepScreen == CrossPointSettings::SLEEP_SCREEN_MODE::COVER_CUSTOM) {
+    const bool cropped = epub && SETTINGS.sleepScreenCoverMode == CrossPointSettings::SLEEP_SCREEN_COVER_MODE::CROP;
+    enqueue(bookPath, cropped ? CoverJob::COVER_CROPPED : CoverJob::COVER, 0, PRIORITY_SLEEP);
+  }
+  if (epub || xtc) {
+    enqueue(bookPath, CoverJob::THUMB, UITheme::getInstance().getMetrics().homeCoverHeight, PRIORITY_RECENT);
+  }
+}
+
+void CoverJobQueue::cancel(const std::string& path) {
+  const std::string folder = path.back() == '/' ? path : path + "/";
+  const size_t before = jobs.size();
+  jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+                            [&](const CoverJob& job) {
+                              return job.bookPath == path || job.bookPath.compare(0, folder.size(), folder) == 0;
+                            }),
+             jobs.end());
+  if (jobs.size() != before) {
+    LOG_DBG("CJQ", "Cancelled %d cover job(s) for %s", static_cast<int>(before - jobs.size()), path.c_str());
+    saveToFile();
+  }
+}
+
+bool CoverJobQueue::hasPending(const std::string& bookPath) const {
+  return std::any_of(jobs.begin(), jobs.end(), [&](const CoverJob& job) { return job.bookPath == bookPath; });
+}
+
+bool CoverJobQueue::runNext() {
+  if (jobs.empty()) {
+    return false;
+  }
+
+  // Highest priority first, the oldest of those on a tie
+  auto next = std::max_element(jobs.begin(), jobs.end(),
+                               [](const CoverJob& a, const CoverJob& b) { return a.priority < b.priority; });
+  // Count the attempt before running it, so a job that crashes the device is not retried forever
+  next->attempts++;
+  saveToFile();
+  const CoverJob job = *next;
+
+  LOG_DBG("CJQ", "Running cover job %d for %s (attempt %d)", job.kind, job.bookPath.c_str(), job.attempts);
+  const unsigned long start = millis();
+  const bool success = Storage.exists(job.bookPath.c_str()) && runJob(job);
+  LOG_DBG("CJQ", "Cover job for %s %s in %lu ms", job.bookPath.c_str(), success ? "done" : "failed",
+          millis() - start);
+
+  // The job may have been cancelled or re-prioritised meanwhile; drop whatever is left of it
+  jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [&](const CoverJob& queued) { return queued.sameWork(job); }),
+             jobs.end());
+  saveToFile();
+
+  if (job.kind == CoverJob::THUMB) {
+    if (!success) {
+      // No thumbnail to wait for; the home screen keeps its placeholder for this book
+      for (const RecentBook& book : RECENT_BOOKS.getBooks()) {
+        if (book.path == job.bookPath) {
+          RECENT_BOOKS.updateBook(book.path, book.title, book.author, "");
+          break;
+        }
+      }
+    }
+    thumbnailCount++;
+  }
+  return true;
+}
+
+bool CoverJobQueue::runJob(const CoverJob& job) const {
+  const std::string& path = job.bookPath;
+  if (job.kind == CoverJob::SLEEP_IMAGE || job.kind == CoverJob::SLEEP_IMAGE_CROPPED) {
+    return SleepImageLibrary::prepare(path, job.kind == CoverJob::SLEEP_IMAGE_CROPPED);
+  }
+
+  if (StringUtils::checkFileExtension(path, ".epub")) {
+    Epub epub(path, "/.crosspoint");
+    // Skip loading css since we only need metadata here
+    if (!epub.load(true, true)) {
+      LOG_ERR("CJQ", "Failed to load epub: %s", path.c_str());
+      return false;
+    }
+    if (job.kind == CoverJob::THUMB) {
+      return epub.generateThumbBmp(job.height);
+    }
+    return epub.generateCoverBmp(job.kind == CoverJob::COVER_CROPPED);
+  }
+
+  if (StringUtils::checkFileExtension(path, ".xtch") || StringUtils::checkFileExtension(path, ".xtc")) {
+    Xtc xtc(path, "/.crosspoint");
+    if (!xtc.load()) {
+      LOG_ERR("CJQ", "Failed to load XTC: %s", path.c_str());
+      return false;
+    }
+    return job.kind == CoverJob::THUMB ? xtc.generateThumbBmp(job.height) : xtc.generateCoverBmp();
+  }
+
+  if (StringUtils::checkFileExtension(path, ".txt") && job.kind != CoverJob::THUMB) {
+    Txt txt(path, "/.crosspoint");
+    return txt.load() && txt.generateCoverBmp();
+  }
+
+  LOG_DBG("CJQ", "No cover job for %s", path.c_str());
+  return false;
+}
+
+bool CoverJobQueue::saveToFile() const {
+  // Make sure the directory exists
+  Storage.mkdir("/.crosspoint");
+
+  FsFile outputFile;
+  if (!Storage.openFileForWrite("CJQ", COVER_JOBS_FILE, outputFile)) {
+    return false;
+  }
+
+  serialization::writePod(outputFile, COVER_JOBS_FILE_VERSION);
+  const uint8_t count = static_cast<uint8_t>(jobs.size());
+  serialization::writePod(outputFile, count);
+
+  for (const auto& job : jobs) {
+    serialization::writeString(outputFile, job.bookPath);
+    serialization::writePod(outputFile, job.kind);
+    serialization::writePod(outputFile, job.height);
+    serialization::writePod(outputFile, job.priority);
+    serialization::writePod(outputFile, job.attempts);
+  }
+
+  outputFile.close();
+  return true;
+}
+
+bool CoverJobQueue::loadFromFile() {
+  FsFile inputFile;
+  if (!Storage.openFileForRead("CJQ", COVER_JOBS_FILE, inputFile)) {
+    return false;
+  }
+
+  uint8_t version;
+  serialization::readPod(inputFile, version);
+  if (version != COVER_JOBS_FILE_VERSION) {
+    LOG_ERR("CJQ", "Deserialization failed: Unknown version %u", version);
+    inputFile.close();
+    return false;
+  }
+
+  uint8_t count;
+  serialization::readPod(inputFile, count);
+  jobs.clear();
+  jobs.reserve(count);
+
+  for (uint8_t i = 0; i < count; i++) {
+    CoverJob job{};
+    serialization::readString(inputFile, job.bookPath);
+    serialization::readPod(inputFile, job.kind);
+    serialization::readPod(inputFile, job.height);
+    serialization::readPod(inputFile, job.priority);
+    serialization::readPod(inputFile, job.attempts);
+    if (job.attempts >= MAX_ATTEMPTS) {
+      LOG_ERR("CJQ", "Dropping cover job for %s after %d attempts", job.bookPath.c_str(), job.attempts);
+      continue;
+    }
+    jobs.push_back(job);
+  }
+
+  inputFile.close();
+  LOG_DBG("CJQ", "Cover jobs loaded from file (%d pending)", static_cast<int>(jobs.size()));
+  return true;
+}
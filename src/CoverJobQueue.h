@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cover work for a book (or a sleep screen image), run in the background instead of while a screen waits on it
+struct CoverJob {
+  enum Kind : uint8_t {
+    THUMB,               // 1-bit home screen thumbnail of `height`
+    COVER,               // Sleep screen cover, fit to the screen
+    COVER_CROPPED,       // Sleep screen cover, cropped to fill the screen (EPUB only)
+    SLEEP_IMAGE,         // Prepared copy of a /sleep image (bookPath), fit to the screen
+    SLEEP_IMAGE_CROPPED  // Prepared copy of a /sleep image, cropped to fill the screen
+  };
+
+  std::string bookPath;
+  Kind kind;
+  uint16_t height;   // Thumbnail height, 0 for covers
+  uint8_t priority;  // Higher runs first; equal priorities run in the order they were queued
+  uint8_t attempts;  // Times the job has been started, counted before it runs
+
+  bool sameWork(const CoverJob& other) const {
+    return bookPath == other.bookPath && kind == other.kind && height == other.height;
+  }
+};
+
+// Persistent, priority-ordered queue of cover and thumbnail jobs. Screens queue what they are missing and draw a
+// placeholder; the main loop runs one job at a time while the UI is idle and the home screen redraws when
+// getThumbnailCount() changes. The queue is saved after every change, so pending jobs survive a reboot, and a job that
+// keeps taking the device down with it is dropped after MAX_ATTEMPTS starts.
+class CoverJobQueue {
+  // Static instance
+  static CoverJobQueue instance;
+
+  std::vector<CoverJob> jobs;
+  uint32_t thumbnailCount = 0;
+
+  bool runJob(const CoverJob& job) const;
+
+ public:
+  static constexpr uint8_t PRIORITY_ON_SCREEN = 2;  // Thumbnails the current screen is waiting for
+  static constexpr uint8_t PRIORITY_RECENT = 1;     // Thumbnails of recent books not shown yet
+  static constexpr uint8_t PRIORITY_SLEEP = 0;      // Sleep screen covers and prepared sleep images
+  static constexpr uint8_t MAX_ATTEMPTS = 2;
+  static constexpr size_t MAX_JOBS = 32;
+  static constexpr unsigned long IDLE_DELAY_MS = 1000;  // Time since the last button press before jobs run
+
+  ~CoverJobQueue() = default;
+
+  // Get singleton instance
+  static CoverJobQueue& getInstance() { return instance; }
+
+  // Queues a job, or raises the priority of the same job already queued
+  void enqueue(const std::string& bookPath, CoverJob::Kind kind, uint16_t height, uint8_t priority);
+  // Queues the sleep screen cover (when the sleep screen shows one) and home screen thumbnail of a book just opened
+  void enqueueBookCovers(const std::string& bookPath);
+  // Drops every job for the book at `path`, or for every book under it when it is a folder
+  void cancel(const std::string& path);
+
+  // Runs the highest priority job. Returns false if there was nothing to run.
+  bool runNext();
+  bool isEmpty() const { return jobs.empty(); }
+  bool hasPending(const std::string& bookPath) const;
+  // Incremented whenever a thumbnail job finishes, successfully or not
+  uint32_t getThumbnailCount() const { return thumbnailCount; }
+
+  bool saveToFile() const;
+  bool loadFromFile();
+};
+
+// Helper macro to access the cover job queue
+#define COVER_JOBS CoverJobQueue::getInstance()
@@ -0,0 +1,321 @@
+#include "SleepImageLibrary.h"
+
+#include <Arduino.h>
+#include <Bitmap.h>
+#include <BmpRowSource.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <ImagePipeline.h>
+#include <Logging.h>
+#include <Serialization.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "CoverJobQueue.h"
+#include "util/StringUtils.h"
+
+namespace {
+constexpr uint8_t SLEEP_INDEX_FILE_VERSION = 2;
+constexpr char CACHE_DIR[] = "/.crosspoint/sleep";
+constexpr char INDEX_FILE[] = "/.crosspoint/sleep/index.bin";
+// Sleep screens are drawn in portrait
+constexpr int SCREEN_WIDTH = HalDisplay::DISPLAY_HEIGHT;
+constexpr int SCREEN_HEIGHT = HalDisplay::DISPLAY_WIDTH;
+
+// FNV-1a
+uint32_t hashBytes(uint32_t hash, const void* data, const size_t length) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+uint32_t getModified(FsFile& file) {
+  uint16_t date = 0;
+  uint16_t time = 0;
+  file.getModifyDateTime(&date, &time);
+  return static_cast<uint32_t>(date) << 16 | time;
+}
+
+// Passes on the centered `width` x `height` window of the rows it is given
+class CenterCropSink final : public GrayRowSink {
+ public:
+  CenterCropSink(const int width, const int height, GrayRowSink& out) : width(width), height(height), out(out) {}
+
+  bool begin(const int sourceWidth, const int sourceHeight) override {
+    offsetX = (sourceWidth - width) / 2;
+    offsetY = (sourceHeight - height) / 2;
+    return out.begin(width, height);
+  }
+  bool writeRow(const uint8_t* gray, const int y) override {
+    if (y < offsetY || y >= offsetY + height) return true;
+    return out.writeRow(gray + offsetX, y - offsetY);
+  }
+
+ private:
+  int width;
+  int height;
+  GrayRowSink& out;
+  int offsetX = 0;
+  int offsetY = 0;
+};
+}  // namespace
+
+SleepImageLibrary SleepImageLibrary::instance;
+
+std::string SleepImageLibrary::getPreparedPath(const Image& image, const bool cropped) {
+  // Keyed by name, size and modification time, so a replaced image gets a new copy even at the same size
+  uint32_t key = hashBytes(2166136261u, image.name.data(), image.name.size());
+  key = hashBytes(key, &image.size, sizeof(image.size));
+  key = hashBytes(key, &image.modified, sizeof(image.modified));
+  char fileName[24];
+  snprintf(fileName, sizeof(fileName), "/%08lx%s.bmp", static_cast<unsigned long>(key), cropped ? "_crop" : "");
+  return std::string(CACHE_DIR) + fileName;
+}
+
+bool SleepImageLibrary::refresh() {
+  if (!loaded) {
+    loadFromFile();
+    loaded = true;
+  }
+
+  auto dir = Storage.open(SLEEP_DIR);
+  if (!dir || !dir.isDirectory()) {
+    if (dir) dir.close();
+    if (!images.empty()) rebuild({}, 0);
+    return false;
+  }
+
+  // Listing the directory only reads its entries; the BMP headers are read when it has changed
+  std::vector<Image> listing;
+  char name[500];
+  for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    file.getName(name, sizeof(name));
+    if (!file.isDirectory() && name[0] != '.' && StringUtils::checkFileExtension(std::string(name), ".bmp")) {
+      listing.push_back({name, static_cast<uint32_t>(file.size()), getModified(file), false});
+    }
+    file.close();
+  }
+  dir.close();
+
+  std::sort(listing.begin(), listing.end(), [](const Image& a, const Image& b) { return a.name < b.name; });
+  uint32_t listingSignature = 2166136261u;
+  for (const Image& image : listing) {
+    listingSignature = hashBytes(listingSignature, image.name.c_str(), image.name.size() + 1);
+    listingSignature = hashBytes(listingSignature, &image.size, sizeof(image.size));
+    listingSignature = hashBytes(listingSignature, &image.modified, sizeof(image.modified));
+  }
+
+  if (listingSignature != signature) {
+    rebuild(std::move(listing), listingSignature);
+  }
+  return true;
+}
+
+void SleepImageLibrary::rebuild(std::vector<Image> listing, const uint32_t listingSignature) {
+  const unsigned long start = millis();
+  std::vector<Image> valid;
+  valid.reserve(listing.size());
+  for (Image& image : listing) {
+    FsFile file;
+    if (!Storage.openFileForRead("SLP", std::string(SLEEP_DIR) + "/" + image.name, file)) {
+      continue;
+    }
+    Bitmap bitmap(file);
+    if (bitmap.parseHeaders() != BmpReaderError::Ok) {
+      LOG_DBG("SLP", "Skipping invalid BMP file: %s", image.name.c_str());
+      file.close();
+      continue;
+    }
+    image.native = bitmap.getBpp() <= 2 && bitmap.getWidth() <= SCREEN_WIDTH && bitmap.getHeight() <= SCREEN_HEIGHT;
+    file.close();
+    valid.push_back(std::move(image));
+  }
+
+  // Drop the prepared copies of images that are gone or were replaced
+  for (const Image& old : images) {
+    const bool kept = std::any_of(valid.begin(), valid.end(), [&](const Image& image) {
+      return image.name == old.name && image.size == old.size && image.modified == old.modified;
+    });
+    if (!kept && !old.native) {
+      Storage.remove(getPreparedPath(old, false).c_str());
+      Storage.remove(getPreparedPath(old, true).c_str());
+    }
+  }
+
+  images = std::move(valid);
+  signature = listingSignature;
+  order.clear();
+  cursor = 0;
+  saveToFile();
+  LOG_DBG("SLP", "Indexed %d sleep image(s) in %lu ms", static_cast<int>(images.size()), millis() - start);
+}
+
+void SleepImageLibrary::shuffle() {
+  const int previous = cursor > 0 && cursor <= order.size() ? order[cursor - 1] : -1;
+  order.resize(images.size());
+  for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<uint16_t>(i);
+  for (size_t i = order.size() - 1; i > 0; i--) {
+    std::swap(order[i], order[random(i + 1)]);
+  }
+  // Don't show the last image of one round first in the next
+  if (order.size() > 1 && order[0] == previous) {
+    std::swap(order[0], order[1 + random(order.size() - 1)]);
+  }
+  cursor = 0;
+}
+
+std::string SleepImageLibrary::next(const bool cropped) {
+  refresh();
+  if (images.empty()) {
+    return "";
+  }
+
+  if (cursor >= order.size()) {
+    shuffle();
+  }
+  const Image& image = images[order[cursor++]];
+  saveToFile();
+
+  const std::string original = std::string(SLEEP_DIR) + "/" + image.name;
+  if (image.native) {
+    return original;
+  }
+  const std::string prepared = getPreparedPath(image, cropped);
+  if (Storage.exists(prepared.c_str())) {
+    return prepared;
+  }
+  // Drawn scaled this time; the copies are made in the background for next time
+  queuePreparation(cropped);
+  return original;
+}
+
+void SleepImageLibrary::queuePreparation(const bool cropped) const {
+  for (const Image& image : images) {
+    if (!image.native && !Storage.exists(getPreparedPath(image, cropped).c_str())) {
+      COVER_JOBS.enqueue(std::string(SLEEP_DIR) + "/" + image.name,
+                         cropped ? CoverJob::SLEEP_IMAGE_CROPPED : CoverJob::SLEEP_IMAGE, 0,
+                         CoverJobQueue::PRIORITY_SLEEP);
+    }
+  }
+}
+
+bool SleepImageLibrary::prepare(const std::string& path, const bool cropped) {
+  FsFile file;
+  if (!Storage.openFileForRead("SLP", path, file)) {
+    return false;
+  }
+  const Image image = {path.substr(path.rfind('/') + 1), static_cast<uint32_t>(file.size()), getModified(file), false};
+  const std::string prepared = getPreparedPath(image, cropped);
+  BmpRowSource source(file);
+  if (!source.open()) {
+    file.close();
+    return false;
+  }
+
+  // Images that fit are kept at their size and centered when drawn, as the originals are
+  int outWidth = source.getWidth();
+  int outHeight = source.getHeight();
+  if (outWidth > SCREEN_WIDTH || outHeight > SCREEN_HEIGHT) {
+    ImagePipeline::fitSize(source.getWidth(), source.getHeight(), SCREEN_WIDTH, SCREEN_HEIGHT, cropped, outWidth,
+                           outHeight);
+  }
+  const int width = std::min(outWidth, SCREEN_WIDTH);
+  const int height = std::min(outHeight, SCREEN_HEIGHT);
+
+  Storage.mkdir(CACHE_DIR);
+  FsFile out;
+  if (!Storage.openFileForWrite("SLP", prepared, out)) {
+    file.close();
+    return false;
+  }
+  AtkinsonRowDitherer ditherer(width);
+  BmpRowSink bmp(out, 2, ditherer);
+  CenterCropSink crop(width, height, bmp);
+  const bool success = ImagePipeline::run(source, outWidth, outHeight, crop);
+  file.close();
+  out.close();
+
+  if (!success) {
+    LOG_ERR("SLP", "Failed to prepare sleep image: %s", path.c_str());
+    Storage.remove(prepared.c_str());
+  }
+  return success;
+}
+
+bool SleepImageLibrary::saveToFile() const {
+  // Make sure the directory exists
+  Storage.mkdir(CACHE_DIR);
+
+  FsFile outputFile;
+  if (!Storage.openFileForWrite("SLP", INDEX_FILE, outputFile)) {
+    return false;
+  }
+
+  serialization::writePod(outputFile, SLEEP_INDEX_FILE_VERSION);
+  serialization::writePod(outputFile, signature);
+  const uint16_t count = static_cast<uint16_t>(images.size());
+  serialization::writePod(outputFile, count);
+  for (const auto& image : images) {
+    serialization::writeString(outputFile, image.name);
+    serialization::writePod(outputFile, image.size);
+    serialization::writePod(outputFile, image.modified);
+    serialization::writePod(outputFile, image.native);
+  }
+  const uint16_t orderCount = static_cast<uint16_t>(order.size());
+  serialization::writePod(outputFile, orderCount);
+  for (const uint16_t index : order) {
+    serialization::writePod(outputFile, index);
+  }
+  serialization::writePod(outputFile, cursor);
+
+  outputFile.close();
+  return true;
+}
+
+bool SleepImageLibrary::loadFromFile() {
+  FsFile inputFile;
+  if (!Storage.openFileForRead("SLP", INDEX_FILE, inputFile)) {
+    return false;
+  }
+
+  uint8_t version;
+  serialization::readPod(inputFile, version);
+  if (version != SLEEP_INDEX_FILE_VERSION) {
+    LOG_ERR("SLP", "Deserialization failed: Unknown version %u", version);
+    inputFile.close();
+    // The prepared copies of another version are keyed differently and would never be found or removed
+    Storage.removeDir(CACHE_DIR);
+    return false;
+  }
+
+  serialization::readPod(inputFile, signature);
+  uint16_t count;
+  serialization::readPod(inputFile, count);
+  images.resize(count);
+  for (auto& image : images) {
+    serialization::readString(inputFile, image.name);
+    serialization::readPod(inputFile, image.size);
+    serialization::readPod(inputFile, image.modified);
+    serialization::readPod(inputFile, image.native);
+  }
+  uint16_t orderCount;
+  serialization::readPod(inputFile, orderCount);
+  order.resize(orderCount);
+  for (auto& index : order) {
+    serialization::readPod(inputFile, index);
+  }
+  serialization::readPod(inputFile, cursor);
+  inputFile.close();
+
+  // A shuffle that no longer matches the images starts over
+  if (std::any_of(order.begin(), order.end(), [&](const uint16_t index) { return index >= images.size(); })) {
+    order.clear();
+    cursor = 0;
+  }
+  LOG_DBG("SLP", "Sleep image index loaded (%d images)", static_cast<int>(images.size()));
+  return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Index of the custom sleep screens in /sleep, kept in /.crosspoint/sleep so going to sleep does not open and
+// validate every BMP each time. The index is rebuilt only when the listing of /sleep (names, sizes and modification
+// times) changes.
+//
+// Images that would be scaled or dithered while drawing get a prepared copy: a 2-bit BMP already scaled (and, in crop
+// mode, cropped) to the portrait screen, so the sleep screen is one sequential read and an unscaled blit whatever the
+// source. Copies are made in the background through COVER_JOBS; until one exists the original is drawn as before.
+//
+// Images are shown in a shuffled order that goes through the whole set before any repeats.
+class SleepImageLibrary {
+  struct Image {
+    std::string name;  // File name in /sleep
+    uint32_t size;
+    uint32_t modified;  // FAT modification date << 16 | time
+    bool native;        // Fits the screen at 1 or 2 bits per pixel, drawn as it is
+  };
+
+  // Static instance
+  static SleepImageLibrary instance;
+
+  std::vector<Image> images;
+  std::vector<uint16_t> order;  // Shuffled indices into images
+  uint16_t cursor = 0;          // Next position in order
+  uint32_t signature = 0;       // Hash of the /sleep listing the index was built from
+  bool loaded = false;
+
+  void rebuild(std::vector<Image> listing, uint32_t listingSignature);
+  void shuffle();
+  static std::string getPreparedPath(const Image& image, bool cropped);
+
+ public:
+  static constexpr char SLEEP_DIR[] = "/sleep";
+
+  ~SleepImageLibrary() = default;
+
+  // Get singleton instance
+  static SleepImageLibrary& getInstance() { return instance; }
+
+  // Brings the index up to date with /sleep. Returns false if there is no /sleep directory.
+  bool refresh();
+  // Path of the next image to show, the prepared copy for `cropped` when there is one. Empty when /sleep has no valid
+  // images.
+  std::string next(bool cropped);
+  // Queues a prepared copy of every image that needs one and does not have it yet
+  void queuePreparation(bool cropped) const;
+  // Writes the prepared copy of the image at `path` (a COVER_JOBS job)
+  static bool prepare(const std::string& path, bool cropped);
+
+  bool saveToFile() const;
+  bool loadFromFile();
+};
+
+// Helper macro to access the sleep image library
+#define SLEEP_IMAGES SleepImageLibrary::getInstance()
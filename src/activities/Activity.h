@@ -47,6 +47,8 @@ class Activity {
   virtual bool skipLoopDelay() { return false; }
   virtual bool preventAutoSleep() { return false; }
   virtual bool isReaderActivity() const { return false; }
+  // Whether the main loop may run queued cover jobs (SD card heavy) while this activity sits idle
+  virtual bool allowsBackgroundJobs() const { return false; }
 
   // RAII helper to lock rendering mutex for the duration of a scope.
   class RenderLock {
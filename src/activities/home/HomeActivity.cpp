@@ -1,16 +1,15 @@
 #include "HomeActivity.h"
 
 #include <Bitmap.h>
-#include <Epub.h>
 #include <GfxRenderer.h>
 #include <HalStorage.h>
 #include <I18n.h>
 #include <Utf8.h>
-#include <Xtc.h>
 
 #include <cstring>
 #include <vector>
 
+#include "CoverJobQueue.h"
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
 #include "MappedInputManager.h"
@@ -50,62 +49,21 @@ void HomeActivity::loadRecentBooks(int maxBooks) {
   }
 }
 
-void HomeActivity::loadRecentCovers(int coverHeight) {
-  recentsLoading = true;
-  bool showingLoading = false;
-  Rect popupRect;
-
-  int progress = 0;
-  for (RecentBook& book : recentBooks) {
-    if (!book.coverBmpPath.empty()) {
-      std::string coverPath = UITheme::getCoverThumbPath(book.coverBmpPath, coverHeight);
-      if (!Storage.exists(coverPath.c_str())) {
-        // If epub, try to load the metadata for title/author and cover
-        if (StringUtils::checkFileExtension(book.path, ".epub")) {
-          Epub epub(book.path, "/.crosspoint");
-          // Skip loading css since we only need metadata here
-          epub.load(false, true);
-
-          // Try to generate thumbnail image for Continue Reading card
-          if (!showingLoading) {
-            showingLoading = true;
-            popupRect = GUI.drawPopup(renderer, tr(STR_LOADING_POPUP));
-          }
-          GUI.fillPopupProgress(renderer, popupRect, 10 + progress * (90 / recentBooks.size()));
-          bool success = epub.generateThumbBmp(coverHeight);
-          if (!success) {
-            RECENT_BOOKS.updateBook(book.path, book.title, book.author, "");
-            book.coverBmpPath = "";
-          }
-          coverRendered = false;
-          requestUpdate();
-        } else if (StringUtils::checkFileExtension(book.path, ".xtch") ||
-                   StringUtils::checkFileExtension(book.path, ".xtc")) {
-          // Handle XTC file
-          Xtc xtc(book.path, "/.crosspoint");
-          if (xtc.load()) {
-            // Try to generate thumbnail image for Continue Reading card
-            if (!showingLoading) {
-              showingLoading = true;
-              popupRect = GUI.drawPopup(renderer, tr(STR_LOADING_POPUP));
-            }
-            GUI.fillPopupProgress(renderer, popupRect, 10 + progress * (90 / recentBooks.size()));
-            bool success = xtc.generateThumbBmp(coverHeight);
-            if (!success) {
-              RECENT_BOOKS.updateBook(book.path, book.title, book.author, "");
-              book.coverBmpPath = "";
-            }
-            coverRendered = false;
-            requestUpdate();
-          }
-        }
-      }
+void HomeActivity::queueRecentCovers(int coverHeight) const {
+  for (size_t i = 0; i < recentBooks.size(); i++) {
+    const RecentBook& book = recentBooks[i];
+    if (book.coverBmpPath.empty() ||
+        Storage.exists(UITheme::getCoverThumbPath(book.coverBmpPath, coverHeight).c_str())) {
+      continue;
+    }
+    if (!StringUtils::checkFileExtension(book.path, ".epub") && !StringUtils::checkFileExtension(book.path, ".xtch") &&
+        !StringUtils::checkFileExtension(book.path, ".xtc")) {
+      continue;
     }
-    progress++;
+    // The selected book's card first; the theme draws a placeholder until its thumbnail is ready
+    COVER_JOBS.enqueue(book.path, CoverJob::THUMB, coverHeight,
+                       i == 0 ? CoverJobQueue::PRIORITY_ON_SCREEN : CoverJobQueue::PRIORITY_RECENT);
   }
-
-  recentsLoaded = true;
-  recentsLoading = false;
 }
 
 void HomeActivity::onEnter() {
@@ -118,6 +76,8 @@ void HomeActivity::onEnter() {
 
   auto metrics = UITheme::getInstance().getMetrics();
   loadRecentBooks(metrics.homeRecentBooksCount);
+  coverJobsSeen = COVER_JOBS.getThumbnailCount();
+  queueRecentCovers(metrics.homeCoverHeight);
 
   // Trigger first update
   requestUpdate();
@@ -130,49 +90,26 @@ void HomeActivity::onExit() {
   freeCoverBuffer();
 }
 
-bool HomeActivity::storeCoverBuffer() {
-  uint8_t* frameBuffer = renderer.getFrameBuffer();
-  if (!frameBuffer) {
-    return false;
-  }
-
-  // Free any existing buffer first
-  freeCoverBuffer();
-
-  const size_t bufferSize = GfxRenderer::getBufferSize();
-  coverBuffer = static_cast<uint8_t*>(malloc(bufferSize));
-  if (!coverBuffer) {
-    return false;
-  }
-
-  memcpy(coverBuffer, frameBuffer, bufferSize);
-  return true;
-}
-
-bool HomeActivity::restoreCoverBuffer() {
-  if (!coverBuffer) {
-    return false;
-  }
-
-  uint8_t* frameBuffer = renderer.getFrameBuffer();
-  if (!frameBuffer) {
-    return false;
-  }
+bool HomeActivity::storeCoverBuffer() { return renderer.storeFrame(coverStash); }
 
-  const size_t bufferSize = GfxRenderer::getBufferSize();
-  memcpy(frameBuffer, coverBuffer, bufferSize);
-  return true;
-}
+bool HomeActivity::restoreCoverBuffer() { return renderer.restoreFrame(coverStash); }
 
 void HomeActivity::freeCoverBuffer() {
-  if (coverBuffer) {
-    free(coverBuffer);
-    coverBuffer = nullptr;
-  }
+  coverStash.release();
   coverBufferStored = false;
 }
 
 void HomeActivity::loop() {
+  if (coverJobsSeen != COVER_JOBS.getThumbnailCount()) {
+    // A thumbnail was generated (or given up on) in the background; redraw the cards with it
+    RenderLock lock(*this);
+    coverJobsSeen = COVER_JOBS.getThumbnailCount();
+    loadRecentBooks(UITheme::getInstance().getMetrics().homeRecentBooksCount);
+    coverRendered = false;
+    freeCoverBuffer();
+    requestUpdate();
+  }
+
   const int menuCount = getMenuItemCount();
 
   buttonNavigator.onNext([this, menuCount] {
@@ -253,8 +190,5 @@ void HomeActivity::render(Activity::RenderLock&&) {
   if (!firstRenderDone) {
     firstRenderDone = true;
     requestUpdate();
-  } else if (!recentsLoaded && !recentsLoading) {
-    recentsLoading = true;
-    loadRecentCovers(metrics.homeCoverHeight);
   }
 }
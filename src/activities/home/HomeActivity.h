@@ -1,4 +1,6 @@
 #pragma once
+#include <FrameStash.h>
+
 #include <functional>
 #include <vector>
 
@@ -12,14 +14,13 @@ struct Rect;
 class HomeActivity final : public Activity {
   ButtonNavigator buttonNavigator;
   int selectorIndex = 0;
-  bool recentsLoading = false;
-  bool recentsLoaded = false;
   bool firstRenderDone = false;
   bool hasOpdsUrl = false;
   bool coverRendered = false;      // Track if cover has been rendered once
   bool coverBufferStored = false;  // Track if cover buffer is stored
-  uint8_t* coverBuffer = nullptr;  // HomeActivity's own buffer for cover image
+  FrameStash coverStash;           // Frame with the cover image drawn, redrawn around on selection changes
   std::vector<RecentBook> recentBooks;
+  uint32_t coverJobsSeen = 0;  // COVER_JOBS thumbnail count the covers were last drawn at
   const std::function<void(const std::string& path)> onSelectBook;
   const std::function<void()> onMyLibraryOpen;
   const std::function<void()> onRecentsOpen;
@@ -32,7 +33,7 @@ class HomeActivity final : public Activity {
   bool restoreCoverBuffer();  // Restore frame buffer from stored cover
   void freeCoverBuffer();     // Free the stored cover buffer
   void loadRecentBooks(int maxBooks);
-  void loadRecentCovers(int coverHeight);
+  void queueRecentCovers(int coverHeight) const;
 
  public:
   explicit HomeActivity(GfxRenderer& renderer, MappedInputManager& mappedInput,
@@ -51,4 +52,5 @@ class HomeActivity final : public Activity {
   void onExit() override;
   void loop() override;
   void render(Activity::RenderLock&&) override;
+  bool allowsBackgroundJobs() const override { return true; }
 };
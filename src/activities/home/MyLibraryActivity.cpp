@@ -222,7 +222,7 @@ void MyLibraryActivity::render(Activity::RenderLock&&) {
                                             tr(STR_DIR_DOWN));
   GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
 
-  renderer.displayBuffer();
+  renderer.displayDirtyRegion();
 }
 
 size_t MyLibraryActivity::findEntry(const std::string& name) const {
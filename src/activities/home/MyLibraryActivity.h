@@ -38,4 +38,5 @@ class MyLibraryActivity final : public Activity {
   void onExit() override;
   void loop() override;
   void render(Activity::RenderLock&&) override;
+  bool allowsBackgroundJobs() const override { return true; }
 };
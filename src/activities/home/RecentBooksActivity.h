@@ -34,4 +34,5 @@ class RecentBooksActivity final : public Activity {
   void onExit() override;
   void loop() override;
   void render(Activity::RenderLock&&) override;
+  bool allowsBackgroundJobs() const override { return true; }
 };
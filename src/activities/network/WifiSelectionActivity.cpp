@@ -510,7 +510,7 @@ void WifiSelectionActivity::render(Activity::RenderLock&&) {
       break;
   }
 
-  renderer.displayBuffer();
+  renderer.displayDirtyRegion();
 }
 
 void WifiSelectionActivity::renderNetworkList() const {
@@ -6,7 +6,9 @@
 #include <HalStorage.h>
 #include <I18n.h>
 #include <Logging.h>
+#include <Trace.h>
 
+#include "CoverJobQueue.h"
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
 #include "EpubReaderChapterSelectionActivity.h"
@@ -68,6 +70,10 @@ void EpubReaderActivity::onEnter() {
   // Configure screen orientation based on settings
   // NOTE: This affects layout math and must be applied before any render calls.
   applyReaderOrientation(renderer, SETTINGS.orientation);
+  // Draw pages row by row in reader orientation; falls back to drawing straight to the panel if memory is short
+  renderer.setLogicalBufferEnabled(true);
+  // The first page of the book clears whatever the menus left on the panel
+  renderer.requestHalfRefresh();
 
   epub->setupCacheDir();
 
@@ -100,6 +106,7 @@ void EpubReaderActivity::onEnter() {
   APP_STATE.openEpubPath = epub->getPath();
   APP_STATE.saveToFile();
   RECENT_BOOKS.addBook(epub->getPath(), epub->getTitle(), epub->getAuthor(), epub->getThumbBmpPath());
+  COVER_JOBS.enqueueBookCovers(epub->getPath());
 
   // Trigger first update
   requestUpdate();
@@ -109,7 +116,12 @@ void EpubReaderActivity::onExit() {
   ActivityWithSubactivity::onExit();
 
   // Reset orientation back to portrait for the rest of the UI
+  renderer.setLogicalBufferEnabled(false);
   renderer.setOrientation(GfxRenderer::Orientation::Portrait);
+  // Release the word runs composed for the book font
+  renderer.clearWordRunCache();
+  // and the BW stash the anti-aliased pages kept
+  renderer.releaseBwBuffer();
 
   APP_STATE.readerActivityLoadCount = 0;
   APP_STATE.saveToFile();
@@ -611,9 +623,11 @@ void EpubReaderActivity::render(Activity::RenderLock&& lock) {
       return;
     }
     const auto start = millis();
+    TRACE_SPAN("page_turn");
     renderContents(std::move(p), orientedMarginTop, orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
     LOG_DBG("ERS", "Rendered page in %dms", millis() - start);
     renderer.clearFontCache();
+    renderer.logWordRunCacheStats();
   }
   saveProgress(currentSpineIndex, section->currentPage, section->pageCount);
 }
@@ -661,13 +675,9 @@ void EpubReaderActivity::renderContents(std::unique_ptr<Page> page, const int or
     } else {
       renderer.displayBuffer(HalDisplay::HALF_REFRESH);
     }
-    // Double FAST_REFRESH handles ghosting for image pages; don't count toward full refresh cadence
-  } else if (pagesUntilFullRefresh <= 1) {
-    renderer.displayBuffer(HalDisplay::HALF_REFRESH);
-    pagesUntilFullRefresh = SETTINGS.getRefreshFrequency();
+    // Double FAST_REFRESH handles ghosting for image pages; the refresh planner still records both frames
   } else {
-    renderer.displayBuffer();
-    pagesUntilFullRefresh--;
+    renderer.displayAutoRefresh(SETTINGS.getRefreshFrequency());
   }
 
   // Save bw buffer to reset buffer state after grayscale data sync
@@ -6,6 +6,7 @@
 #include <Serialization.h>
 #include <Utf8.h>
 
+#include "CoverJobQueue.h"
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
 #include "MappedInputManager.h"
@@ -48,6 +49,10 @@ void TxtReaderActivity::onEnter() {
     default:
       break;
   }
+  // Draw pages row by row in reader orientation; falls back to drawing straight to the panel if memory is short
+  renderer.setLogicalBufferEnabled(true);
+  // The first page of the book clears whatever the menus left on the panel
+  renderer.requestHalfRefresh();
 
   txt->setupCacheDir();
 
@@ -57,6 +62,7 @@ void TxtReaderActivity::onEnter() {
   APP_STATE.openEpubPath = filePath;
   APP_STATE.saveToFile();
   RECENT_BOOKS.addBook(filePath, fileName, "", "");
+  COVER_JOBS.enqueueBookCovers(filePath);
 
   // Trigger first update
   requestUpdate();
@@ -66,7 +72,12 @@ void TxtReaderActivity::onExit() {
   ActivityWithSubactivity::onExit();
 
   // Reset orientation back to portrait for the rest of the UI
+  renderer.setLogicalBufferEnabled(false);
   renderer.setOrientation(GfxRenderer::Orientation::Portrait);
+  // Release the word runs composed for the book font
+  renderer.clearWordRunCache();
+  // and the BW stash the anti-aliased pages kept
+  renderer.releaseBwBuffer();
 
   pageOffsets.clear();
   currentPageLines.clear();
@@ -369,6 +380,7 @@ void TxtReaderActivity::render(Activity::RenderLock&&) {
   renderer.clearScreen();
   renderPage();
   renderer.clearFontCache();
+  renderer.logWordRunCacheStats();
 
   // Save progress
   saveProgress();
@@ -425,13 +437,7 @@ void TxtReaderActivity::renderPage() {
   renderLines();
   renderStatusBar(orientedMarginRight, orientedMarginBottom, orientedMarginLeft);
 
-  if (pagesUntilFullRefresh <= 1) {
-    renderer.displayBuffer(HalDisplay::HALF_REFRESH);
-    pagesUntilFullRefresh = SETTINGS.getRefreshFrequency();
-  } else {
-    renderer.displayBuffer();
-    pagesUntilFullRefresh--;
-  }
+  renderer.displayAutoRefresh(SETTINGS.getRefreshFrequency());
 
   // Grayscale rendering pass (for anti-aliased fonts)
   if (SETTINGS.textAntiAliasing) {
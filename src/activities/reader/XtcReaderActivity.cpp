@@ -12,6 +12,7 @@
 #include <HalStorage.h>
 #include <I18n.h>
 
+#include "CoverJobQueue.h"
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
 #include "MappedInputManager.h"
@@ -33,6 +34,8 @@ void XtcReaderActivity::onEnter() {
   }
 
   xtc->setupCacheDir();
+  // The first page of the book clears whatever the menus left on the panel
+  renderer.requestHalfRefresh();
 
   // Load saved progress
   loadProgress();
@@ -41,6 +44,7 @@ void XtcReaderActivity::onEnter() {
   APP_STATE.openEpubPath = xtc->getPath();
   APP_STATE.saveToFile();
   RECENT_BOOKS.addBook(xtc->getPath(), xtc->getTitle(), xtc->getAuthor(), xtc->getThumbBmpPath());
+  COVER_JOBS.enqueueBookCovers(xtc->getPath());
 
   // Trigger first update
   requestUpdate();
@@ -242,14 +246,8 @@ void XtcReaderActivity::renderPage() {
       }
     }
 
-    // Display BW with conditional refresh based on pagesUntilFullRefresh
-    if (pagesUntilFullRefresh <= 1) {
-      renderer.displayBuffer(HalDisplay::HALF_REFRESH);
-      pagesUntilFullRefresh = SETTINGS.getRefreshFrequency();
-    } else {
-      renderer.displayBuffer();
-      pagesUntilFullRefresh--;
-    }
+    // Display BW, letting the refresh planner pick the refresh from what changed
+    renderer.displayAutoRefresh(SETTINGS.getRefreshFrequency());
 
     // Pass 2: LSB buffer - mark DARK gray only (XTH value 1)
     // In LUT: 0 bit = apply gray effect, 1 bit = untouched
@@ -322,13 +320,7 @@ void XtcReaderActivity::renderPage() {
   // XTC pages already have status bar pre-rendered, no need to add our own
 
   // Display with appropriate refresh
-  if (pagesUntilFullRefresh <= 1) {
-    renderer.displayBuffer(HalDisplay::HALF_REFRESH);
-    pagesUntilFullRefresh = SETTINGS.getRefreshFrequency();
-  } else {
-    renderer.displayBuffer();
-    pagesUntilFullRefresh--;
-  }
+  renderer.displayAutoRefresh(SETTINGS.getRefreshFrequency());
 
   LOG_DBG("XTR", "Rendered page %lu/%lu (%u-bit)", currentPage + 1, xtc->getPageCount(), bitDepth);
 }
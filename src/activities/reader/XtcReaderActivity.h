@@ -15,7 +15,6 @@ class XtcReaderActivity final : public ActivityWithSubactivity {
   std::shared_ptr<Xtc> xtc;
 
   uint32_t currentPage = 0;
-  int pagesUntilFullRefresh = 0;
 
   const std::function<void()> onGoBack;
   const std::function<void()> onGoHome;
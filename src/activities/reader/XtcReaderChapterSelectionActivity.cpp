@@ -132,5 +132,5 @@ void XtcReaderChapterSelectionActivity::render(Activity::RenderLock&&) {
     GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
   }
 
-  renderer.displayBuffer();
+  renderer.displayDirtyRegion();
 }
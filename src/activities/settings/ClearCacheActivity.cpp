@@ -94,8 +94,9 @@ void ClearCacheActivity::clearCache() {
     file.getName(name, sizeof(name));
     String itemName(name);
 
-    // Only delete directories starting with epub_ or xtc_
-    if (file.isDirectory() && (itemName.startsWith("epub_") || itemName.startsWith("xtc_"))) {
+    // Only delete directories starting with epub_ or xtc_, and the images the EPUB caches share
+    if (file.isDirectory() &&
+        (itemName.startsWith("epub_") || itemName.startsWith("xtc_") || itemName == "images")) {
       String fullPath = "/.crosspoint/" + itemName;
       LOG_DBG("CLEAR_CACHE", "Removing cache: %s", fullPath.c_str());
 
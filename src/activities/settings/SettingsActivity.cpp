@@ -257,6 +257,6 @@ void SettingsActivity::render(Activity::RenderLock&&) {
   const auto labels = mappedInput.mapLabels(tr(STR_BACK), tr(STR_TOGGLE), tr(STR_DIR_UP), tr(STR_DIR_DOWN));
   GUI.drawButtonHints(renderer, labels.btn1, labels.btn2, labels.btn3, labels.btn4);
 
-  // Always use standard refresh for settings screen
-  renderer.displayBuffer();
+  // The screen is redrawn from scratch; only the tiles that differ from the displayed frame are refreshed
+  renderer.displayDirtyRegion();
 }
\ No newline at end of file
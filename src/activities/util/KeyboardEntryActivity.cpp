@@ -21,6 +21,7 @@ const char* const KeyboardEntryActivity::shiftString[3] = {"shift", "SHIFT", "LO
 
 void KeyboardEntryActivity::onEnter() {
   Activity::onEnter();
+  fullRedraw = true;
 
   // Trigger first update
   requestUpdate();
@@ -57,6 +58,84 @@ char KeyboardEntryActivity::getSelectedChar() const {
   return layout[selectedRow][selectedCol];
 }
 
+// Keys of the bottom row span several logical columns; returns the first column of the key holding `col`
+int KeyboardEntryActivity::getKeyStartCol(const int row, const int col) const {
+  if (row != SPECIAL_ROW) return col;
+  if (col >= DONE_COL) return DONE_COL;
+  if (col >= BACKSPACE_COL) return BACKSPACE_COL;
+  if (col >= SPACE_COL) return SPACE_COL;
+  return SHIFT_COL;
+}
+
+Rect KeyboardEntryActivity::getKeyRect(const int row, const int col) const {
+  const auto& metrics = UITheme::getInstance().getMetrics();
+  const int keyPitch = metrics.keyboardKeyWidth + metrics.keyboardKeySpacing;
+  const int rowY = keyboardStartY + row * (metrics.keyboardKeyHeight + metrics.keyboardKeySpacing);
+  if (row != SPECIAL_ROW) {
+    return Rect{keyboardLeft + col * keyPitch, rowY, metrics.keyboardKeyWidth, metrics.keyboardKeyHeight};
+  }
+
+  // Bottom row layout: SHIFT (2 cols) | SPACE (5 cols) | <- (2 cols) | OK (2 cols)
+  const int startCol = getKeyStartCol(row, col);
+  int endCol = getRowLength(row);
+  if (startCol == SHIFT_COL) {
+    endCol = SPACE_COL;
+  } else if (startCol == SPACE_COL) {
+    endCol = BACKSPACE_COL;
+  } else if (startCol == BACKSPACE_COL) {
+    endCol = DONE_COL;
+  }
+  return Rect{keyboardLeft + startCol * keyPitch, rowY, (endCol - startCol) * keyPitch, metrics.keyboardKeyHeight};
+}
+
+void KeyboardEntryActivity::drawKey(const int row, const int col, const bool selected) const {
+  const Rect rect = getKeyRect(row, col);
+  if (row == SPECIAL_ROW) {
+    const char* label = tr(STR_OK_BUTTON);
+    switch (getKeyStartCol(row, col)) {
+      case SHIFT_COL:
+        label = shiftString[shiftState];
+        break;
+      case SPACE_COL:
+        label = "_____";
+        break;
+      case BACKSPACE_COL:
+        label = "<-";
+        break;
+      default:
+        break;
+    }
+    GUI.drawKeyboardKey(renderer, rect, label, selected);
+    return;
+  }
+
+  const char* const* layout = shiftState ? keyboardShift : keyboard;
+  const char label[2] = {layout[row][col], '\0'};
+  GUI.drawKeyboardKey(renderer, rect, label, selected);
+}
+
+// Only the selection moved: repaint the previously and newly selected keys and refresh just that part of the panel
+void KeyboardEntryActivity::renderSelectionChange(const int row, const int col) {
+  if (row == drawnRow && getKeyStartCol(row, col) == getKeyStartCol(drawnRow, drawnCol)) {
+    return;
+  }
+
+  const int keySpacing = UITheme::getInstance().getMetrics().keyboardKeySpacing;
+  for (const bool selected : {false, true}) {
+    const int keyRow = selected ? row : drawnRow;
+    const int keyCol = selected ? col : drawnCol;
+    // Clear the key's cell (regular keys leave the spacing gap outside their rect) before drawing it again
+    const Rect rect = getKeyRect(keyRow, keyCol);
+    const int cellWidth = keyRow == SPECIAL_ROW ? rect.width : rect.width + keySpacing;
+    renderer.fillRect(rect.x, rect.y, cellWidth, rect.height + keySpacing, false);
+    drawKey(keyRow, keyCol, selected);
+  }
+  renderer.displayDirtyRegion();
+
+  drawnRow = row;
+  drawnCol = col;
+}
+
 void KeyboardEntryActivity::handleKeyPress() {
   // Handle special row (bottom row with shift, space, backspace, done)
   if (selectedRow == SPECIAL_ROW) {
@@ -178,6 +257,7 @@ void KeyboardEntryActivity::loop() {
   // Selection
   if (mappedInput.wasPressed(MappedInputManager::Button::Confirm)) {
     handleKeyPress();
+    fullRedraw = true;
     requestUpdate();
   }
 
@@ -186,11 +266,19 @@ void KeyboardEntryActivity::loop() {
     if (onCancel) {
       onCancel();
     }
+    fullRedraw = true;
     requestUpdate();
   }
 }
 
 void KeyboardEntryActivity::render(Activity::RenderLock&&) {
+  const int row = selectedRow;
+  const int col = selectedCol;
+  if (!fullRedraw && drawnRow >= 0) {
+    renderSelectionChange(row, col);
+    return;
+  }
+
   renderer.clearScreen();
 
   const auto pageWidth = renderer.getScreenWidth();
@@ -243,72 +331,20 @@ void KeyboardEntryActivity::render(Activity::RenderLock&&) {
   GUI.drawTextField(renderer, Rect{0, inputStartY, pageWidth, inputHeight}, textWidth);
 
   // Draw keyboard - use compact spacing to fit 5 rows on screen
-  const int keyboardStartY = metrics.keyboardBottomAligned
-                                 ? pageHeight - metrics.buttonHintsHeight - metrics.verticalSpacing -
-                                       (metrics.keyboardKeyHeight + metrics.keyboardKeySpacing) * NUM_ROWS
-                                 : inputStartY + inputHeight + metrics.verticalSpacing * 4;
-  const int keyWidth = metrics.keyboardKeyWidth;
-  const int keyHeight = metrics.keyboardKeyHeight;
-  const int keySpacing = metrics.keyboardKeySpacing;
-
-  const char* const* layout = shiftState ? keyboardShift : keyboard;
+  keyboardStartY = metrics.keyboardBottomAligned
+                       ? pageHeight - metrics.buttonHintsHeight - metrics.verticalSpacing -
+                             (metrics.keyboardKeyHeight + metrics.keyboardKeySpacing) * NUM_ROWS
+                       : inputStartY + inputHeight + metrics.verticalSpacing * 4;
 
   // Calculate left margin to center the longest row (13 keys)
-  const int maxRowWidth = KEYS_PER_ROW * (keyWidth + keySpacing);
-  const int leftMargin = (pageWidth - maxRowWidth) / 2;
-
-  for (int row = 0; row < NUM_ROWS; row++) {
-    const int rowY = keyboardStartY + row * (keyHeight + keySpacing);
-
-    // Left-align all rows for consistent navigation
-    const int startX = leftMargin;
-
-    // Handle bottom row (row 4) specially with proper multi-column keys
-    if (row == SPECIAL_ROW) {
-      // Bottom row layout: SHIFT (2 cols) | SPACE (5 cols) | <- (2 cols) | OK (2 cols)
-      // Total: 11 visual columns, but we use logical positions for selection
-
-      int currentX = startX;
-
-      // SHIFT key (logical col 0, spans 2 key widths)
-      const bool shiftSelected = (selectedRow == SPECIAL_ROW && selectedCol >= SHIFT_COL && selectedCol < SPACE_COL);
-      const int shiftWidth = SPACE_COL - SHIFT_COL;
-      const int shiftXWidth = shiftWidth * (keyWidth + keySpacing);
-      GUI.drawKeyboardKey(renderer, Rect{currentX, rowY, shiftXWidth, keyHeight}, shiftString[shiftState],
-                          shiftSelected);
-      currentX += shiftXWidth;
-
-      // Space bar (logical cols 2-6, spans 5 key widths)
-      const bool spaceSelected =
-          (selectedRow == SPECIAL_ROW && selectedCol >= SPACE_COL && selectedCol < BACKSPACE_COL);
-      const int spaceWidth = BACKSPACE_COL - SPACE_COL;
-      const int spaceXWidth = spaceWidth * (keyWidth + keySpacing);
-      GUI.drawKeyboardKey(renderer, Rect{currentX, rowY, spaceXWidth, keyHeight}, "_____", spaceSelected);
-      currentX += spaceXWidth;
-
-      // Backspace key (logical col 7, spans 2 key widths)
-      const bool bsSelected = (selectedRow == SPECIAL_ROW && selectedCol >= BACKSPACE_COL && selectedCol < DONE_COL);
-      const int backspaceWidth = DONE_COL - BACKSPACE_COL;
-      const int backspaceXWidth = backspaceWidth * (keyWidth + keySpacing);
-      GUI.drawKeyboardKey(renderer, Rect{currentX, rowY, backspaceXWidth, keyHeight}, "<-", bsSelected);
-      currentX += backspaceXWidth;
-
-      // OK button (logical col 9, spans 2 key widths)
-      const bool okSelected = (selectedRow == SPECIAL_ROW && selectedCol >= DONE_COL);
-      const int okWidth = getRowLength(row) - DONE_COL;
-      const int okXWidth = okWidth * (keyWidth + keySpacing);
-      GUI.drawKeyboardKey(renderer, Rect{currentX, rowY, okXWidth, keyHeight}, tr(STR_OK_BUTTON), okSelected);
-    } else {
-      // Regular rows: render each key individually
-      for (int col = 0; col < getRowLength(row); col++) {
-        // Get the character to display
-        const char c = layout[row][col];
-        std::string keyLabel(1, c);
-
-        const int keyX = startX + col * (keyWidth + keySpacing);
-        const bool isSelected = row == selectedRow && col == selectedCol;
-        GUI.drawKeyboardKey(renderer, Rect{keyX, rowY, keyWidth, keyHeight}, keyLabel.c_str(), isSelected);
-      }
+  const int maxRowWidth = KEYS_PER_ROW * (metrics.keyboardKeyWidth + metrics.keyboardKeySpacing);
+  keyboardLeft = (pageWidth - maxRowWidth) / 2;
+
+  // Left-align all rows for consistent navigation; multi-column keys of the bottom row are drawn at their first column
+  for (int keyRow = 0; keyRow < NUM_ROWS; keyRow++) {
+    for (int keyCol = 0; keyCol < getRowLength(keyRow); keyCol++) {
+      if (getKeyStartCol(keyRow, keyCol) != keyCol) continue;
+      drawKey(keyRow, keyCol, keyRow == row && keyCol == getKeyStartCol(row, col));
     }
   }
 
@@ -320,4 +356,7 @@ void KeyboardEntryActivity::render(Activity::RenderLock&&) {
   GUI.drawSideButtonHints(renderer, ">", "<");
 
   renderer.displayBuffer();
+  fullRedraw = false;
+  drawnRow = row;
+  drawnCol = col;
 }
@@ -6,6 +6,7 @@
 #include <utility>
 
 #include "../Activity.h"
+#include "components/themes/BaseTheme.h"
 #include "util/ButtonNavigator.h"
 
 /**
@@ -67,6 +68,13 @@ class KeyboardEntryActivity : public Activity {
   int selectedCol = 0;
   int shiftState = 0;  // 0 = lower case, 1 = upper case, 2 = shift lock)
 
+  // What is on screen: moving the selection only repaints the keys involved until something else changes
+  bool fullRedraw = true;
+  int drawnRow = -1;
+  int drawnCol = -1;
+  int keyboardStartY = 0;
+  int keyboardLeft = 0;
+
   // Callbacks
   OnCompleteCallback onComplete;
   OnCancelCallback onCancel;
@@ -88,4 +96,8 @@ class KeyboardEntryActivity : public Activity {
   char getSelectedChar() const;
   void handleKeyPress();
   int getRowLength(int row) const;
+  int getKeyStartCol(int row, int col) const;
+  Rect getKeyRect(int row, int col) const;
+  void drawKey(int row, int col, bool selected) const;
+  void renderSelectionChange(int row, int col);
 };
@@ -9,10 +9,12 @@
 #include <I18n.h>
 #include <Logging.h>
 #include <SPI.h>
+#include <Trace.h>
 #include <builtinFonts/all.h>
 
 #include <cstring>
 
+#include "CoverJobQueue.h"
 #include "CrossPointSettings.h"
 #include "CrossPointState.h"
 #include "KOReaderCredentialStore.h"
@@ -37,6 +39,8 @@ HalGPIO gpio;
 MappedInputManager mappedInputManager(gpio);
 GfxRenderer renderer(display);
 FontDecompressor fontDecompressor;
+WordRunCache wordRunCache;
+RefreshPlanner refreshPlanner;
 Activity* currentActivity;
 
 // Fonts
@@ -197,6 +201,14 @@ void waitForPowerRelease() {
   }
 }
 
+// Writes out the deferred LOG_* lines whenever the loop and render tasks are idle
+void logFlushTask(void*) {
+  while (true) {
+    logFlush();
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+}
+
 // Enter deep sleep mode
 void enterDeepSleep() {
   APP_STATE.lastSleepFromReader = currentActivity && currentActivity->isReaderActivity();
@@ -207,6 +219,7 @@ void enterDeepSleep() {
   display.deepSleep();
   LOG_DBG("MAIN", "Power button press calibration value: %lu ms", t2 - t1);
   LOG_DBG("MAIN", "Entering deep sleep");
+  logFlush();
 
   powerManager.startDeepSleep(gpio);
 }
@@ -266,6 +279,8 @@ void setupDisplayAndFonts() {
     LOG_ERR("MAIN", "Font decompressor init failed");
   }
   renderer.setFontDecompressor(&fontDecompressor);
+  renderer.setWordRunCache(&wordRunCache);
+  renderer.setRefreshPlanner(&refreshPlanner);
   renderer.insertFont(BOOKERLY_14_FONT_ID, bookerly14FontFamily);
 #ifndef OMIT_FONTS
   renderer.insertFont(BOOKERLY_12_FONT_ID, bookerly12FontFamily);
@@ -301,6 +316,9 @@ void setup() {
     while (!Serial && (millis() - start) < 3000) {
       delay(10);
     }
+    if (xTaskCreate(&logFlushTask, "logFlush", 4096, nullptr, tskIDLE_PRIORITY, nullptr) == pdPASS) {
+      logSetDeferred(true);
+    }
   }
 
   // SD Card Initialization
@@ -347,6 +365,7 @@ void setup() {
 
   APP_STATE.loadFromFile();
   RECENT_BOOKS.loadFromFile();
+  COVER_JOBS.loadFromFile();
 
   // Boot to home screen if no book is open, last sleep was not from reader, back button is held, or reader activity
   // crashed (indicated by readerActivityLoadCount > 0)
@@ -393,6 +412,15 @@ void loop() {
         uint8_t* buf = display.getFrameBuffer();
         logSerial.write(buf, HalDisplay::BUFFER_SIZE);
         logSerial.printf("SCREENSHOT_END\n");
+      } else if (cmd == "TRACE_ON") {
+        Trace::clear();
+        Trace::enable();
+      } else if (cmd == "TRACE_OFF") {
+        Trace::disable();
+      } else if (cmd == "TRACE_DUMP") {
+        logSerial.printf("TRACE_START:%u\n", static_cast<unsigned>(Trace::getEventCount()));
+        Trace::writeChromeJson([](const char* line) { logSerial.printf("%s\n", line); });
+        logSerial.printf("TRACE_END\n");
       }
     }
   }
@@ -432,12 +460,22 @@ void loop() {
     }
   }
 
+  // Generate queued covers and thumbnails one at a time once the user has stopped pressing buttons. Jobs hold the
+  // activity's render lock, since the render task shares the SD card and the renderer's buffers.
+  if (currentActivity && currentActivity->allowsBackgroundJobs() && !COVER_JOBS.isEmpty() &&
+      millis() - lastActivityTime >= CoverJobQueue::IDLE_DELAY_MS) {
+    powerManager.setPowerSaving(false);
+    Activity::RenderLock lock(*currentActivity);
+    COVER_JOBS.runNext();
+  }
+
   // Add delay at the end of the loop to prevent tight spinning
   // When an activity requests skip loop delay (e.g., webserver running), use yield() for faster response
   // Otherwise, use longer delay to save power
   if (currentActivity && currentActivity->skipLoopDelay()) {
     powerManager.setPowerSaving(false);  // Make sure we're at full performance when skipLoopDelay is requested
     yield();                             // Give FreeRTOS a chance to run tasks, but return immediately
+    logFlush();                          // The idle-priority log task never runs while the loop spins
   } else {
     if (millis() - lastActivityTime >= HalPowerManager::IDLE_POWER_SAVING_MS) {
       // If we've been inactive for a while, increase the delay to save power
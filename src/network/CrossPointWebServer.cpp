@@ -5,11 +5,13 @@
 #include <FsHelpers.h>
 #include <HalStorage.h>
 #include <Logging.h>
+#include <Trace.h>
 #include <WiFi.h>
 #include <esp_task_wdt.h>
 
 #include <algorithm>
 
+#include "CoverJobQueue.h"
 #include "CrossPointSettings.h"
 #include "SettingsList.h"
 #include "html/FilesPageHtml.generated.h"
@@ -156,6 +158,10 @@ void CrossPointWebServer::begin() {
   server->on("/api/settings", HTTP_GET, [this] { handleGetSettings(); });
   server->on("/api/settings", HTTP_POST, [this] { handlePostSettings(); });
 
+  // Trace endpoints: the recorded spans as Chrome trace JSON, and switching recording on or off
+  server->on("/api/trace", HTTP_GET, [this] { handleGetTrace(); });
+  server->on("/api/trace", HTTP_POST, [this] { handlePostTrace(); });
+
   server->onNotFound([this] { handleNotFound(); });
   LOG_DBG("WEB", "[MEM] Free heap after route setup: %d bytes", ESP.getFreeHeap());
 
@@ -808,6 +814,7 @@ void CrossPointWebServer::handleRename() const {
   }
 
   clearEpubCacheIfNeeded(itemPath);
+  COVER_JOBS.cancel(itemPath.c_str());
   const bool success = file.rename(newPath.c_str());
   file.close();
 
@@ -901,6 +908,7 @@ void CrossPointWebServer::handleMove() const {
   }
 
   clearEpubCacheIfNeeded(itemPath);
+  COVER_JOBS.cancel(itemPath.c_str());
   const bool success = file.rename(newPath.c_str());
   file.close();
 
@@ -988,6 +996,7 @@ void CrossPointWebServer::handleDelete() const {
 
   if (success) {
     LOG_DBG("WEB", "Successfully deleted: %s", itemPath.c_str());
+    COVER_JOBS.cancel(itemPath.c_str());
     server->send(200, "text/plain", "Deleted successfully");
   } else {
     LOG_ERR("WEB", "Failed to delete: %s", itemPath.c_str());
@@ -1306,3 +1315,33 @@ void CrossPointWebServer::onWebSocketEvent(uint8_t num, WStype_t type, uint8_t*
       break;
   }
 }
+
+void CrossPointWebServer::handleGetTrace() const {
+  server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server->send(200, "application/json", "");
+  Trace::writeChromeJson([this](const char* line) {
+    server->sendContent(line);
+    server->sendContent("\n");
+  });
+  // End of streamed response, empty chunk to signal client
+  server->sendContent("");
+  LOG_DBG("WEB", "Served %zu trace events", Trace::getEventCount());
+}
+
+void CrossPointWebServer::handlePostTrace() const {
+  if (!server->hasArg("enabled")) {
+    server->send(400, "text/plain", "Missing enabled");
+    return;
+  }
+
+  if (server->arg("enabled") == "1") {
+    Trace::clear();
+    if (!Trace::enable()) {
+      server->send(500, "text/plain", "Failed to allocate trace buffer");
+      return;
+    }
+  } else {
+    Trace::disable();
+  }
+  server->send(200, "text/plain", Trace::isEnabled() ? "Tracing enabled" : "Tracing disabled");
+}
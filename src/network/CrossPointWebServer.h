@@ -105,4 +105,8 @@ class CrossPointWebServer {
   void handleSettingsPage() const;
   void handleGetSettings() const;
   void handlePostSettings();
+
+  // Trace handlers
+  void handleGetTrace() const;
+  void handlePostTrace() const;
 };
@@ -0,0 +1,190 @@
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HostTest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "lib/EpdFont/builtinFonts/ubuntu_10_regular.h"
+
+// Draws small updates on top of a displayed frame and checks on the host panel model that displayDirtyRegion
+// transfers exactly the panel bytes that changed, in every orientation and with the logical back buffer. A list menu
+// redrawn from scratch checks that the RefreshPlanner narrows a full-screen redraw to the rows that changed.
+
+namespace {
+constexpr int FONT_ID = 1;
+
+struct PanelRect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+  bool operator==(const PanelRect& o) const { return x == o.x && y == o.y && width == o.width && height == o.height; }
+  bool contains(const PanelRect& o) const {
+    return o.x >= x && o.y >= y && o.x + o.width <= x + width && o.y + o.height <= y + height;
+  }
+};
+
+std::string describe(const PanelRect& r) {
+  return "(" + std::to_string(r.x) + ", " + std::to_string(r.y) + ") " + std::to_string(r.width) + "x" +
+         std::to_string(r.height);
+}
+
+// Bounding box, in whole panel bytes, of what differs between the panel and the frame buffer
+bool changedBytes(const uint8_t* shown, const uint8_t* frame, PanelRect* out) {
+  int minX = INT32_MAX, minY = INT32_MAX, maxX = -1, maxY = -1;
+  for (int y = 0; y < HalDisplay::DISPLAY_HEIGHT; y++) {
+    for (int b = 0; b < HalDisplay::DISPLAY_WIDTH_BYTES; b++) {
+      const int i = y * HalDisplay::DISPLAY_WIDTH_BYTES + b;
+      if (shown[i] == frame[i]) continue;
+      minX = std::min(minX, b);
+      maxX = std::max(maxX, b);
+      minY = std::min(minY, y);
+      maxY = std::max(maxY, y);
+    }
+  }
+  if (maxX < 0) return false;
+  *out = PanelRect{minX * 8, minY, (maxX - minX + 1) * 8, maxY - minY + 1};
+  return true;
+}
+
+const uint8_t kIcon[16 * 16 / 8] = {0x00, 0x00, 0x7F, 0xFE, 0x40, 0x02, 0x5F, 0xFA, 0x50, 0x0A, 0x57, 0xEA,
+                                    0x54, 0x2A, 0x55, 0xAA, 0x55, 0xAA, 0x54, 0x2A, 0x57, 0xEA, 0x50, 0x0A,
+                                    0x5F, 0xFA, 0x40, 0x02, 0x7F, 0xFE, 0x00, 0x00};
+}  // namespace
+
+int main() {
+  HalDisplay display;
+  EpdFont font(&ubuntu_10_regular);
+  EpdFontFamily family(&font);
+  GfxRenderer renderer(display);
+  renderer.begin();
+  renderer.insertFont(FONT_ID, family);
+
+  // The host driver models what the panel shows
+  EInkDisplay& panel = *EInkDisplay::latest();
+  const uint8_t* frame = display.getFrameBuffer();
+
+  struct Update {
+    const char* name;
+    void (*draw)(const GfxRenderer&);
+  };
+  const Update updates[] = {
+      {"pixel", [](const GfxRenderer& r) { r.drawPixel(101, 203, true); }},
+      {"rect", [](const GfxRenderer& r) { r.fillRect(33, 150, 57, 21, true); }},
+      {"dither", [](const GfxRenderer& r) { r.fillRectDither(13, 300, 70, 40, Color::DarkGray); }},
+      {"text", [](const GfxRenderer& r) { r.drawText(FONT_ID, 40, 240, "Status 42%"); }},
+      {"rounded key", [](const GfxRenderer& r) { r.fillRoundedRect(200, 380, 31, 50, 6, Color::Black); }},
+      {"two keys",
+       [](const GfxRenderer& r) {
+         r.fillRect(40, 400, 31, 50, true);
+         r.fillRect(300, 440, 31, 50, true);
+       }},
+      {"icon", [](const GfxRenderer& r) { r.drawIcon(kIcon, 120, 96, 16, 16); }},
+  };
+
+  const GfxRenderer::Orientation orientations[] = {GfxRenderer::Portrait, GfxRenderer::LandscapeClockwise,
+                                                   GfxRenderer::PortraitInverted,
+                                                   GfxRenderer::LandscapeCounterClockwise};
+  for (const bool logical : {false, true}) {
+    expect(renderer.setLogicalBufferEnabled(logical), "toggle logical buffer");
+    for (const auto orientation : orientations) {
+      renderer.setOrientation(orientation);
+      const std::string prefix =
+          std::string(logical ? "logical" : "direct") + " orientation " + std::to_string(orientation) + ": ";
+
+      renderer.clearScreen();
+      renderer.drawText(FONT_ID, 10, 30, "Background frame");
+      renderer.displayBuffer();
+      int x, y, w, h;
+      expect(!renderer.getDirtyRect(&x, &y, &w, &h), prefix + "clean after displayBuffer");
+
+      // Nothing drawn, nothing refreshed
+      const uint32_t windows = panel.getWindowRefreshCount();
+      renderer.displayDirtyRegion();
+      expect(panel.getWindowRefreshCount() == windows, prefix + "no refresh without changes");
+      renderer.drawPixel(5, 7, true);
+      expect(renderer.getDirtyRect(&x, &y, &w, &h) && x == 5 && y == 7 && w == 1 && h == 1, prefix + "dirty pixel");
+      renderer.drawPixel(5, 7, false);
+      renderer.displayDirtyRegion();
+
+      for (const auto& update : updates) {
+        const std::string name = prefix + update.name;
+        // drawIcon only supports the portrait layouts
+        if (update.draw == updates[6].draw && renderer.getScreenWidth() != HalDisplay::DISPLAY_HEIGHT) continue;
+        update.draw(renderer);
+        const std::vector<uint8_t> shownBefore(panel.getPanelImage(), panel.getPanelImage() + HalDisplay::BUFFER_SIZE);
+        const uint32_t before = panel.getWindowRefreshCount();
+        renderer.displayDirtyRegion();
+        // Any logical back buffer has been flushed now, so the frame buffer holds what should be shown
+        PanelRect changed;
+        const bool anyChange = changedBytes(shownBefore.data(), frame, &changed);
+
+        expect(anyChange, name + ": draws something");
+        expect(panel.getWindowRefreshCount() == before + 1, name + ": refreshed as a window");
+        expect(memcmp(panel.getPanelImage(), frame, HalDisplay::BUFFER_SIZE) == 0, name + ": panel is up to date");
+
+        uint16_t wx, wy, ww, wh;
+        panel.getLastWindow(&wx, &wy, &ww, &wh);
+        const PanelRect window{wx, wy, ww, wh};
+        expect(window == changed, name + ": window " + describe(window) + " matches changes " + describe(changed));
+      }
+
+      // Large changes fall back to a full refresh
+      const uint32_t fastRefreshes = panel.getRefreshCount(EInkDisplay::FAST_REFRESH);
+      renderer.fillRect(0, 0, renderer.getScreenWidth(), renderer.getScreenHeight() * 3 / 4, true);
+      renderer.displayDirtyRegion();
+      expect(panel.getRefreshCount(EInkDisplay::FAST_REFRESH) == fastRefreshes + 1, prefix + "large change");
+      expect(memcmp(panel.getPanelImage(), frame, HalDisplay::BUFFER_SIZE) == 0, prefix + "large change shown");
+
+      // A list menu repaints the whole screen when its selection moves
+      RefreshPlanner planner;
+      renderer.setRefreshPlanner(&planner);
+      const auto drawMenu = [&renderer](const int selected) {
+        renderer.clearScreen();
+        renderer.drawText(FONT_ID, 20, 20, "Settings");
+        for (int row = 0; row < 8; row++) {
+          if (row == selected) renderer.fillRect(0, 60 + row * 40 - 2, renderer.getScreenWidth(), 40, true);
+          renderer.drawText(FONT_ID, 20, 60 + row * 40, "Menu entry", row != selected);
+        }
+      };
+      drawMenu(2);
+      renderer.displayDirtyRegion();
+      expect(memcmp(panel.getPanelImage(), frame, HalDisplay::BUFFER_SIZE) == 0, prefix + "menu shown");
+
+      drawMenu(3);
+      const std::vector<uint8_t> menuBefore(panel.getPanelImage(), panel.getPanelImage() + HalDisplay::BUFFER_SIZE);
+      const uint32_t menuWindows = panel.getWindowRefreshCount();
+      renderer.displayDirtyRegion();
+      PanelRect changed;
+      expect(changedBytes(menuBefore.data(), frame, &changed), prefix + "selection moved");
+      expect(panel.getWindowRefreshCount() == menuWindows + 1, prefix + "moved selection refreshed as a window");
+      expect(memcmp(panel.getPanelImage(), frame, HalDisplay::BUFFER_SIZE) == 0, prefix + "moved selection shown");
+      uint16_t wx, wy, ww, wh;
+      panel.getLastWindow(&wx, &wy, &ww, &wh);
+      const PanelRect window{wx, wy, ww, wh};
+      const bool small = window.width * window.height * 4 <= HalDisplay::DISPLAY_WIDTH * HalDisplay::DISPLAY_HEIGHT;
+      expect(window.contains(changed) && small,
+             prefix + "menu window " + describe(window) + " covers changes " + describe(changed));
+
+      // Repainting the same menu refreshes nothing
+      drawMenu(3);
+      const uint32_t refreshesBefore = panel.getWindowRefreshCount() + panel.getRefreshCount(EInkDisplay::FAST_REFRESH);
+      renderer.displayDirtyRegion();
+      expect(panel.getWindowRefreshCount() + panel.getRefreshCount(EInkDisplay::FAST_REFRESH) == refreshesBefore,
+             prefix + "unchanged menu skipped");
+      renderer.setRefreshPlanner(nullptr);
+    }
+  }
+  renderer.setLogicalBufferEnabled(false);
+
+  if (failures) {
+    std::cerr << failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "Dirty region: all checks passed\n";
+  return 0;
+}
@@ -0,0 +1,146 @@
+#include <EpdFont.h>
+#include <EpdFontFile.h>
+#include <FontDecompressor.h>
+#include <HalStorage.h>
+#include <HostTest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "lib/EpdFont/builtinFonts/bookerly_14_regular.h"
+
+// Usage: EpdFontFileTest <dir> — <dir> must contain bookerly_14_regular.epdfont converted from the builtin header.
+// Checks that the SD card font pack yields the same metrics and glyph bitmaps as the compiled-in font.
+
+namespace {
+uint32_t glyphBitmapSize(const EpdFontData* data, const EpdGlyph& glyph) {
+  const uint32_t pixels = static_cast<uint32_t>(glyph.width) * glyph.height;
+  return data->is2Bit ? (pixels + 3) / 4 : (pixels + 7) / 8;
+}
+
+void testMatchesBuiltin() {
+  EpdFontFile fontFile;
+  expect(fontFile.open("/bookerly_14_regular.epdfont"), "open .epdfont");
+  if (!fontFile.isOpen()) {
+    return;
+  }
+
+  const EpdFontData* builtin = &bookerly_14_regular;
+  const EpdFontData* paged = fontFile.getData();
+  expect(paged->bitmap == nullptr && paged->glyph == nullptr && paged->groupSource != nullptr,
+         "pack pages glyphs and groups from the file");
+  expect(paged->advanceY == builtin->advanceY && paged->ascender == builtin->ascender &&
+             paged->descender == builtin->descender && paged->is2Bit == builtin->is2Bit,
+         "font metrics");
+  expect(paged->intervalCount == builtin->intervalCount && paged->groupCount == builtin->groupCount,
+         "table sizes");
+  if (failures) {
+    return;
+  }
+
+  const uint32_t glyphCount =
+      builtin->intervals[builtin->intervalCount - 1].offset + builtin->intervals[builtin->intervalCount - 1].last -
+      builtin->intervals[builtin->intervalCount - 1].first + 1;
+
+  FontDecompressor builtinDecompressor;
+  FontDecompressor pagedDecompressor;
+  builtinDecompressor.init();
+  pagedDecompressor.init();
+
+  // Far more glyphs than the metric page cache holds, so pages get evicted and read back along the way
+  expect(glyphCount > EpdFontFile::GLYPHS_PER_PAGE * EpdFontFile::PAGE_SLOTS, "font spans more pages than cached");
+  for (uint32_t i = 0; i < glyphCount; i++) {
+    const EpdGlyph& a = builtin->glyph[i];
+    const EpdGlyph* b = fontFile.getGlyph(i);
+    if (!b || memcmp(&a, b, sizeof(EpdGlyph)) != 0) {
+      expect(false, "glyph " + std::to_string(i) + " metrics");
+      continue;
+    }
+    expect(fontFile.getGroupIndex(b) == builtin->glyphToGroup[i], "glyph " + std::to_string(i) + " group");
+    expect(fontFile.getGlyphIndex(b) == i, "glyph " + std::to_string(i) + " index");
+    const uint32_t size = glyphBitmapSize(builtin, a);
+    if (size == 0) {
+      continue;
+    }
+    const uint8_t* expected = builtinDecompressor.getBitmap(builtin, &a, i);
+    const uint8_t* actual = pagedDecompressor.getBitmap(paged, b, i);
+    expect(expected && actual && memcmp(expected, actual, size) == 0, "glyph " + std::to_string(i) + " bitmap");
+  }
+  expect(fontFile.getGlyph(glyphCount) == nullptr, "glyph index past the table");
+
+  // Code point lookups go through the same pages
+  const EpdFont builtinFont(builtin);
+  const EpdFont pagedFont(paged);
+  for (const uint32_t cp : {0x41u, 0xE9u, 0x2014u, 0x10FFFFu}) {
+    const EpdGlyph* a = builtinFont.getGlyph(cp);
+    const EpdGlyph* b = pagedFont.getGlyph(cp);
+    expect(a ? b && memcmp(a, b, sizeof(EpdGlyph)) == 0 : b == nullptr, "code point " + std::to_string(cp));
+  }
+
+  builtinDecompressor.deinit();
+  pagedDecompressor.deinit();
+}
+
+void testRejectsCorruptFiles(const std::string& dir) {
+  std::ifstream in(dir + "/bookerly_14_regular.epdfont", std::ios::binary);
+  const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  {
+    std::ofstream out(dir + "/truncated.epdfont", std::ios::binary);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+  }
+  {
+    // A huge interval count must be rejected before anything is allocated for it
+    std::vector<char> hugeTable = bytes;
+    const uint32_t intervalCount = 0xFFFFFFF0;
+    memcpy(&hugeTable[12], &intervalCount, sizeof(intervalCount));
+    std::ofstream out(dir + "/huge_table.epdfont", std::ios::binary);
+    out.write(hugeTable.data(), static_cast<std::streamsize>(hugeTable.size()));
+  }
+  {
+    // Glyph count past the end of the file: the paged glyph tables would be read out of bounds
+    std::vector<char> hugeGlyphs = bytes;
+    const uint32_t glyphCount = 0x40000000;
+    memcpy(&hugeGlyphs[16], &glyphCount, sizeof(glyphCount));
+    std::ofstream out(dir + "/huge_glyphs.epdfont", std::ios::binary);
+    out.write(hugeGlyphs.data(), static_cast<std::streamsize>(hugeGlyphs.size()));
+  }
+  {
+    std::vector<char> badMagic = bytes;
+    badMagic[0] = 'X';
+    std::ofstream out(dir + "/bad_magic.epdfont", std::ios::binary);
+    out.write(badMagic.data(), static_cast<std::streamsize>(badMagic.size()));
+  }
+
+  EpdFontFile fontFile;
+  expect(!fontFile.open("/truncated.epdfont"), "reject truncated file");
+  expect(!fontFile.open("/huge_table.epdfont"), "reject interval count past the end of the file");
+  expect(!fontFile.open("/huge_glyphs.epdfont"), "reject glyph count past the end of the file");
+  expect(!fontFile.open("/bad_magic.epdfont"), "reject bad magic");
+  expect(!fontFile.open("/missing.epdfont"), "reject missing file");
+  expect(!fontFile.isOpen() && fontFile.getData()->intervals == nullptr, "failed open leaves the font closed");
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <dir containing bookerly_14_regular.epdfont>\n";
+    return 1;
+  }
+  SDCardManager::getInstance().setRoot(argv[1]);
+
+  testMatchesBuiltin();
+  testRejectsCorruptFiles(argv[1]);
+
+  if (failures) {
+    std::cerr << failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "EpdFontFile: all checks passed\n";
+  return 0;
+}
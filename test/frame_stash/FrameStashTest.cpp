@@ -0,0 +1,145 @@
+#include <FrameStash.h>
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HostTest.h>
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/EpdFont/builtinFonts/ubuntu_10_regular.h"
+
+// Round-trips frames through FrameStash (blank, incompressible, fuzzed runs and literals around the encoding limits,
+// rendered text pages) and checks that GfxRenderer's BW stash restores the page after the grayscale passes while
+// keeping its chunks from page to page.
+
+namespace {
+constexpr int FONT_ID = 1;
+
+bool roundTrips(FrameStash& stash, const std::vector<uint8_t>& frame) {
+  std::vector<uint8_t> restored(HalDisplay::BUFFER_SIZE, 0x5A);
+  return stash.store(frame.data()) && stash.restore(restored.data()) && restored == frame;
+}
+
+// White and ink stretches of random lengths, weighted towards group and blank-count boundaries
+std::vector<uint8_t> fuzzFrame(std::mt19937& rng) {
+  const int lengths[] = {1, 2, 7, 8, 9, 16, 2047, 2048, 2049, 2056, 4096};
+  std::vector<uint8_t> frame;
+  while (frame.size() < HalDisplay::BUFFER_SIZE) {
+    const int length = rng() % 2 ? lengths[rng() % std::size(lengths)] : 1 + rng() % 400;
+    if (rng() % 2) {
+      frame.insert(frame.end(), length, static_cast<uint8_t>(rng() % 3 ? 0xFF : rng()));
+    } else {
+      for (int i = 0; i < length; i++) frame.push_back(static_cast<uint8_t>(rng()));
+    }
+  }
+  frame.resize(HalDisplay::BUFFER_SIZE);
+  return frame;
+}
+
+// Double-spaced small text inks about as many bytes as a reader page at the default font size
+void drawPage(const GfxRenderer& renderer, std::mt19937& rng) {
+  const char* const words[] = {"the", "reader", "turned", "another", "page", "and", "light", "fell", "across", "a"};
+  renderer.clearScreen();
+  const int lineHeight = renderer.getLineHeight(FONT_ID);
+  for (int y = 20; y < renderer.getScreenHeight() - 20; y += 2 * lineHeight) {
+    std::string line;
+    while (renderer.getTextWidth(FONT_ID, line.c_str()) < renderer.getScreenWidth() - 140) {
+      line += std::string(words[rng() % std::size(words)]) + " ";
+    }
+    renderer.drawText(FONT_ID, 20, y, line.c_str());
+  }
+}
+}  // namespace
+
+int main() {
+  FrameStash stash;
+  expect(!stash.hasFrame() && stash.getReservedSize() == 0, "empty stash holds nothing");
+  std::vector<uint8_t> scratch(HalDisplay::BUFFER_SIZE);
+  expect(!stash.restore(scratch.data()), "restoring an empty stash fails");
+
+  // A blank frame is a few dozen bytes
+  std::vector<uint8_t> frame(HalDisplay::BUFFER_SIZE, 0xFF);
+  expect(roundTrips(stash, frame), "blank frame round-trips");
+  expect(stash.getEncodedSize() < 100, "blank frame packs small (" + std::to_string(stash.getEncodedSize()) + ")");
+  expect(stash.getReservedSize() == FrameStash::CHUNK_SIZE, "blank frame needs one chunk");
+
+  // Noise is kept as it is and still fits
+  std::mt19937 rng(5);
+  for (auto& byte : frame) byte = static_cast<uint8_t>(rng());
+  expect(roundTrips(stash, frame), "random frame round-trips");
+  expect(stash.getEncodedSize() <= FrameStash::MAX_ENCODED_SIZE, "random frame stays within the worst case");
+
+  // Chunks stay allocated when a smaller frame follows, until released
+  const size_t reserved = stash.getReservedSize();
+  frame.assign(HalDisplay::BUFFER_SIZE, 0x00);
+  expect(roundTrips(stash, frame), "black frame round-trips");
+  expect(stash.getReservedSize() == reserved, "chunks are kept for later frames");
+  stash.clear();
+  expect(!stash.hasFrame() && stash.getReservedSize() == reserved, "clear keeps the chunks");
+  stash.release();
+  expect(stash.getReservedSize() == 0 && !stash.restore(scratch.data()), "release frees the chunks");
+
+  for (int i = 0; i < 300; i++) {
+    if (!roundTrips(stash, fuzzFrame(rng))) {
+      expect(false, "fuzzed frame " + std::to_string(i) + " round-trips");
+      break;
+    }
+  }
+
+  // The reader's anti-aliased page: the BW page comes back after the gray passes, and page turns reuse the chunks
+  HalDisplay display;
+  EpdFont font(&ubuntu_10_regular);
+  EpdFontFamily family(&font);
+  GfxRenderer renderer(display);
+  renderer.begin();
+  renderer.insertFont(FONT_ID, family);
+  for (const bool logical : {false, true}) {
+    renderer.setLogicalBufferEnabled(logical);
+    FrameStash pages;
+    int growths = 0;
+    size_t largest = 0;
+    for (int page = 0; page < 20; page++) {
+      drawPage(renderer, rng);
+      const std::vector<uint8_t> bw(renderer.getFrameBuffer(), renderer.getFrameBuffer() + HalDisplay::BUFFER_SIZE);
+      expect(renderer.storeBwBuffer(), "store BW page");
+      renderer.clearScreen(0x00);
+      renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
+      renderer.drawText(FONT_ID, 20, 20, "gray pass");
+      renderer.copyGrayscaleMsbBuffers();
+      renderer.setRenderMode(GfxRenderer::BW);
+      renderer.restoreBwBuffer();
+      expect(memcmp(renderer.getFrameBuffer(), bw.data(), HalDisplay::BUFFER_SIZE) == 0,
+             std::string("BW page restored") + (logical ? " (logical buffer)" : ""));
+
+      const size_t reserved = pages.getReservedSize();
+      expect(renderer.storeFrame(pages), "store page");
+      if (page > 0 && pages.getReservedSize() != reserved) growths++;
+      largest = std::max(largest, pages.getEncodedSize());
+    }
+    std::cout << "Text pages" << (logical ? " (logical buffer)" : "") << ": largest " << largest << " of "
+              << HalDisplay::BUFFER_SIZE << " bytes, stash grew " << growths << " time(s) after the first page\n";
+    expect(largest * 3 < HalDisplay::BUFFER_SIZE, "text pages pack to under a third of the frame");
+    expect(growths <= 2, "page turns reuse the stash chunks");
+  }
+  renderer.setLogicalBufferEnabled(false);
+
+  // A caller's stash puts a screen back for redrawing around it
+  std::mt19937 pageRng(9);
+  drawPage(renderer, pageRng);
+  FrameStash cover;
+  expect(renderer.storeFrame(cover), "store the screen");
+  const std::vector<uint8_t> before(renderer.getFrameBuffer(), renderer.getFrameBuffer() + HalDisplay::BUFFER_SIZE);
+  renderer.clearScreen();
+  expect(renderer.restoreFrame(cover), "restore the screen");
+  expect(memcmp(renderer.getFrameBuffer(), before.data(), HalDisplay::BUFFER_SIZE) == 0, "screen restored");
+
+  if (failures) {
+    std::cerr << failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "Frame stash: all checks passed\n";
+  return 0;
+}
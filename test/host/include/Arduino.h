@@ -0,0 +1,50 @@
+// Host stand-in for the Arduino core: just enough of the API for lib/ to build and run on Linux.
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "Print.h"
+#include "WString.h"
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t*>(addr))
+#endif
+
+// ESP32 system information; the heap figures are fixed at what the reader typically has free on the device, so heap
+// guards in lib/ take the same paths as on the device
+class EspClass {
+ public:
+  static constexpr uint32_t DEVICE_FREE_HEAP = 200 * 1024;
+  uint32_t getFreeHeap() const { return DEVICE_FREE_HEAP; }
+  uint32_t getMaxAllocHeap() const { return DEVICE_FREE_HEAP / 2; }
+};
+
+extern EspClass ESP;
+
+// Arduino USB CDC serial, printed to stderr on the host
+class HWCDC : public Print {
+ public:
+  void begin(unsigned long) {}
+  operator bool() const { return true; }
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  void flush() override;
+};
+
+extern HWCDC Serial;
@@ -0,0 +1,4 @@
+// Host stand-in: HalGPIO only needs the type to exist.
+#pragma once
+
+class BatteryMonitor {};
@@ -0,0 +1,70 @@
+// Host stand-in for the SDK's EInkDisplay driver: keeps the frame buffer and grayscale planes in memory and counts
+// refreshes instead of driving a panel.
+#pragma once
+
+#include <cstdint>
+
+class EInkDisplay {
+ public:
+  static constexpr uint16_t DISPLAY_WIDTH = 800;
+  static constexpr uint16_t DISPLAY_HEIGHT = 480;
+  static constexpr uint16_t DISPLAY_WIDTH_BYTES = DISPLAY_WIDTH / 8;
+  static constexpr uint32_t BUFFER_SIZE = DISPLAY_WIDTH_BYTES * DISPLAY_HEIGHT;
+
+  enum RefreshMode { FULL_REFRESH, HALF_REFRESH, FAST_REFRESH };
+
+  EInkDisplay(int8_t sclk, int8_t mosi, int8_t cs, int8_t dc, int8_t rst, int8_t busy);
+
+  void begin() {}
+  void clearScreen(uint8_t color = 0xFF) const;
+  void drawImage(const uint8_t* imageData, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                 bool fromProgmem = false) const;
+  void drawImageTransparent(const uint8_t* imageData, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                            bool fromProgmem = false) const;
+  void displayBuffer(RefreshMode mode = FAST_REFRESH, bool turnOffScreen = false);
+  void displayWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool turnOffScreen = false);
+  void refreshDisplay(RefreshMode mode = FAST_REFRESH, bool turnOffScreen = false);
+  void deepSleep() {}
+  uint8_t* getFrameBuffer() const { return frameBuffer; }
+
+  void copyGrayscaleBuffers(const uint8_t* lsbBuffer, const uint8_t* msbBuffer);
+  void copyGrayscaleLsbBuffers(const uint8_t* lsbBuffer);
+  void copyGrayscaleMsbBuffers(const uint8_t* msbBuffer);
+  void cleanupGrayscaleBuffers(const uint8_t* bwBuffer);
+  void displayGrayBuffer(bool turnOffScreen = false);
+
+  // Host inspection; HalDisplay owns its driver privately, so tests reach it through the latest instance
+  static EInkDisplay* latest() { return latestInstance; }
+  const uint8_t* getLsbBuffer() const { return lsbBuffer; }
+  const uint8_t* getMsbBuffer() const { return msbBuffer; }
+  uint32_t getRefreshCount(RefreshMode mode) const { return refreshCounts[mode]; }
+  uint32_t getGrayRefreshCount() const { return grayRefreshCount; }
+  // What the panel currently shows: refreshes copy the frame buffer, or the refreshed window of it, in here
+  const uint8_t* getPanelImage() const { return panelImage; }
+  uint32_t getWindowRefreshCount() const { return windowRefreshCount; }
+  // The panel as 8-bit gray levels in panel orientation (DISPLAY_WIDTH x DISPLAY_HEIGHT bytes). After a grayscale
+  // refresh, black pixels of the image show the gray level the LSB/MSB planes flag for them.
+  void getPanelLevels(uint8_t* levels) const;
+  void getLastWindow(uint16_t* x, uint16_t* y, uint16_t* w, uint16_t* h) const {
+    *x = lastWindow[0];
+    *y = lastWindow[1];
+    *w = lastWindow[2];
+    *h = lastWindow[3];
+  }
+
+ private:
+  static inline EInkDisplay* latestInstance = nullptr;
+  // mutable: the real driver also writes the frame buffer from const drawing calls
+  mutable uint8_t frameBuffer[BUFFER_SIZE];
+  uint8_t lsbBuffer[BUFFER_SIZE];
+  uint8_t msbBuffer[BUFFER_SIZE];
+  uint32_t refreshCounts[3] = {};
+  uint32_t grayRefreshCount = 0;
+  uint8_t panelImage[BUFFER_SIZE];
+  uint32_t windowRefreshCount = 0;
+  // Gray planes of the last grayscale refresh, shown until the next BW refresh
+  uint8_t shownLsb[BUFFER_SIZE];
+  uint8_t shownMsb[BUFFER_SIZE];
+  bool grayShown = false;
+  uint16_t lastWindow[4] = {};
+};
@@ -0,0 +1,11 @@
+// Writes what the host panel shows to an image file, for looking at rendered pages and golden-testing them on Linux.
+#pragma once
+
+#include <EInkDisplay.h>
+#include <GfxRenderer.h>
+
+#include <string>
+
+// Writes the panel as an 8-bit grayscale image turned into `orientation`, so pages read upright. The format follows
+// the extension of `path`: .png, otherwise binary PGM. Returns false if the file could not be written.
+bool writePanelImage(const std::string& path, const EInkDisplay& panel, GfxRenderer::Orientation orientation);
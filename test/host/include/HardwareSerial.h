@@ -0,0 +1,4 @@
+// Host stand-in: the serial port classes live in Arduino.h.
+#pragma once
+
+#include "Arduino.h"
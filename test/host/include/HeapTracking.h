@@ -0,0 +1,66 @@
+// Heap use and peak of a host benchmark, measured by replacing malloc and friends. Defines the replacements, so
+// include it from one source file of a program only. Measured on glibc hosts only (HEAP_MEASURED).
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+inline std::atomic<size_t> heapInUse{0};
+inline std::atomic<size_t> heapPeak{0};
+
+inline void resetPeak() { heapPeak.store(heapInUse.load()); }
+
+inline size_t peakSinceReset(const size_t before) { return heapPeak.load() - before; }
+
+#if defined(__GLIBC__)
+// Every allocation, malloc or new, goes through these
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+
+static void trackAllocation(void* pointer) {
+  if (!pointer) return;
+  const size_t inUse = heapInUse.fetch_add(malloc_usable_size(pointer)) + malloc_usable_size(pointer);
+  size_t peak = heapPeak.load();
+  while (inUse > peak && !heapPeak.compare_exchange_weak(peak, inUse)) {
+  }
+}
+
+static void trackFree(void* pointer) {
+  if (pointer) heapInUse.fetch_sub(malloc_usable_size(pointer));
+}
+
+void* malloc(size_t size) {
+  void* pointer = __libc_malloc(size);
+  trackAllocation(pointer);
+  return pointer;
+}
+
+void* calloc(size_t count, size_t size) {
+  void* pointer = __libc_calloc(count, size);
+  trackAllocation(pointer);
+  return pointer;
+}
+
+void* realloc(void* pointer, size_t size) {
+  trackFree(pointer);
+  void* moved = __libc_realloc(pointer, size);
+  trackAllocation(moved ? moved : (size ? pointer : nullptr));
+  return moved;
+}
+
+void free(void* pointer) {
+  trackFree(pointer);
+  __libc_free(pointer);
+}
+}
+constexpr bool HEAP_MEASURED = true;
+#else
+constexpr bool HEAP_MEASURED = false;
+#endif
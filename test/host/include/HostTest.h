@@ -0,0 +1,42 @@
+// Helpers shared by the host tests and benchmarks in test/.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Print.h"
+
+// Checks made with expect(); a test returns non-zero from main when any failed
+inline int failures = 0;
+
+inline void expect(const bool condition, const std::string& message) {
+  if (!condition) {
+    fprintf(stderr, "FAIL: %s\n", message.c_str());
+    failures++;
+  }
+}
+
+// Output of a Print sink collected into memory. With a capacity the memory is reserved up front, so the sink adds
+// nothing to a measured heap, and writes past it are refused as a full card would.
+class BufferPrint : public Print {
+ public:
+  BufferPrint() = default;
+  explicit BufferPrint(const size_t capacity) : capacity(capacity) { data.reserve(capacity); }
+  size_t write(const uint8_t b) override {
+    if (data.size() >= capacity) return 0;
+    data.push_back(b);
+    return 1;
+  }
+  size_t write(const uint8_t* buffer, const size_t size) override {
+    const size_t n = std::min(size, capacity - data.size());
+    data.insert(data.end(), buffer, buffer + n);
+    return n;
+  }
+  std::vector<uint8_t> data;
+
+ private:
+  size_t capacity = SIZE_MAX;
+};
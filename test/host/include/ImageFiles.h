@@ -0,0 +1,17 @@
+// Reading and writing the image files the host tests and benchmarks decode.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Whole host file; empty if it could not be read
+std::vector<uint8_t> readFile(const std::string& path);
+// Returns false if the file could not be written
+bool writeFile(const std::string& path, const void* data, size_t size);
+
+// `pixels` are packed, `channels` bytes each: 1 gray, 3 RGB or 4 RGBA
+bool writePng(const std::string& path, const std::vector<uint8_t>& pixels, int width, int height, int channels);
+// 24-bit bottom-up BMP, the layout most tools write. `pixels` are packed RGB (3 channels) or RGBA (4, alpha dropped).
+bool writeBmp24(const std::string& path, const std::vector<uint8_t>& pixels, int width, int height, int channels = 3);
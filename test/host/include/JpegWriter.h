@@ -0,0 +1,20 @@
+// Baseline JPEG encoder for generating test images on the host, in the layouts picojpeg decodes.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class JpegSampling {
+  Grayscale,  // One component
+  H1V1,       // YCbCr, full resolution chroma
+  H2V1,       // YCbCr, chroma halved horizontally
+  H2V2,       // YCbCr, chroma halved both ways (what most cameras and cover art use)
+};
+
+// Encodes `pixels` (8-bit gray for Grayscale, otherwise packed RGB) at `quality` 1-100 with the standard IJG tables.
+std::vector<uint8_t> encodeJpeg(const uint8_t* pixels, int width, int height, JpegSampling sampling, int quality = 85);
+
+// Encodes and writes to a host file. Returns false if the file could not be written.
+bool writeJpeg(const std::string& path, const uint8_t* pixels, int width, int height, JpegSampling sampling,
+               int quality = 85);
@@ -0,0 +1,56 @@
+// Host stand-in for the Arduino Print/Stream classes.
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+class Print {
+ public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      if (write(*buffer++) == 0) break;
+      n++;
+    }
+    return n;
+  }
+  size_t write(const char* str) { return str ? write(reinterpret_cast<const uint8_t*>(str), strlen(str)) : 0; }
+  size_t write(const char* buffer, size_t size) { return write(reinterpret_cast<const uint8_t*>(buffer), size); }
+  virtual void flush() {}
+
+  size_t print(const char* str) { return write(str); }
+  size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+  size_t print(int value) { return printf("%d", value); }
+  size_t println(const char* str = "") { return print(str) + print('\n'); }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    const int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    return write(reinterpret_cast<const uint8_t*>(buf), static_cast<size_t>(len) < sizeof(buf) ? len : sizeof(buf) - 1);
+  }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+      const int c = read();
+      if (c < 0) break;
+      buffer[n++] = static_cast<uint8_t>(c);
+    }
+    return n;
+  }
+  size_t readBytes(char* buffer, size_t length) { return readBytes(reinterpret_cast<uint8_t*>(buffer), length); }
+};
@@ -0,0 +1,37 @@
+// Host stand-in for the SDK's SDCardManager: serves SD card paths from a directory on the host file system.
+#pragma once
+
+#include <Arduino.h>
+#include <SdFat.h>
+
+#include <vector>
+
+class SDCardManager {
+ public:
+  static SDCardManager& getInstance();
+
+  // Host directory that plays the role of the SD card root (defaults to the current directory)
+  void setRoot(const std::string& hostRoot) { root = hostRoot; }
+  std::string hostPath(const char* path) const;
+
+  bool begin() { return true; }
+  bool ready() const { return true; }
+  std::vector<String> listFiles(const char* path = "/", int maxFiles = 200);
+  String readFile(const char* path);
+  bool readFileToStream(const char* path, Print& out, size_t chunkSize = 256);
+  size_t readFileToBuffer(const char* path, char* buffer, size_t bufferSize, size_t maxBytes = 0);
+  bool writeFile(const char* path, const String& content);
+  bool ensureDirectoryExists(const char* path);
+
+  FsFile open(const char* path, oflag_t oflag = O_RDONLY);
+  bool mkdir(const char* path, bool pFlag = true);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rmdir(const char* path);
+  bool openFileForRead(const char* moduleName, const char* path, FsFile& file);
+  bool openFileForWrite(const char* moduleName, const char* path, FsFile& file);
+  bool removeDir(const char* path);
+
+ private:
+  std::string root = ".";
+};
@@ -0,0 +1,61 @@
+// Host stand-in for SdFat's FsFile, backed by POSIX stdio/dirent.
+// Paths handed to FsFile are host paths; SDCardManager maps SD card paths onto a host directory.
+#pragma once
+
+#include <dirent.h>
+#include <fcntl.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "Print.h"
+
+typedef int oflag_t;
+
+class FsFile : public Stream {
+ public:
+  FsFile() = default;
+  ~FsFile() override { close(); }
+  FsFile(const FsFile&) = delete;
+  FsFile& operator=(const FsFile&) = delete;
+  FsFile(FsFile&& other) noexcept { *this = static_cast<FsFile&&>(other); }
+  FsFile& operator=(FsFile&& other) noexcept;
+
+  bool open(const char* hostPath, oflag_t oflag = O_RDONLY);
+  bool close();
+  bool isOpen() const { return fp != nullptr || dir != nullptr; }
+  operator bool() const { return isOpen(); }
+  bool isDirectory() const { return dir != nullptr; }
+
+  int read(void* buf, size_t count);
+  int read() override;
+  int peek() override;
+  int available() override;
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  size_t write(const void* buffer, size_t size) { return write(static_cast<const uint8_t*>(buffer), size); }
+  using Print::write;
+  void flush() override;
+
+  uint64_t size() const;
+  uint64_t fileSize() const { return size(); }
+  uint64_t position() const;
+  uint64_t curPosition() const { return position(); }
+  bool seek(uint64_t pos) { return seekSet(pos); }
+  bool seekSet(uint64_t pos);
+  bool seekCur(int64_t offset);
+  bool seekEnd(int64_t offset = 0);
+
+  size_t getName(char* name, size_t len) const;
+  // FAT-encoded modification date and time, as SdFat returns them
+  bool getModifyDateTime(uint16_t* pdate, uint16_t* ptime);
+  FsFile openNextFile();
+  void rewindDirectory();
+  bool rename(const char* newHostPath);
+
+ private:
+  FILE* fp = nullptr;
+  DIR* dir = nullptr;
+  std::string path;
+};
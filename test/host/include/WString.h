@@ -0,0 +1,78 @@
+// Host stand-in for the Arduino String class, backed by std::string.
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <string>
+
+class String {
+ public:
+  String() = default;
+  String(const char* s) : str(s ? s : "") {}
+  String(const std::string& s) : str(s) {}
+  String(char c) : str(1, c) {}
+  explicit String(int value) : str(std::to_string(value)) {}
+  explicit String(unsigned int value) : str(std::to_string(value)) {}
+  explicit String(long value) : str(std::to_string(value)) {}
+  explicit String(unsigned long value) : str(std::to_string(value)) {}
+
+  const char* c_str() const { return str.c_str(); }
+  unsigned int length() const { return str.length(); }
+  bool isEmpty() const { return str.empty(); }
+  char operator[](unsigned int index) const { return index < str.size() ? str[index] : 0; }
+  char charAt(unsigned int index) const { return (*this)[index]; }
+
+  bool startsWith(const String& prefix) const { return str.rfind(prefix.str, 0) == 0; }
+  bool endsWith(const String& suffix) const {
+    return str.size() >= suffix.str.size() &&
+           str.compare(str.size() - suffix.str.size(), suffix.str.size(), suffix.str) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const {
+    const auto pos = str.find(c, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+  }
+  int indexOf(const String& s, unsigned int from = 0) const {
+    const auto pos = str.find(s.str, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+  }
+  int lastIndexOf(char c) const {
+    const auto pos = str.rfind(c);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+  }
+  String substring(unsigned int from) const { return from < str.size() ? String(str.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    return from < str.size() && to > from ? String(str.substr(from, to - from)) : String();
+  }
+  void toLowerCase() {
+    for (auto& c : str) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+  }
+  void trim() {
+    const auto first = str.find_first_not_of(" \t\r\n");
+    const auto last = str.find_last_not_of(" \t\r\n");
+    str = first == std::string::npos ? std::string() : str.substr(first, last - first + 1);
+  }
+  long toInt() const { return strtol(str.c_str(), nullptr, 10); }
+
+  String& operator+=(const String& other) {
+    str += other.str;
+    return *this;
+  }
+  String& operator+=(const char* other) {
+    str += other ? other : "";
+    return *this;
+  }
+  String& operator+=(char c) {
+    str += c;
+    return *this;
+  }
+  friend String operator+(String lhs, const String& rhs) { return lhs += rhs; }
+  friend String operator+(String lhs, const char* rhs) { return lhs += rhs; }
+  friend String operator+(const char* lhs, const String& rhs) { return String(lhs) += rhs; }
+  bool operator==(const String& other) const { return str == other.str; }
+  bool operator==(const char* other) const { return str == (other ? other : ""); }
+  bool operator!=(const String& other) const { return str != other.str; }
+  bool operator<(const String& other) const { return str < other.str; }
+
+ private:
+  std::string str;
+};
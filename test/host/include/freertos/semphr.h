@@ -0,0 +1,29 @@
+// Host stand-in for FreeRTOS semaphores: mutexes map onto std::recursive_timed_mutex.
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+#include "FreeRTOS.h"
+
+typedef std::recursive_timed_mutex* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::recursive_timed_mutex(); }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return xSemaphoreCreateMutex(); }
+inline void vSemaphoreDelete(const SemaphoreHandle_t semaphore) { delete semaphore; }
+
+inline BaseType_t xSemaphoreTake(const SemaphoreHandle_t semaphore, const TickType_t ticks) {
+  if (ticks == portMAX_DELAY) {
+    semaphore->lock();
+    return pdTRUE;
+  }
+  return semaphore->try_lock_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS)) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(const SemaphoreHandle_t semaphore) {
+  semaphore->unlock();
+  return pdTRUE;
+}
+
+#define xSemaphoreTakeRecursive xSemaphoreTake
+#define xSemaphoreGiveRecursive xSemaphoreGive
@@ -0,0 +1,14 @@
+// Host stand-in for the FreeRTOS task helpers: delays sleep the calling thread, ticks are milliseconds since start.
+#pragma once
+
+#include "FreeRTOS.h"
+
+inline void vTaskDelay(const TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+inline TickType_t xTaskGetTickCount() { return static_cast<TickType_t>(millis() / portTICK_PERIOD_MS); }
+
+typedef void* TaskHandle_t;
+// Each host thread stands in for a task
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+  static thread_local char task;
+  return &task;
+}
@@ -0,0 +1,236 @@
+#include <EInkDisplay.h>
+#include <Epub.h>
+#include <Epub/Page.h>
+#include <Epub/Section.h>
+#include <FontDecompressor.h>
+#include <FrameWriter.h>
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <Logging.h>
+#include <RefreshPlanner.h>
+#include <Trace.h>
+#include <fontIds.h>
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "lib/EpdFont/builtinFonts/bookerly_14_bold.h"
+#include "lib/EpdFont/builtinFonts/bookerly_14_bolditalic.h"
+#include "lib/EpdFont/builtinFonts/bookerly_14_italic.h"
+#include "lib/EpdFont/builtinFonts/bookerly_14_regular.h"
+
+// Opens an EPUB the way the reader does, paginates a chapter with the default reader settings and writes what the
+// panel shows after each page turn to an image file. Frames include the anti-aliasing gray pass unless --no-aa is
+// given. Run without arguments for usage.
+
+namespace {
+// Reader defaults from CrossPointSettings
+constexpr int SCREEN_MARGIN = 5;
+constexpr float LINE_COMPRESSION = 1.0f;
+constexpr bool EXTRA_PARAGRAPH_SPACING = true;
+constexpr uint8_t PARAGRAPH_ALIGNMENT = 0;  // Justified
+constexpr bool HYPHENATION = false;
+constexpr bool EMBEDDED_STYLE = true;
+constexpr int REFRESH_FREQUENCY = 15;
+
+struct Options {
+  std::string book;
+  std::string outDir = "frames";
+  std::string cacheDir = "/tmp/crosspoint_host_cache";
+  std::string format = "png";
+  std::string traceFile;
+  int chapter = -1;  // All chapters
+  int pages = INT_MAX;
+  GfxRenderer::Orientation orientation = GfxRenderer::Portrait;
+  bool antiAliasing = true;
+};
+
+void usage() {
+  std::cerr << "Usage: render_book [options] BOOK.epub\n"
+               "  --out DIR            directory for the frames (default: frames)\n"
+               "  --cache DIR          book and section cache (default: /tmp/crosspoint_host_cache)\n"
+               "  --chapter N          spine index to render (default: all, from the start)\n"
+               "  --pages N            render at most N pages\n"
+               "  --format png|pgm     image format (default: png)\n"
+               "  --orientation portrait|landscape-cw|inverted|landscape-ccw\n"
+               "  --no-aa              skip the anti-aliasing gray pass\n"
+               "  --trace FILE         write the trace spans as Chrome trace JSON\n";
+}
+
+std::string absolutePath(const std::string& path) {
+  char resolved[PATH_MAX];
+  return realpath(path.c_str(), resolved) ? std::string(resolved) : path;
+}
+
+bool parseOptions(const int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--out" && hasValue) {
+      options.outDir = argv[++i];
+    } else if (arg == "--cache" && hasValue) {
+      options.cacheDir = argv[++i];
+    } else if (arg == "--chapter" && hasValue) {
+      options.chapter = atoi(argv[++i]);
+    } else if (arg == "--pages" && hasValue) {
+      options.pages = atoi(argv[++i]);
+    } else if (arg == "--format" && hasValue) {
+      options.format = argv[++i];
+      if (options.format != "png" && options.format != "pgm") return false;
+    } else if (arg == "--orientation" && hasValue) {
+      const std::string name = argv[++i];
+      if (name == "portrait") {
+        options.orientation = GfxRenderer::Portrait;
+      } else if (name == "landscape-cw") {
+        options.orientation = GfxRenderer::LandscapeClockwise;
+      } else if (name == "inverted") {
+        options.orientation = GfxRenderer::PortraitInverted;
+      } else if (name == "landscape-ccw") {
+        options.orientation = GfxRenderer::LandscapeCounterClockwise;
+      } else {
+        return false;
+      }
+    } else if (arg == "--trace" && hasValue) {
+      options.traceFile = argv[++i];
+    } else if (arg == "--no-aa") {
+      options.antiAliasing = false;
+    } else if (!arg.empty() && arg[0] != '-' && options.book.empty()) {
+      options.book = arg;
+    } else {
+      return false;
+    }
+  }
+  return !options.book.empty();
+}
+
+// The reader's page render: BW page turn, then the gray pass on top (EpubReaderActivity::renderContents)
+void renderPage(GfxRenderer& renderer, Page& page, const int marginLeft, const int marginTop, const bool antiAliasing) {
+  renderer.clearScreen();
+  page.render(renderer, BOOKERLY_14_FONT_ID, marginLeft, marginTop);
+  renderer.displayAutoRefresh(REFRESH_FREQUENCY);
+  if (!antiAliasing) return;
+
+  renderer.storeBwBuffer();
+  renderer.clearScreen(0x00);
+  renderer.setRenderMode(GfxRenderer::GRAYSCALE_LSB);
+  page.render(renderer, BOOKERLY_14_FONT_ID, marginLeft, marginTop);
+  renderer.copyGrayscaleLsbBuffers();
+  renderer.clearScreen(0x00);
+  renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
+  page.render(renderer, BOOKERLY_14_FONT_ID, marginLeft, marginTop);
+  renderer.copyGrayscaleMsbBuffers();
+  renderer.displayGrayBuffer();
+  renderer.setRenderMode(GfxRenderer::BW);
+  renderer.restoreBwBuffer();
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    usage();
+    return 2;
+  }
+  // SD card paths are host paths
+  SDCardManager::getInstance().setRoot("");
+  const std::string outDir = absolutePath(options.outDir);
+  Storage.mkdir(outDir.c_str());
+  Storage.mkdir(options.cacheDir.c_str());
+
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  renderer.begin();
+  RefreshPlanner refreshPlanner;
+  renderer.setRefreshPlanner(&refreshPlanner);
+  FontDecompressor fontDecompressor;
+  if (!fontDecompressor.init()) {
+    LOG_ERR("SIM", "Failed to set up the font decompressor");
+    return 1;
+  }
+  renderer.setFontDecompressor(&fontDecompressor);
+  EpdFont regular(&bookerly_14_regular);
+  EpdFont bold(&bookerly_14_bold);
+  EpdFont italic(&bookerly_14_italic);
+  EpdFont boldItalic(&bookerly_14_bolditalic);
+  EpdFontFamily bookerly14(&regular, &bold, &italic, &boldItalic);
+  renderer.insertFont(BOOKERLY_14_FONT_ID, bookerly14);
+  renderer.setOrientation(options.orientation);
+  const EInkDisplay& panel = *EInkDisplay::latest();
+
+  if (!options.traceFile.empty() && !Trace::enable()) return 1;
+
+  const auto epub = std::make_shared<Epub>(absolutePath(options.book), options.cacheDir);
+  if (!epub->load()) {
+    LOG_ERR("SIM", "Failed to load %s", options.book.c_str());
+    return 1;
+  }
+
+  int marginTop, marginRight, marginBottom, marginLeft;
+  renderer.getOrientedViewableTRBL(&marginTop, &marginRight, &marginBottom, &marginLeft);
+  marginTop += SCREEN_MARGIN;
+  marginRight += SCREEN_MARGIN;
+  marginBottom += SCREEN_MARGIN;
+  marginLeft += SCREEN_MARGIN;
+  const uint16_t viewportWidth = renderer.getScreenWidth() - marginLeft - marginRight;
+  const uint16_t viewportHeight = renderer.getScreenHeight() - marginTop - marginBottom;
+
+  // Without --chapter, pages run on across chapters from the start of the book
+  const int firstSpine = options.chapter >= 0 ? options.chapter : 0;
+  const int lastSpine = options.chapter >= 0 ? options.chapter : epub->getSpineItemsCount() - 1;
+  if (firstSpine >= epub->getSpineItemsCount()) {
+    LOG_ERR("SIM", "Chapter %d out of range, the book has %d", firstSpine, epub->getSpineItemsCount());
+    return 1;
+  }
+
+  int written = 0;
+  for (int spine = firstSpine; spine <= lastSpine && written < options.pages; spine++) {
+    Section section(epub, spine, renderer);
+    int chapterPages = 0;
+    if (!section.loadSectionFile(BOOKERLY_14_FONT_ID, LINE_COMPRESSION, EXTRA_PARAGRAPH_SPACING, PARAGRAPH_ALIGNMENT,
+                                 viewportWidth, viewportHeight, HYPHENATION, EMBEDDED_STYLE) &&
+        !section.createSectionFile(BOOKERLY_14_FONT_ID, LINE_COMPRESSION, EXTRA_PARAGRAPH_SPACING, PARAGRAPH_ALIGNMENT,
+                                   viewportWidth, viewportHeight, HYPHENATION, EMBEDDED_STYLE)) {
+      LOG_ERR("SIM", "Failed to paginate spine item %d", spine);
+      return 1;
+    }
+
+    for (int pageIndex = 0; pageIndex < section.pageCount && written < options.pages; pageIndex++) {
+      section.currentPage = pageIndex;
+      const std::unique_ptr<Page> page = section.loadPageFromSectionFile();
+      if (!page) {
+        LOG_ERR("SIM", "Failed to load page %d of spine item %d", pageIndex, spine);
+        return 1;
+      }
+      renderPage(renderer, *page, marginLeft, marginTop, options.antiAliasing);
+
+      char name[64];
+      snprintf(name, sizeof(name), "/spine%03d_page%04d.%s", spine, pageIndex, options.format.c_str());
+      if (!writePanelImage(outDir + name, panel, options.orientation)) return 1;
+      written++;
+      chapterPages++;
+    }
+    std::cout << "Spine item " << spine << ": " << section.pageCount << " pages, wrote " << chapterPages << "\n";
+  }
+  fontDecompressor.deinit();
+  std::cout << "Wrote " << written << " frames to " << outDir << "\n";
+
+  if (!written) {
+    LOG_ERR("SIM", "No pages to render");
+    return 1;
+  }
+  refreshPlanner.logStats();
+
+  if (!options.traceFile.empty()) {
+    // The ring keeps the newest events, so long runs lose the book indexing
+    std::ofstream trace(options.traceFile);
+    Trace::writeChromeJson([&trace](const char* line) { trace << line << "\n"; });
+    std::cout << "Wrote " << Trace::getEventCount() << " trace events to " << options.traceFile << "\n";
+  }
+  return 0;
+}
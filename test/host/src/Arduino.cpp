@@ -0,0 +1,29 @@
+#include <Arduino.h>
+
+#include <chrono>
+#include <thread>
+
+namespace {
+const auto bootTime = std::chrono::steady_clock::now();
+}
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(const unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+void yield() { std::this_thread::yield(); }
+
+EspClass ESP;
+HWCDC Serial;
+
+size_t HWCDC::write(const uint8_t b) { return fputc(b, stderr) == EOF ? 0 : 1; }
+
+size_t HWCDC::write(const uint8_t* buffer, const size_t size) { return fwrite(buffer, 1, size, stderr); }
+
+void HWCDC::flush() { fflush(stderr); }
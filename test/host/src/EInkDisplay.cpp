@@ -0,0 +1,100 @@
+#include <EInkDisplay.h>
+
+#include <cassert>
+#include <cstring>
+
+EInkDisplay::EInkDisplay(int8_t, int8_t, int8_t, int8_t, int8_t, int8_t) {
+  memset(frameBuffer, 0xFF, sizeof(frameBuffer));
+  memset(lsbBuffer, 0x00, sizeof(lsbBuffer));
+  memset(msbBuffer, 0x00, sizeof(msbBuffer));
+  memset(panelImage, 0xFF, sizeof(panelImage));
+  latestInstance = this;
+}
+
+void EInkDisplay::clearScreen(const uint8_t color) const { memset(frameBuffer, color, sizeof(frameBuffer)); }
+
+void EInkDisplay::drawImage(const uint8_t* imageData, const uint16_t x, const uint16_t y, const uint16_t w,
+                            const uint16_t h, bool) const {
+  // Byte aligned copy, like the driver: x and w are expected to be multiples of 8
+  const uint16_t rowBytes = w / 8;
+  for (uint16_t row = 0; row < h && y + row < DISPLAY_HEIGHT; row++) {
+    for (uint16_t col = 0; col < rowBytes && x / 8 + col < DISPLAY_WIDTH_BYTES; col++) {
+      frameBuffer[(y + row) * DISPLAY_WIDTH_BYTES + x / 8 + col] = imageData[row * rowBytes + col];
+    }
+  }
+}
+
+void EInkDisplay::drawImageTransparent(const uint8_t* imageData, const uint16_t x, const uint16_t y, const uint16_t w,
+                                       const uint16_t h, bool) const {
+  // Only black (0) pixels of the image are drawn
+  const uint16_t rowBytes = w / 8;
+  for (uint16_t row = 0; row < h && y + row < DISPLAY_HEIGHT; row++) {
+    for (uint16_t col = 0; col < rowBytes && x / 8 + col < DISPLAY_WIDTH_BYTES; col++) {
+      frameBuffer[(y + row) * DISPLAY_WIDTH_BYTES + x / 8 + col] &= imageData[row * rowBytes + col];
+    }
+  }
+}
+
+void EInkDisplay::displayBuffer(const RefreshMode mode, bool) {
+  memcpy(panelImage, frameBuffer, sizeof(panelImage));
+  grayShown = false;
+  refreshCounts[mode]++;
+}
+
+void EInkDisplay::displayWindow(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h, bool) {
+  // Like the controller, only whole bytes of the window are transferred
+  assert(x % 8 == 0 && w % 8 == 0 && x + w <= DISPLAY_WIDTH && y + h <= DISPLAY_HEIGHT);
+  for (uint16_t row = y; row < y + h; row++) {
+    memcpy(panelImage + row * DISPLAY_WIDTH_BYTES + x / 8, frameBuffer + row * DISPLAY_WIDTH_BYTES + x / 8, w / 8);
+  }
+  lastWindow[0] = x;
+  lastWindow[1] = y;
+  lastWindow[2] = w;
+  lastWindow[3] = h;
+  windowRefreshCount++;
+  grayShown = false;
+}
+
+void EInkDisplay::refreshDisplay(const RefreshMode mode, bool) {
+  memcpy(panelImage, frameBuffer, sizeof(panelImage));
+  grayShown = false;
+  refreshCounts[mode]++;
+}
+
+void EInkDisplay::copyGrayscaleBuffers(const uint8_t* lsb, const uint8_t* msb) {
+  copyGrayscaleLsbBuffers(lsb);
+  copyGrayscaleMsbBuffers(msb);
+}
+
+void EInkDisplay::copyGrayscaleLsbBuffers(const uint8_t* lsb) { memcpy(lsbBuffer, lsb, sizeof(lsbBuffer)); }
+
+void EInkDisplay::copyGrayscaleMsbBuffers(const uint8_t* msb) { memcpy(msbBuffer, msb, sizeof(msbBuffer)); }
+
+void EInkDisplay::cleanupGrayscaleBuffers(const uint8_t* bwBuffer) {
+  memcpy(lsbBuffer, bwBuffer, sizeof(lsbBuffer));
+  memcpy(msbBuffer, bwBuffer, sizeof(msbBuffer));
+}
+
+void EInkDisplay::displayGrayBuffer(bool) {
+  // The panel keeps showing these levels after the planes are cleaned up for the next frame
+  memcpy(shownLsb, lsbBuffer, sizeof(shownLsb));
+  memcpy(shownMsb, msbBuffer, sizeof(shownMsb));
+  grayShown = true;
+  grayRefreshCount++;
+}
+
+void EInkDisplay::getPanelLevels(uint8_t* levels) const {
+  for (uint32_t i = 0; i < BUFFER_SIZE; i++) {
+    for (int bit = 0; bit < 8; bit++) {
+      const uint8_t mask = 0x80 >> bit;
+      uint8_t level = (panelImage[i] & mask) ? 255 : 0;
+      if (grayShown && level == 0) {
+        // The gray passes flag light and dark gray in the MSB plane and dark gray in the LSB plane
+        const bool msb = shownMsb[i] & mask;
+        const bool lsb = shownLsb[i] & mask;
+        level = msb ? (lsb ? 85 : 170) : 0;
+      }
+      *levels++ = level;
+    }
+  }
+}
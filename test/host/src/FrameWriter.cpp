@@ -0,0 +1,72 @@
+#include <FrameWriter.h>
+#include <Logging.h>
+#include <miniz.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+bool endsWith(const std::string& s, const char* suffix) {
+  const size_t n = strlen(suffix);
+  return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+bool writeFile(const std::string& path, const void* data, const size_t size, const std::string& header = "") {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) {
+    LOG_ERR("FRM", "Cannot open %s for writing", path.c_str());
+    return false;
+  }
+  const bool ok = fwrite(header.data(), 1, header.size(), f) == header.size() && fwrite(data, 1, size, f) == size;
+  return fclose(f) == 0 && ok;
+}
+}  // namespace
+
+bool writePanelImage(const std::string& path, const EInkDisplay& panel, const GfxRenderer::Orientation orientation) {
+  constexpr int panelWidth = EInkDisplay::DISPLAY_WIDTH;
+  constexpr int panelHeight = EInkDisplay::DISPLAY_HEIGHT;
+  std::vector<uint8_t> levels(panelWidth * panelHeight);
+  panel.getPanelLevels(levels.data());
+
+  const bool portrait = orientation == GfxRenderer::Portrait || orientation == GfxRenderer::PortraitInverted;
+  const int width = portrait ? panelHeight : panelWidth;
+  const int height = portrait ? panelWidth : panelHeight;
+  std::vector<uint8_t> image(width * height);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      // Same mapping as GfxRenderer's logical to panel rotation
+      int phyX = x, phyY = y;
+      switch (orientation) {
+        case GfxRenderer::Portrait:
+          phyX = y;
+          phyY = panelHeight - 1 - x;
+          break;
+        case GfxRenderer::LandscapeClockwise:
+          phyX = panelWidth - 1 - x;
+          phyY = panelHeight - 1 - y;
+          break;
+        case GfxRenderer::PortraitInverted:
+          phyX = panelWidth - 1 - y;
+          phyY = x;
+          break;
+        case GfxRenderer::LandscapeCounterClockwise:
+          break;
+      }
+      image[y * width + x] = levels[phyY * panelWidth + phyX];
+    }
+  }
+
+  if (endsWith(path, ".png")) {
+    size_t pngSize = 0;
+    void* png = tdefl_write_image_to_png_file_in_memory(image.data(), width, height, 1, &pngSize);
+    if (!png) {
+      LOG_ERR("FRM", "PNG encoding failed");
+      return false;
+    }
+    const bool ok = writeFile(path, png, pngSize);
+    mz_free(png);
+    return ok;
+  }
+  return writeFile(path, image.data(), image.size(),
+                   "P5\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n");
+}
@@ -0,0 +1,60 @@
+#include <ImageFiles.h>
+#include <miniz.h>
+
+#include <cstdio>
+
+std::vector<uint8_t> readFile(const std::string& path) {
+  std::vector<uint8_t> data;
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) return data;
+  uint8_t buf[4096];
+  size_t count;
+  while ((count = fread(buf, 1, sizeof(buf), file)) > 0) data.insert(data.end(), buf, buf + count);
+  fclose(file);
+  return data;
+}
+
+bool writeFile(const std::string& path, const void* data, const size_t size) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file) return false;
+  const bool ok = fwrite(data, 1, size, file) == size;
+  return fclose(file) == 0 && ok;
+}
+
+bool writePng(const std::string& path, const std::vector<uint8_t>& pixels, const int width, const int height,
+              const int channels) {
+  size_t size = 0;
+  void* png = tdefl_write_image_to_png_file_in_memory(pixels.data(), width, height, channels, &size);
+  if (!png) return false;
+  const bool ok = writeFile(path, png, size);
+  mz_free(png);
+  return ok;
+}
+
+bool writeBmp24(const std::string& path, const std::vector<uint8_t>& pixels, const int width, const int height,
+                const int channels) {
+  const int stride = (width * 3 + 3) / 4 * 4;
+  std::vector<uint8_t> file(54 + static_cast<size_t>(stride) * height, 0);
+  auto put32 = [&file](const size_t at, const uint32_t value) {
+    for (int i = 0; i < 4; i++) file[at + i] = static_cast<uint8_t>(value >> (8 * i));
+  };
+  file[0] = 'B';
+  file[1] = 'M';
+  put32(2, file.size());
+  put32(10, 54);
+  put32(14, 40);
+  put32(18, width);
+  put32(22, height);
+  file[26] = 1;
+  file[28] = 24;
+  for (int y = 0; y < height; y++) {
+    uint8_t* row = &file[54 + static_cast<size_t>(height - 1 - y) * stride];
+    for (int x = 0; x < width; x++) {
+      const uint8_t* p = &pixels[(static_cast<size_t>(y) * width + x) * channels];
+      row[x * 3] = p[2];
+      row[x * 3 + 1] = p[1];
+      row[x * 3 + 2] = p[0];
+    }
+  }
+  return writeFile(path, file.data(), file.size());
+}
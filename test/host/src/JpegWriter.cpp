@@ -0,0 +1,264 @@
+#include <JpegWriter.h>
+#include <Logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+// ITU T.81 Annex K tables; the luminance Huffman tables are used for every component
+constexpr uint8_t LUMA_QUANT[64] = {16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+                                    14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+                                    18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+                                    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+constexpr uint8_t CHROMA_QUANT[64] = {17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+                                      24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+                                      99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+                                      99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99};
+constexpr uint8_t ZIGZAG[64] = {0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,  12, 19, 26, 33, 40, 48,
+                                41, 34, 27, 20, 13, 6,  7,  14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23,
+                                30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+constexpr uint8_t DC_BITS[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+constexpr uint8_t DC_VALUES[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+constexpr uint8_t AC_BITS[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+constexpr uint8_t AC_VALUES[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14,
+    0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09,
+    0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a,
+    0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65,
+    0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88,
+    0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9,
+    0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca,
+    0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea,
+    0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa};
+
+struct HuffCode {
+  uint16_t code = 0;
+  uint8_t length = 0;
+};
+
+// Canonical codes from a DHT bit-count list
+void buildCodes(const uint8_t* bits, const uint8_t* values, HuffCode* codes) {
+  uint16_t code = 0;
+  int k = 0;
+  for (int length = 1; length <= 16; length++) {
+    for (int i = 0; i < bits[length - 1]; i++) codes[values[k++]] = {code++, static_cast<uint8_t>(length)};
+    code <<= 1;
+  }
+}
+
+class BitWriter {
+ public:
+  explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+  void put(const uint32_t value, const int length) {
+    buffer = (buffer << length) | (value & ((1u << length) - 1));
+    count += length;
+    while (count >= 8) {
+      const uint8_t byte = static_cast<uint8_t>(buffer >> (count - 8));
+      out.push_back(byte);
+      if (byte == 0xFF) out.push_back(0x00);
+      count -= 8;
+    }
+  }
+
+  // Pads the last byte with 1 bits
+  void flush() {
+    if (count > 0) put(0x7F, 8 - count);
+  }
+
+ private:
+  std::vector<uint8_t>& out;
+  uint32_t buffer = 0;
+  int count = 0;
+};
+
+struct Component {
+  int h;
+  int v;
+  int quantTable;
+  std::vector<uint8_t> plane;  // Full resolution samples
+  int lastDc = 0;
+};
+
+void writeMarker(std::vector<uint8_t>& out, const uint8_t marker, const std::vector<uint8_t>& payload) {
+  out.push_back(0xFF);
+  out.push_back(marker);
+  const size_t length = payload.size() + 2;
+  out.push_back(static_cast<uint8_t>(length >> 8));
+  out.push_back(static_cast<uint8_t>(length));
+  out.insert(out.end(), payload.begin(), payload.end());
+}
+
+uint8_t clampByte(const float value) { return static_cast<uint8_t>(std::clamp(std::lround(value), 0L, 255L)); }
+
+// Bit length of |value|, the JPEG magnitude category
+int category(int value) {
+  value = std::abs(value);
+  int bits = 0;
+  while (value) {
+    bits++;
+    value >>= 1;
+  }
+  return bits;
+}
+}  // namespace
+
+std::vector<uint8_t> encodeJpeg(const uint8_t* pixels, const int width, const int height, const JpegSampling sampling,
+                                const int quality) {
+  // IJG quality scaling
+  const int q = std::clamp(quality, 1, 100);
+  const int scale = q < 50 ? 5000 / q : 200 - 2 * q;
+  uint8_t quant[2][64];
+  for (int i = 0; i < 64; i++) {
+    quant[0][i] = static_cast<uint8_t>(std::clamp((LUMA_QUANT[i] * scale + 50) / 100, 1, 255));
+    quant[1][i] = static_cast<uint8_t>(std::clamp((CHROMA_QUANT[i] * scale + 50) / 100, 1, 255));
+  }
+
+  std::vector<Component> components;
+  const size_t pixelCount = static_cast<size_t>(width) * height;
+  if (sampling == JpegSampling::Grayscale) {
+    components.push_back({1, 1, 0, std::vector<uint8_t>(pixels, pixels + pixelCount)});
+  } else {
+    const int h = sampling == JpegSampling::H1V1 ? 1 : 2;
+    const int v = sampling == JpegSampling::H2V2 ? 2 : 1;
+    components.push_back({h, v, 0, std::vector<uint8_t>(pixelCount)});
+    components.push_back({1, 1, 1, std::vector<uint8_t>(pixelCount)});
+    components.push_back({1, 1, 1, std::vector<uint8_t>(pixelCount)});
+    for (size_t i = 0; i < pixelCount; i++) {
+      const float r = pixels[i * 3], g = pixels[i * 3 + 1], b = pixels[i * 3 + 2];
+      components[0].plane[i] = clampByte(0.299f * r + 0.587f * g + 0.114f * b);
+      components[1].plane[i] = clampByte(-0.168736f * r - 0.331264f * g + 0.5f * b + 128.0f);
+      components[2].plane[i] = clampByte(0.5f * r - 0.418688f * g - 0.081312f * b + 128.0f);
+    }
+  }
+  const int maxH = components[0].h;
+  const int maxV = components[0].v;
+
+  std::vector<uint8_t> out = {0xFF, 0xD8};
+  for (int table = 0; table < (components.size() > 1 ? 2 : 1); table++) {
+    std::vector<uint8_t> dqt = {static_cast<uint8_t>(table)};
+    for (const uint8_t index : ZIGZAG) dqt.push_back(quant[table][index]);
+    writeMarker(out, 0xDB, dqt);
+  }
+  std::vector<uint8_t> sof = {8, static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+                              static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+                              static_cast<uint8_t>(components.size())};
+  for (size_t i = 0; i < components.size(); i++) {
+    sof.insert(sof.end(), {static_cast<uint8_t>(i + 1), static_cast<uint8_t>(components[i].h << 4 | components[i].v),
+                           static_cast<uint8_t>(components[i].quantTable)});
+  }
+  writeMarker(out, 0xC0, sof);
+  std::vector<uint8_t> dht = {0x00};
+  dht.insert(dht.end(), DC_BITS, DC_BITS + 16);
+  dht.insert(dht.end(), DC_VALUES, DC_VALUES + sizeof(DC_VALUES));
+  dht.push_back(0x10);
+  dht.insert(dht.end(), AC_BITS, AC_BITS + 16);
+  dht.insert(dht.end(), AC_VALUES, AC_VALUES + sizeof(AC_VALUES));
+  writeMarker(out, 0xC4, dht);
+  std::vector<uint8_t> sos = {static_cast<uint8_t>(components.size())};
+  for (size_t i = 0; i < components.size(); i++) sos.insert(sos.end(), {static_cast<uint8_t>(i + 1), 0x00});
+  sos.insert(sos.end(), {0, 63, 0});
+  writeMarker(out, 0xDA, sos);
+
+  HuffCode dcCodes[256], acCodes[256];
+  buildCodes(DC_BITS, DC_VALUES, dcCodes);
+  buildCodes(AC_BITS, AC_VALUES, acCodes);
+  float cosines[8][8];
+  for (int u = 0; u < 8; u++) {
+    for (int x = 0; x < 8; x++) {
+      cosines[u][x] = (u == 0 ? std::sqrt(0.125f) : 0.5f) * std::cos((2 * x + 1) * u * static_cast<float>(M_PI) / 16);
+    }
+  }
+
+  BitWriter bits(out);
+  const int mcuWidth = 8 * maxH;
+  const int mcuHeight = 8 * maxV;
+  for (int mcuY = 0; mcuY < height; mcuY += mcuHeight) {
+    for (int mcuX = 0; mcuX < width; mcuX += mcuWidth) {
+      for (Component& component : components) {
+        // Samples per block pixel: a subsampled component averages a square of the full resolution plane
+        const int stepX = maxH / component.h;
+        const int stepY = maxV / component.v;
+        for (int blockY = 0; blockY < component.v; blockY++) {
+          for (int blockX = 0; blockX < component.h; blockX++) {
+            float block[64];
+            for (int y = 0; y < 8; y++) {
+              for (int x = 0; x < 8; x++) {
+                int sum = 0;
+                for (int sy = 0; sy < stepY; sy++) {
+                  for (int sx = 0; sx < stepX; sx++) {
+                    // Edge pixels repeat into the padding of partial MCUs
+                    const int px = std::min(mcuX + (blockX * 8 + x) * stepX + sx, width - 1);
+                    const int py = std::min(mcuY + (blockY * 8 + y) * stepY + sy, height - 1);
+                    sum += component.plane[static_cast<size_t>(py) * width + px];
+                  }
+                }
+                block[y * 8 + x] = static_cast<float>(sum) / (stepX * stepY) - 128.0f;
+              }
+            }
+
+            // Separable forward DCT, then quantize in zigzag order
+            float rows[64];
+            for (int y = 0; y < 8; y++) {
+              for (int u = 0; u < 8; u++) {
+                float sum = 0;
+                for (int x = 0; x < 8; x++) sum += cosines[u][x] * block[y * 8 + x];
+                rows[y * 8 + u] = sum;
+              }
+            }
+            int coefficients[64];
+            const uint8_t* table = quant[component.quantTable];
+            for (int k = 0; k < 64; k++) {
+              const int u = ZIGZAG[k] % 8;
+              const int v = ZIGZAG[k] / 8;
+              float sum = 0;
+              for (int y = 0; y < 8; y++) sum += cosines[v][y] * rows[y * 8 + u];
+              coefficients[k] = static_cast<int>(std::lround(sum / table[ZIGZAG[k]]));
+            }
+
+            const int diff = coefficients[0] - component.lastDc;
+            component.lastDc = coefficients[0];
+            const int dcSize = category(diff);
+            bits.put(dcCodes[dcSize].code, dcCodes[dcSize].length);
+            if (dcSize) bits.put(diff < 0 ? diff - 1 : diff, dcSize);
+
+            int run = 0;
+            for (int k = 1; k < 64; k++) {
+              if (coefficients[k] == 0) {
+                run++;
+                continue;
+              }
+              while (run >= 16) {
+                bits.put(acCodes[0xF0].code, acCodes[0xF0].length);
+                run -= 16;
+              }
+              const int acSize = category(coefficients[k]);
+              const int symbol = run << 4 | acSize;
+              bits.put(acCodes[symbol].code, acCodes[symbol].length);
+              bits.put(coefficients[k] < 0 ? coefficients[k] - 1 : coefficients[k], acSize);
+              run = 0;
+            }
+            if (run) bits.put(acCodes[0x00].code, acCodes[0x00].length);
+          }
+        }
+      }
+    }
+  }
+  bits.flush();
+  out.push_back(0xFF);
+  out.push_back(0xD9);
+  return out;
+}
+
+bool writeJpeg(const std::string& path, const uint8_t* pixels, const int width, const int height,
+               const JpegSampling sampling, const int quality) {
+  const std::vector<uint8_t> jpeg = encodeJpeg(pixels, width, height, sampling, quality);
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) {
+    LOG_ERR("JPW", "Cannot open %s for writing", path.c_str());
+    return false;
+  }
+  const bool ok = fwrite(jpeg.data(), 1, jpeg.size(), f) == jpeg.size();
+  return fclose(f) == 0 && ok;
+}
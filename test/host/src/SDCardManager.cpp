@@ -0,0 +1,133 @@
+#include <SDCardManager.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+SDCardManager& SDCardManager::getInstance() {
+  static SDCardManager instance;
+  return instance;
+}
+
+std::string SDCardManager::hostPath(const char* path) const {
+  std::string p = path ? path : "";
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  return root + p;
+}
+
+std::vector<String> SDCardManager::listFiles(const char* path, const int maxFiles) {
+  std::vector<String> files;
+  FsFile dir = open(path);
+  if (!dir.isDirectory()) return files;
+  for (FsFile entry = dir.openNextFile(); entry && static_cast<int>(files.size()) < maxFiles;
+       entry = dir.openNextFile()) {
+    if (entry.isDirectory()) continue;
+    char name[256];
+    entry.getName(name, sizeof(name));
+    files.emplace_back(name);
+  }
+  return files;
+}
+
+String SDCardManager::readFile(const char* path) {
+  FsFile file = open(path);
+  if (!file || file.isDirectory()) return String();
+  std::string content(file.size(), '\0');
+  const int n = file.read(&content[0], content.size());
+  content.resize(n < 0 ? 0 : n);
+  return String(content);
+}
+
+bool SDCardManager::readFileToStream(const char* path, Print& out, const size_t chunkSize) {
+  FsFile file = open(path);
+  if (!file || file.isDirectory()) return false;
+  std::string buf(chunkSize, '\0');
+  int n;
+  while ((n = file.read(&buf[0], chunkSize)) > 0) {
+    out.write(reinterpret_cast<const uint8_t*>(buf.data()), n);
+  }
+  return true;
+}
+
+size_t SDCardManager::readFileToBuffer(const char* path, char* buffer, const size_t bufferSize, const size_t maxBytes) {
+  if (!buffer || bufferSize == 0) return 0;
+  FsFile file = open(path);
+  if (!file || file.isDirectory()) {
+    buffer[0] = '\0';
+    return 0;
+  }
+  size_t toRead = bufferSize - 1;
+  if (maxBytes > 0 && maxBytes < toRead) toRead = maxBytes;
+  const int n = file.read(buffer, toRead);
+  const size_t got = n < 0 ? 0 : n;
+  buffer[got] = '\0';
+  return got;
+}
+
+bool SDCardManager::writeFile(const char* path, const String& content) {
+  FsFile file;
+  if (!openFileForWrite("SD", path, file)) return false;
+  return file.write(reinterpret_cast<const uint8_t*>(content.c_str()), content.length()) == content.length();
+}
+
+bool SDCardManager::ensureDirectoryExists(const char* path) { return exists(path) || mkdir(path, true); }
+
+FsFile SDCardManager::open(const char* path, const oflag_t oflag) {
+  FsFile file;
+  file.open(hostPath(path).c_str(), oflag);
+  return file;
+}
+
+bool SDCardManager::mkdir(const char* path, const bool pFlag) {
+  const std::string full = hostPath(path);
+  if (!pFlag) return ::mkdir(full.c_str(), 0755) == 0;
+  for (size_t pos = root.size() + 1; pos <= full.size(); pos++) {
+    if (pos == full.size() || full[pos] == '/') {
+      const std::string partial = full.substr(0, pos);
+      struct stat st = {};
+      if (stat(partial.c_str(), &st) != 0 && ::mkdir(partial.c_str(), 0755) != 0) return false;
+    }
+  }
+  return true;
+}
+
+bool SDCardManager::exists(const char* path) {
+  struct stat st = {};
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool SDCardManager::remove(const char* path) { return ::unlink(hostPath(path).c_str()) == 0; }
+
+bool SDCardManager::rmdir(const char* path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+bool SDCardManager::openFileForRead(const char* moduleName, const char* path, FsFile& file) {
+  if (!file.open(hostPath(path).c_str(), O_RDONLY) || file.isDirectory()) {
+    fprintf(stderr, "[%s] File does not exist: %s\n", moduleName, path);
+    file.close();
+    return false;
+  }
+  return true;
+}
+
+bool SDCardManager::openFileForWrite(const char* moduleName, const char* path, FsFile& file) {
+  if (!file.open(hostPath(path).c_str(), O_RDWR | O_CREAT | O_TRUNC)) {
+    fprintf(stderr, "[%s] Failed to open file for writing: %s\n", moduleName, path);
+    return false;
+  }
+  return true;
+}
+
+bool SDCardManager::removeDir(const char* path) {
+  FsFile dir = open(path);
+  if (!dir.isDirectory()) return false;
+  const std::string base = path;
+  for (FsFile entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+    char name[256];
+    entry.getName(name, sizeof(name));
+    const std::string child = base + "/" + name;
+    const bool isDir = entry.isDirectory();
+    entry.close();
+    if (isDir ? !removeDir(child.c_str()) : !remove(child.c_str())) return false;
+  }
+  return rmdir(path);
+}
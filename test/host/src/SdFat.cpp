@@ -0,0 +1,147 @@
+#include <SdFat.h>
+#include <sys/stat.h>
+
+#include <cstring>
+#include <ctime>
+
+FsFile& FsFile::operator=(FsFile&& other) noexcept {
+  if (this != &other) {
+    close();
+    fp = other.fp;
+    dir = other.dir;
+    path = std::move(other.path);
+    other.fp = nullptr;
+    other.dir = nullptr;
+  }
+  return *this;
+}
+
+bool FsFile::open(const char* hostPath, const oflag_t oflag) {
+  close();
+  path = hostPath;
+
+  struct stat st = {};
+  if (stat(hostPath, &st) == 0 && S_ISDIR(st.st_mode)) {
+    dir = opendir(hostPath);
+    return dir != nullptr;
+  }
+
+  const char* mode = "rb";
+  if (oflag & (O_WRONLY | O_RDWR)) {
+    if (oflag & O_APPEND) {
+      mode = (oflag & O_RDWR) ? "a+b" : "ab";
+    } else if (oflag & O_TRUNC) {
+      mode = (oflag & O_RDWR) ? "w+b" : "wb";
+    } else if (oflag & O_CREAT) {
+      // Create without truncating: make sure the file exists, then open it for update
+      FILE* touch = fopen(hostPath, "ab");
+      if (touch) fclose(touch);
+      mode = "r+b";
+    } else {
+      mode = "r+b";
+    }
+  }
+  fp = fopen(hostPath, mode);
+  return fp != nullptr;
+}
+
+bool FsFile::close() {
+  const bool wasOpen = isOpen();
+  if (fp) {
+    fclose(fp);
+    fp = nullptr;
+  }
+  if (dir) {
+    closedir(dir);
+    dir = nullptr;
+  }
+  return wasOpen;
+}
+
+int FsFile::read(void* buf, const size_t count) {
+  if (!fp) return -1;
+  return static_cast<int>(fread(buf, 1, count, fp));
+}
+
+int FsFile::read() {
+  if (!fp) return -1;
+  const int c = fgetc(fp);
+  return c == EOF ? -1 : c;
+}
+
+int FsFile::peek() {
+  if (!fp) return -1;
+  const int c = fgetc(fp);
+  if (c == EOF) return -1;
+  ungetc(c, fp);
+  return c;
+}
+
+int FsFile::available() {
+  if (!fp) return 0;
+  const uint64_t remaining = size() - position();
+  return remaining > INT32_MAX ? INT32_MAX : static_cast<int>(remaining);
+}
+
+size_t FsFile::write(const uint8_t b) { return fp && fputc(b, fp) != EOF ? 1 : 0; }
+
+size_t FsFile::write(const uint8_t* buffer, const size_t size) { return fp ? fwrite(buffer, 1, size, fp) : 0; }
+
+void FsFile::flush() {
+  if (fp) fflush(fp);
+}
+
+uint64_t FsFile::size() const {
+  if (!fp) return 0;
+  struct stat st = {};
+  fflush(fp);
+  return fstat(fileno(fp), &st) == 0 ? st.st_size : 0;
+}
+
+uint64_t FsFile::position() const { return fp ? ftello(fp) : 0; }
+
+bool FsFile::seekSet(const uint64_t pos) { return fp && fseeko(fp, static_cast<off_t>(pos), SEEK_SET) == 0; }
+
+bool FsFile::seekCur(const int64_t offset) { return fp && fseeko(fp, static_cast<off_t>(offset), SEEK_CUR) == 0; }
+
+bool FsFile::seekEnd(const int64_t offset) { return fp && fseeko(fp, static_cast<off_t>(offset), SEEK_END) == 0; }
+
+size_t FsFile::getName(char* name, const size_t len) const {
+  if (!name || len == 0) return 0;
+  const auto slash = path.find_last_of('/');
+  const std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+  strncpy(name, base.c_str(), len - 1);
+  name[len - 1] = '\0';
+  return strlen(name);
+}
+
+bool FsFile::getModifyDateTime(uint16_t* pdate, uint16_t* ptime) {
+  struct stat st = {};
+  if (!isOpen() || stat(path.c_str(), &st) != 0) return false;
+  struct tm local = {};
+  localtime_r(&st.st_mtime, &local);
+  *pdate = static_cast<uint16_t>((local.tm_year - 80) << 9 | (local.tm_mon + 1) << 5 | local.tm_mday);
+  *ptime = static_cast<uint16_t>(local.tm_hour << 11 | local.tm_min << 5 | local.tm_sec / 2);
+  return true;
+}
+
+FsFile FsFile::openNextFile() {
+  FsFile next;
+  if (!dir) return next;
+  while (const dirent* entry = readdir(dir)) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+    next.open((path + "/" + entry->d_name).c_str(), O_RDONLY);
+    break;
+  }
+  return next;
+}
+
+void FsFile::rewindDirectory() {
+  if (dir) rewinddir(dir);
+}
+
+bool FsFile::rename(const char* newHostPath) {
+  if (::rename(path.c_str(), newHostPath) != 0) return false;
+  path = newHostPath;
+  return true;
+}
@@ -0,0 +1,147 @@
+#include <HalStorage.h>
+#include <HostTest.h>
+#include <SDCardManager.h>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "lib/Epub/Epub/ImageCache.h"
+
+// Usage: ImageCacheTest [DIR]
+// Adds and releases references from two books sharing images in a cache under DIR (default /tmp) and checks that an
+// image and its pixel caches stay while any book uses it and are deleted with the last reference, and that a corrupt
+// index is read as empty.
+
+namespace {
+std::string pixelCachePath(const ImageCache& cache, const ImageCache::Key& key) {
+  const std::string image = cache.getImagePath(key, ".png");
+  return image.substr(0, image.size() - 4) + "_400x300.pxc";
+}
+
+// Stands in for extracting an image and decoding it at one size
+void writeImage(const ImageCache& cache, const ImageCache::Key& key) {
+  for (const std::string& path : {cache.getImagePath(key, ".png"), pixelCachePath(cache, key)}) {
+    FsFile file;
+    Storage.openFileForWrite("TST", path, file);
+    file.write(reinterpret_cast<const uint8_t*>("x"), 1);
+    file.close();
+  }
+}
+
+bool hasImage(const ImageCache& cache, const ImageCache::Key& key) {
+  return Storage.exists(cache.getImagePath(key, ".png").c_str()) && Storage.exists(pixelCachePath(cache, key).c_str());
+}
+
+bool hasNoImage(const ImageCache& cache, const ImageCache::Key& key) {
+  return !Storage.exists(cache.getImagePath(key, ".png").c_str()) &&
+         !Storage.exists(pixelCachePath(cache, key).c_str());
+}
+
+void testSharing(const std::string& root) {
+  const std::string dir = root + "/images";
+  const std::string bookA = root + "/book_a";
+  const std::string bookB = root + "/book_b";
+  Storage.removeDir(dir.c_str());
+  Storage.removeDir(bookA.c_str());
+  Storage.removeDir(bookB.c_str());
+  Storage.mkdir(bookA.c_str());
+  Storage.mkdir(bookB.c_str());
+
+  const ImageCache::Key shared = {0x12345678, 1000};
+  const ImageCache::Key onlyA = {0x12345678, 2000};  // Same CRC, different size: a different image
+  const ImageCache::Key onlyB = {0xcafef00d, 1000};
+  expect(ImageCache(dir, bookA).getImagePath(shared, ".png") == dir + "/12345678_000003e8.png", "image path");
+
+  {
+    ImageCache a(dir, bookA);
+    // A book counts once however many chapters show the image
+    expect(a.addReference(shared) && a.addReference(onlyA) && a.addReference(shared), "add references of book A");
+    expect(!Storage.exists((dir + "/refs.bin").c_str()), "references wait for the commit");
+    expect(a.commit(), "commit book A's references");
+    expect(Storage.exists((bookA + "/images.bin").c_str()), "book A's list is written by the commit");
+    writeImage(a, shared);
+    writeImage(a, onlyA);
+  }
+  {
+    // References made while laying out another section of the same book
+    ImageCache a(dir, bookA);
+    expect(a.addReference(shared) && a.commit(), "add reference again from book A");
+  }
+  {
+    ImageCache b(dir, bookB);
+    expect(b.addReference(shared) && b.addReference(onlyB) && b.commit(), "add references of book B");
+    writeImage(b, onlyB);
+  }
+
+  expect(ImageCache(dir, bookA).releaseBook(), "release book A");
+  expect(hasImage(ImageCache(dir, bookB), shared), "image shared with book B is kept");
+  expect(hasImage(ImageCache(dir, bookB), onlyB), "book B's own image is kept");
+  expect(hasNoImage(ImageCache(dir, bookB), onlyA), "book A's own image is deleted");
+  expect(!Storage.exists((bookA + "/images.bin").c_str()), "book A's list is removed");
+  expect(ImageCache(dir, bookA).releaseBook(), "releasing a released book does nothing");
+  expect(hasImage(ImageCache(dir, bookB), shared), "second release leaves the shared image");
+
+  expect(ImageCache(dir, bookB).releaseBook(), "release book B");
+  expect(hasNoImage(ImageCache(dir, bookB), shared), "shared image is deleted with its last book");
+  expect(hasNoImage(ImageCache(dir, bookB), onlyB), "book B's own image is deleted");
+
+  Storage.removeDir(dir.c_str());
+  Storage.removeDir(bookA.c_str());
+  Storage.removeDir(bookB.c_str());
+}
+
+void writeFile(const std::string& path, const uint8_t* data, const size_t size) {
+  FsFile file;
+  Storage.openFileForWrite("TST", path, file);
+  file.write(data, size);
+  file.close();
+}
+
+// A count the file size does not back is read as an empty index rather than sizing a vector from it
+void testCorruptIndex(const std::string& root) {
+  const std::string dir = root + "/images";
+  const std::string book = root + "/book";
+  Storage.removeDir(dir.c_str());
+  Storage.removeDir(book.c_str());
+  Storage.mkdir(dir.c_str());
+  Storage.mkdir(book.c_str());
+
+  // Version 1, then a count of 0xffffffff with no records after it
+  const uint8_t hugeCount[] = {1, 0xff, 0xff, 0xff, 0xff};
+  writeFile(dir + "/refs.bin", hugeCount, sizeof(hugeCount));
+  writeFile(book + "/images.bin", hugeCount, sizeof(hugeCount));
+
+  const ImageCache::Key key = {0x12345678, 1000};
+  {
+    ImageCache cache(dir, book);
+    expect(cache.addReference(key) && cache.commit(), "add a reference over a corrupt index");
+    writeImage(cache, key);
+  }
+  FsFile file;
+  Storage.openFileForRead("TST", dir + "/refs.bin", file);
+  expect(file.size() == 5 + 10, "corrupt index is replaced by one holding the new reference");
+  file.close();
+  expect(ImageCache(dir, book).releaseBook(), "release the book");
+  expect(hasNoImage(ImageCache(dir, book), key), "image is deleted with its only reference");
+
+  Storage.removeDir(dir.c_str());
+  Storage.removeDir(book.c_str());
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::string dir = std::string(argc > 1 ? argv[1] : "/tmp") + "/image_cache_test";
+  SDCardManager::getInstance().setRoot("");  // Cache paths are host paths
+  Storage.mkdir(dir.c_str());
+  testSharing(dir);
+  testCorruptIndex(dir);
+  Storage.removeDir(dir.c_str());
+
+  if (failures) {
+    std::cerr << failures << " failure(s)\n";
+    return 1;
+  }
+  std::cout << "All image cache tests passed\n";
+  return 0;
+}
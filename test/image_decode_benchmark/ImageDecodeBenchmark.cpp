@@ -0,0 +1,583 @@
+#include <BmpRowSource.h>
+#include <HalStorage.h>
+#include <HeapTracking.h>
+#include <HostTest.h>
+#include <ImageFiles.h>
+#include <ImagePipeline.h>
+#include <JpegRowSource.h>
+#include <JpegWriter.h>
+#include <PngRowSource.h>
+#include <miniz.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Usage: ImageDecodeBenchmark [--quick] [--filter TEXT] [--json PATH] [--update] [--keep DIR]
+// Converts a fixed corpus of synthetic book covers (large baseline JPEG, progressive JPEG, PNG with alpha, palette
+// PNG, 24-bit BMP) to the reader's cover size with every decoder and every dither mode, and prints for each the
+// conversion time, peak heap, BMP output size and a perceptual error against a float reference.
+//
+// The reference is the picture the file was written from, converted to gray, blended over white and area-scaled to
+// the cover size in floating point. The error is the RMS difference between the reference and the dithered output
+// after both are blurred (a Gaussian of 1.5 px standing in for reading distance), so dither patterns average out and
+// tone, contrast and detail errors remain. It is measured twice: with the levels shown as the BMP palette says (0, 85,
+// 170, 255), and as the panel shows them (15, 30, 80, 210, the levels the Atkinson and Floyd-Steinberg ditherers are
+// tuned to; 1-bit output uses the ends).
+//
+// Results are compared with baseline.json next to this file. Errors, heap and output sizes are deterministic: an error
+// more than ERROR_TOLERANCE above the baseline, or a case that no longer decodes, fails the run. Timings are
+// machine-specific and only marked. Inputs a decoder does not support are reported and skipped. --update rewrites the
+// baseline, --json writes the results elsewhere, --quick converts each once instead of taking the best of five,
+// --keep writes the corpus and the converted covers to DIR. Peak heap is measured on glibc hosts only.
+
+namespace {
+constexpr int COVER_WIDTH = 480;
+constexpr int COVER_HEIGHT = 800;
+constexpr double BLUR_SIGMA = 1.5;
+constexpr double ERROR_TOLERANCE = 0.25;
+constexpr double REGRESSION_PERCENT = 15.0;
+
+std::string sourceDir() {
+  const std::string source = __FILE__;
+  return source.substr(0, source.find_last_of('/'));
+}
+
+enum class Format { Jpeg, Png, Bmp };
+
+// One corpus image: the file, and the reference it is measured against at full size
+struct Sample {
+  std::string name;
+  Format format;
+  std::string path;
+  int width;
+  int height;
+  std::vector<float> reference;  // Gray over white, 0-255
+};
+
+// Gray the panel shows for each 2-bit level (BitmapHelpers' X4 tuning)
+constexpr float PANEL_LEVELS[4] = {15, 30, 80, 210};
+
+struct DitherMode {
+  const char* name;
+  int bits;
+  std::unique_ptr<RowDitherer> (*make)(int width);
+};
+
+const DitherMode kDitherModes[] = {
+    {"atkinson", 2, [](const int width) -> std::unique_ptr<RowDitherer> {
+       return std::make_unique<AtkinsonRowDitherer>(width);
+     }},
+    {"floyd_steinberg", 2, [](const int width) -> std::unique_ptr<RowDitherer> {
+       return std::make_unique<FloydSteinbergRowDitherer>(width);
+     }},
+    {"bayer", 2, [](int) -> std::unique_ptr<RowDitherer> { return std::make_unique<BayerRowDitherer>(); }},
+    {"threshold", 2, [](int) -> std::unique_ptr<RowDitherer> { return std::make_unique<ThresholdRowDitherer>(); }},
+    {"atkinson_1bit", 1, [](const int width) -> std::unique_ptr<RowDitherer> {
+       return std::make_unique<Atkinson1BitRowDitherer>(width);
+     }},
+};
+
+// A cover-like picture in RGBA: a vertical colour gradient, a disc with a checker texture, fine noise and a block of
+// "title" bars. Opaque unless `alpha`, which fades the top and cuts the disc's surroundings out of the lower half.
+std::vector<uint8_t> makeCover(const int width, const int height, const bool alpha) {
+  std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+  std::mt19937 rng(width * 31 + height);
+  std::uniform_int_distribution<int> noise(-4, 4);
+  const int cx = width / 2, cy = height * 2 / 5, radius = width / 3;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int r = 40 + 160 * y / height, g = 60 + 120 * x / width, b = 200 - 150 * y / height, a = 255;
+      const int dx = x - cx, dy = y - cy;
+      const bool inDisc = dx * dx + dy * dy < radius * radius;
+      if (inDisc) {
+        r = 230, g = 190, b = 60;
+        if ((x / 6 + y / 6) % 2 == 0) g -= 40;  // Checker texture inside the disc
+      }
+      const bool titleRow = y > height * 3 / 4 && y < height * 17 / 20 && (y / (height / 60)) % 2;
+      if (titleRow && x > width / 8 && x < width * 7 / 8 && (x / (width / 40)) % 3 != 2) {
+        r = g = b = 20;
+      }
+      if (alpha) {
+        if (y < height / 4) a = 255 * y / (height / 4);
+        if (!inDisc && !titleRow && y > height / 2 && (x < width / 10 || x > width * 9 / 10)) a = 0;
+      }
+      const int n = noise(rng);
+      uint8_t* p = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+      p[0] = static_cast<uint8_t>(std::clamp(r + n, 0, 255));
+      p[1] = static_cast<uint8_t>(std::clamp(g + n, 0, 255));
+      p[2] = static_cast<uint8_t>(std::clamp(b + n, 0, 255));
+      p[3] = static_cast<uint8_t>(a);
+    }
+  }
+  return pixels;
+}
+
+// The colours of `rgba` reduced to a 4x4x4 palette, as palette indices
+std::vector<uint8_t> posterize(std::vector<uint8_t>& rgba) {
+  std::vector<uint8_t> indices(rgba.size() / 4);
+  for (size_t i = 0; i < indices.size(); i++) {
+    uint8_t* p = &rgba[i * 4];
+    indices[i] = static_cast<uint8_t>((p[0] >> 6) * 16 + (p[1] >> 6) * 4 + (p[2] >> 6));
+    for (int c = 0; c < 3; c++) p[c] = static_cast<uint8_t>((p[c] >> 6) * 85);
+  }
+  return indices;
+}
+
+std::vector<float> toReference(const std::vector<uint8_t>& rgba) {
+  std::vector<float> gray(rgba.size() / 4);
+  for (size_t i = 0; i < gray.size(); i++) {
+    const uint8_t* p = &rgba[i * 4];
+    const float luma = 0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2];
+    gray[i] = 255.0f - (255.0f - luma) * p[3] / 255.0f;
+  }
+  return gray;
+}
+
+std::vector<uint8_t> toRgb(const std::vector<uint8_t>& rgba) {
+  std::vector<uint8_t> rgb(rgba.size() / 4 * 3);
+  for (size_t i = 0; i < rgba.size() / 4; i++) {
+    for (int c = 0; c < 3; c++) rgb[i * 3 + c] = rgba[i * 4 + c];
+  }
+  return rgb;
+}
+
+// 8-bit palette PNG with the 4x4x4 palette of posterize()
+bool writePalettePng(const std::string& path, const std::vector<uint8_t>& indices, const int width, const int height) {
+  std::vector<uint8_t> file = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  auto chunk = [&file](const char* type, const std::vector<uint8_t>& data) {
+    const uint32_t length = data.size();
+    for (int i = 3; i >= 0; i--) file.push_back(static_cast<uint8_t>(length >> (8 * i)));
+    const size_t start = file.size();
+    file.insert(file.end(), type, type + 4);
+    file.insert(file.end(), data.begin(), data.end());
+    const uint32_t crc = static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, &file[start], file.size() - start));
+    for (int i = 3; i >= 0; i--) file.push_back(static_cast<uint8_t>(crc >> (8 * i)));
+  };
+
+  std::vector<uint8_t> header = {0, 0, 0, 0, 0, 0, 0, 0, 8, 3, 0, 0, 0};
+  for (int i = 0; i < 4; i++) {
+    header[3 - i] = static_cast<uint8_t>(width >> (8 * i));
+    header[7 - i] = static_cast<uint8_t>(height >> (8 * i));
+  }
+  std::vector<uint8_t> palette;
+  for (int i = 0; i < 64; i++) {
+    palette.push_back(static_cast<uint8_t>((i / 16) * 85));
+    palette.push_back(static_cast<uint8_t>((i / 4 % 4) * 85));
+    palette.push_back(static_cast<uint8_t>((i % 4) * 85));
+  }
+  std::vector<uint8_t> scanlines;
+  scanlines.reserve(static_cast<size_t>(width + 1) * height);
+  for (int y = 0; y < height; y++) {
+    scanlines.push_back(0);  // No filter
+    scanlines.insert(scanlines.end(), indices.begin() + static_cast<size_t>(y) * width,
+                     indices.begin() + static_cast<size_t>(y + 1) * width);
+  }
+  mz_ulong compressedSize = mz_compressBound(scanlines.size());
+  std::vector<uint8_t> compressed(compressedSize);
+  if (mz_compress(compressed.data(), &compressedSize, scanlines.data(), scanlines.size()) != MZ_OK) return false;
+  compressed.resize(compressedSize);
+
+  chunk("IHDR", header);
+  chunk("PLTE", palette);
+  chunk("IDAT", compressed);
+  chunk("IEND", {});
+  return writeFile(path, file.data(), file.size());
+}
+
+// Writes the corpus to `dir`. Returns false if a file could not be written.
+bool makeCorpus(const std::string& dir, std::vector<Sample>& corpus) {
+  {
+    const int w = 1600, h = 2400;
+    const std::vector<uint8_t> rgba = makeCover(w, h, false);
+    const std::string path = dir + "/large_jpeg.jpg";
+    if (!writeJpeg(path, toRgb(rgba).data(), w, h, JpegSampling::H2V2)) return false;
+    corpus.push_back({"large_jpeg", Format::Jpeg, path, w, h, toReference(rgba)});
+  }
+  {
+    // picojpeg decodes baseline JPEG only. A baseline stream whose frame header is marked progressive (SOF2) is
+    // rejected at the same point a real progressive file is, which is as far as either gets.
+    const int w = 1200, h = 1800;
+    const std::vector<uint8_t> rgba = makeCover(w, h, false);
+    std::vector<uint8_t> jpeg = encodeJpeg(toRgb(rgba).data(), w, h, JpegSampling::H2V2);
+    for (size_t at = 2; at + 4 <= jpeg.size() && jpeg[at] == 0xFF; at += 2 + (jpeg[at + 2] << 8 | jpeg[at + 3])) {
+      if (jpeg[at + 1] == 0xC0) {
+        jpeg[at + 1] = 0xC2;
+        break;
+      }
+    }
+    const std::string path = dir + "/progressive_jpeg.jpg";
+    if (!writeFile(path, jpeg.data(), jpeg.size())) return false;
+    corpus.push_back({"progressive_jpeg", Format::Jpeg, path, w, h, toReference(rgba)});
+  }
+  {
+    const int w = 1200, h = 1800;
+    const std::vector<uint8_t> rgba = makeCover(w, h, true);
+    const std::string path = dir + "/png_alpha.png";
+    if (!writePng(path, rgba, w, h, 4)) return false;
+    corpus.push_back({"png_alpha", Format::Png, path, w, h, toReference(rgba)});
+  }
+  {
+    const int w = 1200, h = 1800;
+    std::vector<uint8_t> rgba = makeCover(w, h, false);
+    const std::vector<uint8_t> indices = posterize(rgba);
+    const std::string path = dir + "/png_palette.png";
+    if (!writePalettePng(path, indices, w, h)) return false;
+    corpus.push_back({"png_palette", Format::Png, path, w, h, toReference(rgba)});
+  }
+  {
+    const int w = 1200, h = 1800;
+    const std::vector<uint8_t> rgba = makeCover(w, h, false);
+    const std::string path = dir + "/bmp_24bit.bmp";
+    if (!writeBmp24(path, rgba, w, h, 4)) return false;
+    corpus.push_back({"bmp_24bit", Format::Bmp, path, w, h, toReference(rgba)});
+  }
+  return true;
+}
+
+// Source weights of each output sample when `srcSize` samples are averaged down (or repeated up) to `outSize`
+struct Span {
+  int start;
+  std::vector<double> weights;
+};
+
+std::vector<Span> areaSpans(const int srcSize, const int outSize) {
+  std::vector<Span> spans(outSize);
+  const double scale = static_cast<double>(srcSize) / outSize;
+  for (int i = 0; i < outSize; i++) {
+    const double from = i * scale, to = (i + 1) * scale;
+    Span& span = spans[i];
+    span.start = static_cast<int>(from);
+    double total = 0;
+    for (int j = span.start; j < srcSize && j < to; j++) {
+      const double weight = std::min<double>(j + 1, to) - std::max<double>(j, from);
+      span.weights.push_back(weight);
+      total += weight;
+    }
+    for (double& weight : span.weights) weight /= total;
+  }
+  return spans;
+}
+
+std::vector<float> areaScale(const std::vector<float>& src, const int srcWidth, const int srcHeight,
+                             const int outWidth, const int outHeight) {
+  const std::vector<Span> columns = areaSpans(srcWidth, outWidth);
+  const std::vector<Span> rows = areaSpans(srcHeight, outHeight);
+  std::vector<double> narrow(static_cast<size_t>(outWidth) * srcHeight);
+  for (int y = 0; y < srcHeight; y++) {
+    for (int x = 0; x < outWidth; x++) {
+      double sum = 0;
+      for (size_t k = 0; k < columns[x].weights.size(); k++) {
+        sum += columns[x].weights[k] * src[static_cast<size_t>(y) * srcWidth + columns[x].start + k];
+      }
+      narrow[static_cast<size_t>(y) * outWidth + x] = sum;
+    }
+  }
+  std::vector<float> out(static_cast<size_t>(outWidth) * outHeight);
+  for (int y = 0; y < outHeight; y++) {
+    for (int x = 0; x < outWidth; x++) {
+      double sum = 0;
+      for (size_t k = 0; k < rows[y].weights.size(); k++) {
+        sum += rows[y].weights[k] * narrow[(rows[y].start + k) * outWidth + x];
+      }
+      out[static_cast<size_t>(y) * outWidth + x] = static_cast<float>(sum);
+    }
+  }
+  return out;
+}
+
+// Separable Gaussian blur, edges clamped
+std::vector<float> blur(const std::vector<float>& image, const int width, const int height) {
+  const int radius = static_cast<int>(std::ceil(BLUR_SIGMA * 3));
+  std::vector<double> kernel(2 * radius + 1);
+  double total = 0;
+  for (int i = -radius; i <= radius; i++) {
+    total += kernel[i + radius] = std::exp(-i * i / (2 * BLUR_SIGMA * BLUR_SIGMA));
+  }
+  for (double& weight : kernel) weight /= total;
+
+  std::vector<float> pass(image.size());
+  std::vector<float> out(image.size());
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      double sum = 0;
+      for (int i = -radius; i <= radius; i++) {
+        sum += kernel[i + radius] * image[static_cast<size_t>(y) * width + std::clamp(x + i, 0, width - 1)];
+      }
+      pass[static_cast<size_t>(y) * width + x] = static_cast<float>(sum);
+    }
+  }
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      double sum = 0;
+      for (int i = -radius; i <= radius; i++) {
+        sum += kernel[i + radius] * pass[static_cast<size_t>(std::clamp(y + i, 0, height - 1)) * width + x];
+      }
+      out[static_cast<size_t>(y) * width + x] = static_cast<float>(sum);
+    }
+  }
+  return out;
+}
+
+// Gray of each pixel of a top-down 1- or 2-bit BMP as BmpRowSink writes it: its palette (index * 255 / max index),
+// or, with `panel`, as the panel shows it
+bool readBmpGray(const std::vector<uint8_t>& bmp, const int width, const int height, const bool panel,
+                 std::vector<float>& gray) {
+  if (bmp.size() < 54 || bmp[0] != 'B' || bmp[1] != 'M') return false;
+  const int offset = bmp[10] | bmp[11] << 8 | bmp[12] << 16 | bmp[13] << 24;
+  const int bpp = bmp[28];
+  if (bpp != 1 && bpp != 2) return false;
+  const int stride = (width * bpp + 31) / 32 * 4;
+  if (bmp.size() < static_cast<size_t>(offset) + static_cast<size_t>(stride) * height) return false;
+  const int maxIndex = (1 << bpp) - 1;
+  gray.resize(static_cast<size_t>(width) * height);
+  for (int y = 0; y < height; y++) {
+    const uint8_t* row = &bmp[offset + static_cast<size_t>(y) * stride];
+    for (int x = 0; x < width; x++) {
+      const int bit = x * bpp;
+      const int index = (row[bit / 8] >> (8 - bpp - bit % 8)) & maxIndex;
+      gray[static_cast<size_t>(y) * width + x] =
+          panel ? PANEL_LEVELS[index * 3 / maxIndex] : static_cast<float>(index * 255 / maxIndex);
+    }
+  }
+  return true;
+}
+
+double perceptualError(const std::vector<float>& output, const std::vector<float>& reference, const int width,
+                       const int height) {
+  const std::vector<float> seen = blur(output, width, height);
+  const std::vector<float> meant = blur(reference, width, height);
+  double sum = 0;
+  for (size_t i = 0; i < seen.size(); i++) {
+    const double difference = seen[i] - meant[i];
+    sum += difference * difference;
+  }
+  return std::sqrt(sum / seen.size());
+}
+
+// Opens the decoder for the sample's format; null if it rejects the file
+std::unique_ptr<ImageRowSource> openSource(const Format format, FsFile& file) {
+  switch (format) {
+    case Format::Jpeg: {
+      auto source = std::make_unique<JpegRowSource>(file);
+      if (source->open()) return source;
+      break;
+    }
+    case Format::Png: {
+      auto source = std::make_unique<PngRowSource>(file);
+      if (source->open()) return source;
+      break;
+    }
+    case Format::Bmp: {
+      auto source = std::make_unique<BmpRowSource>(file);
+      if (source->open()) return source;
+      break;
+    }
+  }
+  return nullptr;
+}
+
+struct Result {
+  double ms = 0;
+  size_t peakHeap = 0;
+  size_t bytes = 0;
+  double error = 0;
+  double panelError = 0;
+};
+
+enum class Outcome { Converted, Unsupported, Failed };
+
+Outcome convert(const Sample& sample, const DitherMode& mode, const int runs, Result& result,
+                std::vector<uint8_t>& bmp) {
+  int outWidth, outHeight;
+  ImagePipeline::fitSize(sample.width, sample.height, COVER_WIDTH, COVER_HEIGHT, false, outWidth, outHeight);
+  result.ms = 1e30;
+  for (int run = 0; run < runs; run++) {
+    FsFile file;
+    if (!file.open(sample.path.c_str())) return Outcome::Failed;
+    BufferPrint out(1 << 20);
+    const size_t before = heapInUse.load();
+    resetPeak();
+    const auto start = std::chrono::steady_clock::now();
+    bool ok;
+    {
+      const std::unique_ptr<ImageRowSource> source = openSource(sample.format, file);
+      if (!source) {
+        file.close();
+        return Outcome::Unsupported;
+      }
+      const std::unique_ptr<RowDitherer> ditherer = mode.make(outWidth);
+      BmpRowSink sink(out, mode.bits, *ditherer);
+      ok = ImagePipeline::run(*source, outWidth, outHeight, sink);
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.peakHeap = peakSinceReset(before);
+    result.ms = std::min(result.ms, ms);
+    file.close();
+    if (!ok) return Outcome::Failed;
+    bmp = std::move(out.data);
+  }
+
+  result.bytes = bmp.size();
+  const std::vector<float> reference = areaScale(sample.reference, sample.width, sample.height, outWidth, outHeight);
+  std::vector<float> gray, panelGray;
+  if (!readBmpGray(bmp, outWidth, outHeight, false, gray) || !readBmpGray(bmp, outWidth, outHeight, true, panelGray)) {
+    return Outcome::Failed;
+  }
+  result.error = perceptualError(gray, reference, outWidth, outHeight);
+  result.panelError = perceptualError(panelGray, reference, outWidth, outHeight);
+  return Outcome::Converted;
+}
+
+std::map<std::string, Result> readBaseline(const std::string& path) {
+  // One case per line: "image/dither": {"ms": N, "peak_heap": N, "bytes": N, "error": N, "panel_error": N},
+  std::map<std::string, Result> baseline;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) {
+    const size_t open = line.find('"');
+    const size_t close = line.find('"', open + 1);
+    const size_t ms = line.find("\"ms\":");
+    const size_t heap = line.find("\"peak_heap\":");
+    const size_t bytes = line.find("\"bytes\":");
+    const size_t error = line.find("\"error\":");
+    const size_t panelError = line.find("\"panel_error\":");
+    if (open == std::string::npos || close == std::string::npos || ms == std::string::npos ||
+        heap == std::string::npos || bytes == std::string::npos || error == std::string::npos ||
+        panelError == std::string::npos) {
+      continue;
+    }
+    baseline[line.substr(open + 1, close - open - 1)] = {std::stod(line.substr(ms + 5)),
+                                                         std::stoull(line.substr(heap + 12)),
+                                                         std::stoull(line.substr(bytes + 8)),
+                                                         std::stod(line.substr(error + 8)),
+                                                         std::stod(line.substr(panelError + 14))};
+  }
+  return baseline;
+}
+
+bool writeResults(const std::string& path, const std::vector<std::pair<std::string, Result>>& results) {
+  std::ofstream out(path);
+  out << "{\n  \"cover\": \"" << COVER_WIDTH << "x" << COVER_HEIGHT << "\",\n  \"cases\": {\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto& [name, result] = results[i];
+    char line[256];
+    snprintf(line, sizeof(line),
+             "    \"%s\": {\"ms\": %.2f, \"peak_heap\": %zu, \"bytes\": %zu, \"error\": %.3f, "
+             "\"panel_error\": %.3f}%s\n",
+             name.c_str(), result.ms, result.peakHeap, result.bytes, result.error, result.panelError,
+             i + 1 < results.size() ? "," : "");
+    out << line;
+  }
+  out << "  }\n}\n";
+  return static_cast<bool>(out);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool quick = false;
+  bool update = false;
+  std::string filter;
+  std::string jsonPath;
+  std::string keepDir;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--quick") {
+      quick = true;
+    } else if (arg == "--update") {
+      update = true;
+    } else if (arg == "--filter" && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (arg == "--json" && i + 1 < argc) {
+      jsonPath = argv[++i];
+    } else if (arg == "--keep" && i + 1 < argc) {
+      keepDir = argv[++i];
+    } else {
+      fprintf(stderr, "Usage: %s [--quick] [--filter TEXT] [--json PATH] [--update] [--keep DIR]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  const std::string dir = keepDir.empty() ? "/tmp" : keepDir;
+  std::vector<Sample> corpus;
+  if (!makeCorpus(dir, corpus)) {
+    fprintf(stderr, "FAIL: cannot write the corpus to %s\n", dir.c_str());
+    return 1;
+  }
+
+  const std::map<std::string, Result> baseline = readBaseline(sourceDir() + "/baseline.json");
+  std::vector<std::pair<std::string, Result>> results;
+  const int runs = quick ? 1 : 5;
+  int failures = 0;
+  int slower = 0;
+
+  printf("%-16s %-15s %8s %10s %8s %7s %7s  %s\n", "image", "dither", "ms", "peak heap", "bytes", "error", "panel",
+         "baseline");
+  for (const Sample& sample : corpus) {
+    for (const DitherMode& mode : kDitherModes) {
+      const std::string name = sample.name + "/" + mode.name;
+      if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+      const auto it = baseline.find(name);
+
+      Result result;
+      std::vector<uint8_t> bmp;
+      const Outcome outcome = convert(sample, mode, runs, result, bmp);
+      if (outcome != Outcome::Converted) {
+        const bool regressed = it != baseline.end();
+        printf("%-16s %-15s %8s%s\n", sample.name.c_str(), mode.name,
+               outcome == Outcome::Unsupported ? "unsupported" : "failed",
+               regressed ? "  (decoded in baseline) !" : "");
+        if (outcome == Outcome::Failed || regressed) failures++;
+        continue;
+      }
+      results.emplace_back(name, result);
+      if (!keepDir.empty()) writeFile(dir + "/" + sample.name + "_" + mode.name + ".bmp", bmp.data(), bmp.size());
+
+      char heap[24] = "-";
+      if (HEAP_MEASURED) snprintf(heap, sizeof(heap), "%zu", result.peakHeap);
+      char delta[64] = "-";
+      if (it != baseline.end()) {
+        const double percent = it->second.ms > 0 ? (result.ms / it->second.ms - 1.0) * 100.0 : 0.0;
+        const double errorDelta = result.error - it->second.error;
+        const double panelDelta = result.panelError - it->second.panelError;
+        const bool worse = errorDelta > ERROR_TOLERANCE || panelDelta > ERROR_TOLERANCE;
+        const bool timeRegressed = !quick && percent > REGRESSION_PERCENT;
+        snprintf(delta, sizeof(delta), "%+.1f%%%s error %+.2f panel %+.2f%s", percent, timeRegressed ? " !" : "",
+                 errorDelta, panelDelta, worse ? " !" : "");
+        if (worse) failures++;
+        if (timeRegressed) slower++;
+      }
+      printf("%-16s %-15s %8.1f %10s %8zu %7.2f %7.2f  %s\n", sample.name.c_str(), mode.name, result.ms, heap,
+             result.bytes, result.error, result.panelError, delta);
+    }
+  }
+  if (keepDir.empty()) {
+    for (const Sample& sample : corpus) remove(sample.path.c_str());
+  }
+
+  if (update) jsonPath = sourceDir() + "/baseline.json";
+  if (!jsonPath.empty()) {
+    if (!writeResults(jsonPath, results)) {
+      fprintf(stderr, "FAIL: write %s\n", jsonPath.c_str());
+      return 1;
+    }
+    printf("Wrote %zu results to %s\n", results.size(), jsonPath.c_str());
+  }
+  if (slower) {
+    printf("%d case(s) more than %.0f%% slower than the baseline (marked !)\n", slower, REGRESSION_PERCENT);
+  }
+  if (failures && !update) {
+    fprintf(stderr, "%d case(s) failed, stopped decoding or got more than %.2f worse than the baseline (marked !)\n",
+            failures, ERROR_TOLERANCE);
+    return 1;
+  }
+  return 0;
+}
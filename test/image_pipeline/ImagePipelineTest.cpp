@@ -0,0 +1,567 @@
+#include <BmpRowSource.h>
+#include <HalStorage.h>
+#include <HostTest.h>
+#include <ImageFiles.h>
+#include <ImagePipeline.h>
+#include <ImageProbe.h>
+#include <JpegRowSource.h>
+#include <JpegWriter.h>
+#include <PngRowSource.h>
+#include <SDCardManager.h>
+#include <ZipFile.h>
+#include <miniz.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Checks the streaming image pipeline: the area scaler against exact means, the row ditherers, and the JPEG, PNG and
+// BMP sources decoding the same picture to the same cover BMP, covers decoded straight out of a ZIP entry, and image
+// sizes read from the headers alone.
+
+namespace {
+// Serves a gray image held in memory
+class VectorSource final : public ImageRowSource {
+ public:
+  VectorSource(const int width, const int height, std::vector<uint8_t> pixels)
+      : width(width), height(height), pixels(std::move(pixels)) {}
+  int getWidth() const override { return width; }
+  int getHeight() const override { return height; }
+  bool decode(GrayRowSink& sink) override {
+    for (int y = 0; y < height; y++) {
+      if (!sink.writeRow(&pixels[static_cast<size_t>(y) * width], y)) return false;
+    }
+    return true;
+  }
+
+ private:
+  int width;
+  int height;
+  std::vector<uint8_t> pixels;
+};
+
+// Collects the rows it is given, and checks they arrive in order
+class CaptureSink final : public GrayRowSink {
+ public:
+  bool begin(const int w, const int h) override {
+    width = w;
+    height = h;
+    return true;
+  }
+  bool writeRow(const uint8_t* gray, const int y) override {
+    if (y != rows) outOfOrder = true;
+    pixels.insert(pixels.end(), gray, gray + width);
+    rows++;
+    return true;
+  }
+  uint8_t at(const int x, const int y) const { return pixels[static_cast<size_t>(y) * width + x]; }
+
+  int width = 0;
+  int height = 0;
+  int rows = 0;
+  bool outOfOrder = false;
+  std::vector<uint8_t> pixels;
+};
+
+// A zip entry as the EPUB cover path reads it
+class ZipInput final : public ImageInput {
+ public:
+  explicit ZipInput(ZipFile::EntryReader& entry) : entry(entry) {}
+  int read(uint8_t* buf, const size_t len) override { return entry.read(buf, len); }
+  bool skip(const uint32_t len) override { return entry.skip(len); }
+
+ private:
+  ZipFile::EntryReader& entry;
+};
+
+// Bytes in memory, counting how far they were read
+class MemoryInput final : public ImageInput {
+ public:
+  explicit MemoryInput(const std::vector<uint8_t>& data) : data(data) {}
+  int read(uint8_t* buf, const size_t len) override {
+    const size_t count = std::min(len, data.size() - position);
+    std::copy_n(data.begin() + position, count, buf);
+    position += count;
+    return static_cast<int>(count);
+  }
+  bool skip(const uint32_t len) override {
+    if (len > data.size() - position) return false;
+    position += len;
+    return true;
+  }
+
+  size_t position = 0;
+
+ private:
+  const std::vector<uint8_t>& data;
+};
+
+// Palette indices of a 2-bit top-down BMP as BmpRowSink writes it
+std::vector<uint8_t> bmpLevels(const std::vector<uint8_t>& bmp, const int width, const int height) {
+  std::vector<uint8_t> levels;
+  const int stride = (width * 2 + 31) / 32 * 4;
+  if (bmp.size() != 70 + static_cast<size_t>(stride) * height) return levels;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      levels.push_back((bmp[70 + static_cast<size_t>(y) * stride + x / 4] >> (6 - (x % 4) * 2)) & 3);
+    }
+  }
+  return levels;
+}
+
+double meanLevel(const std::vector<uint8_t>& levels, const size_t from, const size_t to) {
+  double sum = 0;
+  for (size_t i = from; i < to; i++) sum += levels[i];
+  return sum / (to - from);
+}
+
+void testAreaScaler() {
+  {
+    VectorSource source(37, 23, std::vector<uint8_t>(37 * 23, 100));
+    CaptureSink sink;
+    expect(ImagePipeline::run(source, 10, 7, sink), "constant image scales");
+    expect(sink.width == 10 && sink.height == 7 && sink.rows == 7, "scaler emits exactly the output rows");
+    bool constant = true;
+    for (const uint8_t value : sink.pixels) constant &= value == 100;
+    expect(constant, "a constant image stays constant");
+    expect(!sink.outOfOrder, "scaled rows arrive top to bottom");
+  }
+  {
+    // 2x2 blocks of 0/40/80/120 averaged down to one pixel each
+    std::vector<uint8_t> pixels(8 * 4);
+    for (int y = 0; y < 4; y++) {
+      for (int x = 0; x < 8; x++) pixels[y * 8 + x] = static_cast<uint8_t>((x / 2) * 40 + (y % 2) * 4 * (x % 2));
+    }
+    VectorSource source(8, 4, pixels);
+    CaptureSink sink;
+    expect(ImagePipeline::run(source, 4, 2, sink), "integer factor scales");
+    for (int y = 0; y < 2; y++) {
+      for (int x = 0; x < 4; x++) {
+        const int expected = x * 40 + 1;  // One pixel in each block is 4 brighter
+        expect(sink.at(x, y) == expected, "block mean at " + std::to_string(x) + "," + std::to_string(y) + " is " +
+                                              std::to_string(sink.at(x, y)) + ", expected " + std::to_string(expected));
+      }
+    }
+  }
+  {
+    VectorSource source(2, 2, {10, 20, 30, 40});
+    CaptureSink sink;
+    expect(ImagePipeline::run(source, 5, 5, sink), "upscale runs");
+    expect(sink.rows == 5, "upscaling emits every output row");
+    expect(sink.at(0, 0) == 10 && sink.at(4, 0) == 20 && sink.at(0, 4) == 30 && sink.at(4, 4) == 40,
+           "upscaling repeats the nearest source pixel");
+  }
+  {
+    std::vector<uint8_t> pixels(6 * 3);
+    for (size_t i = 0; i < pixels.size(); i++) pixels[i] = static_cast<uint8_t>(i * 10);
+    VectorSource source(6, 3, pixels);
+    CaptureSink sink;
+    expect(ImagePipeline::run(source, 6, 3, sink) && sink.pixels == pixels, "same size passes rows through");
+  }
+}
+
+void testDitherers() {
+  std::vector<uint8_t> ramp(256);
+  for (int i = 0; i < 256; i++) ramp[i] = static_cast<uint8_t>(i);
+  std::vector<uint8_t> levels(256);
+
+  ThresholdRowDitherer threshold;
+  threshold.ditherRow(ramp.data(), levels.data(), 256, 0);
+  expect(levels[0] == 0 && levels[84] == 0 && levels[85] == 1 && levels[170] == 2 && levels[255] == 3,
+         "threshold splits gray into four even bands");
+
+  BayerRowDitherer bayer;
+  const std::vector<uint8_t> black(64, 0), white(64, 255), mid(64, 128);
+  bayer.ditherRow(black.data(), levels.data(), 64, 0);
+  bool allBlack = true;
+  for (int x = 0; x < 64; x++) allBlack &= levels[x] == 0;
+  bayer.ditherRow(white.data(), levels.data(), 64, 0);
+  bool allWhite = true;
+  for (int x = 0; x < 64; x++) allWhite &= levels[x] == 3;
+  expect(allBlack && allWhite, "Bayer keeps black and white solid");
+
+  std::vector<uint8_t> area;
+  for (int y = 0; y < 4; y++) {
+    bayer.ditherRow(mid.data(), levels.data(), 64, y);
+    area.insert(area.end(), levels.begin(), levels.begin() + 64);
+  }
+  const double bayerMean = meanLevel(area, 0, area.size());
+  expect(bayerMean > 1.2 && bayerMean < 1.8, "Bayer mid gray averages to mid level, got " + std::to_string(bayerMean));
+
+  Atkinson1BitRowDitherer atkinson(64);
+  area.clear();
+  for (int y = 0; y < 32; y++) {
+    atkinson.ditherRow(mid.data(), levels.data(), 64, y);
+    area.insert(area.end(), levels.begin(), levels.begin() + 64);
+  }
+  const double atkinsonMean = meanLevel(area, 0, area.size());
+  expect(atkinsonMean > 0.35 && atkinsonMean < 0.65,
+         "1-bit Atkinson mid gray is half ink, got " + std::to_string(atkinsonMean));
+}
+
+// A cover-sized gradient saved as PNG, BMP and JPEG converts to the same 2-bit cover
+void testFormatsAgree(const std::string& dir) {
+  constexpr int W = 96, H = 64;
+  std::vector<uint8_t> rgb(W * H * 3);
+  for (int y = 0; y < H; y++) {
+    for (int x = 0; x < W; x++) {
+      uint8_t* p = &rgb[(y * W + x) * 3];
+      p[0] = static_cast<uint8_t>(255 * x / (W - 1));
+      p[1] = static_cast<uint8_t>(255 * y / (H - 1));
+      p[2] = static_cast<uint8_t>(x < W / 2 ? 200 : 40);
+    }
+  }
+  const std::string pngPath = dir + "/image_pipeline_test.png";
+  const std::string bmpPath = dir + "/image_pipeline_test.bmp";
+  const std::string jpgPath = dir + "/image_pipeline_test.jpg";
+  expect(writePng(pngPath, rgb, W, H, 3), "write PNG");
+  expect(writeBmp24(bmpPath, rgb, W, H), "write BMP");
+  if (!writeJpeg(jpgPath, rgb.data(), W, H, JpegSampling::H1V1, 95)) {
+    expect(false, "write JPEG to " + dir);
+    return;
+  }
+
+  constexpr int OUT_W = 48, OUT_H = 32;
+  std::vector<uint8_t> levels[3];
+  const std::string paths[3] = {pngPath, bmpPath, jpgPath};
+  for (int i = 0; i < 3; i++) {
+    FsFile file;
+    if (!file.open(paths[i].c_str())) {
+      expect(false, "open " + paths[i]);
+      continue;
+    }
+    BufferPrint out;
+    bool ok = false;
+    if (i == 0) {
+      PngRowSource source(file);
+      ok = source.open() && ImagePipeline::toBmp(source, out, OUT_W, OUT_H, false, false);
+    } else if (i == 1) {
+      BmpRowSource source(file);
+      ok = source.open() && ImagePipeline::toBmp(source, out, OUT_W, OUT_H, false, false);
+    } else {
+      JpegRowSource source(file);
+      ok = source.open() && ImagePipeline::toBmp(source, out, OUT_W, OUT_H, false, false);
+    }
+    file.close();
+    levels[i] = bmpLevels(out.data, OUT_W, OUT_H);
+    expect(ok && levels[i].size() == OUT_W * OUT_H, "convert " + paths[i] + " to a 48x32 2-bit BMP");
+  }
+  expect(levels[0] == levels[1], "PNG and BMP of the same pixels give the same cover");
+
+  // JPEG loses a little, so compare tone over 8x8 tiles rather than pixel for pixel
+  if (levels[2].size() == levels[1].size()) {
+    double worst = 0;
+    for (int ty = 0; ty < OUT_H; ty += 8) {
+      for (int tx = 0; tx < OUT_W; tx += 8) {
+        int sumJpeg = 0, sumBmp = 0;
+        for (int y = ty; y < ty + 8; y++) {
+          for (int x = tx; x < tx + 8; x++) {
+            sumJpeg += levels[2][y * OUT_W + x];
+            sumBmp += levels[1][y * OUT_W + x];
+          }
+        }
+        worst = std::max(worst, std::abs(sumJpeg - sumBmp) / 64.0);
+      }
+    }
+    expect(worst < 0.25, "JPEG cover tone matches the BMP, worst tile off by " + std::to_string(worst) + " levels");
+  }
+
+  remove(pngPath.c_str());
+  remove(bmpPath.c_str());
+  remove(jpgPath.c_str());
+}
+
+// Transparent pixels show the page (white), opaque ones their own color
+void testPngAlpha(const std::string& dir) {
+  constexpr int W = 8, H = 2;
+  std::vector<uint8_t> rgba(W * H * 4, 0);
+  for (int x = 0; x < W; x++) {
+    uint8_t* opaque = &rgba[x * 4];
+    opaque[3] = 255;  // Black, opaque
+    uint8_t* half = &rgba[(W + x) * 4];
+    half[3] = x < W / 2 ? 0 : 128;  // Black, transparent then half covered
+  }
+  const std::string path = dir + "/image_pipeline_alpha.png";
+  expect(writePng(path, rgba, W, H, 4), "write RGBA PNG");
+
+  FsFile file;
+  if (!file.open(path.c_str())) {
+    expect(false, "open " + path);
+    return;
+  }
+  PngRowSource source(file);
+  CaptureSink sink;
+  expect(source.open() && ImagePipeline::run(source, W, H, sink), "decode RGBA PNG");
+  file.close();
+  remove(path.c_str());
+  if (sink.rows != H) return;
+
+  expect(sink.at(0, 0) == 0, "opaque black stays black");
+  expect(sink.at(0, 1) == 255, "transparent pixels are white");
+  expect(sink.at(W - 1, 1) > 110 && sink.at(W - 1, 1) < 145,
+         "half alpha black is mid gray, got " + std::to_string(sink.at(W - 1, 1)));
+}
+// IHDR bit depths and color types outside the PNG specification are rejected before a scanline is sized from them
+void testPngHeaders(const std::string& dir) {
+  constexpr int W = 16, H = 4;
+  const std::string path = dir + "/image_pipeline_ihdr.png";
+  if (!writePng(path, std::vector<uint8_t>(W * H * 3, 128), W, H, 3)) {
+    expect(false, "write IHDR test PNG to " + dir);
+    return;
+  }
+  const std::vector<uint8_t> png = readFile(path);
+  remove(path.c_str());
+  {
+    MemoryInput input(png);
+    PngRowSource source(input);
+    expect(source.open(), "an 8-bit RGB IHDR opens");
+  }
+
+  const struct {
+    uint8_t depth;
+    uint8_t color;
+    const char* name;
+  } corrupt[] = {{0, 0, "gray at depth 0"},
+                 {4, 2, "RGB at depth 4"},
+                 {2, 4, "gray and alpha at depth 2"},
+                 {1, 6, "RGBA at depth 1"},
+                 {16, 3, "palette at depth 16"},
+                 {8, 5, "color type 5"}};
+  for (const auto& header : corrupt) {
+    // Signature (8), IHDR length and type (8), width and height (8), then bit depth and color type
+    std::vector<uint8_t> data = png;
+    data[24] = header.depth;
+    data[25] = header.color;
+    MemoryInput input(data);
+    PngRowSource source(input);
+    expect(!source.open(), std::string("IHDR with ") + header.name + " is rejected");
+  }
+}
+
+// Entries read back through ZipFile::EntryReader match what went in, stored or deflated, and images decoded from the
+// entry give the same cover as from the extracted file
+void testZipEntries(const std::string& dir) {
+  constexpr int W = 160, H = 120;
+  std::vector<uint8_t> rgb(W * H * 3);
+  for (int y = 0; y < H; y++) {
+    for (int x = 0; x < W; x++) {
+      uint8_t* p = &rgb[(y * W + x) * 3];
+      p[0] = static_cast<uint8_t>((x * 7 + y * 3) & 0xFF);
+      p[1] = static_cast<uint8_t>(255 * y / (H - 1));
+      p[2] = static_cast<uint8_t>((x / 8 + y / 8) % 2 ? 220 : 30);
+    }
+  }
+  const std::string pngPath = dir + "/image_pipeline_zip.png";
+  const std::string jpgPath = dir + "/image_pipeline_zip.jpg";
+  const std::string zipPath = dir + "/image_pipeline_test.zip";
+  if (!writePng(pngPath, rgb, W, H, 3) || !writeJpeg(jpgPath, rgb.data(), W, H, JpegSampling::H2V2, 90)) {
+    expect(false, "write zip test images to " + dir);
+    return;
+  }
+  const std::vector<uint8_t> png = readFile(pngPath);
+  const std::vector<uint8_t> jpg = readFile(jpgPath);
+  // Longer than the 32 KB inflate dictionary, so the reader's output wraps around it
+  std::vector<uint8_t> text;
+  for (int i = 0; text.size() < 100000; i++) {
+    const std::string line = "line " + std::to_string(i * 7919 % 1000) + " of the test entry\n";
+    text.insert(text.end(), line.begin(), line.end());
+  }
+
+  mz_zip_archive archive = {};
+  bool built = mz_zip_writer_init_heap(&archive, 0, 0);
+  built = built && mz_zip_writer_add_mem(&archive, "OEBPS/cover.jpg", jpg.data(), jpg.size(), MZ_DEFAULT_LEVEL);
+  built = built && mz_zip_writer_add_mem(&archive, "OEBPS/cover.png", png.data(), png.size(), MZ_NO_COMPRESSION);
+  built = built && mz_zip_writer_add_mem(&archive, "OEBPS/text.txt", text.data(), text.size(), MZ_DEFAULT_LEVEL);
+  void* zipData = nullptr;
+  size_t zipSize = 0;
+  built = built && mz_zip_writer_finalize_heap_archive(&archive, &zipData, &zipSize);
+  built = built && writeFile(zipPath, zipData, zipSize);
+  mz_zip_writer_end(&archive);
+  if (!built) {
+    expect(false, "build test zip");
+    return;
+  }
+
+  ZipFile zip(zipPath);
+  {
+    // Odd read sizes and skips across the dictionary wrap
+    ZipFile::EntryReader entry(zip);
+    expect(entry.open("OEBPS/text.txt") && entry.getSize() == text.size(), "open deflated text entry");
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> buf(4096);
+    size_t at = 0;
+    for (int i = 0; at < text.size(); i++) {
+      if (i % 5 == 4) {
+        const size_t skip = std::min<size_t>(333, text.size() - at);
+        if (!entry.skip(skip)) break;
+        out.insert(out.end(), text.begin() + at, text.begin() + at + skip);
+        at += skip;
+        continue;
+      }
+      const int count = entry.read(buf.data(), 1 + (i * 617) % 4000);
+      if (count <= 0) break;
+      out.insert(out.end(), buf.begin(), buf.begin() + count);
+      at += count;
+    }
+    expect(out == text, "deflated entry reads back byte for byte");
+    expect(entry.read(buf.data(), buf.size()) == 0, "reading past the end of an entry returns 0");
+  }
+  {
+    ZipFile::EntryReader entry(zip);
+    expect(!entry.open("OEBPS/missing.jpg"), "a missing entry does not open");
+  }
+
+  const std::pair<std::string, std::string> images[] = {{"OEBPS/cover.jpg", jpgPath}, {"OEBPS/cover.png", pngPath}};
+  for (const auto& [name, path] : images) {
+    const bool isPng = path == pngPath;
+    BufferPrint fromFile;
+    BufferPrint fromZip;
+    FsFile file;
+    if (file.open(path.c_str())) {
+      if (isPng) {
+        PngRowSource source(file);
+        expect(source.open() && ImagePipeline::toBmp(source, fromFile, 60, 80, false, true), "convert " + path);
+      } else {
+        JpegRowSource source(file);
+        expect(source.open() && ImagePipeline::toBmp(source, fromFile, 60, 80, false, true), "convert " + path);
+      }
+      file.close();
+    }
+    ZipFile::EntryReader entry(zip);
+    if (!entry.open(name.c_str())) {
+      expect(false, "open " + name);
+      continue;
+    }
+    ZipInput input(entry);
+    if (isPng) {
+      PngRowSource source(input);
+      expect(source.open() && ImagePipeline::toBmp(source, fromZip, 60, 80, false, true), "convert " + name);
+    } else {
+      JpegRowSource source(input);
+      expect(source.open() && ImagePipeline::toBmp(source, fromZip, 60, 80, false, true), "convert " + name);
+    }
+    expect(!fromZip.data.empty() && fromZip.data == fromFile.data, name + " from the zip matches the extracted file");
+  }
+
+  remove(pngPath.c_str());
+  remove(jpgPath.c_str());
+  remove(zipPath.c_str());
+}
+bool probe(const std::vector<uint8_t>& data, int& width, int& height, ImageProbe::Format& format,
+           size_t* bytesRead = nullptr) {
+  MemoryInput input(data);
+  const bool ok = ImageProbe::readSize(input, width, height, &format);
+  if (bytesRead) *bytesRead = input.position;
+  return ok;
+}
+
+// Sizes come from the headers, and only the header is read
+void testProbe(const std::string& dir) {
+  using Format = ImageProbe::Format;
+  constexpr int W = 123, H = 45;
+  std::vector<uint8_t> rgb(W * H * 3);
+  for (size_t i = 0; i < rgb.size(); i++) rgb[i] = static_cast<uint8_t>(i * 31 % 251);
+  const std::string pngPath = dir + "/image_pipeline_probe.png";
+  const std::string jpgPath = dir + "/image_pipeline_probe.jpg";
+  const std::string bmpPath = dir + "/image_pipeline_probe.bmp";
+  if (!writePng(pngPath, rgb, W, H, 3) || !writeJpeg(jpgPath, rgb.data(), W, H, JpegSampling::H2V2, 90) ||
+      !writeBmp24(bmpPath, rgb, W, H)) {
+    expect(false, "write probe test images to " + dir);
+    return;
+  }
+  const std::vector<uint8_t> png = readFile(pngPath);
+  const std::vector<uint8_t> jpg = readFile(jpgPath);
+  std::vector<uint8_t> bmp = readFile(bmpPath);
+  remove(pngPath.c_str());
+  remove(jpgPath.c_str());
+  remove(bmpPath.c_str());
+
+  int width = 0, height = 0;
+  Format format = Format::Unknown;
+  size_t bytesRead = 0;
+  expect(probe(png, width, height, format, &bytesRead) && format == Format::Png && width == W && height == H,
+         "PNG size from IHDR");
+  expect(bytesRead == 29, "PNG probe reads the signature and IHDR only, read " + std::to_string(bytesRead));
+  expect(probe(jpg, width, height, format, &bytesRead) && format == Format::Jpeg && width == W && height == H,
+         "JPEG size from SOF");
+  expect(bytesRead < jpg.size() / 2, "JPEG probe stops at the frame header, read " + std::to_string(bytesRead));
+  expect(probe(bmp, width, height, format) && format == Format::Bmp && width == W && height == H,
+         "bottom-up BMP size");
+  for (int i = 0; i < 4; i++) bmp[22 + i] = static_cast<uint8_t>(static_cast<uint32_t>(-H) >> (8 * i));
+  expect(probe(bmp, width, height, format) && width == W && height == H, "top-down BMP size");
+
+  // Segments before the frame header (EXIF, a thumbnail) are skipped, not read, and fill bytes are allowed
+  std::vector<uint8_t> exif = {0xFF, 0xD8, 0xFF, 0xFF, 0xE1, 0x40, 0x00};
+  exif.resize(exif.size() + 0x4000 - 2, 0xAB);
+  exif.insert(exif.end(), jpg.begin() + 2, jpg.end());
+  expect(probe(exif, width, height, format) && width == W && height == H, "JPEG size after a 16 KB APP1 segment");
+
+  const std::vector<uint8_t> gif = {'G', 'I', 'F', '8', '9', 'a', 0x2C, 0x01, 0xC8, 0x00, 0xF7, 0x00, 0x00};
+  expect(probe(gif, width, height, format) && format == Format::Gif && width == 300 && height == 200,
+         "GIF logical screen size");
+  std::vector<uint8_t> os2Bmp(26, 0);
+  os2Bmp[0] = 'B';
+  os2Bmp[1] = 'M';
+  os2Bmp[14] = 12;
+  os2Bmp[18] = 0x20;
+  os2Bmp[19] = 0x03;
+  os2Bmp[20] = 0xE0;
+  os2Bmp[21] = 0x01;
+  expect(probe(os2Bmp, width, height, format) && width == 800 && height == 480, "OS/2 BMP core header size");
+
+  // Frames picojpeg does not decode have no size, so the image falls back to its alt text instead of a blank box: a
+  // baseline stream marked progressive (SOF2), rejected where a real progressive file is, and a CMYK frame
+  std::vector<uint8_t> progressive = jpg;
+  std::vector<uint8_t> cmyk = jpg;
+  for (size_t at = 2; at + 4 <= jpg.size() && jpg[at] == 0xFF; at += 2 + (jpg[at + 2] << 8 | jpg[at + 3])) {
+    if (jpg[at + 1] == 0xC0) {
+      progressive[at + 1] = 0xC2;
+      cmyk[at + 9] = 4;  // Marker (2), length (2), precision (1), height (2), width (2), components
+      break;
+    }
+  }
+  expect(progressive != jpg && !probe(progressive, width, height, format), "a progressive JPEG has no size");
+  expect(cmyk != jpg && !probe(cmyk, width, height, format), "a 4-component JPEG has no size");
+  {
+    MemoryInput input(progressive);
+    JpegRowSource source(input);
+    expect(!source.open(), "the decoder rejects the progressive JPEG as well");
+  }
+
+  // Likewise PNGs PngRowSource does not decode: interlaced, or a bit depth the color type does not allow
+  std::vector<uint8_t> interlaced = png;
+  interlaced[28] = 1;
+  expect(!probe(interlaced, width, height, format), "an interlaced PNG has no size");
+  std::vector<uint8_t> lowDepthRgb = png;
+  lowDepthRgb[24] = 4;
+  expect(!probe(lowDepthRgb, width, height, format), "a 4-bit RGB PNG has no size");
+
+  const std::vector<uint8_t> truncated(jpg.begin(), jpg.begin() + 20);
+  expect(!probe(truncated, width, height, format), "a JPEG cut off before its frame header has no size");
+  const std::vector<uint8_t> text = {'<', 's', 'v', 'g', ' ', 'w', 'i', 'd', 't', 'h', '=', '"', '1', '"'};
+  expect(!probe(text, width, height, format), "an unknown format has no size");
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::string dir = argc > 1 ? argv[1] : "/tmp";
+  SDCardManager::getInstance().setRoot("");  // Zip paths are host paths
+  testAreaScaler();
+  testDitherers();
+  testFormatsAgree(dir);
+  testPngAlpha(dir);
+  testPngHeaders(dir);
+  testZipEntries(dir);
+  testProbe(dir);
+
+  if (failures) {
+    std::cerr << failures << " failure(s)\n";
+    return 1;
+  }
+  std::cout << "All image pipeline tests passed\n";
+  return 0;
+}
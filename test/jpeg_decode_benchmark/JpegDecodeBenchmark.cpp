@@ -0,0 +1,223 @@
+#include <HalStorage.h>
+#include <HeapTracking.h>
+#include <HostTest.h>
+#include <JpegToBmpConverter.h>
+#include <JpegWriter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Usage: JpegDecodeBenchmark [--quick] [--keep DIR]
+// Encodes large synthetic book covers in the JPEG layouts picojpeg decodes, converts each to the reader's cover BMP
+// (2-bit, 480x800, cropped) and home screen thumbnail (1-bit), once decoding at full resolution and once letting the
+// converter decode at 1/2, 1/4 or 1/8 scale, and prints the time and peak heap of each conversion. The two outputs
+// are compared tile by tile to show the reduced decode still produces the same picture. --keep writes the covers to
+// DIR, --quick converts each once instead of taking the best of five. Peak heap is measured on glibc hosts only.
+
+namespace {
+constexpr int THUMB_HEIGHT = 400;
+constexpr int TILE = 16;
+// Mean gray difference between the full and reduced outputs, over 16x16 tiles, above which the reduced decode is wrong
+constexpr double MAX_TILE_DIFFERENCE = 12.0;
+
+struct Cover {
+  const char* name;
+  int width;
+  int height;
+  JpegSampling sampling;
+};
+
+// A cover-like picture: a vertical colour gradient, a few filled shapes, fine texture and a block of "title" bars
+std::vector<uint8_t> makeCover(const Cover& cover) {
+  const int channels = cover.sampling == JpegSampling::Grayscale ? 1 : 3;
+  std::vector<uint8_t> pixels(static_cast<size_t>(cover.width) * cover.height * channels);
+  std::mt19937 rng(cover.width * 31 + cover.height);
+  std::uniform_int_distribution<int> noise(-4, 4);
+  const int cx = cover.width / 2, cy = cover.height * 2 / 5, radius = cover.width / 3;
+  for (int y = 0; y < cover.height; y++) {
+    for (int x = 0; x < cover.width; x++) {
+      int r = 40 + 160 * y / cover.height, g = 60 + 120 * x / cover.width, b = 200 - 150 * y / cover.height;
+      const int dx = x - cx, dy = y - cy;
+      if (dx * dx + dy * dy < radius * radius) {
+        r = 230, g = 190, b = 60;
+        if ((x / 6 + y / 6) % 2 == 0) g -= 40;  // Checker texture inside the disc
+      }
+      const bool titleRow = y > cover.height * 3 / 4 && y < cover.height * 17 / 20 && (y / (cover.height / 60)) % 2;
+      if (titleRow && x > cover.width / 8 && x < cover.width * 7 / 8 && (x / (cover.width / 40)) % 3 != 2) {
+        r = g = b = 20;
+      }
+      const int n = noise(rng);
+      uint8_t* p = &pixels[(static_cast<size_t>(y) * cover.width + x) * channels];
+      if (channels == 1) {
+        p[0] = static_cast<uint8_t>(std::clamp((r * 77 + g * 150 + b * 29) / 256 + n, 0, 255));
+      } else {
+        p[0] = static_cast<uint8_t>(std::clamp(r + n, 0, 255));
+        p[1] = static_cast<uint8_t>(std::clamp(g + n, 0, 255));
+        p[2] = static_cast<uint8_t>(std::clamp(b + n, 0, 255));
+      }
+    }
+  }
+  return pixels;
+}
+
+struct Conversion {
+  bool ok = false;
+  double ms = 0;
+  size_t peakHeap = 0;
+  std::vector<uint8_t> bmp;
+};
+
+Conversion convert(const std::string& path, const bool thumbnail, const int runs) {
+  Conversion result;
+  result.ms = 1e30;
+  for (int run = 0; run < runs; run++) {
+    FsFile file;
+    if (!file.open(path.c_str())) return result;
+    BufferPrint out(1 << 20);
+    const size_t before = heapInUse.load();
+    resetPeak();
+    const auto start = std::chrono::steady_clock::now();
+    result.ok = thumbnail ? JpegToBmpConverter::jpegFileTo1BitBmpStreamWithSize(file, out, THUMB_HEIGHT * 0.6,
+                                                                                 THUMB_HEIGHT)
+                          : JpegToBmpConverter::jpegFileToBmpStream(file, out);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.peakHeap = peakSinceReset(before);
+    result.ms = std::min(result.ms, ms);
+    result.bmp = std::move(out.data);
+    if (!result.ok) return result;
+  }
+  return result;
+}
+
+// Gray levels of a 1- or 2-bit BMP as the converter writes them (palette index * 255 / max index), top row first
+bool readLevels(const std::vector<uint8_t>& bmp, int& width, int& height, std::vector<uint8_t>& levels) {
+  if (bmp.size() < 54 || bmp[0] != 'B' || bmp[1] != 'M') return false;
+  auto read32 = [&bmp](const size_t at) {
+    return static_cast<int32_t>(bmp[at] | bmp[at + 1] << 8 | bmp[at + 2] << 16 |
+                                static_cast<uint32_t>(bmp[at + 3]) << 24);
+  };
+  const int offset = read32(10);
+  width = read32(18);
+  const int rawHeight = read32(22);
+  height = std::abs(rawHeight);
+  const int bpp = bmp[28];
+  if (bpp != 1 && bpp != 2) return false;
+  const int stride = (width * bpp + 31) / 32 * 4;
+  if (bmp.size() < static_cast<size_t>(offset) + static_cast<size_t>(stride) * height) return false;
+  levels.resize(static_cast<size_t>(width) * height);
+  const int maxIndex = (1 << bpp) - 1;
+  for (int y = 0; y < height; y++) {
+    const uint8_t* row = &bmp[offset + static_cast<size_t>(rawHeight < 0 ? y : height - 1 - y) * stride];
+    for (int x = 0; x < width; x++) {
+      const int bit = x * bpp;
+      const int index = (row[bit / 8] >> (8 - bpp - bit % 8)) & maxIndex;
+      levels[static_cast<size_t>(y) * width + x] = static_cast<uint8_t>(index * 255 / maxIndex);
+    }
+  }
+  return true;
+}
+
+// Mean absolute difference of 16x16 tile averages; dithering patterns differ pixel by pixel but not in tone
+double tileDifference(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+  int widthA, heightA, widthB, heightB;
+  std::vector<uint8_t> levelsA, levelsB;
+  if (!readLevels(a, widthA, heightA, levelsA) || !readLevels(b, widthB, heightB, levelsB) || widthA != widthB ||
+      heightA != heightB) {
+    return 255.0;
+  }
+  double total = 0;
+  int tiles = 0;
+  for (int ty = 0; ty + TILE <= heightA; ty += TILE) {
+    for (int tx = 0; tx + TILE <= widthA; tx += TILE) {
+      int sumA = 0, sumB = 0;
+      for (int y = ty; y < ty + TILE; y++) {
+        for (int x = tx; x < tx + TILE; x++) {
+          sumA += levelsA[static_cast<size_t>(y) * widthA + x];
+          sumB += levelsB[static_cast<size_t>(y) * widthA + x];
+        }
+      }
+      total += std::abs(sumA - sumB) / static_cast<double>(TILE * TILE);
+      tiles++;
+    }
+  }
+  return tiles ? total / tiles : 0.0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool quick = false;
+  std::string keepDir;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--quick") {
+      quick = true;
+    } else if (arg == "--keep" && i + 1 < argc) {
+      keepDir = argv[++i];
+    } else {
+      fprintf(stderr, "Usage: %s [--quick] [--keep DIR]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  const Cover covers[] = {
+      {"cover_1600x2400_h2v2", 1600, 2400, JpegSampling::H2V2},
+      {"cover_1200x1800_h1v1", 1200, 1800, JpegSampling::H1V1},
+      {"cover_2000x3000_gray", 2000, 3000, JpegSampling::Grayscale},
+      {"cover_1400x2100_h2v1", 1400, 2100, JpegSampling::H2V1},
+      {"cover_800x1200_h2v2", 800, 1200, JpegSampling::H2V2},
+  };
+  const int runs = quick ? 1 : 5;
+  int failures = 0;
+
+  printf("%-22s %-6s %10s %10s %7s %11s %11s %6s\n", "image", "output", "full ms", "scaled ms", "speedup",
+         "full heap", "scaled heap", "diff");
+  for (const Cover& cover : covers) {
+    const std::string dir = keepDir.empty() ? "/tmp" : keepDir;
+    const std::string path = dir + "/" + cover.name + ".jpg";
+    {
+      const std::vector<uint8_t> pixels = makeCover(cover);
+      if (!writeJpeg(path, pixels.data(), cover.width, cover.height, cover.sampling)) {
+        fprintf(stderr, "FAIL: cannot write %s\n", path.c_str());
+        return 1;
+      }
+    }
+
+    for (const bool thumbnail : {false, true}) {
+      JpegToBmpConverter::setMaxDecodeReduction(1);
+      const Conversion full = convert(path, thumbnail, runs);
+      JpegToBmpConverter::setMaxDecodeReduction(8);
+      const Conversion scaled = convert(path, thumbnail, runs);
+      if (!full.ok || !scaled.ok) {
+        fprintf(stderr, "FAIL: %s %s conversion failed\n", cover.name, thumbnail ? "thumb" : "cover");
+        failures++;
+        continue;
+      }
+      const double difference = tileDifference(full.bmp, scaled.bmp);
+      if (difference > MAX_TILE_DIFFERENCE) {
+        fprintf(stderr, "FAIL: %s %s differs from the full resolution decode by %.1f\n", cover.name,
+                thumbnail ? "thumb" : "cover", difference);
+        failures++;
+      }
+      char fullHeap[24] = "-", scaledHeap[24] = "-";
+      if (HEAP_MEASURED) {
+        snprintf(fullHeap, sizeof(fullHeap), "%zu", full.peakHeap);
+        snprintf(scaledHeap, sizeof(scaledHeap), "%zu", scaled.peakHeap);
+      }
+      printf("%-22s %-6s %10.1f %10.1f %6.1fx %11s %11s %6.1f\n", cover.name, thumbnail ? "thumb" : "cover", full.ms,
+             scaled.ms, full.ms / scaled.ms, fullHeap, scaledHeap, difference);
+    }
+    if (keepDir.empty()) remove(path.c_str());
+  }
+
+  if (failures) {
+    fprintf(stderr, "%d conversion(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include <Arduino.h>
+#include <Logging.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Checks the deferred LOG_* backend against what printf would have written at the call site: the conversions the
+// tree uses, string arguments that die before the flush, a buffer that fills up while deferred, and per call site
+// rate limiting. The host serial writes to stderr, which is redirected to a file and read back.
+
+namespace {
+int failures = 0;
+std::string capturePath;
+
+void expect(const bool condition, const std::string& message) {
+  if (!condition) {
+    std::cout << "FAIL: " << message << "\n";
+    failures++;
+  }
+}
+
+// Everything written to serial since the last call, timestamps stripped
+std::string takeOutput() {
+  fflush(stderr);
+  std::ifstream file(capturePath);
+  std::stringstream text;
+  text << file.rdbuf();
+  freopen(capturePath.c_str(), "w", stderr);
+
+  std::string stripped;
+  std::string line;
+  while (std::getline(text, line)) {
+    const size_t close = line.find("] ");
+    stripped += (line[0] == '[' && close != std::string::npos ? line.substr(close + 2) : line) + "\n";
+  }
+  return stripped;
+}
+
+void expectOutput(const std::string& expected, const std::string& message) {
+  const std::string output = takeOutput();
+  expect(output == expected, message + "\n  expected: " + expected + "  got:      " + output);
+}
+
+void logLine(const int i) { LOG_INF("TST", "line %d", i); }
+
+enum Mode { MODE_A, MODE_B };
+}  // namespace
+
+int main() {
+  capturePath = "/tmp/crosspoint_logging_test.txt";
+  freopen(capturePath.c_str(), "w", stderr);
+
+  // Conversions used across the tree, printed as printf would
+  LOG_ERR("TST", "int %d, unsigned %u, size %zu, long %lu, 64 %llu", -42, 42u, static_cast<size_t>(7), 123456ul,
+          18446744073709551615ull);
+  expectOutput("[ERR] [TST] int -42, unsigned 42, size 7, long 123456, 64 18446744073709551615\n", "integers");
+  LOG_INF("TST", "%.2f%% %.1f %f %08X %04X %c %5d|%-5d|", 12.345, 0.25f, 1.5, 0xBEEFu, 0x1F, 'x', 42, 7);
+  expectOutput("[INF] [TST] 12.35% 0.2 1.500000 0000BEEF 001F x    42|7    |\n", "floats, padding and hex");
+  LOG_DBG("TST", "mode %d, flag %d, negative as unsigned %u", MODE_B, true, -1);
+  expectOutput("[DBG] [TST] mode 1, flag 1, negative as unsigned 4294967295\n", "enums, bools and sign changes");
+  LOG_DBG("TST", "missing %d and %s");
+  expectOutput("[DBG] [TST] missing ? and ?\n", "missing arguments");
+  const char* nullString = nullptr;
+  LOG_DBG("TST", "null %s, empty '%s'", nullString, "");
+  expectOutput("[DBG] [TST] null (null), empty ''\n", "null and empty strings");
+
+  // Deferred: nothing is written until the flush, and strings are copied at the call
+  logSetDeferred(true);
+  {
+    const std::string temporary = "chapter" + std::to_string(3) + ".xhtml";
+    LOG_INF("TST", "Parsing %s", temporary.c_str());
+  }
+  expectOutput("", "deferred line waits for the flush");
+  logFlush();
+  expectOutput("[INF] [TST] Parsing chapter3.xhtml\n", "string argument copied at the call");
+
+  const std::string longName(300, 'a');
+  LOG_INF("TST", "%s|", longName.c_str());
+  logFlush();
+  expectOutput("[INF] [TST] " + std::string(logging::MAX_STRING_ARG, 'a') + "|\n", "long strings are truncated");
+
+  // A full buffer is written out by the caller instead of dropping lines; distinct call sites are limited separately
+  std::string expected;
+  for (int i = 0; i < 3 * LOG_SITE_BURST; i++) {
+    if (i % 3 == 0) {
+      LOG_INF("TST", "first site %d with a longer message to fill the buffer faster %s", i, longName.c_str());
+      expected += "[INF] [TST] first site " + std::to_string(i) + " with a longer message to fill the buffer faster " +
+                  std::string(logging::MAX_STRING_ARG, 'a') + "\n";
+    } else {
+      LOG_INF("TST", "second site %d", i);
+      if (i / 3 * 2 + i % 3 - 1 < LOG_SITE_BURST) expected += "[INF] [TST] second site " + std::to_string(i) + "\n";
+    }
+  }
+  logFlush();
+  expectOutput(expected, "lines survive a full buffer and keep their order");
+  logSetDeferred(false);
+
+  // One call site in a loop: a burst gets through, the rest are counted until the window rolls over
+  for (int i = 0; i < 1000; i++) logLine(i);
+  std::string output = takeOutput();
+  expect(output.find("line " + std::to_string(LOG_SITE_BURST - 1) + "\n") != std::string::npos &&
+             output.find("line " + std::to_string(LOG_SITE_BURST) + "\n") == std::string::npos,
+         "burst of " + std::to_string(LOG_SITE_BURST) + " lines gets through");
+  delay(LOG_SITE_WINDOW_MS + 10);
+  logLine(1000);
+  expectOutput("[INF] [TST] (" + std::to_string(1000 - LOG_SITE_BURST) +
+                   " repeats suppressed)\n[INF] [TST] line 1000\n",
+               "suppressed count reported with the next line");
+
+  fclose(stderr);
+  remove(capturePath.c_str());
+  if (failures) {
+    std::cout << failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "Logging: all checks passed\n";
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HostTest.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "lib/EpdFont/builtinFonts/ubuntu_10_regular.h"
+
+// Draws the same scenes straight to the panel and through the logical back buffer and checks that the panel frame
+// buffers are identical in every orientation, across grayscale store/restore and across orientation switches.
+
+namespace {
+constexpr int FONT_ID = 1;
+const uint8_t kIcon[32 * 32 / 8] = {
+    0x00, 0x00, 0x00, 0x00, 0x7F, 0xFF, 0xFF, 0xFE, 0x40, 0x00, 0x00, 0x02, 0x5F, 0xFF, 0xFF, 0xFA,
+    0x50, 0x00, 0x00, 0x0A, 0x57, 0xFF, 0xFF, 0xEA, 0x54, 0x00, 0x00, 0x2A, 0x55, 0xFF, 0xFF, 0xAA,
+};
+
+void drawScene(const GfxRenderer& renderer) {
+  const int w = renderer.getScreenWidth();
+  const int h = renderer.getScreenHeight();
+  renderer.drawText(FONT_ID, 13, 17, "The quick brown fox jumps over the lazy dog");
+  renderer.drawText(FONT_ID, 5, h / 2, "Grüße, Привет!", false);
+  renderer.drawRect(3, 3, w - 6, h - 6, 2, true);
+  renderer.drawLine(0, 0, w - 1, h - 1, true);
+  renderer.drawLine(w - 1, 0, 0, h - 4, 3, true);
+  renderer.fillRect(40, 60, 77, 33, true);
+  renderer.fillRectDither(130, 60, 61, 41, Color::LightGray);
+  renderer.fillRectDither(200, 60, 59, 43, Color::DarkGray);
+  renderer.fillRoundedRect(30, 120, 150, 70, 12, Color::DarkGray);
+  renderer.drawRoundedRect(200, 120, 130, 80, 3, 15, true);
+  const int xs[] = {50, 150, 100, 20};
+  const int ys[] = {250, 270, 340, 300};
+  renderer.fillPolygon(xs, ys, 4, true);
+  renderer.drawIcon(kIcon, 64, 400, 32, 8);
+  renderer.drawImage(kIcon, 240, 500, 32, 8);
+  renderer.drawImage(kIcon, 16, 16, 32, 8);
+  renderer.drawTextRotated90CW(FONT_ID, 20, h - 40, "Rotated", true);
+}
+
+void snapshot(const GfxRenderer& renderer, std::vector<uint8_t>& out) {
+  const uint8_t* fb = renderer.getFrameBuffer();
+  out.assign(fb, fb + HalDisplay::BUFFER_SIZE);
+}
+}  // namespace
+
+int main() {
+  HalDisplay display;
+  EpdFont font(&ubuntu_10_regular);
+  EpdFontFamily family(&font);
+
+  GfxRenderer direct(display);
+  GfxRenderer logical(display);
+  for (GfxRenderer* renderer : {&direct, &logical}) {
+    renderer->begin();
+    renderer->insertFont(FONT_ID, family);
+  }
+  expect(logical.setLogicalBufferEnabled(true), "enable logical buffer");
+
+  const GfxRenderer::Orientation orientations[] = {GfxRenderer::Portrait, GfxRenderer::LandscapeClockwise,
+                                                   GfxRenderer::PortraitInverted,
+                                                   GfxRenderer::LandscapeCounterClockwise};
+  // Both renderers share the display, so each one snapshots the panel right after drawing
+  std::vector<uint8_t> expected, actual;
+
+  for (const auto orientation : orientations) {
+    const std::string name = "orientation " + std::to_string(orientation);
+
+    direct.setOrientation(orientation);
+    direct.clearScreen();
+    drawScene(direct);
+    snapshot(direct, expected);
+
+    logical.setOrientation(orientation);
+    logical.clearScreen();
+    drawScene(logical);
+    snapshot(logical, actual);
+    expect(expected == actual, name + ": scene");
+
+    // Inverting and drawing on top of a stored/restored buffer
+    for (GfxRenderer* renderer : {&direct, &logical}) {
+      renderer->clearScreen();
+      drawScene(*renderer);
+      renderer->invertScreen();
+      renderer->storeBwBuffer();
+      renderer->clearScreen(0x00);
+      renderer->restoreBwBuffer();
+      renderer->fillRect(10, 10, 100, 20, false);
+      snapshot(*renderer, renderer == &direct ? expected : actual);
+    }
+    expect(expected == actual, name + ": invert and store/restore");
+
+    // Switching orientation keeps what has been drawn
+    for (GfxRenderer* renderer : {&direct, &logical}) {
+      renderer->setOrientation(orientation);
+      renderer->clearScreen();
+      renderer->drawText(FONT_ID, 30, 30, "before");
+      renderer->setOrientation(GfxRenderer::Portrait);
+      renderer->drawText(FONT_ID, 30, 60, "portrait overlay");
+      renderer->setOrientation(orientation);
+      renderer->drawText(FONT_ID, 30, 90, "after");
+      snapshot(*renderer, renderer == &direct ? expected : actual);
+    }
+    expect(expected == actual, name + ": orientation switch");
+  }
+
+  // Flush cost for the default orientation
+  logical.setOrientation(GfxRenderer::Portrait);
+  constexpr int kFlushes = 200;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kFlushes; i++) {
+    logical.displayBuffer();
+  }
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  std::cout << "Portrait flush: " << us.count() / kFlushes << " us\n";
+
+  expect(logical.setLogicalBufferEnabled(false), "disable logical buffer");
+  expect(!logical.isLogicalBufferEnabled(), "buffer released");
+
+  if (failures) {
+    std::cerr << failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "Logical buffer: all checks passed\n";
+  return 0;
+}
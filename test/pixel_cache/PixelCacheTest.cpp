@@ -0,0 +1,339 @@
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <HostTest.h>
+#include <ImagePipeline.h>
+#include <SDCardManager.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/Epub/Epub/converters/DitherUtils.h"
+#include "lib/Epub/Epub/converters/FramebufferRowSink.h"
+#include "lib/Epub/Epub/converters/PixelCache.h"
+
+// Usage: PixelCacheTest [DIR]
+// Round-trips rows through the pixel cache's PackBits coder, writes images to .pxc files in DIR (default /tmp) and
+// checks that drawing them back mask by mask with GfxRenderer::drawMaskRow gives the same frame as drawing the 2-bit
+// levels pixel by pixel, in every render mode and orientation, with and without the logical buffer. Also checks that
+// an image taller than the screen drawn a slice at a time matches the whole image, slice by slice and from each
+// slice's cache.
+
+namespace {
+struct Image {
+  int width;
+  int height;
+  std::vector<uint8_t> levels;
+  uint8_t at(const int x, const int y) const { return levels[static_cast<size_t>(y) * width + x]; }
+};
+
+// Diagonal bands of all four levels
+Image bands(const int width, const int height) {
+  Image image{width, height, {}};
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) image.levels.push_back(((x / 6) + (y / 5)) & 3);
+  }
+  return image;
+}
+
+// A line drawing: white with a dark frame and a few gray strokes
+Image lineArt(const int width, const int height) {
+  Image image{width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height, 3)};
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const bool frame = x < 2 || y < 2 || x >= width - 2 || y >= height - 2;
+      if (frame) image.levels[static_cast<size_t>(y) * width + x] = 0;
+      if (x == y || x == width / 2) image.levels[static_cast<size_t>(y) * width + x] = 1 + (y & 1);
+    }
+  }
+  return image;
+}
+
+bool writeCache(const std::string& path, const Image& image) {
+  PixelCache cache;
+  if (!cache.begin(path, image.width, image.height)) return false;
+  for (int y = 0; y < image.height; y++) {
+    if (!cache.writeRow(&image.levels[static_cast<size_t>(y) * image.width])) return false;
+  }
+  return cache.finish();
+}
+
+long fileSize(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) return -1;
+  fseek(file, 0, SEEK_END);
+  const long size = ftell(file);
+  fclose(file);
+  return size;
+}
+
+// What the first render draws: every level through drawPixelWithRenderMode, clipped to the screen
+void drawReference(GfxRenderer& renderer, const Image& image, const int x, const int y) {
+  renderer.withRenderMode([&]<GfxRenderer::RenderMode mode>() {
+    for (int row = 0; row < image.height; row++) {
+      if (y + row < 0 || y + row >= renderer.getScreenHeight()) continue;
+      for (int col = 0; col < image.width; col++) {
+        if (x + col < 0 || x + col >= renderer.getScreenWidth()) continue;
+        drawPixelWithRenderMode<mode>(renderer, x + col, y + row, image.at(col, row));
+      }
+    }
+  });
+}
+
+// What ImageBlock draws from the cache
+bool drawFromCache(GfxRenderer& renderer, const std::string& path, const int x, const int y) {
+  PixelCacheReader cache;
+  if (!cache.open(path)) return false;
+  std::vector<uint8_t> mask(cache.getMaskBytes());
+  const GfxRenderer::RenderMode mode = renderer.getRenderMode();
+  for (int row = 0; row < cache.getHeight(); row++) {
+    bool drawn = false;
+    if (!cache.readRow(mode, mask.data(), drawn)) return false;
+    if (drawn) renderer.drawMaskRow(x, y + row, mask.data(), cache.getWidth(), mode == GfxRenderer::BW);
+  }
+  return true;
+}
+
+void testPackBits() {
+  std::mt19937 rng(11);
+  for (int i = 0; i < 2000; i++) {
+    const int length = 1 + rng() % 300;
+    std::vector<uint8_t> row(length);
+    // Runs of every length around the 3-byte threshold and the 128-byte limit, between literals
+    for (int at = 0; at < length;) {
+      const int runs[] = {1, 2, 3, 4, 127, 128, 129, 200};
+      const int run = std::min(length - at, runs[rng() % std::size(runs)]);
+      const auto value = static_cast<uint8_t>(rng() % 3 ? rng() % 4 : rng());
+      for (int k = 0; k < run; k++) row[at + k] = rng() % 4 ? value : static_cast<uint8_t>(rng());
+      at += run;
+    }
+    std::vector<uint8_t> packed(length + (length + 127) / 128);
+    const size_t packedLength = PixelCache::packRow(row.data(), length, packed.data());
+    std::vector<uint8_t> unpacked(length);
+    if (packedLength > packed.size() ||
+        !PixelCache::unpackRow(packed.data(), packedLength, unpacked.data(), length) || unpacked != row) {
+      expect(false, "PackBits round trip " + std::to_string(i) + " (" + std::to_string(length) + " bytes)");
+      return;
+    }
+  }
+
+  const std::vector<uint8_t> blank(60, 0);
+  uint8_t packed[61];
+  expect(PixelCache::packRow(blank.data(), 60, packed) == 2, "a blank row packs to one run");
+  uint8_t out[60];
+  expect(!PixelCache::unpackRow(packed, 2, out, 59), "unpacking refuses rows that overflow");
+}
+
+void testFiles(const std::string& dir) {
+  const std::string path = dir + "/pixel_cache_test.pxc";
+
+  // A mostly white full-page illustration packs small
+  const Image art = lineArt(800, 480);
+  expect(writeCache(path, art), "write line art cache");
+  const long artSize = fileSize(path);
+  std::cout << "Line art 800x480: " << artSize << " bytes cached (" << 800 * 480 / 4 << " as raw 2-bit)\n";
+  expect(artSize > 0 && artSize < 800 * 480 / 4 / 4, "line art packs to under a quarter of the raw 2-bit size");
+
+  // A cache left unfinished is deleted rather than read back half written
+  {
+    PixelCache cache;
+    expect(cache.begin(path, art.width, art.height), "begin cache");
+    expect(cache.writeRow(art.levels.data()), "write first row");
+  }
+  expect(fileSize(path) < 0, "unfinished cache is removed");
+  {
+    PixelCache cache;
+    expect(cache.begin(path, 4, 2), "begin short cache");
+    const uint8_t row[4] = {0, 1, 2, 3};
+    cache.writeRow(row);
+    expect(!cache.finish() && fileSize(path) < 0, "finish with rows missing removes the cache");
+  }
+
+  // Files of the old layout (no magic) are refused, so the image is decoded again
+  FILE* old = fopen(path.c_str(), "wb");
+  const uint16_t header[2] = {8, 8};
+  fwrite(header, sizeof(header), 1, old);
+  fclose(old);
+  PixelCacheReader reader;
+  expect(!reader.open(path), "old cache layout is refused");
+  std::remove(path.c_str());
+}
+
+// A tall strip of gray: a vertical gradient crossed by diagonal stripes
+class TallRowSource final : public ImageRowSource {
+ public:
+  TallRowSource(const int width, const int height) : width(width), height(height) {}
+  int getWidth() const override { return width; }
+  int getHeight() const override { return height; }
+  bool decode(GrayRowSink& sink) override {
+    if (!sink.begin(width, height)) return false;
+    std::vector<uint8_t> row(width);
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) row[x] = static_cast<uint8_t>(((x + y) / 12) % 2 ? y * 255 / height : 255 - x);
+      rowsDecoded++;
+      if (!sink.writeRow(row.data(), y)) return false;
+    }
+    return true;
+  }
+
+  int rowsDecoded = 0;
+
+ private:
+  int width;
+  int height;
+};
+
+// Keeps every scaled row
+class CaptureSink final : public GrayRowSink {
+ public:
+  bool begin(const int imageWidth, int) override {
+    width = imageWidth;
+    return true;
+  }
+  bool writeRow(const uint8_t* gray, int) override {
+    rows.insert(rows.end(), gray, gray + width);
+    return true;
+  }
+
+  int width = 0;
+  std::vector<uint8_t> rows;
+};
+
+void testSlices(const std::string& dir) {
+  const std::string path = dir + "/pixel_cache_slice.pxc";
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  renderer.begin();
+  renderer.setOrientation(GfxRenderer::Portrait);
+
+  constexpr int SRC_WIDTH = 300, SRC_HEIGHT = 2400;
+  constexpr int WIDTH = 240, HEIGHT = 1920, SLICE = 700;
+  constexpr int X = 20, Y = 50;
+  TallRowSource wholeSource(SRC_WIDTH, SRC_HEIGHT);
+  CaptureSink whole;
+  expect(ImagePipeline::run(wholeSource, WIDTH, HEIGHT, whole), "decode the whole tall image");
+
+  std::vector<uint8_t> expected(HalDisplay::BUFFER_SIZE);
+  for (const GfxRenderer::RenderMode mode : {GfxRenderer::BW, GfxRenderer::GRAYSCALE_LSB, GfxRenderer::GRAYSCALE_MSB}) {
+    renderer.setRenderMode(mode);
+    const uint8_t background = mode == GfxRenderer::BW ? 0xFF : 0x00;
+    for (int sliceY = 0; sliceY < HEIGHT; sliceY += SLICE) {
+      const int sliceHeight = std::min(SLICE, HEIGHT - sliceY);
+      const std::string name = "slice at " + std::to_string(sliceY) + " in mode " + std::to_string(mode);
+
+      // The slice's rows of the whole image, dithered as part of the whole image
+      Image slice{WIDTH, sliceHeight, {}};
+      for (int y = 0; y < sliceHeight; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+          const uint8_t gray = whole.rows[static_cast<size_t>(sliceY + y) * WIDTH + x];
+          slice.levels.push_back(applyBayerDither4Level(gray, x, sliceY + y));
+        }
+      }
+      renderer.clearScreen(background);
+      drawReference(renderer, slice, X, Y);
+      memcpy(expected.data(), renderer.getFrameBuffer(), HalDisplay::BUFFER_SIZE);
+
+      renderer.clearScreen(background);
+      TallRowSource source(SRC_WIDTH, SRC_HEIGHT);
+      BayerRowDitherer bayer;
+      PixelCache cache;
+      expect(cache.begin(path, WIDTH, sliceHeight), name + ": begin cache");
+      FramebufferRowSink sink(renderer, X, Y, bayer, &cache, sliceY, sliceHeight);
+      const bool decoded = ImagePipeline::run(source, WIDTH, HEIGHT, sink) || sink.isComplete();
+      expect(decoded && cache.finish(), name + ": decode and cache");
+      if (sliceY + sliceHeight < HEIGHT) {
+        expect(source.rowsDecoded < SRC_HEIGHT, name + ": decoding stops after the slice");
+      }
+      expect(memcmp(renderer.getFrameBuffer(), expected.data(), HalDisplay::BUFFER_SIZE) == 0,
+             name + ": differs from the whole image");
+
+      renderer.clearScreen(background);
+      PixelCacheReader reader;
+      expect(reader.open(path) && reader.getWidth() == WIDTH && reader.getHeight() == sliceHeight,
+             name + ": cache holds the slice only");
+      expect(drawFromCache(renderer, path, X, Y) &&
+                 memcmp(renderer.getFrameBuffer(), expected.data(), HalDisplay::BUFFER_SIZE) == 0,
+             name + ": cached slice differs from the whole image");
+    }
+  }
+  renderer.setRenderMode(GfxRenderer::BW);
+  std::remove(path.c_str());
+}
+
+void testDrawing(const std::string& dir) {
+  const std::string path = dir + "/pixel_cache_draw.pxc";
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  renderer.begin();
+
+  const std::pair<GfxRenderer::RenderMode, const char*> modes[] = {
+      {GfxRenderer::BW, "bw"}, {GfxRenderer::GRAYSCALE_LSB, "lsb"}, {GfxRenderer::GRAYSCALE_MSB, "msb"}};
+  const std::pair<GfxRenderer::Orientation, const char*> orientations[] = {
+      {GfxRenderer::Portrait, "portrait"},
+      {GfxRenderer::LandscapeClockwise, "landscapeCW"},
+      {GfxRenderer::LandscapeCounterClockwise, "landscapeCCW"}};
+  struct Placement {
+    Image image;
+    int x;
+    int y;
+  };
+  // Every bit offset, an image narrower than a byte, and images cut off at each screen edge
+  std::vector<Placement> placements;
+  for (int x = 16; x < 24; x++) placements.push_back({bands(123, 9), x, 40});
+  placements.push_back({bands(5, 6), 29, 300});
+  placements.push_back({lineArt(90, 40), -13, 100});
+  placements.push_back({bands(70, 20), 440, 10});
+  placements.push_back({bands(61, 30), 100, -7});
+
+  std::vector<uint8_t> expected(HalDisplay::BUFFER_SIZE);
+  for (const bool logical : {false, true}) {
+    renderer.setLogicalBufferEnabled(logical);
+    for (const auto& [orientation, orientationName] : orientations) {
+      renderer.setOrientation(orientation);
+      for (const auto& [mode, modeName] : modes) {
+        renderer.setRenderMode(mode);
+        for (const Placement& placement : placements) {
+          const std::string name = std::string(orientationName) + "/" + modeName + (logical ? "/logical" : "") +
+                                   " at " + std::to_string(placement.x) + "," + std::to_string(placement.y);
+          const uint8_t background = mode == GfxRenderer::BW ? 0xFF : 0x00;
+          renderer.clearScreen(background);
+          drawReference(renderer, placement.image, placement.x, placement.y);
+          memcpy(expected.data(), renderer.getFrameBuffer(), HalDisplay::BUFFER_SIZE);
+
+          renderer.clearScreen(background);
+          if (!writeCache(path, placement.image) || !drawFromCache(renderer, path, placement.x, placement.y)) {
+            expect(false, name + ": cache round trip");
+            continue;
+          }
+          expect(memcmp(renderer.getFrameBuffer(), expected.data(), HalDisplay::BUFFER_SIZE) == 0,
+                 name + ": cached image differs from the first render");
+        }
+      }
+    }
+  }
+  renderer.setLogicalBufferEnabled(false);
+  renderer.setRenderMode(GfxRenderer::BW);
+  std::remove(path.c_str());
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::string dir = argc > 1 ? argv[1] : "/tmp";
+  SDCardManager::getInstance().setRoot("");  // Cache paths are host paths
+  testPackBits();
+  testFiles(dir);
+  testDrawing(dir);
+  testSlices(dir);
+
+  if (failures) {
+    std::cerr << failures << " failure(s)\n";
+    return 1;
+  }
+  std::cout << "All pixel cache tests passed\n";
+  return 0;
+}
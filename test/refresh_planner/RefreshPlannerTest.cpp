@@ -0,0 +1,246 @@
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HostTest.h>
+#include <RefreshPlanner.h>
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/EpdFont/builtinFonts/ubuntu_10_regular.h"
+
+// Runs reading sessions through GfxRenderer::displayAutoRefresh on the host panel model and compares the refresh
+// planner with the fixed "half refresh every N pages" counter the readers used before. Ghosting is measured exactly:
+// pixels a fast refresh turned from black to white since the last half refresh.
+
+namespace {
+constexpr int FONT_ID = 1;
+constexpr int HALF_REFRESH_EVERY = 10;
+const char* const kWords[] = {"the",    "reader", "turned", "another", "page",  "and",     "light",  "fell",
+                              "across", "a",      "quiet",  "room",    "where", "nothing", "moved",  "except",
+                              "dust",   "of",     "old",    "stories", "said",  "she",     "slowly", "again"};
+
+// A page of `lines` lines of random words below a one-line status bar
+void drawPage(const GfxRenderer& renderer, std::mt19937& rng, const int lines, const int pageNumber) {
+  renderer.clearScreen();
+  const int lineHeight = renderer.getLineHeight(FONT_ID);
+  for (int line = 0; line < lines; line++) {
+    std::string text;
+    while (true) {
+      const std::string next = text + (text.empty() ? "" : " ") + kWords[rng() % std::size(kWords)];
+      if (renderer.getTextWidth(FONT_ID, next.c_str()) > renderer.getScreenWidth() - 40) break;
+      text = next;
+    }
+    renderer.drawText(FONT_ID, 20, 30 + line * lineHeight, text.c_str());
+  }
+  const std::string status = std::to_string(pageNumber) + " / 400";
+  renderer.drawText(FONT_ID, renderer.getScreenWidth() - 80, renderer.getScreenHeight() - 20, status.c_str());
+}
+
+// Follows the panel image between refreshes and accumulates black-to-white transitions since the last half refresh
+struct GhostMeter {
+  const EInkDisplay& panel;
+  std::vector<uint8_t> shown = std::vector<uint8_t>(HalDisplay::BUFFER_SIZE, 0xFF);
+  uint32_t halfRefreshes = 0;
+  uint32_t ghost = 0;
+  uint32_t peakGhost = 0;
+  uint32_t lastHalfCount;
+
+  explicit GhostMeter(const EInkDisplay& p) : panel(p), lastHalfCount(p.getRefreshCount(EInkDisplay::HALF_REFRESH)) {}
+
+  void update() {
+    const uint8_t* image = panel.getPanelImage();
+    const uint32_t halfCount = panel.getRefreshCount(EInkDisplay::HALF_REFRESH);
+    if (halfCount != lastHalfCount) {
+      halfRefreshes += halfCount - lastHalfCount;
+      lastHalfCount = halfCount;
+      ghost = 0;
+    } else {
+      for (uint32_t i = 0; i < HalDisplay::BUFFER_SIZE; i++) {
+        ghost += __builtin_popcount(~shown[i] & image[i] & 0xFF);
+      }
+      peakGhost = std::max(peakGhost, ghost);
+    }
+    shown.assign(image, image + HalDisplay::BUFFER_SIZE);
+  }
+};
+
+// Chapters of a title page, full pages and a short last page
+std::vector<int> bookLineCounts(std::mt19937& rng) {
+  std::vector<int> lines;
+  for (int chapter = 0; chapter < 8; chapter++) {
+    lines.push_back(3);
+    for (int page = 0; page < 9; page++) lines.push_back(32 + rng() % 8);
+    lines.push_back(2 + rng() % 20);
+  }
+  return lines;
+}
+
+struct SessionResult {
+  uint32_t halfRefreshes;
+  uint32_t peakGhost;
+};
+
+SessionResult readWithCounter(GfxRenderer& renderer, EInkDisplay& panel, const std::vector<int>& lines) {
+  std::mt19937 rng(7);
+  GhostMeter meter(panel);
+  int pagesUntilFullRefresh = 0;
+  for (size_t page = 0; page < lines.size(); page++) {
+    drawPage(renderer, rng, lines[page], static_cast<int>(page) + 1);
+    if (pagesUntilFullRefresh <= 1) {
+      renderer.displayBuffer(HalDisplay::HALF_REFRESH);
+      pagesUntilFullRefresh = HALF_REFRESH_EVERY;
+    } else {
+      renderer.displayBuffer();
+      pagesUntilFullRefresh--;
+    }
+    meter.update();
+  }
+  return {meter.halfRefreshes, meter.peakGhost};
+}
+
+// The anti-aliasing pass of the readers: stash the BW frame, show gray shades on top of it, restore it
+void grayPass(GfxRenderer& renderer) {
+  renderer.storeBwBuffer();
+  renderer.clearScreen(0x00);
+  renderer.copyGrayscaleLsbBuffers();
+  renderer.copyGrayscaleMsbBuffers();
+  renderer.displayGrayBuffer();
+  renderer.restoreBwBuffer();
+}
+
+SessionResult readWithPlanner(GfxRenderer& renderer, EInkDisplay& panel, const std::vector<int>& lines,
+                              const bool antiAliased = false) {
+  std::mt19937 rng(7);
+  GhostMeter meter(panel);
+  for (size_t page = 0; page < lines.size(); page++) {
+    drawPage(renderer, rng, lines[page], static_cast<int>(page) + 1);
+    renderer.displayAutoRefresh(HALF_REFRESH_EVERY);
+    meter.update();
+    if (antiAliased) grayPass(renderer);
+    expect(memcmp(panel.getPanelImage(), renderer.getFrameBuffer(), HalDisplay::BUFFER_SIZE) == 0,
+           "planned refresh shows page " + std::to_string(page + 1));
+  }
+  return {meter.halfRefreshes, meter.peakGhost};
+}
+}  // namespace
+
+int main() {
+  HalDisplay display;
+  EpdFont font(&ubuntu_10_regular);
+  EpdFontFamily family(&font);
+  GfxRenderer renderer(display);
+  renderer.begin();
+  renderer.insertFont(FONT_ID, family);
+  EInkDisplay& panel = *EInkDisplay::latest();
+
+  // Without a planner displayAutoRefresh is a plain fast (or, for 1, half) refresh
+  renderer.clearScreen();
+  renderer.displayAutoRefresh(HALF_REFRESH_EVERY);
+  expect(panel.getRefreshCount(EInkDisplay::FAST_REFRESH) == 1, "fast refresh without a planner");
+
+  RefreshPlanner planner;
+  renderer.setRefreshPlanner(&planner);
+  std::mt19937 rng(1);
+
+  // The first frame gets a half refresh, an unchanged frame none
+  drawPage(renderer, rng, 30, 1);
+  renderer.displayAutoRefresh(HALF_REFRESH_EVERY);
+  expect(planner.getLastDecision().action == RefreshPlanner::HALF, "first frame is a half refresh");
+  const uint32_t refreshes = panel.getRefreshCount(EInkDisplay::FAST_REFRESH) +
+                             panel.getRefreshCount(EInkDisplay::HALF_REFRESH) + panel.getWindowRefreshCount();
+  renderer.displayAutoRefresh(HALF_REFRESH_EVERY);
+  expect(planner.getLastDecision().action == RefreshPlanner::SKIP, "unchanged frame is skipped");
+  expect(panel.getRefreshCount(EInkDisplay::FAST_REFRESH) + panel.getRefreshCount(EInkDisplay::HALF_REFRESH) +
+                 panel.getWindowRefreshCount() ==
+             refreshes,
+         "skipped frame does not touch the panel");
+
+  // A status bar change refreshes the tiles around it
+  renderer.fillRect(renderer.getScreenWidth() - 80, renderer.getScreenHeight() - 34, 80, 34, false);
+  renderer.drawText(FONT_ID, renderer.getScreenWidth() - 80, renderer.getScreenHeight() - 20, "2 / 400");
+  renderer.displayAutoRefresh(HALF_REFRESH_EVERY);
+  const RefreshPlanner::Decision& status = planner.getLastDecision();
+  expect(status.action == RefreshPlanner::WINDOW, "status bar change is a window refresh");
+  expect(status.changedTiles <= 6, "status bar change touches few tiles (" + std::to_string(status.changedTiles) + ")");
+  uint16_t wx, wy, ww, wh;
+  panel.getLastWindow(&wx, &wy, &ww, &wh);
+  expect(wx == status.x && wy == status.y && ww == status.width && wh == status.height, "window covers the tiles");
+  expect(memcmp(panel.getPanelImage(), renderer.getFrameBuffer(), HalDisplay::BUFFER_SIZE) == 0, "window shown");
+
+  // A grayscale pass restores the same BW frame, so the signature still holds
+  grayPass(renderer);
+  renderer.displayAutoRefresh(HALF_REFRESH_EVERY);
+  expect(planner.getLastDecision().action == RefreshPlanner::SKIP, "unchanged frame after a grayscale pass is skipped");
+
+  // A requested half refresh (a book being opened) happens even if nothing changed, and only once
+  renderer.requestHalfRefresh();
+  renderer.displayAutoRefresh(HALF_REFRESH_EVERY);
+  expect(planner.getLastDecision().action == RefreshPlanner::HALF, "requested half refresh");
+  renderer.displayAutoRefresh(HALF_REFRESH_EVERY);
+  expect(planner.getLastDecision().action == RefreshPlanner::SKIP, "requested half refresh happens once");
+
+  // Refresh frequency 1 always asks for half refreshes
+  for (int page = 0; page < 3; page++) {
+    drawPage(renderer, rng, 30, page);
+    renderer.displayAutoRefresh(1);
+    expect(planner.getLastDecision().action == RefreshPlanner::HALF, "frequency 1 half refreshes");
+  }
+
+  // Uniform pages keep the configured cadence; the ghosting the counter allows there is what the setting tolerates
+  uint32_t toleratedGhost;
+  {
+    const std::vector<int> lines(60, 36);
+    renderer.displayBuffer(HalDisplay::HALF_REFRESH);
+    const SessionResult counter = readWithCounter(renderer, panel, lines);
+    renderer.displayBuffer(HalDisplay::HALF_REFRESH);
+    const SessionResult planned = readWithPlanner(renderer, panel, lines);
+    std::cout << "Uniform pages: counter " << counter.halfRefreshes << " half refreshes, peak ghost "
+              << counter.peakGhost << " px; planner " << planned.halfRefreshes << " half refreshes, peak ghost "
+              << planned.peakGhost << " px\n";
+    expect(planned.halfRefreshes + 1 >= counter.halfRefreshes && planned.halfRefreshes <= counter.halfRefreshes + 1,
+           "uniform pages keep the cadence");
+    toleratedGhost = counter.peakGhost;
+    expect(planned.peakGhost <= toleratedGhost + toleratedGhost / 50, "uniform pages ghost as much as before");
+  }
+
+  // A book with chapter title pages and short chapter ends needs fewer half refreshes and never ghosts more than the
+  // setting tolerates
+  {
+    std::mt19937 bookRng(3);
+    const std::vector<int> lines = bookLineCounts(bookRng);
+    renderer.displayBuffer(HalDisplay::HALF_REFRESH);
+    const SessionResult counter = readWithCounter(renderer, panel, lines);
+    renderer.displayBuffer(HalDisplay::HALF_REFRESH);
+    planner.resetStats();
+    const SessionResult planned = readWithPlanner(renderer, panel, lines);
+    std::cout << "Book pages:    counter " << counter.halfRefreshes << " half refreshes, peak ghost "
+              << counter.peakGhost << " px; planner " << planned.halfRefreshes << " half refreshes, peak ghost "
+              << planned.peakGhost << " px\n";
+    expect(planned.halfRefreshes < counter.halfRefreshes, "book needs fewer half refreshes");
+    expect(planned.peakGhost <= toleratedGhost + toleratedGhost / 50, "book ghosts within the tolerance");
+
+    // Anti-aliased pages keep the BW signature across their gray pass, so the erased ink is measured and the budget
+    // follows the book exactly as for BW pages
+    renderer.displayBuffer(HalDisplay::HALF_REFRESH);
+    const SessionResult antiAliased = readWithPlanner(renderer, panel, lines, true);
+    std::cout << "Anti-aliased:  planner " << antiAliased.halfRefreshes << " half refreshes, peak ghost "
+              << antiAliased.peakGhost << " px\n";
+    expect(antiAliased.halfRefreshes == planned.halfRefreshes && antiAliased.peakGhost == planned.peakGhost,
+           "anti-aliased pages plan like BW pages");
+  }
+
+  const RefreshPlanner::Stats& stats = planner.getStats();
+  std::cout << "Planner stats: " << stats.skips << " skipped, " << stats.windows << " windowed, "
+            << stats.fastRefreshes << " fast, " << stats.halfRefreshes << " half, " << stats.externalRefreshes
+            << " explicit\n";
+
+  if (failures) {
+    std::cerr << failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "Refresh planner: all checks passed\n";
+  return 0;
+}
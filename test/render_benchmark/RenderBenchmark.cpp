@@ -0,0 +1,378 @@
+#include <Bitmap.h>
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <WordRunCache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/EpdFont/builtinFonts/bookerly_14_bold.h"
+#include "lib/EpdFont/builtinFonts/bookerly_14_italic.h"
+#include "lib/EpdFont/builtinFonts/bookerly_14_regular.h"
+#include "lib/EpdFont/builtinFonts/notosans_14_bold.h"
+#include "lib/EpdFont/builtinFonts/notosans_14_italic.h"
+#include "lib/EpdFont/builtinFonts/notosans_14_regular.h"
+#include "lib/EpdFont/builtinFonts/opendyslexic_14_bold.h"
+#include "lib/EpdFont/builtinFonts/opendyslexic_14_italic.h"
+#include "lib/EpdFont/builtinFonts/opendyslexic_14_regular.h"
+#include "lib/EpdFont/builtinFonts/ubuntu_10_regular.h"
+
+// Usage: RenderBenchmark [--quick] [--filter TEXT] [--json PATH] [--update]
+// Times fixed rasterization scenarios into the host frame buffer and compares them with baseline.json next to this
+// file. A frame is everything a scenario draws after clearing the screen; nothing is sent to the panel. --update
+// rewrites the baseline, --json writes the results elsewhere, --quick runs a few frames per scenario only. Timings are
+// machine-specific: compare against a baseline recorded on the same machine.
+
+namespace {
+constexpr int UI_FONT = 1;
+constexpr int FIRST_BOOK_FONT = 2;
+constexpr int PAGES = 8;  // Distinct pages the text scenarios cycle through, so cached word runs miss as on a page turn
+constexpr double REGRESSION_PERCENT = 15.0;
+
+struct Result {
+  uint64_t pixels;
+  double nsPerFrame;
+  double nsPerPixel() const { return nsPerFrame / static_cast<double>(pixels); }
+};
+
+struct Scenario {
+  std::string name;
+  uint64_t pixels;  // Area the scenario draws into, for the per-pixel figure
+  std::function<void(int frame)> draw;
+};
+
+std::string sourceDir() {
+  const std::string source = __FILE__;
+  return source.substr(0, source.find_last_of('/'));
+}
+
+const char* const kWords[] = {
+    "the",     "reader",  "turned",  "another", "page",    "and",        "light",   "fell",   "across", "a",
+    "quiet",   "room",    "where",   "nothing", "moved",   "except",     "dust",    "of",     "old",    "stories",
+    "said",    "she",     "slowly",  "again",   "harbour", "lanterns",   "whether", "winter", "beyond", "it",
+    "we",      "remember", "quickly", "towards", "evening", "considered", "into",    "was",    "not",    "by"};
+
+// A justified page of words as TextBlock lays it out: words at precomputed x positions, some in italic or bold
+struct PageLayout {
+  struct Word {
+    const char* text;
+    int16_t x;
+    int16_t y;
+    EpdFontFamily::Style style;
+  };
+  std::vector<Word> words;
+};
+
+PageLayout layoutPage(const GfxRenderer& renderer, const int fontId, const int seed) {
+  std::mt19937 rng(seed);
+  const int margin = 12;
+  const int width = renderer.getScreenWidth() - 2 * margin;
+  const int lineHeight = renderer.getLineHeight(fontId);
+  const int spaceWidth = renderer.getSpaceWidth(fontId);
+  PageLayout page;
+  for (int y = margin; y + lineHeight <= renderer.getScreenHeight() - margin; y += lineHeight) {
+    std::vector<PageLayout::Word> line;
+    std::vector<int> widths;
+    int used = 0;
+    while (true) {
+      const char* text = kWords[rng() % std::size(kWords)];
+      const uint32_t pick = rng() % 48;
+      const auto style = pick < 3 ? EpdFontFamily::ITALIC : pick < 5 ? EpdFontFamily::BOLD : EpdFontFamily::REGULAR;
+      const int wordWidth = renderer.getTextWidth(fontId, text, style);
+      const int gap = line.empty() ? 0 : spaceWidth;
+      if (!line.empty() && used + gap + wordWidth > width) break;
+      line.push_back({text, 0, static_cast<int16_t>(y), style});
+      widths.push_back(wordWidth);
+      used += gap + wordWidth;
+    }
+    // Spread the slack over the gaps
+    const int gaps = std::max(static_cast<int>(line.size()) - 1, 1);
+    int x = margin;
+    for (size_t i = 0; i < line.size(); i++) {
+      line[i].x = static_cast<int16_t>(x + (width - used) * static_cast<int>(i) / gaps);
+      x += widths[i] + spaceWidth;
+    }
+    page.words.insert(page.words.end(), line.begin(), line.end());
+  }
+  return page;
+}
+
+void drawPage(const GfxRenderer& renderer, const int fontId, const PageLayout& page) {
+  for (const auto& word : page.words) renderer.drawText(fontId, word.x, word.y, word.text, true, word.style);
+}
+
+// 8-bit grayscale BMP in the size of a full-screen cover
+bool writeCoverBmp(const std::string& path, const int width, const int height) {
+  const int rowBytes = (width + 3) & ~3;
+  const uint32_t offBits = 14 + 40 + 256 * 4;
+  const uint32_t fileSize = offBits + rowBytes * height;
+  std::vector<uint8_t> file(fileSize, 0);
+  auto put16 = [&](const size_t at, const uint16_t v) {
+    file[at] = v & 0xFF;
+    file[at + 1] = v >> 8;
+  };
+  auto put32 = [&](const size_t at, const uint32_t v) {
+    put16(at, v & 0xFFFF);
+    put16(at + 2, v >> 16);
+  };
+  file[0] = 'B';
+  file[1] = 'M';
+  put32(2, fileSize);
+  put32(10, offBits);
+  put32(14, 40);
+  put32(18, width);
+  put32(22, height);
+  put16(26, 1);
+  put16(28, 8);
+  put32(46, 256);
+  for (int i = 0; i < 256; i++) {
+    file[54 + i * 4] = file[54 + i * 4 + 1] = file[54 + i * 4 + 2] = i;
+  }
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const bool title = y > height / 8 && y < height / 4 && x > width / 8 && x < width * 7 / 8;
+      file[offBits + y * rowBytes + x] = title ? 20 : ((x * 255 / width) ^ (y * 255 / height)) & 0xFF;
+    }
+  }
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(file.data()), file.size());
+  return out.good();
+}
+
+template <typename Draw>
+double nsPerFrame(const GfxRenderer& renderer, const int frames, Draw&& draw) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++) {
+    renderer.clearScreen();
+    draw(i);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+// Best of five batches of at least 100ms (a handful of frames with --quick), which keeps scheduler noise out
+Result measure(const GfxRenderer& renderer, const Scenario& scenario, const bool quick) {
+  scenario.draw(0);
+  const double probe = nsPerFrame(renderer, 3, scenario.draw);
+  const int frames = quick ? 3 : std::max(3, static_cast<int>(100e6 / std::max(probe, 1.0)));
+  double best = probe;
+  for (int batch = 0; batch < (quick ? 1 : 5); batch++) {
+    best = std::min(best, nsPerFrame(renderer, frames, scenario.draw));
+  }
+  return {scenario.pixels, best};
+}
+
+std::map<std::string, Result> readBaseline(const std::string& path) {
+  // One scenario per line: "name": {"pixels": N, "ns_per_frame": N, "ns_per_pixel": N},
+  std::map<std::string, Result> baseline;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) {
+    const size_t open = line.find('"');
+    const size_t close = line.find('"', open + 1);
+    const size_t pixels = line.find("\"pixels\":");
+    const size_t ns = line.find("\"ns_per_frame\":");
+    if (open == std::string::npos || close == std::string::npos || pixels == std::string::npos ||
+        ns == std::string::npos) {
+      continue;
+    }
+    baseline[line.substr(open + 1, close - open - 1)] = {std::stoull(line.substr(pixels + 9)),
+                                                         std::stod(line.substr(ns + 15))};
+  }
+  return baseline;
+}
+
+bool writeResults(const std::string& path, const std::vector<std::pair<std::string, Result>>& results) {
+  std::ofstream out(path);
+  out << "{\n  \"unit\": \"ns\",\n  \"scenarios\": {\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto& [name, result] = results[i];
+    char line[256];
+    snprintf(line, sizeof(line), "    \"%s\": {\"pixels\": %llu, \"ns_per_frame\": %.0f, \"ns_per_pixel\": %.3f}%s\n",
+             name.c_str(), static_cast<unsigned long long>(result.pixels), result.nsPerFrame, result.nsPerPixel(),
+             i + 1 < results.size() ? "," : "");
+    out << line;
+  }
+  out << "  }\n}\n";
+  return out.good();
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool quick = false;
+  bool update = false;
+  std::string filter;
+  std::string jsonPath;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--quick") {
+      quick = true;
+    } else if (arg == "--update") {
+      update = true;
+    } else if (arg == "--filter" && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (arg == "--json" && i + 1 < argc) {
+      jsonPath = argv[++i];
+    } else {
+      fprintf(stderr, "Usage: %s [--quick] [--filter TEXT] [--json PATH] [--update]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  renderer.begin();
+  FontDecompressor fontDecompressor;
+  if (!fontDecompressor.init()) {
+    fprintf(stderr, "FAIL: font decompressor\n");
+    return 1;
+  }
+  renderer.setFontDecompressor(&fontDecompressor);
+  WordRunCache wordRunCache;
+  renderer.setWordRunCache(&wordRunCache);
+
+  EpdFont uiFont(&ubuntu_10_regular);
+  EpdFontFamily uiFamily(&uiFont);
+  renderer.insertFont(UI_FONT, uiFamily);
+
+  struct BookFamily {
+    const char* name;
+    EpdFont regular;
+    EpdFont bold;
+    EpdFont italic;
+  };
+  BookFamily families[] = {
+      {"bookerly", EpdFont(&bookerly_14_regular), EpdFont(&bookerly_14_bold), EpdFont(&bookerly_14_italic)},
+      {"notosans", EpdFont(&notosans_14_regular), EpdFont(&notosans_14_bold), EpdFont(&notosans_14_italic)},
+      {"opendyslexic", EpdFont(&opendyslexic_14_regular), EpdFont(&opendyslexic_14_bold),
+       EpdFont(&opendyslexic_14_italic)},
+  };
+  std::vector<EpdFontFamily> fontFamilies;
+  fontFamilies.reserve(std::size(families));
+  for (auto& family : families) fontFamilies.emplace_back(&family.regular, &family.bold, &family.italic);
+  for (size_t i = 0; i < fontFamilies.size(); i++) renderer.insertFont(FIRST_BOOK_FONT + i, fontFamilies[i]);
+
+  const uint64_t screenPixels = static_cast<uint64_t>(HalDisplay::DISPLAY_WIDTH) * HalDisplay::DISPLAY_HEIGHT;
+  std::vector<Scenario> scenarios;
+
+  // Text pages as the reader draws them: portrait, logical back buffer, word run cache
+  renderer.setOrientation(GfxRenderer::Portrait);
+  std::vector<std::vector<PageLayout>> pages(std::size(families));
+  for (size_t f = 0; f < std::size(families); f++) {
+    const int fontId = FIRST_BOOK_FONT + static_cast<int>(f);
+    for (int p = 0; p < PAGES; p++) pages[f].push_back(layoutPage(renderer, fontId, p + 1));
+    scenarios.push_back({std::string("text_page_") + families[f].name, screenPixels,
+                         [&, f, fontId](const int frame) { drawPage(renderer, fontId, pages[f][frame % PAGES]); }});
+  }
+
+  // The anti-aliased page render: BW pass, then the LSB and MSB gray passes with the BW frame stashed in between
+  scenarios.push_back({"aa_triple_pass_bookerly", screenPixels, [&](const int frame) {
+                         const PageLayout& page = pages[0][frame % PAGES];
+                         drawPage(renderer, FIRST_BOOK_FONT, page);
+                         renderer.storeBwBuffer();
+                         renderer.clearScreen(0x00);
+                         renderer.setRenderMode(GfxRenderer::GRAYSCALE_LSB);
+                         drawPage(renderer, FIRST_BOOK_FONT, page);
+                         renderer.copyGrayscaleLsbBuffers();
+                         renderer.clearScreen(0x00);
+                         renderer.setRenderMode(GfxRenderer::GRAYSCALE_MSB);
+                         drawPage(renderer, FIRST_BOOK_FONT, page);
+                         renderer.copyGrayscaleMsbBuffers();
+                         renderer.setRenderMode(GfxRenderer::BW);
+                         renderer.restoreBwBuffer();
+                       }});
+
+  // Rotated text, as the side button hints draw it
+  scenarios.push_back({"rotated_text", screenPixels, [&](const int) {
+                         const int bottom = renderer.getScreenHeight() - 20;
+                         for (int x = 20; x < renderer.getScreenWidth() - 20; x += 24) {
+                           renderer.drawTextRotated90CW(UI_FONT, x, bottom, "Rotated label text 0123456789");
+                         }
+                       }});
+
+  // Rounded rectangle grids: menu tiles and buttons in every fill the themes use
+  scenarios.push_back({"rounded_rect_grid", screenPixels, [&](const int frame) {
+                         const Color colors[] = {Color::Black, Color::DarkGray, Color::LightGray, Color::White};
+                         const int w = renderer.getScreenWidth() / 4;
+                         const int h = renderer.getScreenHeight() / 8;
+                         for (int row = 0; row < 8; row++) {
+                           for (int col = 0; col < 4; col++) {
+                             renderer.fillRoundedRect(col * w + 2, row * h + 2, w - 4, h - 4, 8 + (row + frame) % 4 * 2,
+                                                      colors[(row + col) % 4]);
+                           }
+                         }
+                       }});
+
+  // Cover bitmaps at full screen, half size and home screen thumbnail size
+  const std::string bmpPath = "/tmp/render_benchmark_cover.bmp";
+  if (!writeCoverBmp(bmpPath, 480, 800)) {
+    fprintf(stderr, "FAIL: write %s\n", bmpPath.c_str());
+    return 1;
+  }
+  FsFile bmpFile;
+  bmpFile.open(bmpPath.c_str());
+  Bitmap cover(bmpFile, true);
+  if (cover.parseHeaders() != BmpReaderError::Ok) {
+    fprintf(stderr, "FAIL: parse %s\n", bmpPath.c_str());
+    return 1;
+  }
+  for (const auto& [name, width, height] : {std::tuple{"bitmap_full", 480, 800}, std::tuple{"bitmap_half", 240, 400},
+                                            std::tuple{"bitmap_thumbnail", 120, 200}}) {
+    scenarios.push_back({name, static_cast<uint64_t>(width) * height, [&, width, height](const int) {
+                           cover.rewindToData();
+                           renderer.drawBitmap(cover, 0, 0, width, height);
+                         }});
+  }
+
+  std::vector<std::pair<std::string, Result>> results;
+  const std::map<std::string, Result> baseline = readBaseline(sourceDir() + "/baseline.json");
+  int regressions = 0;
+  printf("%-26s %14s %10s %10s %10s\n", "scenario", "ns/frame", "ns/pixel", "baseline", "run hits");
+  for (const auto& scenario : scenarios) {
+    if (!filter.empty() && scenario.name.find(filter) == std::string::npos) continue;
+    const bool logical = scenario.name.rfind("text_page_", 0) == 0 || scenario.name.rfind("aa_", 0) == 0;
+    renderer.setLogicalBufferEnabled(logical);
+    wordRunCache.clear();
+    wordRunCache.resetStats();
+    const Result result = measure(renderer, scenario, quick);
+    results.emplace_back(scenario.name, result);
+
+    char delta[32] = "-";
+    const auto it = baseline.find(scenario.name);
+    if (it != baseline.end() && it->second.nsPerFrame > 0) {
+      const double percent = (result.nsPerFrame / it->second.nsPerFrame - 1.0) * 100.0;
+      snprintf(delta, sizeof(delta), "%+.1f%%%s", percent, percent > REGRESSION_PERCENT ? " !" : "");
+      if (percent > REGRESSION_PERCENT) regressions++;
+    }
+    // Share of drawText words served from the word run cache
+    const WordRunCache::Stats& runs = wordRunCache.getStats();
+    char hits[16] = "-";
+    if (runs.hits + runs.misses > 0) snprintf(hits, sizeof(hits), "%u%%", runs.hits * 100 / (runs.hits + runs.misses));
+    printf("%-26s %14.0f %10.3f %10s %10s\n", scenario.name.c_str(), result.nsPerFrame, result.nsPerPixel(), delta,
+           hits);
+  }
+  renderer.setLogicalBufferEnabled(false);
+  bmpFile.close();
+  std::remove(bmpPath.c_str());
+  fontDecompressor.deinit();
+
+  if (update) jsonPath = sourceDir() + "/baseline.json";
+  if (!jsonPath.empty()) {
+    if (!writeResults(jsonPath, results)) {
+      fprintf(stderr, "FAIL: write %s\n", jsonPath.c_str());
+      return 1;
+    }
+    printf("Wrote %zu results to %s\n", results.size(), jsonPath.c_str());
+  }
+  if (regressions && !quick) {
+    printf("%d scenario(s) more than %.0f%% slower than the baseline (marked !)\n", regressions, REGRESSION_PERCENT);
+  }
+  return 0;
+}
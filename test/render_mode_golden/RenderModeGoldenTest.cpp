@@ -0,0 +1,212 @@
+#include <Bitmap.h>
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HalStorage.h>
+#include <HostTest.h>
+#include <WordRunCache.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lib/EpdFont/builtinFonts/bookerly_14_regular.h"
+#include "lib/EpdFont/builtinFonts/ubuntu_10_regular.h"
+#include "lib/Epub/Epub/converters/DitherUtils.h"
+
+// Usage: RenderModeGoldenTest [--update]
+// Draws the same scenes in every render mode and orientation and compares a hash of each frame buffer with
+// golden.txt next to this file. The golden hashes were recorded before the render mode became a template parameter
+// of the pixel loops, so they pin the output bit for bit. --update rewrites them.
+
+namespace {
+constexpr int TEXT_2BIT = 1;
+constexpr int TEXT_1BIT = 2;
+
+uint64_t hashFrame(const uint8_t* frame) {
+  uint64_t hash = 14695981039346656037ull;
+  for (uint32_t i = 0; i < HalDisplay::BUFFER_SIZE; i++) {
+    hash = (hash ^ frame[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+std::string goldenPath() {
+  const std::string source = __FILE__;
+  return source.substr(0, source.find_last_of('/')) + "/golden.txt";
+}
+
+// 8-bit grayscale BMP with a diagonal gradient and a hard-edged block, to exercise every gray level
+bool writeGradientBmp(const std::string& path, const int width, const int height) {
+  const int rowBytes = (width + 3) & ~3;
+  const uint32_t paletteBytes = 256 * 4;
+  const uint32_t offBits = 14 + 40 + paletteBytes;
+  const uint32_t fileSize = offBits + rowBytes * height;
+  std::vector<uint8_t> file(fileSize, 0);
+  auto put16 = [&](const size_t at, const uint16_t v) {
+    file[at] = v & 0xFF;
+    file[at + 1] = v >> 8;
+  };
+  auto put32 = [&](const size_t at, const uint32_t v) {
+    put16(at, v & 0xFFFF);
+    put16(at + 2, v >> 16);
+  };
+  file[0] = 'B';
+  file[1] = 'M';
+  put32(2, fileSize);
+  put32(10, offBits);
+  put32(14, 40);
+  put32(18, width);
+  put32(22, height);
+  put16(26, 1);
+  put16(28, 8);
+  put32(46, 256);
+  for (int i = 0; i < 256; i++) {
+    file[54 + i * 4] = file[54 + i * 4 + 1] = file[54 + i * 4 + 2] = i;
+  }
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const bool block = x > width / 2 && x < width * 3 / 4 && y > height / 3 && y < height * 2 / 3;
+      file[offBits + y * rowBytes + x] = block ? 40 : (x * 255 / width + y * 255 / height) / 2;
+    }
+  }
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(file.data()), file.size());
+  return out.good();
+}
+
+// A packed 2-bit image (4 pixels per byte, MSB first) drawn pixel by pixel
+void drawPackedImage(GfxRenderer& renderer, const int x, const int y, const int width, const int height) {
+  const int bytesPerRow = (width + 3) / 4;
+  std::vector<uint8_t> row(bytesPerRow);
+  for (int r = 0; r < height; r++) {
+    for (int col = 0; col < width; col++) {
+      const uint8_t value = ((col / 6) + (r / 5)) & 3;
+      row[col / 4] = (row[col / 4] & ~(0xC0 >> (col % 4) * 2)) | value << (6 - (col % 4) * 2);
+    }
+    renderer.withRenderMode([&]<GfxRenderer::RenderMode mode>() {
+      drawPackedRowWithRenderMode<mode>(renderer, x, y + r, row.data(), width);
+    });
+  }
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const bool update = argc > 1 && std::string(argv[1]) == "--update";
+
+  HalDisplay display;
+  EpdFont font2Bit(&bookerly_14_regular);
+  EpdFontFamily family2Bit(&font2Bit);
+  EpdFont font1Bit(&ubuntu_10_regular);
+  EpdFontFamily family1Bit(&font1Bit);
+  FontDecompressor fontDecompressor;
+  expect(fontDecompressor.init(), "font decompressor");
+  GfxRenderer renderer(display);
+  renderer.begin();
+  renderer.setFontDecompressor(&fontDecompressor);
+  renderer.insertFont(TEXT_2BIT, family2Bit);
+  renderer.insertFont(TEXT_1BIT, family1Bit);
+  WordRunCache wordRunCache;
+
+  const std::string bmpPath = "/tmp/render_mode_golden.bmp";
+  expect(writeGradientBmp(bmpPath, 150, 90), "write test bitmap");
+
+  struct Scene {
+    const char* name;
+    void (*draw)(GfxRenderer&, const std::string&);
+  };
+  const Scene scenes[] = {
+      {"text2bit",
+       [](GfxRenderer& r, const std::string&) {
+         r.drawText(TEXT_2BIT, 12, 20, "Grayscale glyphs: AVAST Wave, fiery quiz!");
+         r.drawText(TEXT_2BIT, 12, 60, "Second line, drawn white on nothing", false);
+       }},
+      {"text1bit", [](GfxRenderer& r, const std::string&) { r.drawText(TEXT_1BIT, 30, 100, "Status 42% 12:30"); }},
+      {"rotated", [](GfxRenderer& r, const std::string&) { r.drawTextRotated90CW(TEXT_2BIT, 20, 300, "Sideways"); }},
+      {"cached",
+       [](GfxRenderer& r, const std::string&) {
+         // Repeated words get composed into word runs and drawn from the cache
+         for (int i = 0; i < 6; i++) r.drawText(TEXT_2BIT, 16, 120 + i * 30, "the quick brown fox");
+       }},
+      {"bitmap",
+       [](GfxRenderer& r, const std::string& path) {
+         FsFile file;
+         if (!file.open(path.c_str())) return;
+         Bitmap bitmap(file);
+         if (bitmap.parseHeaders() != BmpReaderError::Ok) return;
+         r.drawBitmap(bitmap, 40, 200, 0, 0);
+       }},
+      {"bitmapScaledCropped",
+       [](GfxRenderer& r, const std::string& path) {
+         FsFile file;
+         if (!file.open(path.c_str())) return;
+         Bitmap bitmap(file, true);
+         if (bitmap.parseHeaders() != BmpReaderError::Ok) return;
+         r.drawBitmap(bitmap, 10, 10, 100, 80, 0.2f, 0.1f);
+       }},
+      {"imageCache", [](GfxRenderer& r, const std::string&) { drawPackedImage(r, 25, 320, 123, 77); }},
+  };
+
+  const std::pair<GfxRenderer::RenderMode, const char*> modes[] = {
+      {GfxRenderer::BW, "bw"}, {GfxRenderer::GRAYSCALE_LSB, "lsb"}, {GfxRenderer::GRAYSCALE_MSB, "msb"}};
+  const std::pair<GfxRenderer::Orientation, const char*> orientations[] = {
+      {GfxRenderer::Portrait, "portrait"}, {GfxRenderer::LandscapeCounterClockwise, "landscapeCCW"}};
+
+  std::map<std::string, uint64_t> actual;
+  for (const auto& [orientation, orientationName] : orientations) {
+    renderer.setOrientation(orientation);
+    for (const auto& [mode, modeName] : modes) {
+      for (const auto& scene : scenes) {
+        for (const bool cached : {false, true}) {
+          renderer.setWordRunCache(cached ? &wordRunCache : nullptr);
+          wordRunCache.clear();
+          renderer.setRenderMode(mode);
+          renderer.clearScreen(mode == GfxRenderer::BW ? 0xFF : 0x00);
+          scene.draw(renderer, bmpPath);
+          const std::string name = std::string(orientationName) + "/" + modeName + "/" + scene.name +
+                                   (cached ? "/wordcache" : "");
+          actual[name] = hashFrame(renderer.getFrameBuffer());
+        }
+      }
+    }
+  }
+  renderer.setRenderMode(GfxRenderer::BW);
+  renderer.setWordRunCache(nullptr);
+  std::remove(bmpPath.c_str());
+  fontDecompressor.deinit();
+
+  if (update) {
+    std::ofstream out(goldenPath());
+    for (const auto& [name, hash] : actual) {
+      char line[32];
+      snprintf(line, sizeof(line), "%016llx", static_cast<unsigned long long>(hash));
+      out << name << " " << line << "\n";
+    }
+    std::cout << "Wrote " << actual.size() << " golden hashes to " << goldenPath() << "\n";
+    return failures ? 1 : 0;
+  }
+
+  std::ifstream in(goldenPath());
+  expect(in.good(), "read " + goldenPath());
+  std::string name, hex;
+  size_t compared = 0;
+  while (in >> name >> hex) {
+    const auto it = actual.find(name);
+    if (it == actual.end()) {
+      expect(false, name + ": scene no longer drawn");
+      continue;
+    }
+    expect(std::stoull(hex, nullptr, 16) == it->second, name + ": frame differs from the golden image");
+    compared++;
+  }
+  expect(compared == actual.size(), "every scene has a golden hash");
+
+  if (failures) {
+    std::cerr << failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "Render mode golden images: " << compared << " frames match\n";
+  return 0;
+}
@@ -0,0 +1,11 @@
+#!/usr/bin/env bash
+# Builds the host library, tests and benchmarks (test/host/CMakeLists.txt) and runs them through ctest. Arguments go to
+# ctest, e.g. `-R pixel_cache` for one test; the binaries are in build/host.
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_DIR="$ROOT_DIR/build/host"
+
+cmake -S "$ROOT_DIR/test/host" -B "$BUILD_DIR" >/dev/null
+cmake --build "$BUILD_DIR" -j"$(nproc 2>/dev/null || sysctl -n hw.ncpu)"
+ctest --test-dir "$BUILD_DIR" --output-on-failure "$@"
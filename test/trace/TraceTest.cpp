@@ -0,0 +1,105 @@
+#include <Arduino.h>
+#include <HostTest.h>
+#include <Trace.h>
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records spans into the trace ring and checks what the Chrome trace JSON dump holds: nothing while disabled, nested
+// spans with their durations, the newest CAPACITY events once the ring wraps, and one tid per task.
+
+namespace {
+std::vector<std::string> dump() {
+  std::vector<std::string> lines;
+  Trace::writeChromeJson([&lines](const char* line) { lines.emplace_back(line); });
+  return lines;
+}
+
+// Integer field of one event line, or -1
+long field(const std::string& line, const std::string& name) {
+  const size_t at = line.find("\"" + name + "\":");
+  return at == std::string::npos ? -1 : std::stol(line.substr(at + name.size() + 3));
+}
+
+bool contains(const std::string& line, const std::string& text) { return line.find(text) != std::string::npos; }
+}  // namespace
+
+int main() {
+  // Disabled spans record nothing and the dump is still a valid, empty document
+  {
+    TRACE_SPAN("disabled");
+  }
+  std::vector<std::string> lines = dump();
+  expect(lines.size() == 2 && lines.front() == "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" && lines.back() == "]}",
+         "empty trace is an empty event list");
+  expect(Trace::getEventCount() == 0, "disabled spans are not recorded");
+
+  // Nested spans end inner first and the outer one covers the inner one
+  expect(Trace::enable() && Trace::isEnabled(), "enable tracing");
+  {
+    TRACE_SPAN("outer");
+    delay(2);
+    {
+      TRACE_SPAN("inner");
+      delay(3);
+    }
+  }
+  lines = dump();
+  expect(lines.size() == 4, "two events dumped (" + std::to_string(lines.size() - 2) + ")");
+  if (lines.size() == 4) {
+    const std::string& inner = lines[1];
+    const std::string& outer = lines[2];
+    expect(contains(inner, "\"name\":\"inner\"") && contains(outer, "\"name\":\"outer\""), "inner span ends first");
+    expect(contains(inner, "\"ph\":\"X\"") && inner.back() == ',' && outer.back() == '}',
+           "complete events separated by commas");
+    expect(field(inner, "dur") >= 3000, "inner span lasts its delay (" + std::to_string(field(inner, "dur")) + "us)");
+    expect(field(outer, "ts") <= field(inner, "ts") &&
+               field(outer, "ts") + field(outer, "dur") >= field(inner, "ts") + field(inner, "dur"),
+           "outer span covers the inner one");
+    expect(field(outer, "dur") >= 5000, "outer span includes the inner one");
+  }
+
+  // Dumping pauses recording and then resumes it
+  expect(Trace::isEnabled(), "dumping keeps tracing enabled");
+
+  // The ring keeps the newest events
+  Trace::clear();
+  const char* names[] = {"even", "odd"};
+  for (size_t i = 0; i < Trace::CAPACITY + 10; i++) {
+    TRACE_SPAN(names[i % 2]);
+  }
+  expect(Trace::getEventCount() == Trace::CAPACITY, "ring holds CAPACITY events");
+  lines = dump();
+  expect(lines.size() == Trace::CAPACITY + 2, "dump holds CAPACITY events");
+  // The 10 oldest (0..9) were overwritten, so the dump starts at event 10, an "even" one
+  expect(contains(lines[1], "\"name\":\"even\"") && contains(lines[2], "\"name\":\"odd\""), "oldest event first");
+  bool ordered = true;
+  for (size_t i = 2; i + 1 < lines.size(); i++) ordered &= field(lines[i], "ts") >= field(lines[i - 1], "ts");
+  expect(ordered, "events dumped in time order");
+
+  // Spans from different tasks get different tids
+  Trace::clear();
+  {
+    TRACE_SPAN("main_task");
+  }
+  std::thread other([] { TRACE_SPAN("other_task"); });
+  other.join();
+  lines = dump();
+  expect(lines.size() == 4 && field(lines[1], "tid") != field(lines[2], "tid"), "one tid per task");
+
+  // Disabling stops recording but keeps what was recorded
+  Trace::disable();
+  {
+    TRACE_SPAN("after_disable");
+  }
+  expect(Trace::getEventCount() == 2 && !Trace::isEnabled(), "disabled tracing keeps its events");
+
+  if (failures) {
+    std::cerr << failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "Trace: all checks passed\n";
+  return 0;
+}
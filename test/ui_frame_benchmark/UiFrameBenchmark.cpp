@@ -0,0 +1,284 @@
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HostTest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Checks the span-based fills against per-pixel reference versions of the same primitives in every orientation, with
+// and without the logical back buffer, then times a full-screen menu frame built from the primitives the themes use.
+
+namespace {
+// Per-pixel reference: the fill and arc algorithms as they were before span fills, plotting through drawPixel
+class Reference {
+ public:
+  explicit Reference(const GfxRenderer& renderer) : r(renderer) {}
+
+  void plot(const int x, const int y, const bool state) const {
+    if (x >= 0 && y >= 0 && x < r.getScreenWidth() && y < r.getScreenHeight()) r.drawPixel(x, y, state);
+  }
+
+  void plotDither(const int x, const int y, const Color color) const {
+    switch (color) {
+      case Color::Clear:
+        break;
+      case Color::Black:
+        plot(x, y, true);
+        break;
+      case Color::White:
+        plot(x, y, false);
+        break;
+      case Color::LightGray:
+        plot(x, y, x % 2 == 0 && y % 2 == 0);
+        break;
+      case Color::DarkGray:
+        plot(x, y, (x + y) % 2 == 0);
+        break;
+    }
+  }
+
+  void fillRectDither(const int x, const int y, const int width, const int height, const Color color) const {
+    for (int fillY = y; fillY < y + height; fillY++) {
+      for (int fillX = x; fillX < x + width; fillX++) {
+        plotDither(fillX, fillY, color);
+      }
+    }
+  }
+
+  void fillRect(const int x, const int y, const int width, const int height, const bool state) const {
+    fillRectDither(x, y, width, height, state ? Color::Black : Color::White);
+  }
+
+  void drawLine(const int x1, const int y1, const int x2, const int y2, const bool state) const {
+    if (x1 == x2 || y1 == y2) {
+      fillRect(std::min(x1, x2), std::min(y1, y2), std::abs(x2 - x1) + 1, std::abs(y2 - y1) + 1, state);
+    } else {
+      r.drawLine(x1, y1, x2, y2, state);
+    }
+  }
+
+  void drawRect(const int x, const int y, const int width, const int height, const int lineWidth,
+                const bool state) const {
+    for (int i = 0; i < lineWidth; i++) {
+      drawLine(x + i, y + i, x + width - i, y + i, state);
+      drawLine(x + width - i, y + i, x + width - i, y + height - i, state);
+      drawLine(x + width - i, y + height - i, x + i, y + height - i, state);
+      drawLine(x + i, y + height - i, x + i, y + i, state);
+    }
+  }
+
+  void drawArc(const int maxRadius, const int cx, const int cy, const int xDir, const int yDir, const int lineWidth,
+               const bool state) const {
+    const int stroke = std::min(lineWidth, maxRadius);
+    const int innerRadius = std::max(maxRadius - stroke, 0);
+    for (int dy = 0; dy <= maxRadius; ++dy) {
+      for (int dx = 0; dx <= maxRadius; ++dx) {
+        const int distSq = dx * dx + dy * dy;
+        if (distSq > maxRadius * maxRadius || distSq < innerRadius * innerRadius) continue;
+        plot(cx + xDir * dx, cy + yDir * dy, state);
+      }
+    }
+  }
+
+  void drawRoundedRect(const int x, const int y, const int width, const int height, const int lineWidth,
+                       const int cornerRadius, const bool state) const {
+    if (lineWidth <= 0 || width <= 0 || height <= 0) return;
+    const int maxRadius = std::min({cornerRadius, width / 2, height / 2});
+    if (maxRadius <= 0) {
+      drawRect(x, y, width, height, lineWidth, state);
+      return;
+    }
+    const int stroke = std::min(lineWidth, maxRadius);
+    const int right = x + width - 1;
+    const int bottom = y + height - 1;
+    if (width - 2 * maxRadius > 0) {
+      fillRect(x + maxRadius, y, width - 2 * maxRadius, stroke, state);
+      fillRect(x + maxRadius, bottom - stroke + 1, width - 2 * maxRadius, stroke, state);
+    }
+    if (height - 2 * maxRadius > 0) {
+      fillRect(x, y + maxRadius, stroke, height - 2 * maxRadius, state);
+      fillRect(right - stroke + 1, y + maxRadius, stroke, height - 2 * maxRadius, state);
+    }
+    drawArc(maxRadius, x + maxRadius, y + maxRadius, -1, -1, lineWidth, state);
+    drawArc(maxRadius, right - maxRadius, y + maxRadius, 1, -1, lineWidth, state);
+    drawArc(maxRadius, right - maxRadius, bottom - maxRadius, 1, 1, lineWidth, state);
+    drawArc(maxRadius, x + maxRadius, bottom - maxRadius, -1, 1, lineWidth, state);
+  }
+
+  void fillArc(const int maxRadius, const int cx, const int cy, const int xDir, const int yDir,
+               const Color color) const {
+    for (int dy = 0; dy <= maxRadius; ++dy) {
+      for (int dx = 0; dx <= maxRadius; ++dx) {
+        if (dx * dx + dy * dy <= maxRadius * maxRadius) plotDither(cx + xDir * dx, cy + yDir * dy, color);
+      }
+    }
+  }
+
+  void fillRoundedRect(const int x, const int y, const int width, const int height, const int cornerRadius,
+                       const Color color) const {
+    if (width <= 0 || height <= 0) return;
+    const int maxRadius = std::min({cornerRadius, width / 2, height / 2});
+    if (maxRadius <= 0) {
+      fillRectDither(x, y, width, height, color);
+      return;
+    }
+    if (width - 2 * maxRadius > 0) {
+      fillRectDither(x + maxRadius + 1, y, width - 2 * maxRadius - 2, height, color);
+    }
+    const int fillTop = y + maxRadius + 1;
+    const int fillBottom = y + height - 1 - (maxRadius + 1);
+    if (fillBottom >= fillTop) {
+      fillRectDither(x, fillTop, maxRadius + 1, fillBottom - fillTop + 1, color);
+      fillRectDither(x + width - maxRadius - 1, fillTop, maxRadius + 1, fillBottom - fillTop + 1, color);
+    }
+    fillArc(maxRadius, x + maxRadius, y + maxRadius, -1, -1, color);
+    fillArc(maxRadius, x + width - maxRadius - 1, y + maxRadius, 1, -1, color);
+    fillArc(maxRadius, x + width - maxRadius - 1, y + height - maxRadius - 1, 1, 1, color);
+    fillArc(maxRadius, x + maxRadius, y + height - maxRadius - 1, -1, 1, color);
+  }
+
+ private:
+  const GfxRenderer& r;
+};
+
+// A menu screen in the style of the Lyra theme: header, tab bar, list with a rounded selection and separators,
+// scroll bar, cover tiles and button hints. Text is left out; it has its own benchmarks.
+template <typename Painter>
+void drawMenuFrame(const Painter& p, const int w, const int h) {
+  p.fillRect(0, 0, w, 40, true);
+  p.fillRectDither(0, 40, w, 36, Color::LightGray);
+  p.fillRoundedRect(16, 41, 120, 32, 6, Color::Black);
+  p.drawLine(0, 75, w - 1, 75, true);
+  for (int i = 0; i < 3; i++) {
+    const int tileX = 16 + i * (w - 32) / 3;
+    p.fillRoundedRect(tileX, 90, (w - 32) / 3 - 8, 190, 6, i == 1 ? Color::DarkGray : Color::LightGray);
+    p.fillRect(tileX + 8, 98, (w - 32) / 3 - 24, 150, false);
+  }
+  constexpr int rowHeight = 44;
+  const int listTop = 300;
+  p.fillRoundedRect(16, listTop + 2 * rowHeight, w - 40, rowHeight, 6, Color::LightGray);
+  for (int y = listTop + rowHeight; y < h - 60; y += rowHeight) {
+    p.drawLine(16, y - 1, w - 24, y - 1, true);
+  }
+  p.drawLine(w - 8, listTop, w - 8, h - 60, true);
+  p.fillRect(w - 12, listTop + 40, 4, 120, true);
+  for (int i = 0; i < 4; i++) {
+    p.drawRoundedRect(8 + i * (w - 16) / 4, h - 50, (w - 16) / 4 - 8, 42, 1, 6, true);
+  }
+}
+
+void snapshot(const GfxRenderer& renderer, std::vector<uint8_t>& out) {
+  const uint8_t* fb = renderer.getFrameBuffer();
+  out.assign(fb, fb + HalDisplay::BUFFER_SIZE);
+}
+
+template <typename Draw>
+double millisPerFrame(const GfxRenderer& renderer, const int frames, Draw&& draw) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; i++) {
+    renderer.clearScreen();
+    draw();
+  }
+  // Make sure a logical back buffer is transposed into the panel buffer, as a real frame would be
+  renderer.getFrameBuffer();
+  const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / frames;
+}
+}  // namespace
+
+int main() {
+  HalDisplay display;
+  GfxRenderer renderer(display);
+  renderer.begin();
+  const Reference reference(renderer);
+
+  const GfxRenderer::Orientation orientations[] = {GfxRenderer::Portrait, GfxRenderer::LandscapeClockwise,
+                                                   GfxRenderer::PortraitInverted,
+                                                   GfxRenderer::LandscapeCounterClockwise};
+  const Color colors[] = {Color::Black, Color::White, Color::LightGray, Color::DarkGray};
+  std::vector<uint8_t> expected, actual;
+
+  for (const bool logical : {false, true}) {
+    expect(renderer.setLogicalBufferEnabled(logical), "toggle logical buffer");
+    for (const auto orientation : orientations) {
+      renderer.setOrientation(orientation);
+      const int w = renderer.getScreenWidth();
+      const int h = renderer.getScreenHeight();
+      const std::string name =
+          std::string(logical ? "logical" : "direct") + " orientation " + std::to_string(orientation);
+
+      renderer.clearScreen();
+      drawMenuFrame(reference, w, h);
+      snapshot(renderer, expected);
+      renderer.clearScreen();
+      drawMenuFrame(renderer, w, h);
+      snapshot(renderer, actual);
+      expect(expected == actual, name + ": menu frame");
+
+      // Random shapes, partly off screen, to cover every edge mask and clipping case
+      std::mt19937 rng(1234 + orientation);
+      auto coord = [&rng](const int limit) { return static_cast<int>(rng() % (limit + 40)) - 20; };
+      for (const bool useReference : {true, false}) {
+        rng.seed(1234 + orientation);
+        renderer.clearScreen(0xAA);
+        for (int i = 0; i < 300; i++) {
+          const int x = coord(w);
+          const int y = coord(h);
+          const int rw = 1 + static_cast<int>(rng() % 90);
+          const int rh = 1 + static_cast<int>(rng() % 90);
+          const int radius = static_cast<int>(rng() % 30);
+          const int lineWidth = 1 + static_cast<int>(rng() % 5);
+          const Color color = colors[rng() % 4];
+          const bool state = rng() & 1;
+          switch (i % 5) {
+            case 0:
+              useReference ? reference.fillRectDither(x, y, rw, rh, color)
+                           : renderer.fillRectDither(x, y, rw, rh, color);
+              break;
+            case 1:
+              useReference ? reference.fillRect(x, y, rw, rh, state) : renderer.fillRect(x, y, rw, rh, state);
+              break;
+            case 2:
+              useReference ? reference.fillRoundedRect(x, y, rw, rh, radius, color)
+                           : renderer.fillRoundedRect(x, y, rw, rh, radius, color);
+              break;
+            case 3:
+              useReference ? reference.drawRoundedRect(x, y, rw, rh, lineWidth, radius, state)
+                           : renderer.drawRoundedRect(x, y, rw, rh, lineWidth, radius, state);
+              break;
+            case 4:
+              useReference ? reference.drawRect(x, y, rw, rh, lineWidth, state)
+                           : renderer.drawRect(x, y, rw, rh, lineWidth, state);
+              break;
+          }
+        }
+        snapshot(renderer, useReference ? expected : actual);
+      }
+      expect(expected == actual, name + ": random shapes");
+    }
+  }
+
+  constexpr int kFrames = 50;
+  for (const bool logical : {false, true}) {
+    renderer.setLogicalBufferEnabled(logical);
+    renderer.setOrientation(GfxRenderer::Portrait);
+    const int w = renderer.getScreenWidth();
+    const int h = renderer.getScreenHeight();
+    const double perPixel = millisPerFrame(renderer, kFrames, [&] { drawMenuFrame(reference, w, h); });
+    const double spans = millisPerFrame(renderer, kFrames, [&] { drawMenuFrame(renderer, w, h); });
+    printf("Portrait menu frame (%s): per-pixel %.3f ms, spans %.3f ms (%.1fx)\n",
+           logical ? "logical buffer" : "direct", perPixel, spans, perPixel / spans);
+  }
+  renderer.setLogicalBufferEnabled(false);
+
+  if (failures) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("UI frame: all checks passed\n");
+  return 0;
+}
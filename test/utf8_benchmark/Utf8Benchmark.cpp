@@ -0,0 +1,138 @@
+#include <Utf8.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Compares utf8NextCodepoint against the span decoder (utf8NextCodepoints) on English, German and Russian text:
+// first that both produce identical codepoints at every buffer alignment, then their throughput.
+// Usage: Utf8Benchmark [iterations]
+
+namespace {
+struct Sample {
+  const char* name;
+  const char* text;
+};
+
+const Sample kSamples[] = {
+    {"english",
+     "It was the best of times, it was the worst of times, it was the age of wisdom, it was the age of foolishness, "
+     "it was the epoch of belief, it was the epoch of incredulity, it was the season of Light, it was the season of "
+     "Darkness, it was the spring of hope, it was the winter of despair, we had everything before us, we had nothing "
+     "before us, we were all going direct to Heaven, we were all going direct the other way. "},
+    {"german",
+     "Als Gregor Samsa eines Morgens aus unruhigen Träumen erwachte, fand er sich in seinem Bett zu einem ungeheueren "
+     "Ungeziefer verwandelt. Er lag auf seinem panzerartig harten Rücken und sah, wenn er den Kopf ein wenig hob, "
+     "seinen gewölbten, braunen, von bogenförmigen Versteifungen geteilten Bauch, auf dessen Höhe sich die "
+     "Bettdecke, zum gänzlichen Niedergleiten bereit, kaum noch erhalten konnte. "},
+    {"russian",
+     "Все счастливые семьи похожи друг на друга, каждая несчастливая семья несчастлива по-своему. Всё смешалось в "
+     "доме Облонских. Жена узнала, что муж был в связи с бывшею в их доме француженкою-гувернанткой, и объявила мужу, "
+     "что не может жить с ним в одном доме. "},
+};
+
+constexpr size_t kTextBytes = 64 * 1024;
+
+std::string repeatToSize(const char* text, const size_t size) {
+  std::string out;
+  while (out.size() < size) {
+    out += text;
+  }
+  return out;
+}
+
+std::vector<uint32_t> decodeSingle(const char* text) {
+  std::vector<uint32_t> cps;
+  const auto* p = reinterpret_cast<const unsigned char*>(text);
+  uint32_t cp;
+  while ((cp = utf8NextCodepoint(&p))) {
+    cps.push_back(cp);
+  }
+  return cps;
+}
+
+std::vector<uint32_t> decodeSpans(const char* text) {
+  std::vector<uint32_t> cps;
+  const auto* p = reinterpret_cast<const unsigned char*>(text);
+  uint32_t span[UTF8_SPAN_MAX];
+  size_t count;
+  while ((count = utf8NextCodepoints(&p, span, UTF8_SPAN_MAX))) {
+    cps.insert(cps.end(), span, span + count);
+  }
+  return cps;
+}
+
+template <typename Fn>
+double measureMBps(const std::string& text, const int iterations, Fn&& decode) {
+  uint64_t checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    checksum += decode(text.c_str());
+  }
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  // Keep the decode loops from being optimized away
+  if (checksum == 42) {
+    printf(" ");
+  }
+  return static_cast<double>(text.size()) * iterations / elapsed / (1024.0 * 1024.0);
+}
+
+uint64_t sumSingle(const char* text) {
+  uint64_t sum = 0;
+  const auto* p = reinterpret_cast<const unsigned char*>(text);
+  uint32_t cp;
+  while ((cp = utf8NextCodepoint(&p))) {
+    sum += cp;
+  }
+  return sum;
+}
+
+uint64_t sumSpans(const char* text) {
+  uint64_t sum = 0;
+  const auto* p = reinterpret_cast<const unsigned char*>(text);
+  uint32_t span[UTF8_SPAN_MAX];
+  size_t count;
+  while ((count = utf8NextCodepoints(&p, span, UTF8_SPAN_MAX))) {
+    for (size_t i = 0; i < count; i++) {
+      sum += span[i];
+    }
+  }
+  return sum;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int iterations = argc > 1 ? std::max(1, atoi(argv[1])) : 200;
+  int failures = 0;
+
+  for (const auto& sample : kSamples) {
+    // Every start alignment, so both the byte loop and the word loop see all offsets
+    std::vector<char> buffer(strlen(sample.text) + 16);
+    for (size_t offset = 0; offset < 8; offset++) {
+      memcpy(buffer.data() + offset, sample.text, strlen(sample.text) + 1);
+      if (decodeSingle(buffer.data() + offset) != decodeSpans(buffer.data() + offset)) {
+        printf("FAIL: %s decodes differently at offset %zu\n", sample.name, offset);
+        failures++;
+      }
+    }
+  }
+  // Truncated sequences must not run past the terminator
+  if (decodeSpans("ab\xD0") != std::vector<uint32_t>{'a', 'b', REPLACEMENT_GLYPH}) {
+    printf("FAIL: truncated sequence\n");
+    failures++;
+  }
+  if (failures) {
+    return 1;
+  }
+
+  printf("%-8s %12s %12s %8s\n", "sample", "single MB/s", "spans MB/s", "speedup");
+  for (const auto& sample : kSamples) {
+    const std::string text = repeatToSize(sample.text, kTextBytes);
+    const double single = measureMBps(text, iterations, sumSingle);
+    const double spans = measureMBps(text, iterations, sumSpans);
+    printf("%-8s %12.1f %12.1f %7.2fx\n", sample.name, single, spans, spans / single);
+  }
+  return 0;
+}
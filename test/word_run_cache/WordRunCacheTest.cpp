@@ -0,0 +1,140 @@
+#include <GfxRenderer.h>
+#include <HalDisplay.h>
+#include <HostTest.h>
+#include <WordRunCache.h>
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lib/EpdFont/builtinFonts/bookerly_14_bold.h"
+#include "lib/EpdFont/builtinFonts/bookerly_14_italic.h"
+#include "lib/EpdFont/builtinFonts/bookerly_14_regular.h"
+
+// Renders the same pages with and without a WordRunCache and checks that the frame buffers are identical in every
+// orientation and render mode, and that repeated words are served from the cache within its memory budget. A second
+// cache with a tiny budget checks that runs stay intact while the arena is compacted on every other insert.
+
+namespace {
+constexpr int FONT_ID = 1;
+
+const char* const kPageText =
+    "It was the best of times, it was the worst of times, it was the age of wisdom, it was the age of foolishness, "
+    "it was the epoch of belief, it was the epoch of incredulity, it was the season of Light, it was the season of "
+    "Darkness, it was the spring of hope, it was the winter of despair. Über den Wolken muss die Freiheit wohl "
+    "grenzenlos sein. Все счастливые семьи похожи друг на друга, каждая несчастливая семья несчастлива по-своему.";
+
+std::vector<std::string> splitWords(const char* text) {
+  std::vector<std::string> words;
+  std::istringstream in(text);
+  std::string word;
+  while (in >> word) {
+    words.push_back(word);
+  }
+  return words;
+}
+
+// Lays words out like TextBlock: left to right, wrapping at the screen edge, cycling through styles
+void renderPage(const GfxRenderer& renderer, const std::vector<std::string>& words, const int pass) {
+  const int spaceWidth = renderer.getSpaceWidth(FONT_ID);
+  const int lineHeight = renderer.getLineHeight(FONT_ID);
+  int x = 10;
+  int y = 10 + pass;
+  for (size_t i = 0; i < words.size(); i++) {
+    const auto style = static_cast<EpdFontFamily::Style>(i % 7 == 3 ? EpdFontFamily::BOLD
+                                                         : i % 11 == 5 ? EpdFontFamily::ITALIC
+                                                                       : EpdFontFamily::REGULAR);
+    const int width = renderer.getTextAdvanceX(FONT_ID, words[i].c_str(), style);
+    if (x + width > renderer.getScreenWidth() - 10) {
+      x = 10;
+      y += lineHeight;
+    }
+    if (y + lineHeight > renderer.getScreenHeight()) {
+      break;
+    }
+    renderer.drawText(FONT_ID, x, y, words[i].c_str(), true, style);
+    x += width + spaceWidth;
+  }
+}
+}  // namespace
+
+int main() {
+  HalDisplay display;
+  FontDecompressor decompressor;
+  decompressor.init();
+
+  EpdFont regular(&bookerly_14_regular);
+  EpdFont bold(&bookerly_14_bold);
+  EpdFont italic(&bookerly_14_italic);
+  EpdFontFamily family(&regular, &bold, &italic);
+
+  GfxRenderer plain(display);
+  GfxRenderer cached(display);
+  GfxRenderer tight(display);
+  for (GfxRenderer* renderer : {&plain, &cached, &tight}) {
+    renderer->begin();
+    renderer->setFontDecompressor(&decompressor);
+    renderer->insertFont(FONT_ID, family);
+  }
+  WordRunCache cache;
+  cached.setWordRunCache(&cache);
+  WordRunCache tinyCache(2048);
+  tight.setWordRunCache(&tinyCache);
+
+  const auto words = splitWords(kPageText);
+  std::vector<uint8_t> expected(HalDisplay::BUFFER_SIZE);
+
+  const GfxRenderer::Orientation orientations[] = {GfxRenderer::Portrait, GfxRenderer::LandscapeClockwise,
+                                                   GfxRenderer::PortraitInverted,
+                                                   GfxRenderer::LandscapeCounterClockwise};
+  const GfxRenderer::RenderMode modes[] = {GfxRenderer::BW, GfxRenderer::GRAYSCALE_LSB, GfxRenderer::GRAYSCALE_MSB};
+
+  for (const auto orientation : orientations) {
+    for (const auto mode : modes) {
+      // Several pages so words are seen, admitted and then hit
+      for (int pass = 0; pass < 3; pass++) {
+        plain.setOrientation(orientation);
+        plain.setRenderMode(mode);
+        plain.clearScreen(mode == GfxRenderer::BW ? 0xFF : 0x00);
+        renderPage(plain, words, pass);
+        plain.clearFontCache();
+        memcpy(expected.data(), display.getFrameBuffer(), expected.size());
+
+        for (GfxRenderer* renderer : {&cached, &tight}) {
+          renderer->setOrientation(orientation);
+          renderer->setRenderMode(mode);
+          renderer->clearScreen(mode == GfxRenderer::BW ? 0xFF : 0x00);
+          renderPage(*renderer, words, pass);
+          renderer->clearFontCache();
+
+          expect(memcmp(expected.data(), display.getFrameBuffer(), expected.size()) == 0,
+                 std::string(renderer == &tight ? "tiny cache: " : "") + "frame buffer differs (orientation " +
+                     std::to_string(orientation) + ", mode " + std::to_string(mode) + ", pass " +
+                     std::to_string(pass) + ")");
+        }
+      }
+    }
+  }
+
+  const auto& stats = cache.getStats();
+  std::cout << "hits " << stats.hits << ", misses " << stats.misses << ", inserts " << stats.inserts
+            << ", evictions " << stats.evictions << ", peak " << stats.peakBytes << " bytes\n";
+  expect(stats.hits > 0, "repeated words are served from the cache");
+  expect(stats.peakBytes <= WordRunCache::DEFAULT_BUDGET_BYTES, "cache stays within its budget");
+  const auto& tinyStats = tinyCache.getStats();
+  expect(tinyStats.hits > 0 && tinyStats.evictions > 0, "tiny cache evicts and still hits");
+  expect(tinyStats.peakBytes <= 2048, "tiny cache stays within its budget");
+
+  cache.clear();
+  expect(cache.getStats().entries == 0 && cache.getStats().bytesUsed == 0, "clear releases all runs");
+
+  decompressor.deinit();
+  if (failures) {
+    std::cerr << failures << " check(s) failed\n";
+    return 1;
+  }
+  std::cout << "WordRunCache: all checks passed\n";
+  return 0;
+}